@@ -148,6 +148,53 @@ void BM_Execute_Identity(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Execute_Identity)->Arg(0)->Arg(1);
 
+// Dispatches a mix of small scalar ops, whose cost is dominated by the eager
+// dispatch overhead.
+void BM_Execute_ScalarOps(::testing::benchmark::State& state) {
+  const int async = state.range(0);
+  state.SetLabel(async ? "ExecuteScalarOpsAsync" : "ExecuteScalarOps");
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_ContextOptionsSetAsync(opts, static_cast<unsigned char>(async));
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  const char* const op_names[] = {"AddV2", "Mul", "Sub", "Maximum"};
+  TFE_TensorHandle* x = TestScalarTensorHandle(ctx, 2.0f);
+  TFE_TensorHandle* y = TestScalarTensorHandle(ctx, 3.0f);
+  TFE_Op* op = TFE_NewOp(ctx, op_names[0], status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_TensorHandle* retvals[1];
+  int num_retvals = 1;
+  int i = 0;
+  for (auto s : state) {
+    TFE_OpReset(op, op_names[i++ % 4], nullptr, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(op, x, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(op, y, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpSetAttrType(op, "T", TF_FLOAT);
+    TFE_Execute(op, &retvals[0], &num_retvals, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(retvals[0]);
+    if (state.iterations() >= state.max_iterations && async) {
+      TFE_Executor* executor = TFE_ContextGetExecutorForThread(ctx);
+      TFE_ExecutorWaitForAllPendingNodes(executor, status);
+      ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+      TFE_DeleteExecutor(executor);
+    }
+  }
+  TFE_DeleteOp(op);
+  TFE_DeleteTensorHandle(x);
+  TFE_DeleteTensorHandle(y);
+  TFE_DeleteContext(ctx);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_DeleteStatus(status);
+}
+BENCHMARK(BM_Execute_ScalarOps)->Arg(0)->Arg(1);
+
 TEST(CAPI, Context) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
@@ -0,0 +1,253 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This file extends/implements core tf.data components to call UDFs provided
+// by plugins through the C API defined in udf_plugin.h.
+
+#include "tensorflow/c/experimental/data/udf_plugin.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/c/experimental/data/udf_plugin_internal.h"
+#include "tensorflow/c/tf_status_helper.h"
+#include "tensorflow/c/tf_tensor_internal.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace {
+
+#define VALIDATE_STRUCT_SIZE(STRUCT_NAME, STRUCT_OBJ, SIZE_VALUE_NAME)    \
+  do {                                                                    \
+    if (STRUCT_OBJ.struct_size == 0) {                                    \
+      return tensorflow::Status(tensorflow::error::FAILED_PRECONDITION,   \
+                                "struct_size field in " #STRUCT_NAME      \
+                                " must be set to " #SIZE_VALUE_NAME "."); \
+    }                                                                     \
+  } while (0)
+
+#define VALIDATE_MEMBER(STRUCT_NAME, STRUCT_OBJ, NAME)                  \
+  do {                                                                  \
+    if (STRUCT_OBJ.NAME == 0) {                                         \
+      return tensorflow::Status(tensorflow::error::FAILED_PRECONDITION, \
+                                "'" #NAME "' field in " #STRUCT_NAME    \
+                                " must be set.");                       \
+    }                                                                   \
+  } while (0)
+
+tensorflow::Status ValidateTPDataUdfRegistrationParams(
+    const TP_DataUdfRegistrationParams& params) {
+  VALIDATE_STRUCT_SIZE(TP_DataUdfRegistrationParams, params,
+                       TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE);
+  if (params.num_udfs > 0) {
+    VALIDATE_MEMBER(TP_DataUdfRegistrationParams, params, udfs);
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ValidateTPDataUdf(const TP_DataUdf& udf) {
+  VALIDATE_STRUCT_SIZE(TP_DataUdf, udf, TP_DATA_UDF_STRUCT_SIZE);
+  VALIDATE_MEMBER(TP_DataUdf, udf, name);
+  VALIDATE_MEMBER(TP_DataUdf, udf, compute_func);
+  if (udf.create_func != nullptr) {
+    VALIDATE_MEMBER(TP_DataUdf, udf, destroy_func);
+  }
+  return tensorflow::Status::OK();
+}
+
+#undef VALIDATE_MEMBER
+#undef VALIDATE_STRUCT_SIZE
+
+// Registry of the UDFs provided by plugins, keyed by name.
+class DataUdfRegistry {
+ public:
+  static DataUdfRegistry* Global() {
+    static DataUdfRegistry* registry = new DataUdfRegistry;
+    return registry;
+  }
+
+  // Registers all of `udfs`, or none of them if any name is already taken.
+  tensorflow::Status Register(const TP_DataUdf* udfs, int num_udfs) {
+    tensorflow::mutex_lock l(mu_);
+    absl::flat_hash_set<tensorflow::string> names;
+    for (int i = 0; i < num_udfs; ++i) {
+      if (udfs_.contains(udfs[i].name)) {
+        return tensorflow::errors::AlreadyExists(
+            "A tf.data UDF named '", udfs[i].name, "' is already registered.");
+      }
+      if (!names.insert(udfs[i].name).second) {
+        return tensorflow::errors::AlreadyExists(
+            "The plugin provides more than one tf.data UDF named '",
+            udfs[i].name, "'.");
+      }
+    }
+    for (int i = 0; i < num_udfs; ++i) {
+      udfs_.emplace(udfs[i].name, udfs[i]);
+    }
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status Lookup(const tensorflow::string& name,
+                            TP_DataUdf* udf) const {
+    tensorflow::tf_shared_lock l(mu_);
+    auto it = udfs_.find(name);
+    if (it == udfs_.end()) {
+      return tensorflow::errors::NotFound(
+          "No tf.data UDF named '", name,
+          "' is registered. Make sure that the plugin providing it is loaded "
+          "in this process.");
+    }
+    *udf = it->second;
+    return tensorflow::Status::OK();
+  }
+
+ private:
+  mutable tensorflow::mutex mu_;
+  absl::flat_hash_map<tensorflow::string, TP_DataUdf> udfs_
+      TF_GUARDED_BY(mu_);
+};
+
+struct TFStatusDeleter {
+  void operator()(TF_Status* s) const { TF_DeleteStatus(s); }
+};
+using OwnedTFStatus = std::unique_ptr<TF_Status, TFStatusDeleter>;
+
+struct TFTensorDeleter {
+  void operator()(TF_Tensor* t) const { TF_DeleteTensor(t); }
+};
+using OwnedTFTensor = std::unique_ptr<TF_Tensor, TFTensorDeleter>;
+
+}  // namespace
+
+namespace tensorflow {
+namespace data {
+
+Status InitDataUdfPlugin(void* dso_handle) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+
+  // Step 1: Load symbol for `TF_InitDataUdf`
+  void* dso_symbol;
+  TF_RETURN_IF_ERROR(
+      env->GetSymbolFromLibrary(dso_handle, "TF_InitDataUdf", &dso_symbol));
+
+  // Step 2: Call `TF_InitDataUdf`
+  auto init_fn = reinterpret_cast<TFInitDataUdfPluginFn>(dso_symbol);
+  return InitDataUdfPlugin(init_fn);
+}
+
+Status InitDataUdfPlugin(TFInitDataUdfPluginFn init_fn) {
+  TP_DataUdfRegistrationParams params{
+      TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE};
+  params.major_version = DU_MAJOR;
+  params.minor_version = DU_MINOR;
+  params.patch_version = DU_PATCH;
+
+  OwnedTFStatus c_status(TF_NewStatus());
+  init_fn(&params, c_status.get());
+  TF_RETURN_IF_ERROR(tensorflow::StatusFromTF_Status(c_status.get()));
+  TF_RETURN_IF_ERROR(ValidateTPDataUdfRegistrationParams(params));
+
+  for (int i = 0; i < params.num_udfs; ++i) {
+    TF_RETURN_IF_ERROR(ValidateTPDataUdf(params.udfs[i]));
+  }
+  TF_RETURN_IF_ERROR(
+      DataUdfRegistry::Global()->Register(params.udfs, params.num_udfs));
+  for (int i = 0; i < params.num_udfs; ++i) {
+    VLOG(1) << "Registered tf.data UDF " << params.udfs[i].name;
+  }
+  return Status::OK();
+}
+
+Status LoadDataUdfPlugin(const string& library_filename) {
+  static mutex* mu = new mutex;
+  static auto* loaded_libraries = new absl::flat_hash_set<string>;
+  mutex_lock l(*mu);
+  if (loaded_libraries->contains(library_filename)) {
+    return Status::OK();
+  }
+  void* dso_handle;
+  TF_RETURN_IF_ERROR(Env::Default()->LoadDynamicLibrary(
+      library_filename.c_str(), &dso_handle));
+  TF_RETURN_IF_ERROR(InitDataUdfPlugin(dso_handle));
+  loaded_libraries->insert(library_filename);
+  return Status::OK();
+}
+
+Status CDataUdf::Create(const string& name, const string& config,
+                        std::unique_ptr<CDataUdf>* out) {
+  TP_DataUdf udf;
+  TF_RETURN_IF_ERROR(DataUdfRegistry::Global()->Lookup(name, &udf));
+  void* state = nullptr;
+  if (udf.create_func != nullptr) {
+    OwnedTFStatus c_status(TF_NewStatus());
+    state = udf.create_func(config.data(), config.size(), c_status.get());
+    TF_RETURN_IF_ERROR(tensorflow::StatusFromTF_Status(c_status.get()));
+  }
+  out->reset(new CDataUdf(udf, state));
+  return Status::OK();
+}
+
+CDataUdf::~CDataUdf() {
+  if (udf_.destroy_func != nullptr) {
+    udf_.destroy_func(state_);
+  }
+}
+
+Status CDataUdf::Compute(const std::vector<Tensor>& inputs, int num_outputs,
+                         std::vector<Tensor>* outputs) const {
+  std::vector<OwnedTFTensor> c_inputs;
+  std::vector<TF_Tensor*> c_input_ptrs;
+  c_inputs.reserve(inputs.size());
+  c_input_ptrs.reserve(inputs.size());
+  for (const Tensor& input : inputs) {
+    Status s;
+    c_inputs.emplace_back(TF_TensorFromTensor(input, &s));
+    TF_RETURN_IF_ERROR(s);
+    c_input_ptrs.push_back(c_inputs.back().get());
+  }
+
+  std::vector<TF_Tensor*> c_output_ptrs(num_outputs, nullptr);
+  OwnedTFStatus c_status(TF_NewStatus());
+  udf_.compute_func(state_, c_input_ptrs.data(), c_input_ptrs.size(),
+                    c_output_ptrs.data(), num_outputs, c_status.get());
+  // Take ownership of the outputs before checking the status, so that they
+  // are released in any case.
+  std::vector<OwnedTFTensor> c_outputs;
+  c_outputs.reserve(num_outputs);
+  for (TF_Tensor* c_output : c_output_ptrs) {
+    c_outputs.emplace_back(c_output);
+  }
+  TF_RETURN_IF_ERROR(tensorflow::StatusFromTF_Status(c_status.get()));
+
+  outputs->clear();
+  outputs->reserve(num_outputs);
+  for (int i = 0; i < num_outputs; ++i) {
+    if (c_outputs[i] == nullptr) {
+      return errors::Internal("tf.data UDF '", udf_.name,
+                              "' did not produce output ", i, ".");
+    }
+    outputs->emplace_back();
+    TF_RETURN_IF_ERROR(TF_TensorToTensor(c_outputs[i].get(), &outputs->back()));
+  }
+  return Status::OK();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,148 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_C_EXPERIMENTAL_DATA_UDF_PLUGIN_H_
+#define TENSORFLOW_C_EXPERIMENTAL_DATA_UDF_PLUGIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tensorflow/c/c_api_macros.h"
+#include "tensorflow/c/tf_status.h"
+#include "tensorflow/c/tf_tensor.h"
+
+// --------------------------------------------------------------------------
+// C API for tf.data user-defined functions (UDFs). It allows registering
+// compiled per-element transformations, implemented in a shared object, which
+// can be called from the functions of tf.data transformations such as `map`
+// through the `DataUdf` op. Unlike `tf.py_function`, such UDFs don't hold the
+// Python GIL, so they run with the full parallelism of the transformation, and
+// they can run in tf.data service workers, which don't embed Python.
+//
+// Conventions:
+//   * Struct prefix indicates whether struct fields should be filled by the
+//     plugin or core implementation:
+//     * Struct that should be filled by the plugin: `TP_DataUdf`,
+//       `TP_DataUdfRegistrationParams`
+//   * We use `struct_size` for version checking. It should be set both by
+//     core and the plugin.
+//   * `void* ext` is a free-form field that can be populated by
+//     a plugin in `TP_*` structs or potential future extension points.
+//   * A UDF is identified by its name, which must be unique in the process.
+//     The `DataUdf` op refers to the UDF by name, so the same plugin must be
+//     available wherever the dataset runs, e.g. on the tf.data service workers.
+//
+// Example usage:
+//
+//   /* Plugin code below */
+//   void* Create(const char* config, size_t config_len, TF_Status* status) {
+//     return new MyState(config, config_len);
+//   }
+//
+//   void Compute(void* state, TF_Tensor* const* inputs, int num_inputs,
+//                TF_Tensor** outputs, int num_outputs, TF_Status* status) {
+//     outputs[0] = TF_AllocateTensor(...);
+//     ...
+//     TF_SetStatus(status, TF_OK, "");
+//   }
+//
+//   void Destroy(void* state) { delete static_cast<MyState*>(state); }
+//
+//   static TP_DataUdf udfs[1];
+//
+//   void TF_InitDataUdf(TP_DataUdfRegistrationParams* params,
+//                       TF_Status* status) {
+//     params->struct_size = TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE;
+//     udfs[0].struct_size = TP_DATA_UDF_STRUCT_SIZE;
+//     udfs[0].name = "my_udf";
+//     udfs[0].create_func = Create;
+//     udfs[0].compute_func = Compute;
+//     udfs[0].destroy_func = Destroy;
+//     params->udfs = udfs;
+//     params->num_udfs = 1;
+//     TF_SetStatus(status, TF_OK, "");
+//   }
+
+#define DU_MAJOR 0
+#define DU_MINOR 0
+#define DU_PATCH 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Struct for a UDF. Plugin authors must provide a name and a compute function.
+// Creation and deletion functions are optional.
+typedef struct TP_DataUdf {
+  size_t struct_size;
+  void* ext;  // reserved for future use
+
+  // Name of the UDF, referred to by the `udf_name` attr of the `DataUdf` op.
+  // Must outlive the plugin.
+  const char* name;
+
+  // [Optional]
+  // Creates the state of one instance of the UDF, given the `config` attr of
+  // the `DataUdf` op. Returns an opaque pointer passed to `compute_func`.
+  void* (*create_func)(const char* config, size_t config_len,
+                       TF_Status* status);
+
+  // Applies the UDF to one element. The first param is the state created by
+  // `create_func` (or null). The function must fill in the `num_outputs`
+  // output tensors, whose ownership is transferred to the caller, and must
+  // not take ownership of the inputs.
+  //
+  // `compute_func` is called concurrently from multiple threads, with the
+  // same state, so it must be thread-safe. It should also be deterministic
+  // and free of side effects, as TensorFlow may fold, reorder or retry calls.
+  void (*compute_func)(void* state, TF_Tensor* const* inputs, int num_inputs,
+                       TF_Tensor** outputs, int num_outputs,
+                       TF_Status* status);
+
+  // [Optional]
+  // Destroys the state created by `create_func`. If the create function is
+  // provided, the destroy function is a must.
+  void (*destroy_func)(void* state);
+} TP_DataUdf;
+
+#define TP_DATA_UDF_STRUCT_SIZE TF_OFFSET_OF_END(TP_DataUdf, destroy_func)
+
+typedef struct TP_DataUdfRegistrationParams {
+  size_t struct_size;
+  void* ext;  // reserved for future use
+
+  // Data UDF C API version.
+  int32_t major_version;
+  int32_t minor_version;
+  int32_t patch_version;
+
+  // UDFs provided by the plugin. The array must outlive the plugin.
+  int32_t num_udfs;  // output, set by plugin
+  TP_DataUdf* udfs;  // output, set by plugin
+} TP_DataUdfRegistrationParams;
+
+#define TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE \
+  TF_OFFSET_OF_END(TP_DataUdfRegistrationParams, udfs)
+
+// TF_InitDataUdf is used to do UDF registration.
+// Plugin should implement TF_InitDataUdf to register its UDFs.
+void TF_InitDataUdf(TP_DataUdfRegistrationParams* params, TF_Status* status);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TENSORFLOW_C_EXPERIMENTAL_DATA_UDF_PLUGIN_H_
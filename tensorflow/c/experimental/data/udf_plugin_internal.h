@@ -0,0 +1,71 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Classes and utilities that are used to register and call tf.data UDFs
+// provided by plugins through the C API defined in udf_plugin.h.
+
+#ifndef TENSORFLOW_C_EXPERIMENTAL_DATA_UDF_PLUGIN_INTERNAL_H_
+#define TENSORFLOW_C_EXPERIMENTAL_DATA_UDF_PLUGIN_INTERNAL_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/c/experimental/data/udf_plugin.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// Plugin initialization function that a UDF plugin must define.
+typedef void (*TFInitDataUdfPluginFn)(TP_DataUdfRegistrationParams* const,
+                                      TF_Status* const);
+
+// Registers the UDFs of the plugin loaded in `dso_handle`.
+Status InitDataUdfPlugin(void* dso_handle);
+
+// Allow registering UDFs using a function (used for testing).
+Status InitDataUdfPlugin(TFInitDataUdfPluginFn init_fn);
+
+// Loads the shared object `library_filename` and registers its UDFs. Loading
+// the same library again is a no-op, so this may be called for each use of the
+// library.
+Status LoadDataUdfPlugin(const string& library_filename);
+
+// An instance of a registered UDF, holding the state created by the plugin.
+class CDataUdf {
+ public:
+  // Creates an instance of the UDF registered as `name` with `config`.
+  static Status Create(const string& name, const string& config,
+                       std::unique_ptr<CDataUdf>* out);
+
+  ~CDataUdf();
+
+  // Applies the UDF to `inputs`, producing `num_outputs` tensors. This can be
+  // called concurrently.
+  Status Compute(const std::vector<Tensor>& inputs, int num_outputs,
+                 std::vector<Tensor>* outputs) const;
+
+ private:
+  CDataUdf(const TP_DataUdf& udf, void* state) : udf_(udf), state_(state) {}
+
+  const TP_DataUdf udf_;
+  void* const state_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_C_EXPERIMENTAL_DATA_UDF_PLUGIN_INTERNAL_H_
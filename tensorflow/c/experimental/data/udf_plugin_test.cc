@@ -0,0 +1,170 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/c/experimental/data/udf_plugin.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/c/experimental/data/udf_plugin_internal.h"
+#include "tensorflow/c/tf_status.h"
+#include "tensorflow/c/tf_tensor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Adds the float in `config` to every element of its float input.
+void* CreateAddConstant(const char* config, size_t config_len,
+                        TF_Status* status) {
+  TF_SetStatus(status, TF_OK, "");
+  return new float(std::stof(std::string(config, config_len)));
+}
+
+void ComputeAddConstant(void* state, TF_Tensor* const* inputs, int num_inputs,
+                        TF_Tensor** outputs, int num_outputs,
+                        TF_Status* status) {
+  if (num_inputs != 1 || num_outputs != 1 ||
+      TF_TensorType(inputs[0]) != TF_FLOAT) {
+    TF_SetStatus(status, TF_INVALID_ARGUMENT, "Expected one float tensor.");
+    return;
+  }
+  const int num_dims = TF_NumDims(inputs[0]);
+  std::vector<int64_t> dims(num_dims);
+  for (int i = 0; i < num_dims; ++i) {
+    dims[i] = TF_Dim(inputs[0], i);
+  }
+  outputs[0] = TF_AllocateTensor(TF_FLOAT, dims.data(), num_dims,
+                                 TF_TensorByteSize(inputs[0]));
+  const float* in = static_cast<const float*>(TF_TensorData(inputs[0]));
+  float* out = static_cast<float*>(TF_TensorData(outputs[0]));
+  const float constant = *static_cast<float*>(state);
+  for (int64_t i = 0; i < TF_TensorElementCount(inputs[0]); ++i) {
+    out[i] = in[i] + constant;
+  }
+  TF_SetStatus(status, TF_OK, "");
+}
+
+void DestroyAddConstant(void* state) { delete static_cast<float*>(state); }
+
+void PopulateDefaultUdf(TP_DataUdf* udf, const char* name) {
+  udf->struct_size = TP_DATA_UDF_STRUCT_SIZE;
+  udf->name = name;
+  udf->create_func = CreateAddConstant;
+  udf->compute_func = ComputeAddConstant;
+  udf->destroy_func = DestroyAddConstant;
+}
+
+TEST(DataUdfPlugin, RegisterAndCompute) {
+  auto plugin_init = [](TP_DataUdfRegistrationParams* const params,
+                        TF_Status* const status) -> void {
+    static TP_DataUdf udfs[1];
+    PopulateDefaultUdf(&udfs[0], "add_constant");
+    params->struct_size = TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE;
+    params->udfs = udfs;
+    params->num_udfs = 1;
+    TF_SetStatus(status, TF_OK, "");
+  };
+  TF_ASSERT_OK(InitDataUdfPlugin(plugin_init));
+
+  std::unique_ptr<CDataUdf> udf;
+  TF_ASSERT_OK(CDataUdf::Create("add_constant", "1.5", &udf));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(udf->Compute({test::AsTensor<float>({1.0f, 2.0f}, {2})},
+                            /*num_outputs=*/1, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(outputs[0],
+                                 test::AsTensor<float>({2.5f, 3.5f}, {2}));
+
+  Status s = udf->Compute({test::AsTensor<int32>({1}, {1})},
+                          /*num_outputs=*/1, &outputs);
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+  EXPECT_EQ(s.error_message(), "Expected one float tensor.");
+}
+
+TEST(DataUdfPlugin, DuplicateName) {
+  auto plugin_init = [](TP_DataUdfRegistrationParams* const params,
+                        TF_Status* const status) -> void {
+    static TP_DataUdf udfs[1];
+    PopulateDefaultUdf(&udfs[0], "duplicate");
+    params->struct_size = TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE;
+    params->udfs = udfs;
+    params->num_udfs = 1;
+    TF_SetStatus(status, TF_OK, "");
+  };
+  TF_ASSERT_OK(InitDataUdfPlugin(plugin_init));
+  EXPECT_EQ(InitDataUdfPlugin(plugin_init).code(), error::ALREADY_EXISTS);
+}
+
+TEST(DataUdfPlugin, ConflictRegistersNothing) {
+  auto taken_init = [](TP_DataUdfRegistrationParams* const params,
+                       TF_Status* const status) -> void {
+    static TP_DataUdf udfs[1];
+    PopulateDefaultUdf(&udfs[0], "taken");
+    params->struct_size = TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE;
+    params->udfs = udfs;
+    params->num_udfs = 1;
+    TF_SetStatus(status, TF_OK, "");
+  };
+  TF_ASSERT_OK(InitDataUdfPlugin(taken_init));
+
+  auto plugin_init = [](TP_DataUdfRegistrationParams* const params,
+                        TF_Status* const status) -> void {
+    static TP_DataUdf udfs[2];
+    PopulateDefaultUdf(&udfs[0], "not_taken");
+    PopulateDefaultUdf(&udfs[1], "taken");
+    params->struct_size = TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE;
+    params->udfs = udfs;
+    params->num_udfs = 2;
+    TF_SetStatus(status, TF_OK, "");
+  };
+  EXPECT_EQ(InitDataUdfPlugin(plugin_init).code(), error::ALREADY_EXISTS);
+  std::unique_ptr<CDataUdf> udf;
+  EXPECT_EQ(CDataUdf::Create("not_taken", "1.0", &udf).code(),
+            error::NOT_FOUND);
+}
+
+TEST(DataUdfPlugin, ComputeFuncNotSet) {
+  auto plugin_init = [](TP_DataUdfRegistrationParams* const params,
+                        TF_Status* const status) -> void {
+    static TP_DataUdf udfs[1];
+    PopulateDefaultUdf(&udfs[0], "no_compute");
+    udfs[0].compute_func = nullptr;
+    params->struct_size = TP_DATA_UDF_REGISTRATION_PARAMS_STRUCT_SIZE;
+    params->udfs = udfs;
+    params->num_udfs = 1;
+    TF_SetStatus(status, TF_OK, "");
+  };
+  Status status = InitDataUdfPlugin(plugin_init);
+  ASSERT_EQ(status.code(), error::FAILED_PRECONDITION);
+  ASSERT_EQ(status.error_message(),
+            "'compute_func' field in TP_DataUdf must be set.");
+}
+
+TEST(DataUdfPlugin, UnknownUdf) {
+  std::unique_ptr<CDataUdf> udf;
+  EXPECT_EQ(CDataUdf::Create("unknown", "", &udf).code(), error::NOT_FOUND);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
 #include <unordered_set>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
 #include "tensorflow/cc/saved_model/metrics.h"
@@ -257,11 +261,21 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              const SavedModelLoadOptions& load_options,
                               SavedModelBundle* const bundle) {
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  const string variables_path = io::JoinPath(
+      export_dir, kSavedModelVariablesDirectory, kSavedModelVariablesFilename);
+  if (load_options.num_restore_shards > 1 &&
+      bundle->meta_graph_def.has_saver_def() &&
+      Env::Default()->FileExists(MetaFilename(variables_path)).ok()) {
+    TF_RETURN_IF_ERROR(internal::ShardRestoreOps(
+        variables_path, load_options.num_restore_shards,
+        bundle->meta_graph_def.mutable_graph_def()));
+  }
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
@@ -269,16 +283,20 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   return Status::OK();
 }
 
-Status LoadSavedModel(const SessionOptions& session_options,
-                      const RunOptions& run_options, const string& export_dir,
-                      const std::unordered_set<string>& tags,
-                      SavedModelBundle* const bundle) {
+namespace {
+Status LoadSavedModelAndRecordMetrics(const SessionOptions& session_options,
+                                      const RunOptions& run_options,
+                                      const string& export_dir,
+                                      const std::unordered_set<string>& tags,
+                                      const SavedModelLoadOptions& load_options,
+                                      SavedModelBundle* const bundle) {
   metrics::SavedModelReadApi(kCCLoadLabel).IncrementBy(1);
 
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status =
+      LoadSavedModelInternal(session_options, run_options, export_dir, tags,
+                             load_options, bundle);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -294,6 +312,16 @@ Status LoadSavedModel(const SessionOptions& session_options,
       ->IncrementBy(GetLatencyMicroseconds(start_microseconds));
   return status;
 }
+}  // namespace
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle) {
+  return LoadSavedModelAndRecordMetrics(session_options, run_options,
+                                        export_dir, tags,
+                                        SavedModelLoadOptions(), bundle);
+}
 
 namespace {
 // Session wrapper that prevents calls to Session::Create(), Session::Extend(),
@@ -321,10 +349,66 @@ class LiteSessionWrapper : public Session {
     return errors::Unimplemented("Session::Extend()");
   }
 
+  // Prepares the executors of `signature_def`, which are then used by Run()
+  // calls with the signature's inputs and outputs.
+  Status PrepareSignature(const SignatureDef& signature_def) {
+    PreparedSignature prepared;
+    for (const auto& input : signature_def.inputs()) {
+      prepared.feeds.push_back(input.second.name());
+    }
+    for (const auto& output : signature_def.outputs()) {
+      prepared.fetches.push_back(output.second.name());
+    }
+    std::sort(prepared.feeds.begin(), prepared.feeds.end());
+    std::sort(prepared.fetches.begin(), prepared.fetches.end());
+    prepared.fetches.erase(
+        std::unique(prepared.fetches.begin(), prepared.fetches.end()),
+        prepared.fetches.end());
+    const string key = PreparedSignatureKey(prepared.feeds, prepared.fetches);
+    if (prepared_signatures_.contains(key)) {
+      return Status::OK();
+    }
+    // Uses the default run options, like the Run() calls served by it.
+    CallableOptions callable_options;
+    for (const string& feed : prepared.feeds) {
+      callable_options.add_feed(feed);
+    }
+    for (const string& fetch : prepared.fetches) {
+      callable_options.add_fetch(fetch);
+    }
+    TF_RETURN_IF_ERROR(
+        wrapped_->MakeCallable(callable_options, &prepared.handle));
+    prepared_signatures_.emplace(key, std::move(prepared));
+    return Status::OK();
+  }
+
   Status Run(const std::vector<std::pair<string, Tensor>>& inputs,
              const std::vector<string>& output_tensor_names,
              const std::vector<string>& target_node_names,
              std::vector<Tensor>* outputs) override {
+    if (!prepared_signatures_.empty() && target_node_names.empty()) {
+      std::vector<std::pair<string, Tensor>> sorted_inputs(inputs);
+      std::sort(sorted_inputs.begin(), sorted_inputs.end(),
+                [](const std::pair<string, Tensor>& a,
+                   const std::pair<string, Tensor>& b) {
+                  return a.first < b.first;
+                });
+      std::vector<string> feeds;
+      feeds.reserve(sorted_inputs.size());
+      for (const auto& input : sorted_inputs) {
+        feeds.push_back(input.first);
+      }
+      std::vector<string> fetches(output_tensor_names);
+      std::sort(fetches.begin(), fetches.end());
+      fetches.erase(std::unique(fetches.begin(), fetches.end()),
+                    fetches.end());
+      const auto it =
+          prepared_signatures_.find(PreparedSignatureKey(feeds, fetches));
+      if (it != prepared_signatures_.end()) {
+        return RunPrepared(it->second, sorted_inputs, output_tensor_names,
+                           outputs);
+      }
+    }
     return wrapped_->Run(inputs, output_tensor_names, target_node_names,
                          outputs);
   }
@@ -400,7 +484,46 @@ class LiteSessionWrapper : public Session {
   }
 
  private:
+  struct PreparedSignature {
+    // Sorted feed and fetch names of the callable.
+    std::vector<string> feeds;
+    std::vector<string> fetches;
+    CallableHandle handle;
+  };
+
+  static string PreparedSignatureKey(const std::vector<string>& feeds,
+                                     const std::vector<string>& fetches) {
+    return strings::StrCat(absl::StrJoin(feeds, ","), ";",
+                           absl::StrJoin(fetches, ","));
+  }
+
+  Status RunPrepared(
+      const PreparedSignature& prepared,
+      const std::vector<std::pair<string, Tensor>>& sorted_inputs,
+      const std::vector<string>& output_tensor_names,
+      std::vector<Tensor>* outputs) {
+    std::vector<Tensor> feed_tensors;
+    feed_tensors.reserve(sorted_inputs.size());
+    for (const auto& input : sorted_inputs) {
+      feed_tensors.push_back(input.second);
+    }
+    std::vector<Tensor> fetch_tensors;
+    TF_RETURN_IF_ERROR(wrapped_->RunCallable(prepared.handle, feed_tensors,
+                                             &fetch_tensors,
+                                             /*run_metadata=*/nullptr));
+    outputs->clear();
+    outputs->reserve(output_tensor_names.size());
+    for (const string& name : output_tensor_names) {
+      const auto it = std::lower_bound(prepared.fetches.begin(),
+                                       prepared.fetches.end(), name);
+      outputs->push_back(fetch_tensors[it - prepared.fetches.begin()]);
+    }
+    return Status::OK();
+  }
+
   const std::unique_ptr<Session> wrapped_;
+  // Only modified while loading, before the session is shared.
+  absl::flat_hash_map<string, PreparedSignature> prepared_signatures_;
 };
 }  // namespace
 
@@ -439,6 +562,15 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle) {
+  return LoadSavedModel(session_options, run_options, export_dir, tags,
+                        SavedModelLoadOptions(), bundle);
+}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const SavedModelLoadOptions& load_options,
+                      SavedModelBundleLite* const bundle) {
   SavedModelBundle legacy_bundle;
   SessionOptions rewritten_options(session_options);
   // We disallow calls to Session::Extend() on the returned session, so we can
@@ -452,11 +584,24 @@ Status LoadSavedModel(const SessionOptions& session_options,
       ->set_disable_output_partition_graphs(true);
   // TODO(mrry): Consider specializing the session creation to reduce peak
   // RAM consumption by using `Session::Create(GraphDef&&)`.
-  TF_RETURN_IF_ERROR(LoadSavedModel(rewritten_options, run_options, export_dir,
-                                    tags, &legacy_bundle));
+  TF_RETURN_IF_ERROR(LoadSavedModelAndRecordMetrics(
+      rewritten_options, run_options, export_dir, tags, load_options,
+      &legacy_bundle));
+  auto* session = new LiteSessionWrapper(std::move(legacy_bundle.session));
   *bundle = SavedModelBundleLite(
-      absl::make_unique<LiteSessionWrapper>(std::move(legacy_bundle.session)),
+      absl::WrapUnique(session),
       std::move(*legacy_bundle.meta_graph_def.mutable_signature_def()));
+  // The bundle owns the session from here on, so that it is closed if warming
+  // up fails.
+  for (const string& signature_key : load_options.warmup_signatures) {
+    const auto it = bundle->GetSignatures().find(signature_key);
+    if (it == bundle->GetSignatures().end()) {
+      return errors::InvalidArgument("Warmup signature \"", signature_key,
+                                     "\" not found in SavedModel at ",
+                                     export_dir);
+    }
+    TF_RETURN_IF_ERROR(session->PrepareSignature(it->second));
+  }
   return Status::OK();
 }
 
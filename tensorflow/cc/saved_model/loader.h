@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
@@ -135,6 +136,31 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle);
 
+/// Options that trade work done by LoadSavedModel against work done on the
+/// first call of each signature.
+///
+/// The session optimizes the graph of a signature and instantiates its
+/// functions on the first Run() with the signature's feeds and fetches, so
+/// loading does not prepare any signature unless it is listed in
+/// `warmup_signatures`.
+struct SavedModelLoadOptions {
+  /// Splits each restore op that restores several variables into up to this
+  /// many ops of about the same size, which restore their variables in
+  /// parallel.
+  int num_restore_shards = 1;
+  /// Keys of the signatures that are prepared while loading. Run() calls
+  /// whose feeds and fetches are exactly the inputs and outputs of a prepared
+  /// signature, and that have no targets, use the prepared executors.
+  std::vector<string> warmup_signatures;
+};
+
+/// Like the overload above, with the given `load_options`.
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      const SavedModelLoadOptions& load_options,
+                      SavedModelBundleLite* const bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
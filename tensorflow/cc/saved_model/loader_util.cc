@@ -15,15 +15,60 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader_util.h"
 
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace internal {
+namespace {
+
+// Returns the value of the Const node `name` in `graph_def`, or false if `name`
+// is not a Const node.
+bool GetConstValue(const GraphDef& graph_def,
+                   const std::unordered_map<string, int>& node_index,
+                   const string& name, Tensor* value) {
+  const auto it = node_index.find(name);
+  if (it == node_index.end()) {
+    return false;
+  }
+  const NodeDef& node = graph_def.node(it->second);
+  const auto value_it = node.attr().find("value");
+  return node.op() == "Const" && value_it != node.attr().end() &&
+         value->FromProto(value_it->second.tensor());
+}
+
+// Appends a Const node holding the elements `indices` of `value`.
+void AddConstNode(const string& name, const string& device,
+                  const Tensor& value, const std::vector<int>& indices,
+                  GraphDef* graph_def) {
+  Tensor shard_value(DT_STRING, TensorShape({static_cast<int64_t>(
+                                    indices.size())}));
+  for (int i = 0; i < indices.size(); ++i) {
+    shard_value.vec<tstring>()(i) = value.vec<tstring>()(indices[i]);
+  }
+  NodeDef* node = graph_def->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  (*node->mutable_attr())["dtype"].set_type(DT_STRING);
+  shard_value.AsProtoTensorContent(
+      (*node->mutable_attr())["value"].mutable_tensor());
+}
+
+}  // namespace
 
 // A SavedModel may store the name of the initialization op to run in the
 // in the SignatureDef (v2) or a collection (v1). If an init_op collection
@@ -86,5 +131,144 @@ Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
   return Status::OK();
 }
 
+Status ShardRestoreOps(const string& checkpoint_prefix, int num_shards,
+                       GraphDef* graph_def) {
+  if (num_shards <= 1) {
+    return Status::OK();
+  }
+  BundleReader reader(Env::Default(), checkpoint_prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+
+  std::unordered_map<string, int> node_index;
+  for (int i = 0; i < graph_def->node_size(); ++i) {
+    node_index[graph_def->node(i).name()] = i;
+  }
+  // Maps outputs of the sharded ops to the corresponding shard outputs.
+  std::unordered_map<string, string> shard_outputs;
+  // Maps the names of the sharded ops to the names of their shards.
+  std::unordered_map<string, std::vector<string>> shard_names;
+  const int num_nodes = graph_def->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    // Copied, because adding nodes invalidates references into `graph_def`.
+    const NodeDef node = graph_def->node(i);
+    Tensor names, shape_and_slices;
+    if (node.op() != "RestoreV2" || node.input_size() < 3 ||
+        !GetConstValue(*graph_def, node_index, node.input(1), &names) ||
+        !GetConstValue(*graph_def, node_index, node.input(2),
+                       &shape_and_slices) ||
+        names.dtype() != DT_STRING || names.dims() != 1 ||
+        shape_and_slices.dtype() != DT_STRING ||
+        shape_and_slices.NumElements() != names.NumElements() ||
+        node.attr().at("dtypes").list().type_size() != names.NumElements()) {
+      continue;
+    }
+    const int num_tensors = names.NumElements();
+    const int num_op_shards = std::min(num_shards, num_tensors);
+    if (num_op_shards <= 1) {
+      continue;
+    }
+
+    // Assigns the largest remaining tensor to the least loaded shard. Tensors
+    // missing from the checkpoint count as empty; RestoreV2 reports them.
+    std::vector<int64_t> tensor_bytes(num_tensors, 0);
+    for (int j = 0; j < num_tensors; ++j) {
+      DataType dtype;
+      TensorShape shape;
+      if (reader.LookupDtypeAndShape(names.vec<tstring>()(j), &dtype, &shape)
+              .ok()) {
+        tensor_bytes[j] = shape.num_elements() * DataTypeSize(dtype);
+      }
+    }
+    std::vector<int> order(num_tensors);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return tensor_bytes[a] > tensor_bytes[b];
+    });
+    std::vector<std::vector<int>> shards(num_op_shards);
+    std::vector<int64_t> shard_bytes(num_op_shards, 0);
+    for (const int j : order) {
+      const int shard = std::min_element(shard_bytes.begin(),
+                                         shard_bytes.end()) -
+                        shard_bytes.begin();
+      shards[shard].push_back(j);
+      shard_bytes[shard] += tensor_bytes[j];
+    }
+
+    const NodeDef& names_node = graph_def->node(node_index.at(node.input(1)));
+    const NodeDef& slices_node =
+        graph_def->node(node_index.at(node.input(2)));
+    const string names_device = names_node.device();
+    const string slices_device = slices_node.device();
+    for (int shard = 0; shard < num_op_shards; ++shard) {
+      std::vector<int>& indices = shards[shard];
+      std::sort(indices.begin(), indices.end());
+      const string shard_name = strings::StrCat(node.name(), "/shard_", shard);
+      AddConstNode(strings::StrCat(shard_name, "/tensor_names"), names_device,
+                   names, indices, graph_def);
+      AddConstNode(strings::StrCat(shard_name, "/shape_and_slices"),
+                   slices_device, shape_and_slices, indices, graph_def);
+      NodeDef* shard_node = graph_def->add_node();
+      *shard_node = node;
+      shard_node->set_name(shard_name);
+      shard_names[node.name()].push_back(shard_name);
+      shard_node->set_input(1, strings::StrCat(shard_name, "/tensor_names"));
+      shard_node->set_input(2,
+                            strings::StrCat(shard_name, "/shape_and_slices"));
+      auto* dtypes = (*shard_node->mutable_attr())["dtypes"].mutable_list();
+      dtypes->clear_type();
+      for (int k = 0; k < indices.size(); ++k) {
+        dtypes->add_type(node.attr().at("dtypes").list().type(indices[k]));
+        shard_outputs[strings::StrCat(node.name(), ":", indices[k])] =
+            strings::StrCat(shard_name, ":", k);
+      }
+    }
+  }
+
+  if (shard_names.empty()) {
+    return Status::OK();
+  }
+  // Rewires the consumers of the sharded ops, including shards whose original
+  // op had a control dependency on another sharded op, and then removes the
+  // sharded ops.
+  for (int i = 0; i < graph_def->node_size(); ++i) {
+    NodeDef* node = graph_def->mutable_node(i);
+    std::vector<string> control_inputs;
+    for (int j = 0; j < node->input_size(); ++j) {
+      const string& input = node->input(j);
+      if (absl::StartsWith(input, "^")) {
+        const auto it = shard_names.find(input.substr(1));
+        if (it != shard_names.end()) {
+          control_inputs.insert(control_inputs.end(), it->second.begin(),
+                                it->second.end());
+          node->mutable_input()->DeleteSubrange(j--, 1);
+        }
+        continue;
+      }
+      const auto it = shard_outputs.find(
+          input.find(':') == string::npos ? strings::StrCat(input, ":0")
+                                          : input);
+      if (it != shard_outputs.end()) {
+        node->set_input(j, it->second);
+      }
+    }
+    for (const string& control_input : control_inputs) {
+      const string input = strings::StrCat("^", control_input);
+      if (std::find(node->input().begin(), node->input().end(), input) ==
+          node->input().end()) {
+        node->add_input(input);
+      }
+    }
+  }
+  auto* nodes = graph_def->mutable_node();
+  int num_kept = 0;
+  for (int i = 0; i < nodes->size(); ++i) {
+    if (!shard_names.count(nodes->Get(i).name())) {
+      nodes->SwapElements(num_kept++, i);
+    }
+  }
+  nodes->DeleteSubrange(num_kept, nodes->size() - num_kept);
+  return Status::OK();
+}
+
 }  // namespace internal
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <string>
 
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 
@@ -33,6 +34,19 @@ Status GetInitOp(const string& export_dir, const MetaGraphDef& meta_graph_def,
 Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
                         std::vector<AssetFileDef>* asset_file_defs);
 
+// Splits each RestoreV2 op in `graph_def` that restores several tensors from
+// constant names into up to `num_shards` RestoreV2 ops, which the session runs
+// in parallel. Tensors are assigned to shards so that the shards restore about
+// the same number of bytes of the checkpoint at `checkpoint_prefix`. Consumers
+// of the original op, including control dependencies on it, are rewired to the
+// shards, and the original op is removed.
+//
+// Only RestoreV2 ops of the top-level graph are sharded, which covers the
+// restore ops of TF1 `Saver`s. RestoreV2 ops inside functions of the graph's
+// library, such as the restore functions of TF2 checkpoints, are left as is.
+Status ShardRestoreOps(const string& checkpoint_prefix, int num_shards,
+                       GraphDef* graph_def);
+
 }  // namespace internal
 }  // namespace tensorflow
 
@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/loader_util.h"
 #include "tensorflow/cc/saved_model/signature_constants.h"
 #include "tensorflow/cc/saved_model/tag_constants.h"
 #include "tensorflow/core/example/example.pb.h"
@@ -25,8 +27,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -263,5 +267,166 @@ TEST_F(LoaderTest, SavedModelInitOpV2Format) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, RestoreShardsAndWarmup) {
+  SavedModelBundleLite bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+  SavedModelLoadOptions load_options;
+  load_options.num_restore_shards = 4;
+  load_options.warmup_signatures = {"regress_x_to_y"};
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, load_options, &bundle));
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
+TEST_F(LoaderTest, UnknownWarmupSignature) {
+  SavedModelBundleLite bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+  SavedModelLoadOptions load_options;
+  load_options.warmup_signatures = {"unknown_signature"};
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  Status s = LoadSavedModel(session_options, run_options, export_dir,
+                            {kSavedModelTagServe}, load_options, &bundle);
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+}
+
+TEST_F(LoaderTest, ShardRestoreOps) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "shard_restore_ops");
+  BundleWriter writer(Env::Default(), prefix);
+  TF_ASSERT_OK(writer.Add("a", test::AsTensor<float>({1, 2, 3, 4})));
+  TF_ASSERT_OK(writer.Add("b", test::AsTensor<float>({5})));
+  TF_ASSERT_OK(writer.Add("c", test::AsTensor<int64_t>({6, 7})));
+  TF_ASSERT_OK(writer.Finish());
+
+  GraphDef graph_def;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      R"pb(
+        node {
+          name: "prefix"
+          op: "Const"
+          attr {
+            key: "dtype"
+            value { type: DT_STRING }
+          }
+          attr {
+            key: "value"
+            value { tensor { dtype: DT_STRING tensor_shape {} } }
+          }
+        }
+        node {
+          name: "restore/tensor_names"
+          op: "Const"
+          attr {
+            key: "dtype"
+            value { type: DT_STRING }
+          }
+          attr {
+            key: "value"
+            value {
+              tensor {
+                dtype: DT_STRING
+                tensor_shape { dim { size: 3 } }
+                string_val: "a"
+                string_val: "b"
+                string_val: "c"
+              }
+            }
+          }
+        }
+        node {
+          name: "restore/shape_and_slices"
+          op: "Const"
+          attr {
+            key: "dtype"
+            value { type: DT_STRING }
+          }
+          attr {
+            key: "value"
+            value {
+              tensor {
+                dtype: DT_STRING
+                tensor_shape { dim { size: 3 } }
+                string_val: ""
+                string_val: ""
+                string_val: ""
+              }
+            }
+          }
+        }
+        node {
+          name: "restore"
+          op: "RestoreV2"
+          input: "prefix"
+          input: "restore/tensor_names"
+          input: "restore/shape_and_slices"
+          attr {
+            key: "dtypes"
+            value { list { type: DT_FLOAT type: DT_FLOAT type: DT_INT64 } }
+          }
+        }
+        node {
+          name: "a"
+          op: "Identity"
+          input: "restore"
+          attr {
+            key: "T"
+            value { type: DT_FLOAT }
+          }
+        }
+        node {
+          name: "b"
+          op: "Identity"
+          input: "restore:1"
+          attr {
+            key: "T"
+            value { type: DT_FLOAT }
+          }
+        }
+        node {
+          name: "c"
+          op: "Identity"
+          input: "restore:2"
+          attr {
+            key: "T"
+            value { type: DT_INT64 }
+          }
+        }
+        node { name: "restore_all" op: "NoOp" input: "^restore" }
+      )pb",
+      &graph_def));
+  graph_def.mutable_node(0)->mutable_attr()->at("value").mutable_tensor()
+      ->add_string_val(prefix);
+  TF_ASSERT_OK(internal::ShardRestoreOps(prefix, 2, &graph_def));
+  for (const NodeDef& node : graph_def.node()) {
+    EXPECT_NE(node.name(), "restore");
+    if (node.op() == "Identity") {
+      EXPECT_TRUE(absl::StartsWith(node.input(0), "restore/shard_"))
+          << node.DebugString();
+    }
+    if (node.name() == "restore_all") {
+      EXPECT_THAT(node.input(), ::testing::UnorderedElementsAre(
+                                    "^restore/shard_0", "^restore/shard_1"));
+    }
+  }
+
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_ASSERT_OK(session->Create(graph_def));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {"a", "b", "c"}, {"restore_all"}, &outputs));
+  ASSERT_EQ(outputs.size(), 3);
+  test::ExpectTensorEqual<float>(outputs[0],
+                                 test::AsTensor<float>({1, 2, 3, 4}));
+  test::ExpectTensorEqual<float>(outputs[1], test::AsTensor<float>({5}));
+  test::ExpectTensorEqual<int64_t>(outputs[2],
+                                   test::AsTensor<int64_t>({6, 7}));
+  TF_ASSERT_OK(session->Close());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,7 +16,11 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/context.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 // clang-format off
@@ -74,6 +78,157 @@ auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
 
+// Number of entries in each per-thread kernel cache.
+constexpr int kThreadKernelCacheSize = 256;
+// Maximum number of per-thread kernel caches of a context. Threads beyond the
+// limit use the shared kernel cache only.
+constexpr int kMaxThreadKernelCaches = 64;
+
+std::atomic<int64_t> next_context_instance_id{0};
+
+}  // namespace
+
+// Direct-mapped cache of the kernels looked up by one thread. Entries are
+// tagged with the generation of the shared kernel cache, so that kernels which
+// were removed from the shared cache are never returned. The mutex is only
+// contended when the context invalidates all thread caches.
+class ThreadKernelCache {
+ public:
+  core::RefCountPtr<KernelAndDevice> Lookup(const Fprint128& cache_key,
+                                            int64_t generation)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (generation > generation_) {
+      ClearLocked(generation);
+    }
+    if (generation != generation_) {
+      return nullptr;
+    }
+    Entry& entry = EntryFor(cache_key);
+    if (entry.kernel == nullptr || !(entry.cache_key == cache_key)) {
+      return nullptr;
+    }
+    core::RefCountPtr<KernelAndDevice> new_ref(entry.kernel.get());
+    new_ref->Ref();
+    return new_ref;
+  }
+
+  // Inserts a kernel which was read from the shared kernel cache at
+  // `generation`. The kernel is dropped if the shared cache changed since.
+  void Insert(const Fprint128& cache_key, KernelAndDevice* kernel,
+              int64_t generation) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (generation > generation_) {
+      ClearLocked(generation);
+    }
+    if (generation != generation_) {
+      return;
+    }
+    Entry& entry = EntryFor(cache_key);
+    kernel->Ref();
+    entry.cache_key = cache_key;
+    entry.kernel.reset(kernel);
+  }
+
+  // Releases all kernels older than `generation`.
+  void Clear(int64_t generation) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (generation > generation_) {
+      ClearLocked(generation);
+    }
+  }
+
+ private:
+  struct Entry {
+    Fprint128 cache_key = {0, 0};
+    core::RefCountPtr<KernelAndDevice> kernel;
+  };
+
+  Entry& EntryFor(const Fprint128& cache_key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return entries_[cache_key.low64 % kThreadKernelCacheSize];
+  }
+
+  void ClearLocked(int64_t generation) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (Entry& entry : entries_) {
+      entry.kernel.reset();
+    }
+    generation_ = generation;
+  }
+
+  mutex mu_;
+  int64_t generation_ TF_GUARDED_BY(mu_) = 0;
+  std::array<Entry, kThreadKernelCacheSize> entries_ TF_GUARDED_BY(mu_);
+};
+
+// The per-thread kernel caches of a context. It is shared with the threads
+// which own a cache, so that they release their cache when they exit.
+class ThreadKernelCaches {
+ public:
+  // Returns the cache of `thread_id`, or nullptr if the maximum number of
+  // thread caches has been reached.
+  ThreadKernelCache* GetOrCreate(std::thread::id thread_id)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = caches_.find(thread_id);
+    if (it != caches_.end()) {
+      return it->second.get();
+    }
+    if (caches_.size() >= kMaxThreadKernelCaches) {
+      return nullptr;
+    }
+    auto cache = absl::make_unique<ThreadKernelCache>();
+    ThreadKernelCache* result = cache.get();
+    caches_.emplace(thread_id, std::move(cache));
+    return result;
+  }
+
+  void Release(std::thread::id thread_id) TF_LOCKS_EXCLUDED(mu_) {
+    std::unique_ptr<ThreadKernelCache> cache;
+    mutex_lock l(mu_);
+    auto it = caches_.find(thread_id);
+    if (it != caches_.end()) {
+      cache = std::move(it->second);
+      caches_.erase(it);
+    }
+  }
+
+  // Releases the kernels of all thread caches which are older than
+  // `generation`.
+  void Clear(int64_t generation) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    for (auto& entry : caches_) {
+      entry.second->Clear(generation);
+    }
+  }
+
+ private:
+  mutex mu_;
+  std::unordered_map<std::thread::id, std::unique_ptr<ThreadKernelCache>>
+      caches_ TF_GUARDED_BY(mu_);
+};
+
+namespace {
+
+// The thread kernel caches owned by the calling thread. The thread releases
+// them when it exits, unless their context was already destroyed.
+struct ThreadKernelCacheRefs {
+  ~ThreadKernelCacheRefs() {
+    for (const std::weak_ptr<ThreadKernelCaches>& owner : owners) {
+      std::shared_ptr<ThreadKernelCaches> caches = owner.lock();
+      if (caches != nullptr) {
+        caches->Release(std::this_thread::get_id());
+      }
+    }
+  }
+
+  // The thread kernel cache of the context that the calling thread used last.
+  int64_t context_instance_id = -1;
+  ThreadKernelCache* cache = nullptr;
+  // The contexts in which the calling thread owns a cache.
+  std::vector<std::weak_ptr<ThreadKernelCaches>> owners;
+};
+thread_local ThreadKernelCacheRefs current_thread_kernel_caches;
+
 }  // namespace
 
 EagerContext::EagerContext(
@@ -91,6 +246,8 @@ EagerContext::EagerContext(
       rendezvous_(rendezvous),
       thread_pool_(NewThreadPoolFromSessionOptions(opts)),
       cluster_flr_(cluster_flr),
+      instance_id_(next_context_instance_id++),
+      thread_kernel_caches_(std::make_shared<ThreadKernelCaches>()),
       log_device_placement_(opts.config.log_device_placement()),
       allow_soft_placement_(opts.config.allow_soft_placement()),
       num_active_steps_(0),
@@ -402,6 +559,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
   mutex_lock ml(cache_mu_);
   default_executor_.WaitForAllPendingNodes().IgnoreError();
   kernel_cache_.clear();
+  InvalidateThreadKernelCaches();
   for (auto& entry : registered_functions_) {
     entry.second->cached_kernel_keys->clear();
   }
@@ -863,6 +1021,7 @@ Status EagerContext::RemoveFunction(const string& func) {
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
+      InvalidateThreadKernelCaches();
       registered_functions_.erase(func);
     }
     registered_function->Unref();
@@ -929,15 +1088,66 @@ Status EagerContext::SyncExecutors() {
   return sg.as_summary_status();
 }
 
+ThreadKernelCache* EagerContext::GetThreadKernelCache() {
+  ThreadKernelCacheRefs& current = current_thread_kernel_caches;
+  if (current.context_instance_id == instance_id_) {
+    return current.cache;
+  }
+  ThreadKernelCache* cache =
+      thread_kernel_caches_->GetOrCreate(std::this_thread::get_id());
+  if (cache != nullptr) {
+    auto& owners = current.owners;
+    owners.erase(std::remove_if(owners.begin(), owners.end(),
+                                [](const std::weak_ptr<ThreadKernelCaches>& o) {
+                                  return o.expired();
+                                }),
+                 owners.end());
+    bool owned = false;
+    for (const std::weak_ptr<ThreadKernelCaches>& owner : owners) {
+      owned |= owner.lock() == thread_kernel_caches_;
+    }
+    if (!owned) {
+      owners.push_back(thread_kernel_caches_);
+    }
+  }
+  current.context_instance_id = instance_id_;
+  current.cache = cache;
+  return cache;
+}
+
+void EagerContext::InvalidateThreadKernelCaches() {
+  const int64_t generation =
+      kernel_cache_generation_.fetch_add(1, std::memory_order_release) + 1;
+  thread_kernel_caches_->Clear(generation);
+}
+
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
-    return nullptr;
+  // Load the generation before reading `kernel_cache_`, so that a kernel which
+  // is removed concurrently is tagged with an outdated generation.
+  const int64_t generation =
+      kernel_cache_generation_.load(std::memory_order_acquire);
+  ThreadKernelCache* thread_cache = GetThreadKernelCache();
+  if (thread_cache != nullptr) {
+    core::RefCountPtr<KernelAndDevice> kernel =
+        thread_cache->Lookup(cache_key, generation);
+    if (kernel != nullptr) {
+      return kernel;
+    }
+  }
+  core::RefCountPtr<KernelAndDevice> new_ref;
+  {
+    tf_shared_lock l(cache_mu_);
+    auto iter = kernel_cache_.find(cache_key);
+    if (iter == kernel_cache_.end()) {
+      return nullptr;
+    }
+    new_ref.reset(iter->second.get());
+    new_ref->Ref();
+  }
+  if (thread_cache != nullptr) {
+    thread_cache->Insert(cache_key, new_ref.get(), generation);
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-  new_ref->Ref();
   return new_ref;
 }
 
@@ -946,7 +1156,11 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  core::RefCountPtr<KernelAndDevice>& cached_kernel = kernel_cache_[cache_key];
+  if (cached_kernel != nullptr) {
+    InvalidateThreadKernelCaches();
+  }
+  cached_kernel = std::move(new_ref);
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
   // The kernel name can be either a primitive op or a function.
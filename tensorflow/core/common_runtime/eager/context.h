@@ -82,6 +82,8 @@ class RemoteMgr;
 
 class TensorHandle;
 class EagerOperation;
+class ThreadKernelCache;
+class ThreadKernelCaches;
 
 class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
  public:
@@ -249,6 +251,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   Status AsyncWait() override { return SyncExecutors(); }
 
+  // Returns the kernel cached for `cache_key`, or nullptr. Repeated lookups
+  // from the same thread are served by a per-thread cache without taking
+  // `cache_mu_`.
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
 
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
@@ -656,6 +661,21 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  // Incremented whenever kernels are removed from or replaced in
+  // `kernel_cache_`, to invalidate the per-thread kernel caches.
+  std::atomic<int64_t> kernel_cache_generation_{0};
+
+  // Returns the kernel cache of the calling thread, or nullptr if the maximum
+  // number of thread caches has been reached.
+  ThreadKernelCache* GetThreadKernelCache();
+  // Increments `kernel_cache_generation_` and releases the kernels held by the
+  // per-thread kernel caches.
+  void InvalidateThreadKernelCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(cache_mu_);
+  // Identifies this context in the thread-local pointers to thread caches.
+  const int64_t instance_id_;
+  // Per-thread caches in front of `kernel_cache_`. A thread's cache is
+  // released when the thread exits.
+  const std::shared_ptr<ThreadKernelCaches> thread_kernel_caches_;
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_graphs_{false};
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/context.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -44,6 +47,14 @@ static Device* CreateDevice(const string& type, int n) {
   return new FakeDevice(attr);
 }
 
+// Returns a kernel that is only used as a kernel cache entry.
+core::RefCountPtr<KernelAndDevice> NewCacheEntry() {
+  return core::RefCountPtr<KernelAndDevice>(new KernelAndDeviceOp(
+      /*rendezvous=*/nullptr, /*log_memory=*/false, /*flr=*/nullptr,
+      /*runner=*/nullptr, /*collective_executor=*/nullptr,
+      /*host_cpu_device=*/nullptr));
+}
+
 class EagerContextTest : public ::testing::Test {
  public:
   EagerContext* context() { return context_.get(); }
@@ -303,5 +314,80 @@ TEST_F(EagerContextTest, FunctionErrorRecovery) {
   retvals[0] = nullptr;
 }
 
+TEST_F(EagerContextTest, CachedKernel) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = Fingerprint128("kernel");
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+
+  core::RefCountPtr<KernelAndDevice> kernel = NewCacheEntry();
+  context()->AddKernelToCache(cache_key, kernel.get());
+  // The second lookup is served by the kernel cache of this thread.
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel(Fingerprint128("other")), nullptr);
+
+  // Replacing the kernel invalidates the kernel cache of this thread, which
+  // releases the replaced kernel.
+  core::RefCountPtr<KernelAndDevice> new_kernel = NewCacheEntry();
+  context()->AddKernelToCache(cache_key, new_kernel.get());
+  EXPECT_TRUE(kernel->RefCountIsOne());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), new_kernel.get());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), new_kernel.get());
+
+  context()->ClearCachesAndThreadExecutors();
+  EXPECT_TRUE(new_kernel->RefCountIsOne());
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+}
+
+TEST_F(EagerContextTest, CachedKernelReleasedOnThreadExit) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = Fingerprint128("kernel");
+  core::RefCountPtr<KernelAndDevice> kernel = NewCacheEntry();
+  context()->AddKernelToCache(cache_key, kernel.get());
+  // Held by `kernel` and the shared kernel cache.
+  EXPECT_EQ(kernel->RefCount(), 2);
+
+  // More threads than the maximum number of thread caches, so that the later
+  // threads only get a thread cache if the earlier ones released theirs.
+  for (int i = 0; i < 100; ++i) {
+    KernelAndDevice* cached_kernel = nullptr;
+    int64_t ref_count = 0;
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), absl::StrCat("lookup_", i), [&]() {
+          context()->GetCachedKernel(cache_key);
+          cached_kernel = context()->GetCachedKernel(cache_key).get();
+          ref_count = kernel->RefCount();
+        }));
+    thread.reset();
+    EXPECT_EQ(cached_kernel, kernel.get());
+    // Also held by the cache of the thread while it was running.
+    EXPECT_EQ(ref_count, 3);
+    EXPECT_EQ(kernel->RefCount(), 2);
+  }
+}
+
+TEST_F(EagerContextTest, CachedKernelMultipleThreads) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = Fingerprint128("kernel");
+  core::RefCountPtr<KernelAndDevice> kernel = NewCacheEntry();
+  context()->AddKernelToCache(cache_key, kernel.get());
+
+  constexpr int kNumThreads = 8;
+  std::vector<std::unique_ptr<Thread>> threads;
+  std::vector<KernelAndDevice*> cached_kernels(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back(Env::Default()->StartThread(
+        ThreadOptions(), absl::StrCat("lookup_", i), [&, i]() {
+          for (int j = 0; j < 100; ++j) {
+            cached_kernels[i] = context()->GetCachedKernel(cache_key).get();
+          }
+        }));
+  }
+  threads.clear();
+  for (KernelAndDevice* cached_kernel : cached_kernels) {
+    EXPECT_EQ(cached_kernel, kernel.get());
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
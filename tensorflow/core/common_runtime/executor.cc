@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <vector>
@@ -1165,6 +1166,16 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
+  if (immutable_state_.has_schedule_priorities() && ready->size() > 1) {
+    // Dispatch the ready nodes in the order of the static schedule, so that
+    // nodes on the critical path and communication ops run first.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [](const TaggedNode& a, const TaggedNode& b) {
+                       return a.node_item->schedule_priority <
+                              b.node_item->schedule_priority;
+                     });
+  }
+
   if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
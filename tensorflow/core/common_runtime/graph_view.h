@@ -60,6 +60,12 @@ struct NodeItem {
   // The index of this node's item in its GraphView.
   int node_id = -1;
 
+  // Position of this node in the static schedule computed by Grappler, taken
+  // from the `_schedule_priority` attr. Among simultaneously ready nodes, the
+  // executor dispatches those with lower values first. Nodes without the attr,
+  // e.g. Send/Recv nodes added by graph partitioning, have priority 0.
+  int32 schedule_priority = 0;
+
   // Cached attributes of this node for fast lookup.
   bool kernel_is_async : 1;     // True iff kernel->AsAsync() != nullptr
   bool is_merge : 1;            // True iff IsMerge(node)
@@ -14,18 +14,124 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace data {
 
+namespace {
+
+// Returns the parts of the buffers in `iov` which hold bytes [begin, end) of
+// their concatenation.
+std::vector<struct iovec> SliceIOVec(const std::vector<struct iovec>& iov,
+                                     size_t begin, size_t end) {
+  std::vector<struct iovec> slice;
+  size_t offset = 0;
+  for (const struct iovec& buffer : iov) {
+    const size_t buffer_begin = offset;
+    const size_t buffer_end = offset + buffer.iov_len;
+    offset = buffer_end;
+    if (buffer_end <= begin || buffer.iov_len == 0) {
+      continue;
+    }
+    if (buffer_begin >= end) {
+      break;
+    }
+    const size_t from = std::max(begin, buffer_begin);
+    const size_t to = std::min(end, buffer_end);
+    struct iovec part;
+    part.iov_base = static_cast<char*>(buffer.iov_base) + (from - buffer_begin);
+    part.iov_len = to - from;
+    slice.push_back(part);
+  }
+  return slice;
+}
+
+// Uncompresses the snappy-compressed `data` into the buffers in `iov`, which
+// must add up to exactly the uncompressed size of `data`.
+Status UncompressToIOVec(const std::string& data,
+                         const std::vector<struct iovec>& iov) {
+  size_t total_size = 0;
+  for (const struct iovec& buffer : iov) {
+    total_size += buffer.iov_len;
+  }
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                          &uncompressed_size)) {
+    return errors::Internal(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        data.size());
+  }
+  if (uncompressed_size != total_size) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", total_size);
+  }
+  if (!port::Snappy_UncompressToIOVec(data.data(), data.size(), iov.data(),
+                                      iov.size())) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return Status::OK();
+}
+
+// Uncompresses the chunks of `compressed` into the buffers in `iov`, which add
+// up to `total_size` bytes. If `runner` is set, the chunks are uncompressed in
+// parallel.
+Status UncompressChunks(
+    const CompressedElement& compressed, const std::vector<struct iovec>& iov,
+    size_t total_size,
+    const std::function<void(std::function<void()>)>& runner) {
+  const int64_t chunk_size = compressed.chunk_size_bytes();
+  const int64_t num_chunks = compressed.chunks_size();
+  if (chunk_size <= 0 ||
+      num_chunks != (static_cast<int64_t>(total_size) + chunk_size - 1) /
+                        chunk_size) {
+    return errors::Internal("Element of ", total_size, " bytes has ",
+                            num_chunks, " chunks of ", chunk_size, " bytes");
+  }
+  std::vector<Status> statuses(num_chunks);
+  auto uncompress_chunk = [&](int64_t i) {
+    const size_t begin = i * chunk_size;
+    const size_t end = std::min<size_t>(begin + chunk_size, total_size);
+    statuses[i] =
+        UncompressToIOVec(compressed.chunks(i), SliceIOVec(iov, begin, end));
+  };
+  if (!runner || num_chunks == 1) {
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      uncompress_chunk(i);
+    }
+  } else {
+    BlockingCounter counter(num_chunks);
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      runner([&uncompress_chunk, &counter, i] {
+        uncompress_chunk(i);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, /*chunk_size_bytes=*/0, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       int64_t chunk_size_bytes, CompressedElement* out) {
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
@@ -74,6 +180,21 @@ Status CompressElement(const std::vector<Tensor>& element,
   }
   DCHECK_EQ(position, uncompressed.mdata() + total_size);
 
+  if (chunk_size_bytes > 0 &&
+      total_size > static_cast<size_t>(chunk_size_bytes)) {
+    out->set_chunk_size_bytes(chunk_size_bytes);
+    for (size_t offset = 0; offset < total_size; offset += chunk_size_bytes) {
+      const size_t size =
+          std::min<size_t>(chunk_size_bytes, total_size - offset);
+      if (!port::Snappy_Compress(uncompressed.mdata() + offset, size,
+                                 out->add_chunks())) {
+        return errors::Internal("Failed to compress using snappy.");
+      }
+    }
+    VLOG(3) << "Compressed element of " << total_size << " bytes into "
+            << out->chunks_size() << " chunks";
+    return Status::OK();
+  }
   if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
                              out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
@@ -85,6 +206,13 @@ Status CompressElement(const std::vector<Tensor>& element,
 
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
+  return UncompressElement(compressed, /*runner=*/nullptr, out);
+}
+
+Status UncompressElement(
+    const CompressedElement& compressed,
+    const std::function<void(std::function<void()>)>& runner,
+    std::vector<Tensor>* out) {
   int num_components = compressed.component_metadata_size();
   out->clear();
   out->reserve(num_components);
@@ -125,23 +253,10 @@ Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 2: Uncompress into the iovec.
-  const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(total_size)) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", total_size);
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.data(),
-                                      num_components)) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.chunks_size() > 0) {
+    TF_RETURN_IF_ERROR(UncompressChunks(compressed, iov, total_size, runner));
+  } else {
+    TF_RETURN_IF_ERROR(UncompressToIOVec(compressed.data(), iov));
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
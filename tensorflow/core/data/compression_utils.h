@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_UTILS_H_
 
+#include <functional>
+
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/platform/status.h"
@@ -31,10 +33,24 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Like `CompressElement`, but if the uncompressed size of the element exceeds
+// `chunk_size_bytes`, splits the tensor bytes into chunks of that size which
+// are compressed independently. A `chunk_size_bytes` of 0 disables chunking.
+Status CompressElement(const std::vector<Tensor>& element,
+                       int64_t chunk_size_bytes, CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
+// Like `UncompressElement`, but uncompresses the chunks of a chunked element
+// in parallel by scheduling them on `runner`. Each chunk is uncompressed
+// directly into the buffers of the output tensors.
+Status UncompressElement(
+    const CompressedElement& compressed,
+    const std::function<void(std::function<void()>)>& runner,
+    std::vector<Tensor>* out);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -16,7 +16,9 @@ limitations under the License.
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -49,5 +51,58 @@ std::vector<std::vector<Tensor>> TestCases() {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+class ChunkedCompressionUtilsTest
+    : public DatasetOpsTestBase,
+      public ::testing::WithParamInterface<int64_t> {};
+
+TEST_P(ChunkedCompressionUtilsTest, RoundTrip) {
+  const int64_t chunk_size_bytes = GetParam();
+  std::vector<Tensor> element = {
+      CreateTensor<int64_t>(TensorShape{5}, {1, 2, 3, 4, 5}),
+      CreateTensor<tstring>(TensorShape{2}, {"a", "bc"}),
+      CreateTensor<int64_t>(TensorShape{0}, {}),
+      CreateTensor<int32>(TensorShape{3}, {6, 7, 8})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, chunk_size_bytes, &compressed));
+  EXPECT_GT(compressed.chunks_size(), 1);
+  EXPECT_TRUE(compressed.data().empty());
+
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+
+  thread::ThreadPool pool(Env::Default(), "chunks", /*num_threads=*/3);
+  std::vector<Tensor> parallel_round_trip_element;
+  TF_ASSERT_OK(UncompressElement(
+      compressed,
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      &parallel_round_trip_element));
+  TF_EXPECT_OK(ExpectEqual(element, parallel_round_trip_element,
+                           /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_SUITE_P(Instantiation, ChunkedCompressionUtilsTest,
+                         ::testing::Values(1, 7, 16, 50));
+
+TEST(CompressionUtilsTest, SmallElementIsNotChunked) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, /*chunk_size_bytes=*/1024,
+                               &compressed));
+  EXPECT_EQ(compressed.chunks_size(), 0);
+  EXPECT_FALSE(compressed.data().empty());
+}
+
+TEST(CompressionUtilsTest, MissingChunk) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, /*chunk_size_bytes=*/8, &compressed));
+  compressed.mutable_chunks()->RemoveLast();
+  std::vector<Tensor> round_trip_element;
+  EXPECT_EQ(UncompressElement(compressed, &round_trip_element).code(),
+            error::INTERNAL);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -602,6 +602,41 @@ Status DatasetOpsTestBase::CheckIteratorGetNext(
   return Status::OK();
 }
 
+Status DatasetOpsTestBase::CheckIteratorGetNextN(
+    const DatasetParams& dataset_params, int max_elements,
+    const std::vector<Tensor>& expected_outputs, bool compare_order) {
+  std::unique_ptr<IteratorBase> iterator;
+  TF_RETURN_IF_ERROR(dataset_->MakeIterator(iterator_ctx_.get(),
+                                            /*parent=*/nullptr,
+                                            dataset_params.iterator_prefix(),
+                                            &iterator));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    std::vector<std::vector<Tensor>> elements;
+    TF_RETURN_IF_ERROR(iterator->GetNextN(iterator_ctx_.get(), max_elements,
+                                          &elements, &end_of_sequence));
+    EXPECT_LE(elements.size(), static_cast<size_t>(max_elements));
+    if (!end_of_sequence) {
+      EXPECT_EQ(elements.size(), static_cast<size_t>(max_elements));
+    }
+    for (const auto& element : elements) {
+      out_tensors.insert(out_tensors.end(), element.begin(), element.end());
+    }
+  }
+  // Call GetNextN one more time to make sure it still reports
+  // end_of_sequence = True.
+  std::vector<std::vector<Tensor>> unused;
+  TF_RETURN_IF_ERROR(iterator->GetNextN(iterator_ctx_.get(), max_elements,
+                                        &unused, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  EXPECT_TRUE(unused.empty());
+
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/compare_order));
+  return Status::OK();
+}
+
 Status DatasetOpsTestBase::CheckIteratorSkip(
     int num_to_skip, int expected_num_skipped, bool get_next,
     const std::vector<Tensor>& expected_outputs, bool compare_order) {
@@ -620,6 +620,13 @@ class DatasetOpsTestBase : public ::testing::Test {
                               const std::vector<Tensor>& expected_outputs,
                               bool compare_order);
 
+  // Checks `IteratorBase::GetNextN()` by reading all outputs of a new iterator
+  // over the dataset in chunks of at most `max_elements`.
+  Status CheckIteratorGetNextN(const DatasetParams& dataset_params,
+                               int max_elements,
+                               const std::vector<Tensor>& expected_outputs,
+                               bool compare_order);
+
   // Checks `IteratorBase::Skip()`
   Status CheckIteratorSkip(int num_to_skip, int expected_num_skipped,
                            bool get_next,
@@ -848,6 +855,29 @@ class DatasetOpsTestBase : public ::testing::Test {
       ::testing::ValuesIn(                                                    \
           std::vector<GetNextTestCase<dataset_params_class>>(test_cases)));
 
+#define ITERATOR_GET_NEXT_N_TEST_P(dataset_op_test_class,                 \
+                                   dataset_params_class, test_cases)        \
+  class ParameterizedGetNextNTest                                           \
+      : public dataset_op_test_class,                                       \
+        public ::testing::WithParamInterface<                               \
+            GetNextTestCase<dataset_params_class>> {};                      \
+                                                                            \
+  TEST_P(ParameterizedGetNextNTest, GetNextN) {                             \
+    auto test_case = GetParam();                                            \
+    TF_ASSERT_OK(Initialize(test_case.dataset_params));                     \
+    for (int max_elements : {1, 2, 3, 64}) {                                \
+      TF_ASSERT_OK(CheckIteratorGetNextN(                                   \
+          test_case.dataset_params, max_elements,                           \
+          test_case.expected_outputs,                                       \
+          /*compare_order=*/test_case.compare_order));                      \
+    }                                                                       \
+  }                                                                         \
+                                                                            \
+  INSTANTIATE_TEST_SUITE_P(                                                 \
+      dataset_op_test_class, ParameterizedGetNextNTest,                     \
+      ::testing::ValuesIn(                                                  \
+          std::vector<GetNextTestCase<dataset_params_class>>(test_cases)));
+
 #define ITERATOR_SKIP_TEST_P(dataset_op_test_class, dataset_params_class,   \
                              test_cases)                                    \
   class ParameterizedSkipTest : public dataset_op_test_class,               \
@@ -86,6 +86,7 @@ constexpr char kAutotuneOpt[] = "autotune";
 constexpr char kSlackOpt[] = "slack";
 constexpr char kSlackPeriodOpt[] = "slack_period";
 constexpr char kMakeDeterministicOpt[] = "make_deterministic";
+constexpr char kPreprocessingFusionOpt[] = "preprocessing_fusion";
 
 void DefaultOptimizationGraphRewrites(
     const Options& options, absl::flat_hash_set<tstring>* optimization_enabled,
@@ -111,6 +112,10 @@ void DefaultOptimizationGraphRewrites(
         OptimizationOptions::kShuffleAndRepeatFusion) {
       optimization_default->insert(kShuffleAndRepeatFusionOpt);
     }
+    if (optimization_options.optional_preprocessing_fusion_case() !=
+        OptimizationOptions::kPreprocessingFusion) {
+      optimization_default->insert(kPreprocessingFusionOpt);
+    }
   }
   if (OpDeterminismRequired()) {
     optimization_enabled->insert(kMakeDeterministicOpt);
@@ -179,6 +184,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kShuffleAndRepeatFusionOpt);
     }
   }
+  if (optimization_options.optional_preprocessing_fusion_case() ==
+      OptimizationOptions::kPreprocessingFusion) {
+    if (optimization_options.preprocessing_fusion()) {
+      optimization_enabled->insert(kPreprocessingFusionOpt);
+    } else {
+      optimization_disabled->insert(kPreprocessingFusionOpt);
+    }
+  }
 }
 
 // Returns whether an op has been allowlisted as stateless. Uses a heuristic to
@@ -486,7 +486,8 @@ GetOptimizationsTestCase GetOptimizationTestCase1() {
           /*expected_disabled=*/{},
           /*expected_default=*/
           {"noop_elimination", "map_and_batch_fusion",
-           "shuffle_and_repeat_fusion", "map_parallelization"}};
+           "shuffle_and_repeat_fusion", "map_parallelization",
+           "preprocessing_fusion"}};
 }
 
 // Tests disabling application of default optimizations.
@@ -505,11 +506,13 @@ GetOptimizationsTestCase GetOptimizationTestCase3() {
   options.mutable_optimization_options()->set_map_and_batch_fusion(true);
   options.mutable_optimization_options()->set_map_parallelization(false);
   options.mutable_optimization_options()->set_parallel_batch(false);
-  return {
-      options,
-      /*expected_enabled=*/{"make_sloppy", "map_and_batch_fusion"},
-      /*expected_disabled=*/{"parallel_batch", "map_parallelization"},
-      /*expected_default=*/{"noop_elimination", "shuffle_and_repeat_fusion"}};
+  options.mutable_optimization_options()->set_preprocessing_fusion(false);
+  return {options,
+          /*expected_enabled=*/{"make_sloppy", "map_and_batch_fusion"},
+          /*expected_disabled=*/
+          {"parallel_batch", "map_parallelization", "preprocessing_fusion"},
+          /*expected_default=*/
+          {"noop_elimination", "shuffle_and_repeat_fusion"}};
 }
 
 // Test enabling all / most available optimizations.
@@ -524,13 +527,14 @@ GetOptimizationsTestCase GetOptimizationTestCase4() {
   options.mutable_optimization_options()->set_noop_elimination(true);
   options.mutable_optimization_options()->set_parallel_batch(true);
   options.mutable_optimization_options()->set_shuffle_and_repeat_fusion(true);
+  options.mutable_optimization_options()->set_preprocessing_fusion(true);
   options.set_slack(true);
   return {options,
           /*expected_enabled=*/
           {"filter_fusion", "make_sloppy", "map_and_batch_fusion",
            "map_and_filter_fusion", "map_fusion", "map_parallelization",
            "noop_elimination", "parallel_batch", "shuffle_and_repeat_fusion",
-           "slack"},
+           "preprocessing_fusion", "slack"},
           /*expected_disabled=*/{},
           /*expected_default=*/{}};
 }
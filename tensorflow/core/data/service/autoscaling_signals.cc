@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/autoscaling_signals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/data/service/dispatcher.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Weight of the latest report in a client's smoothed load.
+constexpr double kLoadSmoothing = 0.3;
+// Jobs whose clients wait less than this fraction of the time are not
+// input-bound.
+constexpr double kMinStallRatio = 0.05;
+// Stall ratios are capped, so that a fully stalled job asks for a bounded
+// number of workers.
+constexpr double kMaxStallRatio = 0.9;
+// Clients whose buffers are filled beyond this fraction are not input-bound.
+constexpr double kMaxStarvedBufferOccupancy = 0.5;
+
+double Clamp(double value) { return std::min(std::max(value, 0.0), 1.0); }
+
+double Smooth(double previous, double latest) {
+  return (1 - kLoadSmoothing) * previous + kLoadSmoothing * latest;
+}
+
+}  // namespace
+
+void UpdateClientLoad(const ClientHeartbeatRequest& request, bool first_report,
+                      ClientLoad& load) {
+  const double stall_ratio = Clamp(request.stall_ratio());
+  const double buffer_occupancy =
+      request.buffer_capacity() > 0
+          ? Clamp(static_cast<double>(request.buffered_elements()) /
+                  request.buffer_capacity())
+          : 0.0;
+  const double elements_per_second =
+      std::max(request.elements_per_second(), 0.0);
+  if (first_report) {
+    load.stall_ratio = stall_ratio;
+    load.buffer_occupancy = buffer_occupancy;
+    load.elements_per_second = elements_per_second;
+    return;
+  }
+  load.stall_ratio = Smooth(load.stall_ratio, stall_ratio);
+  load.buffer_occupancy = Smooth(load.buffer_occupancy, buffer_occupancy);
+  load.elements_per_second =
+      Smooth(load.elements_per_second, elements_per_second);
+}
+
+ClientLoad AggregateClientLoads(const std::vector<ClientLoad>& client_loads) {
+  ClientLoad job_load;
+  if (client_loads.empty()) {
+    return job_load;
+  }
+  job_load.job_id = client_loads.front().job_id;
+  for (const ClientLoad& load : client_loads) {
+    job_load.stall_ratio += load.stall_ratio;
+    job_load.buffer_occupancy += load.buffer_occupancy;
+    job_load.elements_per_second += load.elements_per_second;
+  }
+  job_load.stall_ratio /= client_loads.size();
+  job_load.buffer_occupancy /= client_loads.size();
+  return job_load;
+}
+
+int64_t AdditionalWorkers(const ClientLoad& job_load, int64_t num_workers) {
+  if (num_workers <= 0 || job_load.stall_ratio < kMinStallRatio ||
+      job_load.buffer_occupancy > kMaxStarvedBufferOccupancy) {
+    return 0;
+  }
+  const double stall_ratio = std::min(job_load.stall_ratio, kMaxStallRatio);
+  const int64_t wanted_workers =
+      static_cast<int64_t>(std::ceil(num_workers / (1 - stall_ratio) - 1e-9));
+  return std::max<int64_t>(wanted_workers - num_workers, 0);
+}
+
+}  // namespace data
+}  // namespace tensorflow
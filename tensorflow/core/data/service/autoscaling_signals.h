@@ -0,0 +1,56 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_AUTOSCALING_SIGNALS_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_AUTOSCALING_SIGNALS_H_
+
+#include <vector>
+
+#include "tensorflow/core/data/service/dispatcher.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Load of a job client, as reported in its heartbeats and smoothed over
+// heartbeats.
+struct ClientLoad {
+  int64_t job_id = 0;
+  double stall_ratio = 0.0;
+  double buffer_occupancy = 0.0;
+  double elements_per_second = 0.0;
+};
+
+// Folds the load reported in `request` into `load`. The first report
+// initializes `load`.
+void UpdateClientLoad(const ClientHeartbeatRequest& request, bool first_report,
+                      ClientLoad& load);
+
+// Aggregates the loads of the clients of a job: the stall ratio and buffer
+// occupancy are averaged, and the consumption rates are summed.
+ClientLoad AggregateClientLoads(const std::vector<ClientLoad>& client_loads);
+
+// Returns how many workers to add to the `num_workers` workers of a job with
+// load `job_load` so that its clients stop waiting for elements.
+//
+// A client which waits for a fraction `s` of the time would consume
+// 1 / (1 - s) times as many elements if it did not wait, so the job needs
+// 1 / (1 - s) times as many workers. Clients whose buffers are mostly full
+// are not input-bound, whatever their stall ratio.
+int64_t AdditionalWorkers(const ClientLoad& job_load, int64_t num_workers);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_AUTOSCALING_SIGNALS_H_
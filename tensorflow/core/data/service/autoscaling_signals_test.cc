@@ -0,0 +1,100 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/autoscaling_signals.h"
+
+#include <vector>
+
+#include "tensorflow/core/data/service/dispatcher.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+ClientHeartbeatRequest Report(double stall_ratio, int64_t buffered_elements,
+                              int64_t buffer_capacity,
+                              double elements_per_second) {
+  ClientHeartbeatRequest request;
+  request.set_stall_ratio(stall_ratio);
+  request.set_buffered_elements(buffered_elements);
+  request.set_buffer_capacity(buffer_capacity);
+  request.set_elements_per_second(elements_per_second);
+  return request;
+}
+
+TEST(AutoscalingSignalsTest, FirstReportInitializesLoad) {
+  ClientLoad load;
+  UpdateClientLoad(Report(0.5, 2, 8, 100), /*first_report=*/true, load);
+  EXPECT_DOUBLE_EQ(load.stall_ratio, 0.5);
+  EXPECT_DOUBLE_EQ(load.buffer_occupancy, 0.25);
+  EXPECT_DOUBLE_EQ(load.elements_per_second, 100);
+}
+
+TEST(AutoscalingSignalsTest, LaterReportsAreSmoothed) {
+  ClientLoad load;
+  UpdateClientLoad(Report(0.0, 0, 8, 100), /*first_report=*/true, load);
+  UpdateClientLoad(Report(1.0, 8, 8, 200), /*first_report=*/false, load);
+  EXPECT_GT(load.stall_ratio, 0.0);
+  EXPECT_LT(load.stall_ratio, 1.0);
+  EXPECT_GT(load.elements_per_second, 100);
+  EXPECT_LT(load.elements_per_second, 200);
+}
+
+TEST(AutoscalingSignalsTest, ReportsAreClamped) {
+  ClientLoad load;
+  UpdateClientLoad(Report(1.5, 20, 8, -1), /*first_report=*/true, load);
+  EXPECT_DOUBLE_EQ(load.stall_ratio, 1.0);
+  EXPECT_DOUBLE_EQ(load.buffer_occupancy, 1.0);
+  EXPECT_DOUBLE_EQ(load.elements_per_second, 0.0);
+}
+
+TEST(AutoscalingSignalsTest, AggregateClientLoads) {
+  ClientLoad load1{/*job_id=*/3, /*stall_ratio=*/0.2,
+                   /*buffer_occupancy=*/0.0, /*elements_per_second=*/10};
+  ClientLoad load2{/*job_id=*/3, /*stall_ratio=*/0.6,
+                   /*buffer_occupancy=*/0.5, /*elements_per_second=*/30};
+  ClientLoad job_load = AggregateClientLoads({load1, load2});
+  EXPECT_EQ(job_load.job_id, 3);
+  EXPECT_DOUBLE_EQ(job_load.stall_ratio, 0.4);
+  EXPECT_DOUBLE_EQ(job_load.buffer_occupancy, 0.25);
+  EXPECT_DOUBLE_EQ(job_load.elements_per_second, 40);
+}
+
+TEST(AutoscalingSignalsTest, AdditionalWorkers) {
+  ClientLoad load;
+  load.stall_ratio = 0.5;
+  EXPECT_EQ(AdditionalWorkers(load, /*num_workers=*/4), 4);
+  load.stall_ratio = 0.75;
+  EXPECT_EQ(AdditionalWorkers(load, /*num_workers=*/1), 3);
+  // Stall ratios are capped.
+  load.stall_ratio = 1.0;
+  EXPECT_EQ(AdditionalWorkers(load, /*num_workers=*/1), 9);
+}
+
+TEST(AutoscalingSignalsTest, NoAdditionalWorkersWhenNotInputBound) {
+  ClientLoad load;
+  load.stall_ratio = 0.01;
+  EXPECT_EQ(AdditionalWorkers(load, /*num_workers=*/4), 0);
+  load.stall_ratio = 0.5;
+  load.buffer_occupancy = 0.9;
+  EXPECT_EQ(AdditionalWorkers(load, /*num_workers=*/4), 0);
+  load.buffer_occupancy = 0.0;
+  EXPECT_EQ(AdditionalWorkers(load, /*num_workers=*/0), 0);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
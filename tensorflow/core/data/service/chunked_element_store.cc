@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/chunked_element_store.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+
+namespace tensorflow {
+namespace data {
+
+ChunkedElementStore::ChunkedElementStore(int64_t timeout_micros,
+                                         int64_t max_bytes)
+    : timeout_micros_(timeout_micros),
+      max_bytes_(max_bytes),
+      // Leaves room for the ids to increase without overflowing.
+      next_chunked_element_id_(random::New64() >> 2) {}
+
+int64_t ChunkedElementStore::Put(int64_t task_id,
+                                 std::vector<std::string> chunks) {
+  ChunkedElement element;
+  element.task_id = task_id;
+  element.fetched.resize(chunks.size(), false);
+  element.remaining_chunks = chunks.size();
+  element.num_bytes = 0;
+  for (const std::string& chunk : chunks) {
+    element.num_bytes += chunk.size();
+  }
+  element.chunks = std::move(chunks);
+  int64_t now_micros = Env::Default()->NowMicros();
+
+  mutex_lock l(mu_);
+  EvictExpiredLocked(now_micros);
+  // Waits for clients to fetch or abandon earlier elements. Evicting them
+  // instead would lose elements whose clients are still fetching them.
+  while (!elements_.empty() && num_bytes_ + element.num_bytes > max_bytes_) {
+    VLOG(1) << "Waiting for chunked elements to be fetched to stay within "
+            << max_bytes_ << " bytes";
+    const int64_t wait_micros = MicrosUntilNextExpiry(now_micros);
+    if (wait_micros < 0) {
+      cv_.wait(l);
+    } else {
+      cv_.wait_for(l, std::chrono::microseconds(wait_micros));
+    }
+    now_micros = Env::Default()->NowMicros();
+    EvictExpiredLocked(now_micros);
+  }
+  element.last_access_micros = now_micros;
+  const int64_t chunked_element_id = next_chunked_element_id_++;
+  num_bytes_ += element.num_bytes;
+  elements_.emplace(chunked_element_id, std::move(element));
+  return chunked_element_id;
+}
+
+Status ChunkedElementStore::GetChunk(int64_t chunked_element_id,
+                                     int64_t chunk_index, std::string& data) {
+  mutex_lock l(mu_);
+  auto it = elements_.find(chunked_element_id);
+  if (it == elements_.end()) {
+    return errors::FailedPrecondition(
+        "Chunked element ", chunked_element_id, " not found. It may have been ",
+        "fetched already, or evicted, or its task may have been deleted.");
+  }
+  ChunkedElement& element = it->second;
+  if (chunk_index < 0 || chunk_index >= element.chunks.size()) {
+    return errors::InvalidArgument("Invalid chunk index ", chunk_index,
+                                   " for chunked element ", chunked_element_id,
+                                   " with ", element.chunks.size(), " chunks");
+  }
+  data = element.chunks[chunk_index];
+  element.last_access_micros = Env::Default()->NowMicros();
+  if (!element.fetched[chunk_index]) {
+    element.fetched[chunk_index] = true;
+    if (--element.remaining_chunks == 0) {
+      Erase(it);
+    }
+  }
+  return Status::OK();
+}
+
+void ChunkedElementStore::DeleteTask(int64_t task_id) {
+  mutex_lock l(mu_);
+  for (auto it = elements_.begin(); it != elements_.end();) {
+    if (it->second.task_id == task_id) {
+      Erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ChunkedElementStore::EvictExpired() {
+  mutex_lock l(mu_);
+  EvictExpiredLocked(Env::Default()->NowMicros());
+}
+
+int64_t ChunkedElementStore::NumElements() {
+  mutex_lock l(mu_);
+  return elements_.size();
+}
+
+int64_t ChunkedElementStore::NumBytes() {
+  mutex_lock l(mu_);
+  return num_bytes_;
+}
+
+void ChunkedElementStore::Erase(ElementMap::iterator it) {
+  num_bytes_ -= it->second.num_bytes;
+  elements_.erase(it);
+  cv_.notify_all();
+}
+
+void ChunkedElementStore::EvictExpiredLocked(int64_t now_micros) {
+  for (auto it = elements_.begin(); it != elements_.end();) {
+    if (now_micros - it->second.last_access_micros >= timeout_micros_) {
+      VLOG(1) << "Evicting chunked element " << it->first
+              << ", which was not accessed for " << timeout_micros_
+              << " microseconds";
+      Erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+int64_t ChunkedElementStore::MicrosUntilNextExpiry(int64_t now_micros) {
+  if (elements_.empty() || timeout_micros_ == kint64max) {
+    return -1;
+  }
+  int64_t oldest_access_micros = kint64max;
+  for (const auto& it : elements_) {
+    oldest_access_micros =
+        std::min(oldest_access_micros, it.second.last_access_micros);
+  }
+  if (oldest_access_micros > kint64max - timeout_micros_) {
+    return -1;
+  }
+  return std::max<int64_t>(oldest_access_micros + timeout_micros_ - now_micros,
+                           0);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CHUNKED_ELEMENT_STORE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CHUNKED_ELEMENT_STORE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Holds the chunks of the elements a worker sends as `ChunkedElementHeader`s
+// until clients have fetched them.
+//
+// A chunk may be fetched any number of times, so that clients can retry failed
+// fetches, until every chunk of its element has been fetched. Elements whose
+// chunks are not fetched, e.g. because the client failed, are evicted once they
+// have not been accessed for `timeout_micros`. Elements are never evicted for
+// space, since their clients may still be fetching them; instead, `Put` blocks
+// while the chunks held would exceed `max_bytes`.
+class ChunkedElementStore {
+ public:
+  ChunkedElementStore(int64_t timeout_micros, int64_t max_bytes);
+  ChunkedElementStore(const ChunkedElementStore&) = delete;
+  ChunkedElementStore& operator=(const ChunkedElementStore&) = delete;
+
+  // Stores the chunks of an element produced by `task_id`, and returns the id
+  // of the chunked element. Blocks until the chunks fit within `max_bytes`,
+  // unless the store is empty.
+  int64_t Put(int64_t task_id, std::vector<std::string> chunks)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Copies chunk `chunk_index` of `chunked_element_id` into `data`. Returns
+  // FAILED_PRECONDITION if the element is not stored, e.g. because it was
+  // evicted.
+  Status GetChunk(int64_t chunked_element_id, int64_t chunk_index,
+                  std::string& data) TF_LOCKS_EXCLUDED(mu_);
+  // Drops the elements of `task_id`.
+  void DeleteTask(int64_t task_id) TF_LOCKS_EXCLUDED(mu_);
+  // Drops the elements which have not been accessed for `timeout_micros`.
+  void EvictExpired() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of stored elements.
+  int64_t NumElements() TF_LOCKS_EXCLUDED(mu_);
+  // Returns the total size of the stored chunks.
+  int64_t NumBytes() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct ChunkedElement {
+    int64_t task_id;
+    std::vector<std::string> chunks;
+    std::vector<bool> fetched;
+    int64_t remaining_chunks;
+    int64_t num_bytes;
+    int64_t last_access_micros;
+  };
+
+  using ElementMap = std::map<int64_t, ChunkedElement>;
+
+  void Erase(ElementMap::iterator it) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void EvictExpiredLocked(int64_t now_micros) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the time until the next element expires, or -1 if no element
+  // will expire.
+  int64_t MicrosUntilNextExpiry(int64_t now_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t timeout_micros_;
+  const int64_t max_bytes_;
+
+  mutex mu_;
+  // Notified when elements are removed.
+  condition_variable cv_;
+  // Keyed by chunked element id.
+  ElementMap elements_ TF_GUARDED_BY(mu_);
+  // Starts at a random value, so that a client retrying a fetch after the
+  // worker restarted does not get a chunk of an unrelated element.
+  int64_t next_chunked_element_id_ TF_GUARDED_BY(mu_);
+  int64_t num_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CHUNKED_ELEMENT_STORE_H_
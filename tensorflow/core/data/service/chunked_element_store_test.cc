@@ -0,0 +1,155 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/chunked_element_store.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kNoTimeout = kint64max;
+constexpr int64_t kNoMaxBytes = kint64max;
+
+TEST(ChunkedElementStoreTest, GetChunks) {
+  ChunkedElementStore store(kNoTimeout, kNoMaxBytes);
+  int64_t id = store.Put(/*task_id=*/1, {"ab", "cd", "e"});
+  EXPECT_EQ(store.NumElements(), 1);
+  EXPECT_EQ(store.NumBytes(), 5);
+  std::string data;
+  TF_ASSERT_OK(store.GetChunk(id, 2, data));
+  EXPECT_EQ(data, "e");
+  TF_ASSERT_OK(store.GetChunk(id, 0, data));
+  EXPECT_EQ(data, "ab");
+  TF_ASSERT_OK(store.GetChunk(id, 1, data));
+  EXPECT_EQ(data, "cd");
+  EXPECT_EQ(store.NumElements(), 0);
+  EXPECT_EQ(store.NumBytes(), 0);
+}
+
+TEST(ChunkedElementStoreTest, RetryFetchedChunk) {
+  ChunkedElementStore store(kNoTimeout, kNoMaxBytes);
+  int64_t id = store.Put(/*task_id=*/1, {"ab", "cd"});
+  std::string data;
+  TF_ASSERT_OK(store.GetChunk(id, 0, data));
+  TF_ASSERT_OK(store.GetChunk(id, 0, data));
+  EXPECT_EQ(data, "ab");
+  EXPECT_EQ(store.NumElements(), 1);
+  TF_ASSERT_OK(store.GetChunk(id, 1, data));
+  EXPECT_EQ(data, "cd");
+  EXPECT_EQ(store.NumElements(), 0);
+}
+
+TEST(ChunkedElementStoreTest, InvalidChunkIndex) {
+  ChunkedElementStore store(kNoTimeout, kNoMaxBytes);
+  int64_t id = store.Put(/*task_id=*/1, {"ab", "cd"});
+  std::string data;
+  EXPECT_TRUE(errors::IsInvalidArgument(store.GetChunk(id, 2, data)));
+  EXPECT_TRUE(errors::IsInvalidArgument(store.GetChunk(id, -1, data)));
+  EXPECT_TRUE(errors::IsFailedPrecondition(store.GetChunk(id + 1, 0, data)));
+}
+
+TEST(ChunkedElementStoreTest, DeleteTask) {
+  ChunkedElementStore store(kNoTimeout, kNoMaxBytes);
+  int64_t id1 = store.Put(/*task_id=*/1, {"ab", "cd"});
+  int64_t id2 = store.Put(/*task_id=*/2, {"ef", "gh"});
+  store.DeleteTask(/*task_id=*/1);
+  EXPECT_EQ(store.NumElements(), 1);
+  EXPECT_EQ(store.NumBytes(), 4);
+  std::string data;
+  EXPECT_TRUE(errors::IsFailedPrecondition(store.GetChunk(id1, 0, data)));
+  TF_ASSERT_OK(store.GetChunk(id2, 0, data));
+  EXPECT_EQ(data, "ef");
+}
+
+TEST(ChunkedElementStoreTest, EvictExpired) {
+  ChunkedElementStore store(/*timeout_micros=*/0, kNoMaxBytes);
+  int64_t id = store.Put(/*task_id=*/1, {"ab", "cd"});
+  store.EvictExpired();
+  EXPECT_EQ(store.NumElements(), 0);
+  EXPECT_EQ(store.NumBytes(), 0);
+  std::string data;
+  EXPECT_TRUE(errors::IsFailedPrecondition(store.GetChunk(id, 0, data)));
+}
+
+TEST(ChunkedElementStoreTest, KeepUnexpired) {
+  ChunkedElementStore store(kNoTimeout, kNoMaxBytes);
+  store.Put(/*task_id=*/1, {"ab", "cd"});
+  store.EvictExpired();
+  EXPECT_EQ(store.NumElements(), 1);
+}
+
+TEST(ChunkedElementStoreTest, PutWaitsForFetchOverMaxBytes) {
+  ChunkedElementStore store(kNoTimeout, /*max_bytes=*/8);
+  int64_t id1 = store.Put(/*task_id=*/1, {"ab", "cd"});
+  int64_t id2 = store.Put(/*task_id=*/1, {"ef", "gh"});
+  Notification put_done;
+  int64_t id3;
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      /*thread_options=*/{}, /*name=*/"put", [&] {
+        id3 = store.Put(/*task_id=*/1, {"ij", "kl"});
+        put_done.Notify();
+      }));
+  Env::Default()->SleepForMicroseconds(10 * 1000);
+  EXPECT_FALSE(put_done.HasBeenNotified());
+  std::string data;
+  TF_ASSERT_OK(store.GetChunk(id1, 0, data));
+  TF_ASSERT_OK(store.GetChunk(id1, 1, data));
+  put_done.WaitForNotification();
+  EXPECT_EQ(store.NumElements(), 2);
+  EXPECT_EQ(store.NumBytes(), 8);
+  TF_EXPECT_OK(store.GetChunk(id2, 0, data));
+  TF_EXPECT_OK(store.GetChunk(id3, 0, data));
+  EXPECT_EQ(data, "ij");
+}
+
+TEST(ChunkedElementStoreTest, PutEvictsExpiredOverMaxBytes) {
+  ChunkedElementStore store(/*timeout_micros=*/1000, /*max_bytes=*/4);
+  int64_t id1 = store.Put(/*task_id=*/1, {"ab", "cd"});
+  int64_t id2 = store.Put(/*task_id=*/1, {"ef"});
+  EXPECT_EQ(store.NumElements(), 1);
+  std::string data;
+  EXPECT_TRUE(errors::IsFailedPrecondition(store.GetChunk(id1, 0, data)));
+  TF_ASSERT_OK(store.GetChunk(id2, 0, data));
+  EXPECT_EQ(data, "ef");
+}
+
+TEST(ChunkedElementStoreTest, IdsDifferAcrossStores) {
+  ChunkedElementStore store1(kNoTimeout, kNoMaxBytes);
+  ChunkedElementStore store2(kNoTimeout, kNoMaxBytes);
+  EXPECT_NE(store1.Put(/*task_id=*/1, {"ab"}),
+            store2.Put(/*task_id=*/1, {"ab"}));
+}
+
+TEST(ChunkedElementStoreTest, KeepElementLargerThanMaxBytes) {
+  ChunkedElementStore store(kNoTimeout, /*max_bytes=*/2);
+  int64_t id = store.Put(/*task_id=*/1, {"ab", "cd"});
+  std::string data;
+  TF_ASSERT_OK(store.GetChunk(id, 1, data));
+  EXPECT_EQ(data, "cd");
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,206 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/constant_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/utils.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kImmutableConstOp[] = "ImmutableConst";
+constexpr char kValueAttr[] = "value";
+constexpr char kRawSuffix[] = ".tensor";
+constexpr char kProtoSuffix[] = ".pb";
+
+}  // namespace
+
+ConstantCache::ConstantCache(const std::string& cache_dir, int64_t chunk_size,
+                             int64_t num_parallel_reads,
+                             ReadChunkFn read_chunk)
+    : cache_dir_(cache_dir),
+      chunk_size_(chunk_size),
+      num_parallel_reads_(std::max<int64_t>(num_parallel_reads, 1)),
+      read_chunk_(std::move(read_chunk)) {}
+
+Status ConstantCache::ResolveConstants(DatasetDef& dataset) {
+  return ForEachLargeConstantReference(
+      dataset,
+      [&](const std::string& key, NodeDef& node, bool in_function) -> Status {
+        const std::string constant_key = key;
+        const TensorProto& placeholder = node.attr().at(kValueAttr).tensor();
+        const DataType dtype = placeholder.dtype();
+        TensorShape shape(placeholder.tensor_shape());
+        // Function bodies refer to node outputs by name, and `ImmutableConst`
+        // names its output differently from `Const`, so constants in function
+        // bodies are inlined.
+        const bool raw = !in_function && DataTypeCanUseMemcpy(dtype) &&
+                         shape.num_elements() > 0;
+        std::string path;
+        TF_RETURN_IF_ERROR(EnsureCached(constant_key, raw, path));
+        if (raw) {
+          // `ImmutableConst` memory-maps the tensor data instead of copying it
+          // into the graph.
+          node.set_op(kImmutableConstOp);
+          node.clear_attr();
+          AttrValue dtype_attr;
+          dtype_attr.set_type(dtype);
+          (*node.mutable_attr())["dtype"] = dtype_attr;
+          shape.AsProto((*node.mutable_attr())["shape"].mutable_shape());
+          (*node.mutable_attr())["memory_region_name"].set_s(path);
+          return Status::OK();
+        }
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        TF_RETURN_IF_ERROR(
+            Env::Default()->NewReadOnlyMemoryRegionFromFile(path, &region));
+        node.mutable_attr()->erase(kLargeConstantKeyAttr);
+        TensorProto* constant =
+            (*node.mutable_attr())[kValueAttr].mutable_tensor();
+        if (!constant->ParseFromArray(region->data(), region->length())) {
+          return errors::DataLoss("Failed to parse cached constant ", path);
+        }
+        return Status::OK();
+      });
+}
+
+Status ConstantCache::EnsureCached(const std::string& key, bool raw,
+                                   std::string& path) {
+  path = io::JoinPath(cache_dir_,
+                      absl::StrCat(key, raw ? kRawSuffix : kProtoSuffix));
+  {
+    mutex_lock l(mu_);
+    // Wait for concurrent fetches of the same constant instead of fetching it
+    // again.
+    while (fetching_.contains(path)) {
+      cv_.wait(l);
+    }
+    if (Env::Default()->FileExists(path).ok()) {
+      return Status::OK();
+    }
+    fetching_.insert(path);
+  }
+  std::string serialized;
+  Status s = Fetch(key, serialized);
+  if (s.ok()) {
+    s = Write(serialized, raw, path);
+  }
+  mutex_lock l(mu_);
+  fetching_.erase(path);
+  cv_.notify_all();
+  return s;
+}
+
+Status ConstantCache::Fetch(const std::string& key, std::string& serialized) {
+  std::string first_chunk;
+  int64_t total_size;
+  TF_RETURN_IF_ERROR(read_chunk_(key, /*offset=*/0, chunk_size_, first_chunk,
+                                 total_size));
+  if (first_chunk.empty() && total_size > 0) {
+    return errors::DataLoss("Received empty chunk of constant ", key);
+  }
+  serialized.resize(total_size);
+  memcpy(&serialized[0], first_chunk.data(),
+         std::min<int64_t>(first_chunk.size(), total_size));
+  // The size of the first chunk tells how much data the source returns per
+  // request, which may be less than `chunk_size_`.
+  const int64_t chunk_size = std::max<int64_t>(first_chunk.size(), 1);
+  const int64_t num_chunks = (total_size + chunk_size - 1) / chunk_size;
+  if (num_chunks > 1) {
+    thread::ThreadPool pool(
+        Env::Default(), "tf_data_constant_fetch",
+        static_cast<int>(std::min(num_parallel_reads_, num_chunks - 1)));
+    BlockingCounter counter(num_chunks - 1);
+    mutex status_mu;
+    Status status;
+    for (int64_t i = 1; i < num_chunks; ++i) {
+      pool.Schedule([&, i]() {
+        const int64_t offset = i * chunk_size;
+        const int64_t length = std::min(chunk_size, total_size - offset);
+        std::string chunk;
+        int64_t chunk_total_size;
+        Status s = read_chunk_(key, offset, length, chunk, chunk_total_size);
+        if (s.ok() && (chunk.size() != length ||
+                       chunk_total_size != total_size)) {
+          s = errors::DataLoss("Received ", chunk.size(), " bytes at offset ",
+                               offset, " of constant ", key, ", expected ",
+                               length);
+        }
+        if (s.ok()) {
+          memcpy(&serialized[offset], chunk.data(), length);
+        } else {
+          mutex_lock l(status_mu);
+          status.Update(s);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    TF_RETURN_IF_ERROR(status);
+  }
+  if (LargeConstantKey(serialized) != key) {
+    return errors::DataLoss("Content hash mismatch for constant ", key);
+  }
+  return Status::OK();
+}
+
+Status ConstantCache::Write(const std::string& serialized, bool raw,
+                            const std::string& path) {
+  Tensor tensor;
+  StringPiece contents = serialized;
+  if (raw) {
+    TensorProto proto;
+    if (!proto.ParseFromString(serialized) || !tensor.FromProto(proto)) {
+      return errors::DataLoss("Failed to parse constant for ", path);
+    }
+    contents = tensor.tensor_data();
+  }
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(cache_dir_));
+  // Write to a uniquely named temporary file first, so that readers sharing the
+  // cache directory never see a partially written entry.
+  std::string tmp_path = path;
+  if (!Env::Default()->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(tmp_path, &file));
+  TF_RETURN_IF_ERROR(file->Append(contents));
+  TF_RETURN_IF_ERROR(file->Close());
+  return Env::Default()->RenameFile(tmp_path, path);
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_CONSTANT_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_CONSTANT_CACHE_H_
+
+#include <functional>
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Caches the large constants of dataset graphs (see `ExtractLargeConstants`)
+// on local disk, so that a worker fetches each constant at most once.
+//
+// Constants are fetched in parallel chunks with `read_chunk`. Top-level graph
+// constants of types that can be memcpy-ed are cached as raw tensor data and
+// are memory-mapped by `ImmutableConst` nodes when the dataset is built,
+// instead of being parsed into the graph. Other constants, including all
+// constants in function bodies, are cached as serialized `TensorProto`s and
+// inlined into the graph.
+//
+// Cache entries are named by content hash, so several workers may share a
+// cache directory.
+class ConstantCache {
+ public:
+  // Reads up to `length` bytes starting at `offset` of the serialized constant
+  // with content hash `key`, and the total size of the serialized constant.
+  using ReadChunkFn = std::function<Status(
+      const std::string& key, int64_t offset, int64_t length,
+      std::string& data, int64_t& total_size)>;
+
+  ConstantCache(const std::string& cache_dir, int64_t chunk_size,
+                int64_t num_parallel_reads, ReadChunkFn read_chunk);
+  ConstantCache(const ConstantCache&) = delete;
+  ConstantCache& operator=(const ConstantCache&) = delete;
+
+  // Replaces the large constant references in `dataset` with nodes that
+  // produce the constants, fetching the constants which are not cached yet.
+  Status ResolveConstants(DatasetDef& dataset);
+
+ private:
+  // Returns the path of the cache entry for constant `key`, fetching the
+  // constant if needed. If `raw` is true, the entry holds raw tensor data.
+  Status EnsureCached(const std::string& key, bool raw,
+                      std::string& path) TF_LOCKS_EXCLUDED(mu_);
+  // Fetches the serialized constant `key`, verifying its content hash.
+  Status Fetch(const std::string& key, std::string& serialized);
+  // Writes the constant to `path`, as raw tensor data if `raw` is true.
+  Status Write(const std::string& serialized, bool raw,
+               const std::string& path);
+
+  const std::string cache_dir_;
+  const int64_t chunk_size_;
+  const int64_t num_parallel_reads_;
+  const ReadChunkFn read_chunk_;
+
+  mutex mu_;
+  condition_variable cv_;
+  // Paths of the cache entries that are being written.
+  absl::flat_hash_set<std::string> fetching_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_CONSTANT_CACHE_H_
@@ -0,0 +1,221 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/constant_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/dataset_store.h"
+#include "tensorflow/core/data/service/utils.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kChunkSize = 100 * 1024;
+constexpr int64_t kNumParallelReads = 4;
+
+std::string NewCacheDir() {
+  std::string cache_dir = io::JoinPath(testing::TmpDir(), "constant_cache");
+  if (Env::Default()->FileExists(cache_dir).ok()) {
+    int64_t undeleted_files, undeleted_dirs;
+    TF_CHECK_OK(Env::Default()->DeleteRecursively(cache_dir, &undeleted_files,
+                                                  &undeleted_dirs));
+  }
+  return cache_dir;
+}
+
+Tensor LargeFloatTensor() {
+  const int64_t num_rows = kMinLargeConstantBytes / sizeof(float);
+  Tensor tensor(DT_FLOAT, TensorShape({num_rows, 2}));
+  auto flat = tensor.flat<float>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = i;
+  }
+  return tensor;
+}
+
+Tensor LargeStringTensor() {
+  Tensor tensor(DT_STRING, TensorShape({1024}));
+  auto flat = tensor.flat<tstring>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = std::string(kMinLargeConstantBytes / flat.size() + 1,
+                          'a' + i % 26);
+  }
+  return tensor;
+}
+
+void InitConstant(const std::string& name, const Tensor& tensor,
+                  NodeDef& node) {
+  node.set_name(name);
+  node.set_op("Const");
+  (*node.mutable_attr())["dtype"].set_type(tensor.dtype());
+  tensor.AsProtoTensorContent((*node.mutable_attr())["value"].mutable_tensor());
+}
+
+void AddConstant(const std::string& name, const Tensor& tensor,
+                 DatasetDef& dataset) {
+  InitConstant(name, tensor, *dataset.mutable_graph()->add_node());
+}
+
+// Adds a function returning `tensor` to the library of `dataset`.
+void AddFunctionConstant(const std::string& name, const Tensor& tensor,
+                         DatasetDef& dataset) {
+  FunctionDef* function =
+      dataset.mutable_graph()->mutable_library()->add_function();
+  function->mutable_signature()->set_name(name);
+  OpDef::ArgDef* output = function->mutable_signature()->add_output_arg();
+  output->set_name("output");
+  output->set_type(tensor.dtype());
+  InitConstant("constant", tensor, *function->add_node_def());
+  (*function->mutable_ret())["output"] = "constant:output:0";
+}
+
+// Stores `dataset` in `store` and returns it with large constants replaced by
+// references.
+DatasetDef StoreDataset(const DatasetDef& dataset, DatasetStore& store) {
+  TF_CHECK_OK(store.Put("key", dataset));
+  std::shared_ptr<const DatasetDef> stripped;
+  TF_CHECK_OK(store.GetWithConstantReferences("key", stripped));
+  return *stripped;
+}
+
+}  // namespace
+
+TEST(ConstantCacheTest, ResolveConstants) {
+  MemoryDatasetStore store;
+  DatasetDef dataset;
+  AddConstant("float_constant", LargeFloatTensor(), dataset);
+  AddConstant("string_constant", LargeStringTensor(), dataset);
+  DatasetDef stripped = StoreDataset(dataset, store);
+
+  std::atomic<int64_t> num_reads(0);
+  ConstantCache cache(
+      NewCacheDir(), kChunkSize, kNumParallelReads,
+      [&](const std::string& key, int64_t offset, int64_t length,
+          std::string& data, int64_t& total_size) {
+        ++num_reads;
+        return store.ReadConstant(key, offset, length, data, total_size);
+      });
+  DatasetDef resolved = stripped;
+  TF_ASSERT_OK(cache.ResolveConstants(resolved));
+  EXPECT_GT(num_reads, 2);
+
+  const NodeDef& float_node = resolved.graph().node(0);
+  EXPECT_EQ(float_node.op(), "ImmutableConst");
+  EXPECT_EQ(float_node.attr().at("dtype").type(), DT_FLOAT);
+  EXPECT_EQ(TensorShape(float_node.attr().at("shape").shape()),
+            LargeFloatTensor().shape());
+  std::string raw_data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(),
+                                float_node.attr().at("memory_region_name").s(),
+                                &raw_data));
+  EXPECT_EQ(raw_data, LargeFloatTensor().tensor_data());
+
+  const NodeDef& string_node = resolved.graph().node(1);
+  EXPECT_EQ(string_node.op(), "Const");
+  EXPECT_FALSE(string_node.attr().contains(kLargeConstantKeyAttr));
+  Tensor string_tensor;
+  ASSERT_TRUE(string_tensor.FromProto(string_node.attr().at("value").tensor()));
+  test::ExpectEqual(string_tensor, LargeStringTensor());
+
+  // Resolving again is served from the local cache.
+  const int64_t num_reads_before = num_reads;
+  resolved = stripped;
+  TF_ASSERT_OK(cache.ResolveConstants(resolved));
+  EXPECT_EQ(num_reads, num_reads_before);
+  EXPECT_EQ(resolved.graph().node(0).op(), "ImmutableConst");
+}
+
+TEST(ConstantCacheTest, InlinesConstantsInFunctions) {
+  MemoryDatasetStore store;
+  DatasetDef dataset;
+  AddFunctionConstant("function", LargeFloatTensor(), dataset);
+  DatasetDef stripped = StoreDataset(dataset, store);
+  ASSERT_TRUE(stripped.graph().library().function(0).node_def(0).attr()
+                  .contains(kLargeConstantKeyAttr));
+
+  ConstantCache cache(
+      NewCacheDir(), kChunkSize, kNumParallelReads,
+      [&](const std::string& key, int64_t offset, int64_t length,
+          std::string& data, int64_t& total_size) {
+        return store.ReadConstant(key, offset, length, data, total_size);
+      });
+  DatasetDef resolved = stripped;
+  TF_ASSERT_OK(cache.ResolveConstants(resolved));
+  // An `ImmutableConst` would break the `constant:output:0` reference.
+  const NodeDef& node = resolved.graph().library().function(0).node_def(0);
+  EXPECT_EQ(node.op(), "Const");
+  EXPECT_FALSE(node.attr().contains(kLargeConstantKeyAttr));
+  Tensor tensor;
+  ASSERT_TRUE(tensor.FromProto(node.attr().at("value").tensor()));
+  test::ExpectEqual(tensor, LargeFloatTensor());
+}
+
+TEST(ConstantCacheTest, RejectsCorruptedConstant) {
+  MemoryDatasetStore store;
+  DatasetDef dataset;
+  AddConstant("float_constant", LargeFloatTensor(), dataset);
+  DatasetDef stripped = StoreDataset(dataset, store);
+
+  std::string cache_dir = NewCacheDir();
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(cache_dir));
+  ConstantCache cache(
+      cache_dir, kChunkSize, kNumParallelReads,
+      [&](const std::string& key, int64_t offset, int64_t length,
+          std::string& data, int64_t& total_size) {
+        TF_RETURN_IF_ERROR(
+            store.ReadConstant(key, offset, length, data, total_size));
+        if (offset > 0) {
+          data[0] = ~data[0];
+        }
+        return Status::OK();
+      });
+  Status s = cache.ResolveConstants(stripped);
+  EXPECT_EQ(s.code(), error::DATA_LOSS);
+  std::vector<std::string> cached_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &cached_files));
+  EXPECT_TRUE(cached_files.empty());
+}
+
+TEST(ConstantCacheTest, NoConstantReferences) {
+  DatasetDef dataset;
+  AddConstant("small_constant", Tensor(int64_t{1}), dataset);
+  ConstantCache cache(NewCacheDir(), kChunkSize, kNumParallelReads,
+                      [](const std::string& key, int64_t offset, int64_t length,
+                         std::string& data, int64_t& total_size) {
+                        return errors::Internal("Unexpected read");
+                      });
+  DatasetDef resolved = dataset;
+  TF_ASSERT_OK(cache.ResolveConstants(resolved));
+  EXPECT_EQ(resolved.SerializeAsString(), dataset.SerializeAsString());
+}
+
+}  // namespace data
+}  // namespace tensorflow
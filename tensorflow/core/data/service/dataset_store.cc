@@ -15,11 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dataset_store.h"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <string>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/utils.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
@@ -29,6 +34,51 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+constexpr char kConstantsDir[] = "constants";
+
+// Reads the range [offset, offset + length) of `serialized`, clamped to its
+// size.
+Status ReadRange(const std::string& serialized, int64_t offset, int64_t length,
+                 std::string& data, int64_t& total_size) {
+  total_size = serialized.size();
+  if (offset < 0 || length < 0 || offset > total_size) {
+    return errors::InvalidArgument("Invalid range [", offset, ", ",
+                                   offset + length, ") of constant with ",
+                                   total_size, " bytes");
+  }
+  data = serialized.substr(offset, length);
+  return Status::OK();
+}
+
+// Reads the range [offset, offset + length) of the file at `path`, clamped to
+// its size.
+Status ReadConstantFile(const std::string& path, int64_t offset,
+                        int64_t length, std::string& data,
+                        int64_t& total_size) {
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(Env::Default()->GetFileSize(path, &file_size));
+  total_size = file_size;
+  if (offset < 0 || length < 0 || offset > total_size) {
+    return errors::InvalidArgument("Invalid range [", offset, ", ",
+                                   offset + length, ") of constant ", path,
+                                   " with ", total_size, " bytes");
+  }
+  length = std::min(length, total_size - offset);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(path, &file));
+  data.resize(length);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(offset, length, &result, &data[0]));
+  if (result.data() != data.data()) {
+    memmove(&data[0], result.data(), result.size());
+  }
+  data.resize(result.size());
+  return Status::OK();
+}
+
+}  // namespace
 
 FileSystemDatasetStore::FileSystemDatasetStore(const std::string& datasets_dir)
     : datasets_dir_(datasets_dir) {}
@@ -40,7 +90,24 @@ Status FileSystemDatasetStore::Put(const std::string& key,
   if (Env::Default()->FileExists(path_to_write).ok()) {
     return errors::AlreadyExists("File ", path_to_write, " already exists");
   }
-  TF_RETURN_IF_ERROR(WriteDatasetDef(path_to_write, dataset));
+  const std::string constants_dir = io::JoinPath(datasets_dir_, kConstantsDir);
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(constants_dir));
+  DatasetDef stripped_dataset = dataset;
+  TF_RETURN_IF_ERROR(ExtractLargeConstants(
+      stripped_dataset,
+      [&](const std::string& key, const std::string& serialized) -> Status {
+        std::string path = io::JoinPath(constants_dir, key);
+        if (Env::Default()->FileExists(path).ok()) {
+          return Status::OK();
+        }
+        // Write to a temporary file first so that a partially written
+        // constant is never visible under its content hash.
+        std::string tmp_path = absl::StrCat(path, ".tmp");
+        TF_RETURN_IF_ERROR(
+            WriteStringToFile(Env::Default(), tmp_path, serialized));
+        return Env::Default()->RenameFile(tmp_path, path);
+      }));
+  TF_RETURN_IF_ERROR(WriteDatasetDef(path_to_write, stripped_dataset));
   return Status::OK();
 }
 
@@ -49,11 +116,50 @@ Status FileSystemDatasetStore::Get(
   std::string path = io::JoinPath(datasets_dir_, key);
   TF_RETURN_IF_ERROR(Env::Default()->FileExists(path));
   DatasetDef def;
+  TF_RETURN_IF_ERROR(ReadStoredDatasetDef(path, def));
+  dataset_def = std::make_shared<const DatasetDef>(std::move(def));
+  return Status::OK();
+}
+
+Status FileSystemDatasetStore::GetWithConstantReferences(
+    const std::string& key, std::shared_ptr<const DatasetDef>& dataset_def) {
+  std::string path = io::JoinPath(datasets_dir_, key);
+  TF_RETURN_IF_ERROR(Env::Default()->FileExists(path));
+  DatasetDef def;
   TF_RETURN_IF_ERROR(ReadDatasetDef(path, def));
-  dataset_def = std::make_shared<const DatasetDef>(def);
+  dataset_def = std::make_shared<const DatasetDef>(std::move(def));
   return Status::OK();
 }
 
+Status FileSystemDatasetStore::ReadConstant(const std::string& key,
+                                            int64_t offset, int64_t length,
+                                            std::string& data,
+                                            int64_t& total_size) {
+  return ReadConstantFile(io::JoinPath(datasets_dir_, kConstantsDir, key),
+                          offset, length, data, total_size);
+}
+
+Status FileSystemDatasetStore::GetConstantReader(const std::string& key,
+                                                 ConstantReader& reader) {
+  std::string path = io::JoinPath(datasets_dir_, kConstantsDir, key);
+  reader = [path](int64_t offset, int64_t length, std::string& data,
+                  int64_t& total_size) {
+    return ReadConstantFile(path, offset, length, data, total_size);
+  };
+  return Status::OK();
+}
+
+Status ReadStoredDatasetDef(const std::string& path, DatasetDef& dataset_def) {
+  TF_RETURN_IF_ERROR(ReadDatasetDef(path, dataset_def));
+  const std::string constants_dir =
+      io::JoinPath(io::Dirname(path), kConstantsDir);
+  return InlineLargeConstants(
+      dataset_def, [&](const std::string& key, TensorProto& constant) {
+        return ReadBinaryProto(Env::Default(), io::JoinPath(constants_dir, key),
+                               &constant);
+      });
+}
+
 MemoryDatasetStore::MemoryDatasetStore() {}
 
 Status MemoryDatasetStore::Put(const std::string& key,
@@ -63,17 +169,80 @@ Status MemoryDatasetStore::Put(const std::string& key,
     return errors::AlreadyExists("Dataset with key ", key,
                                  " is already stored.");
   }
-  stored_dataset = std::make_shared<const DatasetDef>(dataset);
+  auto stripped_dataset = std::make_shared<DatasetDef>(dataset);
+  bool has_constants = false;
+  TF_RETURN_IF_ERROR(ExtractLargeConstants(
+      *stripped_dataset,
+      [&](const std::string& key, const std::string& serialized) {
+        has_constants = true;
+        auto& stored_constant = constants_[key];
+        if (!stored_constant) {
+          stored_constant = std::make_shared<const std::string>(serialized);
+        }
+        return Status::OK();
+      }));
+  if (has_constants) {
+    datasets_with_constants_.insert(key);
+  }
+  stored_dataset = std::move(stripped_dataset);
   return Status::OK();
 }
 
 Status MemoryDatasetStore::Get(const std::string& key,
                                std::shared_ptr<const DatasetDef>& dataset_def) {
-  auto& stored_dataset = datasets_[key];
-  if (!stored_dataset) {
+  std::shared_ptr<const DatasetDef> stripped_dataset;
+  TF_RETURN_IF_ERROR(GetWithConstantReferences(key, stripped_dataset));
+  if (!datasets_with_constants_.contains(key)) {
+    dataset_def = std::move(stripped_dataset);
+    return Status::OK();
+  }
+  DatasetDef def = *stripped_dataset;
+  TF_RETURN_IF_ERROR(InlineLargeConstants(
+      def, [&](const std::string& key, TensorProto& constant) -> Status {
+        auto it = constants_.find(key);
+        if (it == constants_.end()) {
+          return errors::NotFound("Constant ", key, " not found");
+        }
+        if (!constant.ParseFromString(*it->second)) {
+          return errors::DataLoss("Failed to parse constant ", key);
+        }
+        return Status::OK();
+      }));
+  dataset_def = std::make_shared<const DatasetDef>(std::move(def));
+  return Status::OK();
+}
+
+Status MemoryDatasetStore::GetWithConstantReferences(
+    const std::string& key, std::shared_ptr<const DatasetDef>& dataset_def) {
+  auto it = datasets_.find(key);
+  if (it == datasets_.end() || !it->second) {
     return errors::NotFound("Dataset with key ", key, " not found");
   }
-  dataset_def = stored_dataset;
+  dataset_def = it->second;
+  return Status::OK();
+}
+
+Status MemoryDatasetStore::ReadConstant(const std::string& key, int64_t offset,
+                                        int64_t length, std::string& data,
+                                        int64_t& total_size) {
+  auto it = constants_.find(key);
+  if (it == constants_.end()) {
+    return errors::NotFound("Constant ", key, " not found");
+  }
+  return ReadRange(*it->second, offset, length, data, total_size);
+}
+
+Status MemoryDatasetStore::GetConstantReader(const std::string& key,
+                                             ConstantReader& reader) {
+  auto it = constants_.find(key);
+  if (it == constants_.end()) {
+    return errors::NotFound("Constant ", key, " not found");
+  }
+  std::shared_ptr<const std::string> constant = it->second;
+  reader = [constant](int64_t offset, int64_t length, std::string& data,
+                      int64_t& total_size) {
+    return ReadRange(*constant, offset, length, data, total_size);
+  };
   return Status::OK();
 }
 
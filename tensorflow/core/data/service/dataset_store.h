@@ -15,7 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_DATASET_STORE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_DATASET_STORE_H_
 
+#include <functional>
+#include <memory>
+#include <string>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -26,6 +31,10 @@ namespace tensorflow {
 namespace data {
 
 // An interface for storing and getting dataset definitions.
+//
+// Large constants (see `ExtractLargeConstants`) are deduplicated by content
+// hash across the datasets in a store, and can be read separately from the
+// datasets referencing them.
 class DatasetStore {
  public:
   virtual ~DatasetStore() = default;
@@ -36,10 +45,34 @@ class DatasetStore {
   // Gets the dataset for the given key, storing the dataset in `dataset_def`.
   virtual Status Get(const std::string& key,
                      std::shared_ptr<const DatasetDef>& dataset_def) = 0;
+  // Like `Get`, but leaves large constants as references to their content
+  // hashes instead of inlining them.
+  virtual Status GetWithConstantReferences(
+      const std::string& key,
+      std::shared_ptr<const DatasetDef>& dataset_def) = 0;
+  // Reads up to `length` bytes starting at `offset` from the serialized
+  // `TensorProto` of the large constant with content hash `key`, storing them
+  // in `data`. `total_size` is set to the size of the whole serialized
+  // constant.
+  virtual Status ReadConstant(const std::string& key, int64_t offset,
+                              int64_t length, std::string& data,
+                              int64_t& total_size) = 0;
+
+  // Reads from a large constant like `ReadConstant`, without the key.
+  using ConstantReader = std::function<Status(
+      int64_t offset, int64_t length, std::string& data, int64_t& total_size)>;
+  // Gets a reader for the large constant with content hash `key`. Unlike the
+  // store, the reader may be used concurrently with later calls on the store,
+  // so that callers can read without holding the lock guarding the store.
+  virtual Status GetConstantReader(const std::string& key,
+                                   ConstantReader& reader) = 0;
 };
 
 // Dataset store which reads and writes datasets within a directory.
-// The dataset with key `key` is stored at the path "datasets_dir/key".
+// The dataset with key `key` is stored at the path "datasets_dir/key". Large
+// constant tensors are stored once per content hash `hash` at the path
+// "datasets_dir/constants/hash", so the dataset file alone is incomplete; read
+// it with `ReadStoredDatasetDef`.
 class FileSystemDatasetStore : public DatasetStore {
  public:
   explicit FileSystemDatasetStore(const std::string& datasets_dir);
@@ -49,13 +82,28 @@ class FileSystemDatasetStore : public DatasetStore {
   Status Put(const std::string& key, const DatasetDef& dataset) override;
   Status Get(const std::string& key,
              std::shared_ptr<const DatasetDef>& dataset_def) override;
+  Status GetWithConstantReferences(
+      const std::string& key,
+      std::shared_ptr<const DatasetDef>& dataset_def) override;
+  Status ReadConstant(const std::string& key, int64_t offset, int64_t length,
+                      std::string& data, int64_t& total_size) override;
+  Status GetConstantReader(const std::string& key,
+                           ConstantReader& reader) override;
 
  private:
   const std::string datasets_dir_;
 };
 
+// Reads the dataset which a `FileSystemDatasetStore` stored at `path`, and
+// inlines its large constants from the store's directory.
+Status ReadStoredDatasetDef(const std::string& path, DatasetDef& dataset_def);
+
 // DatasetStore which stores all datasets in memory. This is useful when the
-// dispatcher doesn't have a work directory configured.
+// dispatcher doesn't have a work directory configured. Like
+// `FileSystemDatasetStore`, datasets are kept with references to a table of
+// serialized large constants shared between datasets with identical
+// constants, so that each constant is held once. `Get` inlines the constants
+// into a copy of the dataset.
 class MemoryDatasetStore : public DatasetStore {
  public:
   MemoryDatasetStore();
@@ -65,10 +113,23 @@ class MemoryDatasetStore : public DatasetStore {
   Status Put(const std::string& key, const DatasetDef& dataset) override;
   Status Get(const std::string& key,
              std::shared_ptr<const DatasetDef>& dataset_def) override;
+  Status GetWithConstantReferences(
+      const std::string& key,
+      std::shared_ptr<const DatasetDef>& dataset_def) override;
+  Status ReadConstant(const std::string& key, int64_t offset, int64_t length,
+                      std::string& data, int64_t& total_size) override;
+  Status GetConstantReader(const std::string& key,
+                           ConstantReader& reader) override;
 
  private:
-  // Mapping from key to dataset definition.
+  // Mapping from key to dataset definition with large constants replaced by
+  // references into `constants_`.
   absl::flat_hash_map<std::string, std::shared_ptr<const DatasetDef>> datasets_;
+  // Keys of the datasets which reference large constants.
+  absl::flat_hash_set<std::string> datasets_with_constants_;
+  // Mapping from content hash to serialized constant tensor.
+  absl::flat_hash_map<std::string, std::shared_ptr<const std::string>>
+      constants_;
 };
 
 }  // namespace data
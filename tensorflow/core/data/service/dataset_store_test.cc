@@ -19,7 +19,11 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
@@ -63,6 +67,19 @@ DatasetDef DatasetDefWithVersion(int32_t version) {
   return def;
 }
 
+// Returns a dataset definition with a constant node that is large enough to
+// be deduplicated.
+DatasetDef DatasetDefWithLargeConstant(int32_t version, uint8 fill_value) {
+  DatasetDef def = DatasetDefWithVersion(version);
+  NodeDef* node = def.mutable_graph()->add_node();
+  node->set_name("large_constant");
+  node->set_op("Const");
+  Tensor tensor(DT_UINT8, TensorShape({kMinLargeConstantBytes}));
+  tensor.flat<uint8>().setConstant(fill_value);
+  tensor.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return def;
+}
+
 }  // namespace
 
 class DatasetStoreTest : public ::testing::Test,
@@ -115,6 +132,137 @@ TEST_P(DatasetStoreTest, GetMissing) {
   EXPECT_EQ(s.code(), error::NOT_FOUND);
 }
 
+TEST_P(DatasetStoreTest, StoreAndGetLargeConstants) {
+  std::unique_ptr<DatasetStore> store = MakeStore(GetParam());
+  DatasetDef def_1 = DatasetDefWithLargeConstant(/*version=*/1, /*fill_value=*/1);
+  DatasetDef def_2 = DatasetDefWithLargeConstant(/*version=*/2, /*fill_value=*/1);
+  DatasetDef def_3 = DatasetDefWithLargeConstant(/*version=*/3, /*fill_value=*/2);
+  TF_ASSERT_OK(store->Put("key1", def_1));
+  TF_ASSERT_OK(store->Put("key2", def_2));
+  TF_ASSERT_OK(store->Put("key3", def_3));
+  for (const auto& expected : {std::make_pair("key1", &def_1),
+                               std::make_pair("key2", &def_2),
+                               std::make_pair("key3", &def_3)}) {
+    std::shared_ptr<const DatasetDef> result;
+    TF_ASSERT_OK(store->Get(expected.first, result));
+    EXPECT_EQ(result->SerializeAsString(),
+              expected.second->SerializeAsString());
+  }
+}
+
+TEST_P(DatasetStoreTest, ReadConstantInChunks) {
+  std::unique_ptr<DatasetStore> store = MakeStore(GetParam());
+  DatasetDef def = DatasetDefWithLargeConstant(/*version=*/1, /*fill_value=*/1);
+  TF_ASSERT_OK(store->Put("key", def));
+  std::shared_ptr<const DatasetDef> stripped;
+  TF_ASSERT_OK(store->GetWithConstantReferences("key", stripped));
+  const NodeDef& node = stripped->graph().node(0);
+  ASSERT_TRUE(node.attr().contains(kLargeConstantKeyAttr));
+  EXPECT_EQ(node.attr().at("value").tensor().tensor_content(), "");
+  const std::string& constant_key = node.attr().at(kLargeConstantKeyAttr).s();
+
+  const int64_t chunk_size = kMinLargeConstantBytes / 3;
+  std::string serialized;
+  int64_t total_size = -1;
+  do {
+    std::string chunk;
+    TF_ASSERT_OK(store->ReadConstant(constant_key, serialized.size(),
+                                     chunk_size, chunk, total_size));
+    ASSERT_FALSE(chunk.empty());
+    serialized += chunk;
+  } while (serialized.size() < total_size);
+  EXPECT_EQ(serialized.size(), total_size);
+  TensorProto constant;
+  ASSERT_TRUE(constant.ParseFromString(serialized));
+  EXPECT_EQ(constant.SerializeAsString(),
+            def.graph().node(0).attr().at("value").tensor().SerializeAsString());
+}
+
+TEST_P(DatasetStoreTest, ReadMissingConstant) {
+  std::unique_ptr<DatasetStore> store = MakeStore(GetParam());
+  std::string data;
+  int64_t total_size;
+  Status s = store->ReadConstant("missing", 0, 1, data, total_size);
+  EXPECT_EQ(s.code(), error::NOT_FOUND);
+}
+
+TEST_P(DatasetStoreTest, ConstantReader) {
+  std::unique_ptr<DatasetStore> store = MakeStore(GetParam());
+  DatasetDef def = DatasetDefWithLargeConstant(/*version=*/1, /*fill_value=*/1);
+  TF_ASSERT_OK(store->Put("key", def));
+  std::shared_ptr<const DatasetDef> stripped;
+  TF_ASSERT_OK(store->GetWithConstantReferences("key", stripped));
+  const std::string& constant_key =
+      stripped->graph().node(0).attr().at(kLargeConstantKeyAttr).s();
+
+  DatasetStore::ConstantReader reader;
+  TF_ASSERT_OK(store->GetConstantReader(constant_key, reader));
+  // The reader stays valid while the store changes.
+  TF_ASSERT_OK(store->Put("other_key", DatasetDefWithLargeConstant(
+                                           /*version=*/2, /*fill_value=*/2)));
+  std::string expected;
+  int64_t expected_total_size;
+  TF_ASSERT_OK(store->ReadConstant(constant_key, /*offset=*/10, /*length=*/20,
+                                   expected, expected_total_size));
+  std::string data;
+  int64_t total_size;
+  TF_ASSERT_OK(reader(/*offset=*/10, /*length=*/20, data, total_size));
+  EXPECT_EQ(data, expected);
+  EXPECT_EQ(total_size, expected_total_size);
+}
+
+TEST(FileSystemDatasetStoreTest, DeduplicatesLargeConstants) {
+  std::string datasets_dir = NewDatasetsDir();
+  FileSystemDatasetStore store(datasets_dir);
+  TF_ASSERT_OK(
+      store.Put("key1", DatasetDefWithLargeConstant(/*version=*/1,
+                                                    /*fill_value=*/1)));
+  TF_ASSERT_OK(
+      store.Put("key2", DatasetDefWithLargeConstant(/*version=*/2,
+                                                    /*fill_value=*/1)));
+  std::vector<std::string> constants;
+  TF_ASSERT_OK(Env::Default()->GetChildren(
+      io::JoinPath(datasets_dir, "constants"), &constants));
+  EXPECT_EQ(constants.size(), 1);
+  uint64 dataset_file_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(io::JoinPath(datasets_dir, "key1"),
+                                           &dataset_file_size));
+  EXPECT_LT(dataset_file_size, kMinLargeConstantBytes);
+}
+
+TEST(FileSystemDatasetStoreTest, ReadStoredDatasetDefInlinesConstants) {
+  std::string datasets_dir = NewDatasetsDir();
+  FileSystemDatasetStore store(datasets_dir);
+  DatasetDef def = DatasetDefWithLargeConstant(/*version=*/1, /*fill_value=*/1);
+  TF_ASSERT_OK(store.Put("key", def));
+  DatasetDef result;
+  TF_ASSERT_OK(
+      ReadStoredDatasetDef(io::JoinPath(datasets_dir, "key"), result));
+  EXPECT_EQ(result.SerializeAsString(), def.SerializeAsString());
+}
+
+TEST(MemoryDatasetStoreTest, StoresConstantsOnce) {
+  MemoryDatasetStore store;
+  DatasetDef def = DatasetDefWithLargeConstant(/*version=*/1, /*fill_value=*/1);
+  TF_ASSERT_OK(store.Put("key", def));
+  std::shared_ptr<const DatasetDef> stripped;
+  TF_ASSERT_OK(store.GetWithConstantReferences("key", stripped));
+  EXPECT_LT(stripped->ByteSizeLong(), kMinLargeConstantBytes);
+  std::shared_ptr<const DatasetDef> result;
+  TF_ASSERT_OK(store.Get("key", result));
+  EXPECT_EQ(result->SerializeAsString(), def.SerializeAsString());
+}
+
+TEST(MemoryDatasetStoreTest, GetSharesDatasetWithoutConstants) {
+  MemoryDatasetStore store;
+  TF_ASSERT_OK(store.Put("key", DatasetDefWithVersion(1)));
+  std::shared_ptr<const DatasetDef> result_1;
+  std::shared_ptr<const DatasetDef> result_2;
+  TF_ASSERT_OK(store.Get("key", result_1));
+  TF_ASSERT_OK(store.Get("key", result_2));
+  EXPECT_EQ(result_1.get(), result_2.get());
+}
+
 INSTANTIATE_TEST_SUITE_P(DatasetStoreTests, DatasetStoreTest,
                          ::testing::Values(kFileSystem, kMemory));
 }  // namespace data
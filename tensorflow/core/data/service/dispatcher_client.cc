@@ -17,6 +17,7 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "grpcpp/client_context.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/data/service/common.h"
@@ -32,9 +34,12 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -43,6 +48,58 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Maximum number of entries in the dataset fingerprint cache.
+constexpr int64_t kMaxFingerprintCacheEntries = 1024;
+
+// Process-wide cache from a 128-bit fingerprint of the serialized dataset graph
+// to its dataset fingerprint. Fingerprinting the serialized bytes is much
+// cheaper than computing `FingerprintDatasetGraph`, and the same graph is
+// usually registered again at the start of every epoch. The key is 128 bits
+// wide so that different graphs do not collide in practice.
+class DatasetFingerprintCache {
+ public:
+  static DatasetFingerprintCache& Global() {
+    static DatasetFingerprintCache* cache = new DatasetFingerprintCache();
+    return *cache;
+  }
+
+  Status GetFingerprint(const GraphDef& graph, uint64& fingerprint) {
+    Fprint128 key;
+    {
+      std::string serialized_graph;
+      if (!SerializeToStringDeterministic(graph, &serialized_graph)) {
+        return errors::InvalidArgument("Failed to serialize dataset graph");
+      }
+      key = Fingerprint128(serialized_graph);
+    }
+    {
+      mutex_lock l(mu_);
+      auto it = fingerprints_.find(key);
+      if (it != fingerprints_.end()) {
+        fingerprint = it->second;
+        return Status::OK();
+      }
+    }
+    GraphDef prepared_graph = graph;
+    PrepareDatasetGraph(prepared_graph);
+    TF_RETURN_IF_ERROR(FingerprintDatasetGraph(prepared_graph, fingerprint));
+    mutex_lock l(mu_);
+    if (fingerprints_.size() >= kMaxFingerprintCacheEntries) {
+      fingerprints_.clear();
+    }
+    fingerprints_[key] = fingerprint;
+    return Status::OK();
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<Fprint128, uint64, Fprint128Hasher> fingerprints_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
 
 StatusOr<WorkerHeartbeatResponse> DataServiceDispatcherClient::WorkerHeartbeat(
     const WorkerHeartbeatRequest& request) {
@@ -79,6 +136,7 @@ Status DataServiceDispatcherClient::GetDatasetDef(int64_t dataset_id,
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetDatasetDefRequest req;
   req.set_dataset_id(dataset_id);
+  req.set_allow_constant_references(true);
   GetDatasetDefResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetDatasetDef(&client_ctx, req, &resp);
@@ -89,6 +147,27 @@ Status DataServiceDispatcherClient::GetDatasetDef(int64_t dataset_id,
   return Status::OK();
 }
 
+Status DataServiceDispatcherClient::GetConstantChunk(const std::string& key,
+                                                     int64_t offset,
+                                                     int64_t length,
+                                                     std::string& data,
+                                                     int64_t& total_size) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetConstantChunkRequest req;
+  req.set_key(key);
+  req.set_offset(offset);
+  req.set_length(length);
+  GetConstantChunkResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetConstantChunk(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get constant chunk", status);
+  }
+  data = std::move(*resp.mutable_data());
+  total_size = resp.total_size();
+  return Status::OK();
+}
+
 Status DataServiceDispatcherClient::GetSplit(int64_t job_id, int64_t repetition,
                                              int64_t split_provider_index,
                                              Tensor& split,
@@ -117,8 +196,32 @@ Status DataServiceDispatcherClient::RegisterDataset(
     const DatasetDef& dataset, const absl::optional<std::string>& element_spec,
     int64_t& dataset_id) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
+  uint64 fingerprint;
+  TF_RETURN_IF_ERROR(DatasetFingerprintCache::Global().GetFingerprint(
+      dataset.graph(), fingerprint));
+  fingerprint = FingerprintDatasetDef(dataset, fingerprint);
+
+  // Only send the fingerprint first, so that the graph is uploaded only if the
+  // dispatcher doesn't know the dataset yet.
+  GetOrRegisterDatasetRequest lookup_req;
+  lookup_req.set_fingerprint(fingerprint);
+  GetOrRegisterDatasetResponse lookup_resp;
+  {
+    grpc::ClientContext client_ctx;
+    grpc::Status status =
+        stub_->GetOrRegisterDataset(&client_ctx, lookup_req, &lookup_resp);
+    if (!status.ok()) {
+      return grpc_util::WrapError("Failed to register dataset", status);
+    }
+  }
+  if (!lookup_resp.dataset_required()) {
+    dataset_id = lookup_resp.dataset_id();
+    return Status::OK();
+  }
+
   GetOrRegisterDatasetRequest req;
   *req.mutable_dataset() = dataset;
+  req.set_fingerprint(fingerprint);
   if (element_spec.has_value()) {
     req.set_element_spec(element_spec.value());
   }
@@ -239,6 +342,31 @@ Status DataServiceDispatcherClient::GetElementSpec(int64_t dataset_id,
   return Status::OK();
 }
 
+Status DataServiceDispatcherClient::PrewarmDataset(int64_t dataset_id) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  PrewarmDatasetRequest req;
+  req.set_dataset_id(dataset_id);
+  PrewarmDatasetResponse resp;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->PrewarmDataset(&ctx, req, &resp);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to prewarm dataset", s);
+  }
+  return Status::OK();
+}
+
+Status DataServiceDispatcherClient::GetAutoscalingSignals(
+    GetAutoscalingSignalsResponse& signals) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetAutoscalingSignalsRequest req;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->GetAutoscalingSignals(&ctx, req, &signals);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get autoscaling signals", s);
+  }
+  return Status::OK();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   mutex_lock l(mu_);
   if (stub_) {
@@ -55,9 +55,17 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
                       std::vector<TaskProgress>& task_progress);
 
   // Gets a dataset definition for the given dataset id, and stores the
-  // definition in `dataset_def`.
+  // definition in `dataset_def`. Large constants are returned as references to
+  // their content hashes (see `ExtractLargeConstants`).
   Status GetDatasetDef(int64_t dataset_id, DatasetDef& dataset_def);
 
+  // Reads up to `length` bytes starting at `offset` of the serialized large
+  // constant with content hash `key`. `total_size` is set to the size of the
+  // whole serialized constant.
+  Status GetConstantChunk(const std::string& key, int64_t offset,
+                          int64_t length, std::string& data,
+                          int64_t& total_size);
+
   // Gets the next split for the specified job id, repetition, and split
   // provider index.
   Status GetSplit(int64_t job_id, int64_t repetition,
@@ -65,7 +73,8 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
                   bool& end_of_splits);
 
   // Registers a dataset with the tf.data service, and stores the generated
-  // dataset id in `dataset_id`.
+  // dataset id in `dataset_id`. The dataset graph is only uploaded if the
+  // dispatcher does not already know its fingerprint.
   Status RegisterDataset(const DatasetDef& dataset,
                          const absl::optional<std::string>& element_spec,
                          int64_t& dataset_id);
@@ -100,6 +109,13 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // Returns element spec for the registered dataset.
   Status GetElementSpec(int64_t dataset_id, std::string& element_spec);
 
+  // Asks workers to keep a prewarmed task ready for the registered dataset, so
+  // that upcoming jobs reading the dataset start without delay.
+  Status PrewarmDataset(int64_t dataset_id);
+
+  // Gets the autoscaling signals of the dispatcher's jobs.
+  Status GetAutoscalingSignals(GetAutoscalingSignalsResponse& signals);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/dispatcher_impl.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,13 +31,14 @@ limitations under the License.
 #include "grpcpp/create_channel.h"
 #include "grpcpp/impl/codegen/server_context.h"
 #include "grpcpp/security/credentials.h"
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/data/dataset_utils.h"
-#include "tensorflow/core/data/hash_utils.h"
+#include "tensorflow/core/data/service/autoscaling_signals.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
@@ -44,10 +47,12 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/journal.h"
+#include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/env.h"
@@ -75,17 +80,14 @@ constexpr char kDatasetsDir[] = "datasets";
 constexpr int64_t kDefaultJobGcCheckIntervalMs = 10 * 60 * 1000;  // 10 minutes.
 constexpr int64_t kDefaultJobGcTimeoutMs = 5 * 60 * 1000;         // 5 minutes.
 constexpr int64_t kDefaultClientTimeoutMs = 2 * 60 * 1000;        // 2 minutes.
-
-constexpr std::array<const char*, 8> kNodeNameSharingOps = {
-    "HashTable",
-    "HashTableV2",
-    "MutableHashTable",
-    "MutableHashTableV2",
-    "MutableDenseHashTable",
-    "MutableDenseHashTableV2",
-    "MutableHashTableOfTensors",
-    "MutableHashTableOfTensorsV2",
-};
+// Upper bound on the size of a `GetConstantChunk` response, to stay well below
+// gRPC message size limits.
+constexpr int64_t kMaxConstantChunkBytes = 32 << 20;  // 32 MiB.
+// A job whose clients are always stalled gets this many times the weight of a
+// job with the same priority whose clients never stall.
+constexpr double kMaxStallWeightFactor = 4.0;
+// Bound on the magnitude of job priorities, to keep weights finite.
+constexpr int64_t kMaxJobPriority = 30;
 
 using DispatcherConfig = experimental::DispatcherConfig;
 using Dataset = DispatcherState::Dataset;
@@ -118,23 +120,6 @@ Status CreateWorkerStub(const std::string& address, const std::string& protocol,
   return Status::OK();
 }
 
-void PrepareGraph(GraphDef* graph) {
-  for (NodeDef& node : *graph->mutable_node()) {
-    for (const auto& op : kNodeNameSharingOps) {
-      // Set `use_node_name_sharing` to `true` so that resources aren't deleted
-      // prematurely. Otherwise, resources may be deleted when their ops are
-      // deleted at the end of the GraphRunner::Run used by standalone::Dataset.
-      if (node.op() == op) {
-        (*node.mutable_attr())["use_node_name_sharing"].set_b(true);
-      }
-      if (!node.device().empty()) {
-        *node.mutable_device() = "";
-      }
-    }
-  }
-  StripDevicePlacement(graph->mutable_library());
-}
-
 DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
   DispatcherConfig new_config(config);
   if (new_config.job_gc_check_interval_ms() == 0) {
@@ -337,6 +322,7 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     TF_RETURN_IF_ERROR(Apply(update));
     TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
     TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+    UpdateAutoscalingMetrics();
   }
   absl::flat_hash_set<int64_t> current_tasks;
   current_tasks.insert(request->current_tasks().cbegin(),
@@ -345,6 +331,13 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
       FindTasksToDelete(current_tasks, assigned_tasks, response));
   TF_RETURN_IF_ERROR(
       FindNewTasks(worker_address, current_tasks, assigned_tasks, response));
+  for (const auto& entry : prewarm_datasets_) {
+    response->add_datasets_to_prewarm(entry.first);
+  }
+  for (const auto& task : assigned_tasks) {
+    (*response->mutable_job_weights())[task->job->job_id] =
+        JobWeight(*task->job);
+  }
 
   VLOG(4) << "Finished worker heartbeat for worker at address "
           << request->worker_address();
@@ -372,6 +365,7 @@ Status DataServiceDispatcherImpl::WorkerUpdate(
               << " completed";
     }
   }
+  UpdateAutoscalingMetrics();
   return Status::OK();
 }
 
@@ -382,11 +376,34 @@ Status DataServiceDispatcherImpl::GetDatasetDef(
   std::shared_ptr<const Dataset> dataset;
   TF_RETURN_IF_ERROR(state_.DatasetFromId(request->dataset_id(), dataset));
   std::shared_ptr<const DatasetDef> dataset_def;
-  TF_RETURN_IF_ERROR(GetDatasetDef(*dataset, dataset_def));
+  if (request->allow_constant_references()) {
+    TF_RETURN_IF_ERROR(dataset_store_->GetWithConstantReferences(
+        DatasetKey(dataset->dataset_id, dataset->fingerprint), dataset_def));
+  } else {
+    TF_RETURN_IF_ERROR(GetDatasetDef(*dataset, dataset_def));
+  }
   *response->mutable_dataset_def() = *dataset_def;
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::GetConstantChunk(
+    const GetConstantChunkRequest* request,
+    GetConstantChunkResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  DatasetStore::ConstantReader reader;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(
+        dataset_store_->GetConstantReader(request->key(), reader));
+  }
+  int64_t total_size;
+  TF_RETURN_IF_ERROR(reader(request->offset(),
+                            std::min(request->length(), kMaxConstantChunkBytes),
+                            *response->mutable_data(), total_size));
+  response->set_total_size(total_size);
+  return Status::OK();
+}
+
 Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
                                            GetSplitResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
@@ -457,11 +474,40 @@ Status DataServiceDispatcherImpl::GetOrRegisterDataset(
     const GetOrRegisterDatasetRequest* request,
     GetOrRegisterDatasetResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
+  const bool has_fingerprint = request->optional_fingerprint_case() ==
+                               GetOrRegisterDatasetRequest::kFingerprint;
+  if (has_fingerprint && !request->has_dataset()) {
+    // First phase of a two-phase registration: the client only sent the
+    // fingerprint, and uploads the graph if the dataset is unknown.
+    mutex_lock l(mu_);
+    std::shared_ptr<const Dataset> dataset;
+    Status s = state_.DatasetFromFingerprint(request->fingerprint(), dataset);
+    if (errors::IsNotFound(s)) {
+      VLOG(3) << "Dataset fingerprint " << request->fingerprint()
+              << " is not registered. Requesting the dataset graph.";
+      response->set_dataset_required(true);
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(s);
+    response->set_dataset_id(dataset->dataset_id);
+    return Status::OK();
+  }
+
   uint64 fingerprint;
   DatasetDef dataset_def = request->dataset();
   GraphDef* graph = dataset_def.mutable_graph();
-  PrepareGraph(graph);
-  TF_RETURN_IF_ERROR(HashGraph(*graph, &fingerprint));
+  PrepareDatasetGraph(*graph);
+  TF_RETURN_IF_ERROR(FingerprintDatasetGraph(*graph, fingerprint));
+  fingerprint = FingerprintDatasetDef(dataset_def, fingerprint);
+  // A fingerprint which doesn't match the uploaded graph would register the
+  // graph under another dataset's fingerprint, or return another dataset.
+  if (has_fingerprint && request->fingerprint() != fingerprint) {
+    return errors::InvalidArgument(
+        "Dataset fingerprint ", request->fingerprint(),
+        " does not match the fingerprint of the dataset graph, ", fingerprint,
+        ". The fingerprint must be computed with FingerprintDatasetGraph and "
+        "FingerprintDatasetDef.");
+  }
 
   mutex_lock l(mu_);
 #if defined(PLATFORM_GOOGLE)
@@ -533,6 +579,19 @@ Status DataServiceDispatcherImpl::GetElementSpec(
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::PrewarmDataset(
+    const PrewarmDatasetRequest* request, PrewarmDatasetResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  std::shared_ptr<const Dataset> dataset;
+  TF_RETURN_IF_ERROR(state_.DatasetFromId(request->dataset_id(), dataset));
+  if (!prewarm_datasets_.contains(request->dataset_id())) {
+    VLOG(1) << "Prewarming dataset " << request->dataset_id() << " on workers";
+  }
+  prewarm_datasets_[request->dataset_id()] = env_->NowMicros();
+  return Status::OK();
+}
+
 Status DataServiceDispatcherImpl::GetOrCreateJob(
     const GetOrCreateJobRequest* request, GetOrCreateJobResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
@@ -634,6 +693,8 @@ Status DataServiceDispatcherImpl::ReleaseJobClient(
   release_job_client->set_job_client_id(job_client_id);
   release_job_client->set_time_micros(env_->NowMicros());
   TF_RETURN_IF_ERROR(Apply(update));
+  client_loads_.erase(job_client_id);
+  UpdateAutoscalingMetrics();
   return Status::OK();
 }
 
@@ -873,6 +934,12 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
         "Consider configuring the dispatcher with a higher "
         "`job_gc_timeout_ms`.");
   }
+  auto load_it = client_loads_.find(request->job_client_id());
+  const bool first_report = load_it == client_loads_.end();
+  ClientLoad& client_load = client_loads_[request->job_client_id()];
+  client_load.job_id = job->job_id;
+  UpdateClientLoad(*request, first_report, client_load);
+  UpdateAutoscalingMetrics();
   if (request->optional_current_round_case() ==
       ClientHeartbeatRequest::kCurrentRound) {
     round_robin_rounds_[request->job_client_id()] =
@@ -953,6 +1020,55 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   return Status::OK();
 }
 
+Status DataServiceDispatcherImpl::GetAutoscalingSignals(
+    const GetAutoscalingSignalsRequest* request,
+    GetAutoscalingSignalsResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  return ComputeAutoscalingSignals(*response);
+}
+
+Status DataServiceDispatcherImpl::ComputeAutoscalingSignals(
+    GetAutoscalingSignalsResponse& response) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64_t additional_workers = 0;
+  for (const auto& job : state_.ListJobs()) {
+    if (job->finished || job->garbage_collected || job->num_clients == 0) {
+      continue;
+    }
+    std::vector<std::shared_ptr<const Task>> tasks;
+    TF_RETURN_IF_ERROR(state_.TasksForJob(job->job_id, tasks));
+    const int64_t num_workers =
+        absl::c_count_if(tasks, [](const std::shared_ptr<const Task>& task) {
+          return !task->finished;
+        });
+    const ClientLoad job_load = JobLoad(job->job_id);
+    JobAutoscalingSignal* signal = response.add_jobs();
+    signal->set_job_id(job->job_id);
+    if (job->named_job_key.has_value()) {
+      signal->set_job_name(job->named_job_key->name);
+    }
+    signal->set_num_workers(num_workers);
+    signal->set_stall_ratio(job_load.stall_ratio);
+    signal->set_buffer_occupancy(job_load.buffer_occupancy);
+    signal->set_elements_per_second(job_load.elements_per_second);
+    signal->set_additional_workers(AdditionalWorkers(job_load, num_workers));
+    additional_workers =
+        std::max(additional_workers, signal->additional_workers());
+  }
+  response.set_additional_workers(additional_workers);
+  metrics::RecordTFDataServiceAdditionalWorkers(additional_workers);
+  return Status::OK();
+}
+
+void DataServiceDispatcherImpl::UpdateAutoscalingMetrics()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  GetAutoscalingSignalsResponse response;
+  Status s = ComputeAutoscalingSignals(response);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to update the autoscaling metrics: " << s;
+  }
+}
+
 Status DataServiceDispatcherImpl::PopulateTaskDef(
     std::shared_ptr<const Task> task, TaskDef* task_def) const
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -979,8 +1095,11 @@ Status DataServiceDispatcherImpl::PopulateTaskDef(
   std::string dataset_key =
       DatasetKey(dataset->dataset_id, dataset->fingerprint);
   if (config_.work_dir().empty()) {
+    // Large constants are left out of the task definition. Workers fetch them
+    // with `GetConstantChunk` unless they already have them cached.
     std::shared_ptr<const DatasetDef> dataset_def;
-    TF_RETURN_IF_ERROR(dataset_store_->Get(dataset_key, dataset_def));
+    TF_RETURN_IF_ERROR(
+        dataset_store_->GetWithConstantReferences(dataset_key, dataset_def));
     *task_def->mutable_dataset_def() = *dataset_def;
   } else {
     std::string path =
@@ -1048,6 +1167,8 @@ void DataServiceDispatcherImpl::JobGcThread() {
         LOG(WARNING) << "Error garbage collecting old jobs: " << s;
       }
     }
+    GcPrewarmDatasets();
+    UpdateAutoscalingMetrics();
     next_check_micros =
         env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
@@ -1067,6 +1188,7 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
       release_client->set_job_client_id(client_id);
       release_client->set_time_micros(now);
       TF_RETURN_IF_ERROR(Apply(update));
+      client_loads_.erase(client_id);
     }
   }
   return Status::OK();
@@ -1090,6 +1212,58 @@ Status DataServiceDispatcherImpl::GcOldJobs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   return Status::OK();
 }
 
+void DataServiceDispatcherImpl::GcPrewarmDatasets()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (prewarm_datasets_.empty()) {
+    return;
+  }
+  int64_t now = env_->NowMicros();
+  for (const auto& job : state_.ListJobs()) {
+    auto it = prewarm_datasets_.find(job->dataset_id);
+    if (it != prewarm_datasets_.end() && job->num_clients > 0) {
+      it->second = now;
+    }
+  }
+  for (auto it = prewarm_datasets_.begin(); it != prewarm_datasets_.end();) {
+    if (now < it->second + (config_.job_gc_timeout_ms() * 1000)) {
+      ++it;
+      continue;
+    }
+    LOG(INFO) << "Stopped prewarming dataset " << it->first
+              << ", which has not been read for "
+              << config_.job_gc_timeout_ms() << "ms";
+    prewarm_datasets_.erase(it++);
+  }
+}
+
+double DataServiceDispatcherImpl::JobWeight(const Job& job) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64_t priority = 0;
+  if (job.named_job_key.has_value()) {
+    auto it = config_.job_priorities().find(job.named_job_key->name);
+    if (it != config_.job_priorities().end()) {
+      priority = std::min(std::max(it->second, -kMaxJobPriority),
+                          kMaxJobPriority);
+    }
+  }
+  const double stall_ratio = JobLoad(job.job_id).stall_ratio;
+  return std::ldexp(1.0, priority) *
+         (1.0 + (kMaxStallWeightFactor - 1.0) * stall_ratio);
+}
+
+ClientLoad DataServiceDispatcherImpl::JobLoad(int64_t job_id) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<ClientLoad> client_loads;
+  for (const auto& client_load : client_loads_) {
+    if (client_load.second.job_id == job_id) {
+      client_loads.push_back(client_load.second);
+    }
+  }
+  ClientLoad job_load = AggregateClientLoads(client_loads);
+  job_load.job_id = job_id;
+  return job_load;
+}
+
 Status DataServiceDispatcherImpl::GetDatasetDef(
     int64_t dataset_id, std::shared_ptr<const DatasetDef>& dataset_def)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/data/service/common.h"
+#include "tensorflow/core/data/service/autoscaling_signals.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
@@ -148,6 +149,8 @@ class DataServiceDispatcherImpl {
                       WorkerUpdateResponse* response);
   Status GetDatasetDef(const GetDatasetDefRequest* request,
                        GetDatasetDefResponse* response);
+  Status GetConstantChunk(const GetConstantChunkRequest* request,
+                          GetConstantChunkResponse* response);
   Status GetSplit(const GetSplitRequest* request, GetSplitResponse* response);
 
   /// Client-facing API.
@@ -167,6 +170,10 @@ class DataServiceDispatcherImpl {
                          ClientHeartbeatResponse* response);
   Status GetWorkers(const GetWorkersRequest* request,
                     GetWorkersResponse* response);
+  Status PrewarmDataset(const PrewarmDatasetRequest* request,
+                        PrewarmDatasetResponse* response);
+  Status GetAutoscalingSignals(const GetAutoscalingSignalsRequest* request,
+                               GetAutoscalingSignalsResponse* response);
 
  private:
   // Restores split providers from the state in `job` and stores them in
@@ -215,6 +222,19 @@ class DataServiceDispatcherImpl {
       const absl::flat_hash_set<int64_t>& current_tasks,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& assigned_tasks,
       WorkerHeartbeatResponse* response);
+  // Computes the autoscaling signals of the jobs which are being read, and
+  // records the number of additional workers in the metrics.
+  Status ComputeAutoscalingSignals(GetAutoscalingSignalsResponse& response)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Updates the autoscaling metrics after an input of the autoscaling signals
+  // changed: the client loads, the jobs, or their tasks.
+  void UpdateAutoscalingMetrics() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the load of the clients of `job_id`, aggregated over the clients.
+  ClientLoad JobLoad(int64_t job_id) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the fair-share scheduling weight of `job`, based on its priority
+  // and the stall ratio of its clients.
+  double JobWeight(const DispatcherState::Job& job) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Acquires a job client id to read from the given job and sets
   // `job_client_id`.
   Status AcquireJobClientId(
@@ -279,6 +299,9 @@ class DataServiceDispatcherImpl {
   Status ReleaseMissingClients() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old jobs and marks them as finished.
   Status GcOldJobs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Stops prewarming datasets which have had no job clients for
+  // `job_gc_timeout_ms`.
+  void GcPrewarmDatasets() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Gets a `DatasetDef` from `dataset_store_` for the given dataset id, and
   // stores it in `dataset_def`.
   Status GetDatasetDef(int64_t dataset_id,
@@ -311,9 +334,16 @@ class DataServiceDispatcherImpl {
   // Map from task id to a TaskRemover which determines when to remove the task.
   absl::flat_hash_map<int64_t, std::shared_ptr<TaskRemover>>
       remove_task_requests_ TF_GUARDED_BY(mu_);
+  // Map from the ids of the datasets workers should keep prewarmed tasks for to
+  // the time the dataset was last prewarmed or read by a job client. This is a
+  // performance hint, so it is not journaled.
+  absl::flat_hash_map<int64_t, int64_t> prewarm_datasets_ TF_GUARDED_BY(mu_);
   // Map from client id to the time of the client's last heartbeat.
   absl::flat_hash_map<int64_t, absl::Time> latest_client_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // Map from client id to the load reported in the client's heartbeats. This
+  // is a scheduling and autoscaling hint, so it is not journaled.
+  absl::flat_hash_map<int64_t, ClientLoad> client_loads_ TF_GUARDED_BY(mu_);
 
   absl::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
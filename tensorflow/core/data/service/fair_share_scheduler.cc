@@ -0,0 +1,196 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/fair_share_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+
+FairShareScheduler::FairShareScheduler(int64_t num_slots)
+    : num_slots_(std::max<int64_t>(num_slots, 1)) {}
+
+void FairShareScheduler::SetJobWeights(
+    const absl::flat_hash_map<int64_t, double>& job_weights)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  for (auto it = jobs_.begin(); it != jobs_.end();) {
+    if (job_weights.contains(it->first)) {
+      ++it;
+      continue;
+    }
+    if (it->second.num_waiting == 0 && it->second.num_running == 0) {
+      jobs_.erase(it++);
+    } else {
+      it->second.weight = 1.0;
+      ++it;
+    }
+  }
+  for (const auto& job_weight : job_weights) {
+    jobs_[job_weight.first].weight =
+        job_weight.second > 0 ? job_weight.second : 1.0;
+  }
+  cv_.notify_all();
+}
+
+Status FairShareScheduler::Acquire(int64_t job_id, int64_t task_id)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  JobState& job = jobs_[job_id];
+  if (job.num_waiting == 0 && job.num_running == 0) {
+    job.virtual_time = std::max(job.virtual_time, virtual_clock_);
+  }
+  ++job.num_waiting;
+  while (!IsCancelled(task_id) && !CanRun(job_id)) {
+    cv_.wait(l);
+  }
+  // `jobs_` may have been rehashed while waiting.
+  JobState& running_job = jobs_[job_id];
+  --running_job.num_waiting;
+  if (IsCancelled(task_id)) {
+    // Other jobs may have been waiting for this job to run first.
+    cv_.notify_all();
+    return errors::Cancelled("Task ", task_id, " is cancelled");
+  }
+  ++running_job.num_running;
+  ++num_running_;
+  virtual_clock_ = std::max(virtual_clock_, running_job.virtual_time);
+  return Status::OK();
+}
+
+void FairShareScheduler::Release(int64_t job_id, double cost)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  JobState& job = jobs_[job_id];
+  job.virtual_time += std::max(cost, 0.0) / job.weight;
+  --job.num_running;
+  --num_running_;
+  cv_.notify_all();
+}
+
+double FairShareScheduler::VirtualTime(int64_t job_id) TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  auto it = jobs_.find(job_id);
+  return it == jobs_.end() ? virtual_clock_ : it->second.virtual_time;
+}
+
+void FairShareScheduler::RegisterTask(int64_t task_id) TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  ++tasks_[task_id].num_iterators;
+}
+
+void FairShareScheduler::UnregisterTask(int64_t task_id)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  auto it = tasks_.find(task_id);
+  if (it != tasks_.end() && --it->second.num_iterators <= 0) {
+    tasks_.erase(it);
+  }
+}
+
+void FairShareScheduler::CancelTask(int64_t task_id) TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  auto it = tasks_.find(task_id);
+  if (it != tasks_.end()) {
+    it->second.cancelled = true;
+    cv_.notify_all();
+  }
+}
+
+bool FairShareScheduler::CanRun(int64_t job_id) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (num_running_ >= num_slots_ || HoldsFairShare(job_id)) {
+    return false;
+  }
+  const JobState& job = jobs_.at(job_id);
+  for (const auto& other : jobs_) {
+    if (other.second.num_waiting == 0 || other.first == job_id ||
+        HoldsFairShare(other.first)) {
+      continue;
+    }
+    if (std::make_pair(other.second.virtual_time, other.first) <
+        std::make_pair(job.virtual_time, job_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FairShareScheduler::HoldsFairShare(int64_t job_id) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const JobState& job = jobs_.at(job_id);
+  double active_weight = 0.0;
+  bool others_waiting = false;
+  for (const auto& other : jobs_) {
+    if (other.second.num_waiting == 0 && other.second.num_running == 0) {
+      continue;
+    }
+    active_weight += other.second.weight;
+    if (other.first != job_id && other.second.num_waiting > 0) {
+      others_waiting = true;
+    }
+  }
+  if (!others_waiting) {
+    return false;
+  }
+  // Rounding up lets the shares of the active jobs cover all slots.
+  const int64_t fair_share = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(num_slots_ * job.weight /
+                                        active_weight)));
+  return job.num_running >= fair_share;
+}
+
+bool FairShareScheduler::IsCancelled(int64_t task_id) const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  auto it = tasks_.find(task_id);
+  return it != tasks_.end() && it->second.cancelled;
+}
+
+FairShareTaskIterator::FairShareTaskIterator(
+    std::unique_ptr<TaskIterator> iterator, FairShareScheduler& scheduler,
+    int64_t job_id, int64_t task_id)
+    : iterator_(std::move(iterator)),
+      scheduler_(scheduler),
+      job_id_(job_id),
+      task_id_(task_id) {
+  scheduler_.RegisterTask(task_id_);
+}
+
+FairShareTaskIterator::~FairShareTaskIterator() {
+  scheduler_.UnregisterTask(task_id_);
+}
+
+Status FairShareTaskIterator::GetNext(std::vector<Tensor>& element,
+                                      bool& end_of_sequence) {
+  TF_RETURN_IF_ERROR(scheduler_.Acquire(job_id_, task_id_));
+  Status s = iterator_->GetNext(element, end_of_sequence);
+  scheduler_.Release(job_id_, /*cost=*/1.0);
+  return s;
+}
+
+int64_t FairShareTaskIterator::Cardinality() const {
+  return iterator_->Cardinality();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,127 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_FAIR_SHARE_SCHEDULER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_FAIR_SHARE_SCHEDULER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/service/task_runner.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Arbitrates the element production of the tasks on a worker between their
+// jobs by weighted fair queuing.
+//
+// At most `num_slots` elements are produced at a time. When more tasks want
+// to produce elements, the slot goes to the job which has produced the fewest
+// elements relative to its weight: each job has a virtual time, which advances
+// by the cost of its elements divided by its weight, and the waiting job with
+// the lowest virtual time runs next. Jobs which become active start at the
+// virtual time of the jobs being served, so idle jobs do not accumulate
+// credit. While other jobs are waiting, a job holds at most its weighted share
+// of the slots, so that jobs whose elements take long to produce, e.g. because
+// they wait for their input, cannot starve the other jobs.
+class FairShareScheduler {
+ public:
+  explicit FairShareScheduler(int64_t num_slots);
+  FairShareScheduler(const FairShareScheduler&) = delete;
+  FairShareScheduler& operator=(const FairShareScheduler&) = delete;
+
+  // Sets the weights of the jobs, keyed by job id. Jobs without a weight have
+  // weight 1.
+  void SetJobWeights(const absl::flat_hash_map<int64_t, double>& job_weights)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Blocks until a task of `job_id` may produce an element. Returns CANCELLED
+  // if `task_id` is cancelled before then.
+  Status Acquire(int64_t job_id, int64_t task_id) TF_LOCKS_EXCLUDED(mu_);
+  // Releases the slot acquired for `job_id`, charging the job `cost`.
+  void Release(int64_t job_id, double cost) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the virtual time of `job_id`.
+  double VirtualTime(int64_t job_id) TF_LOCKS_EXCLUDED(mu_);
+
+  // Registers an iterator of `task_id`, which must be unregistered with
+  // `UnregisterTask` once it is destroyed.
+  void RegisterTask(int64_t task_id) TF_LOCKS_EXCLUDED(mu_);
+  void UnregisterTask(int64_t task_id) TF_LOCKS_EXCLUDED(mu_);
+  // Makes pending and future calls to `Acquire` for `task_id` return
+  // CANCELLED.
+  void CancelTask(int64_t task_id) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct JobState {
+    double weight = 1.0;
+    double virtual_time = 0.0;
+    int64_t num_waiting = 0;
+    int64_t num_running = 0;
+  };
+
+  struct TaskState {
+    int64_t num_iterators = 0;
+    bool cancelled = false;
+  };
+
+  // Returns whether a waiting task of `job_id` may take a slot.
+  bool CanRun(int64_t job_id) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether `job_id` holds its share of the slots while another job is
+  // waiting.
+  bool HoldsFairShare(int64_t job_id) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether `task_id` has been cancelled.
+  bool IsCancelled(int64_t task_id) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t num_slots_;
+
+  mutex mu_;
+  condition_variable cv_;
+  int64_t num_running_ TF_GUARDED_BY(mu_) = 0;
+  // Virtual time of the most recently served job.
+  double virtual_clock_ TF_GUARDED_BY(mu_) = 0.0;
+  absl::flat_hash_map<int64_t, JobState> jobs_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64_t, TaskState> tasks_ TF_GUARDED_BY(mu_);
+};
+
+// Task iterator which produces the elements of its task in the fair share of
+// the task's job. Each element costs 1: the worker cannot attribute CPU time
+// to jobs, and the duration of `GetNext` is mostly spent waiting for the
+// asynchronous stages of the input pipeline.
+class FairShareTaskIterator : public TaskIterator {
+ public:
+  // `scheduler` must outlive the iterator.
+  FairShareTaskIterator(std::unique_ptr<TaskIterator> iterator,
+                        FairShareScheduler& scheduler, int64_t job_id,
+                        int64_t task_id);
+  ~FairShareTaskIterator() override;
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override;
+  int64_t Cardinality() const override;
+
+ private:
+  const std::unique_ptr<TaskIterator> iterator_;
+  FairShareScheduler& scheduler_;
+  const int64_t job_id_;
+  const int64_t task_id_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_FAIR_SHARE_SCHEDULER_H_
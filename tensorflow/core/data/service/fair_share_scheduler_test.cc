@@ -0,0 +1,194 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/fair_share_scheduler.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class RangeTaskIterator : public TaskIterator {
+ public:
+  explicit RangeTaskIterator(int64_t range) : range_(range) {}
+
+  Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence) override {
+    end_of_sequence = next_ >= range_;
+    if (!end_of_sequence) {
+      element = {Tensor(next_++)};
+    }
+    return Status::OK();
+  }
+
+  int64_t Cardinality() const override { return range_; }
+
+ private:
+  const int64_t range_;
+  int64_t next_ = 0;
+};
+
+TEST(FairShareSchedulerTest, VirtualTimeAdvancesByWeight) {
+  FairShareScheduler scheduler(/*num_slots=*/1);
+  scheduler.SetJobWeights({{1, 2.0}});
+  TF_EXPECT_OK(scheduler.Acquire(1, /*task_id=*/1));
+  scheduler.Release(1, /*cost=*/100);
+  EXPECT_EQ(scheduler.VirtualTime(1), 50.0);
+
+  TF_EXPECT_OK(scheduler.Acquire(2, /*task_id=*/2));
+  scheduler.Release(2, /*cost=*/100);
+  EXPECT_EQ(scheduler.VirtualTime(2), 100.0);
+}
+
+TEST(FairShareSchedulerTest, IdleJobsDoNotAccumulateCredit) {
+  FairShareScheduler scheduler(/*num_slots=*/1);
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(scheduler.Acquire(1, /*task_id=*/1));
+    scheduler.Release(1, /*cost=*/100);
+  }
+  TF_EXPECT_OK(scheduler.Acquire(1, /*task_id=*/1));
+  // Job 2 becomes active while job 1 is served, so it starts at job 1's
+  // virtual time.
+  std::unique_ptr<Thread> thread = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "job_2", [&scheduler]() {
+        TF_EXPECT_OK(scheduler.Acquire(2, /*task_id=*/2));
+        scheduler.Release(2, /*cost=*/0);
+      }));
+  scheduler.Release(1, /*cost=*/100);
+  thread.reset();
+  EXPECT_EQ(scheduler.VirtualTime(2), 300.0);
+}
+
+TEST(FairShareSchedulerTest, LowestVirtualTimeRunsFirst) {
+  FairShareScheduler scheduler(/*num_slots=*/1);
+  TF_EXPECT_OK(scheduler.Acquire(1, /*task_id=*/1));
+  scheduler.Release(1, /*cost=*/1000);
+  TF_EXPECT_OK(scheduler.Acquire(2, /*task_id=*/2));
+  scheduler.Release(2, /*cost=*/10);
+  // Hold the only slot while jobs 1 and 2 queue up.
+  TF_EXPECT_OK(scheduler.Acquire(3, /*task_id=*/3));
+
+  mutex mu;
+  std::vector<int64_t> order;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t job_id : {1, 2}) {
+    threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, "job", [&scheduler, &mu, &order, job_id]() {
+          TF_EXPECT_OK(scheduler.Acquire(job_id, /*task_id=*/job_id));
+          {
+            mutex_lock l(mu);
+            order.push_back(job_id);
+          }
+          scheduler.Release(job_id, /*cost=*/0);
+        })));
+  }
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  scheduler.Release(3, /*cost=*/0);
+  threads.clear();
+  EXPECT_EQ(order, std::vector<int64_t>({2, 1}));
+}
+
+TEST(FairShareSchedulerTest, JobsHoldAtMostTheirShareWhileOthersWait) {
+  FairShareScheduler scheduler(/*num_slots=*/2);
+  TF_ASSERT_OK(scheduler.Acquire(2, /*task_id=*/2));
+  scheduler.Release(2, /*cost=*/100);
+  // Job 1 takes both slots while no other job is waiting.
+  TF_ASSERT_OK(scheduler.Acquire(1, /*task_id=*/1));
+  TF_ASSERT_OK(scheduler.Acquire(1, /*task_id=*/1));
+
+  mutex mu;
+  std::vector<int64_t> order;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t job_id : {1, 2}) {
+    threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, "job", [&scheduler, &mu, &order, job_id]() {
+          TF_EXPECT_OK(scheduler.Acquire(job_id, /*task_id=*/job_id));
+          {
+            mutex_lock l(mu);
+            order.push_back(job_id);
+          }
+          scheduler.Release(job_id, /*cost=*/0);
+        })));
+  }
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  scheduler.Release(1, /*cost=*/0);
+  // Job 1 has the lower virtual time, but already holds its share of the
+  // slots.
+  threads.clear();
+  scheduler.Release(1, /*cost=*/0);
+  EXPECT_EQ(order, std::vector<int64_t>({2, 1}));
+}
+
+TEST(FairShareSchedulerTest, CancelTaskUnblocksAcquire) {
+  FairShareScheduler scheduler(/*num_slots=*/1);
+  scheduler.RegisterTask(/*task_id=*/2);
+  // Hold the only slot.
+  TF_ASSERT_OK(scheduler.Acquire(1, /*task_id=*/1));
+  Status status;
+  std::unique_ptr<Thread> thread = absl::WrapUnique(Env::Default()->StartThread(
+      {}, "job_2", [&scheduler, &status]() {
+        status = scheduler.Acquire(2, /*task_id=*/2);
+      }));
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  scheduler.CancelTask(/*task_id=*/2);
+  thread.reset();
+  EXPECT_EQ(status.code(), error::CANCELLED);
+  EXPECT_EQ(scheduler.Acquire(2, /*task_id=*/2).code(), error::CANCELLED);
+  scheduler.Release(1, /*cost=*/0);
+  scheduler.UnregisterTask(/*task_id=*/2);
+}
+
+TEST(FairShareSchedulerTest, DroppedJobsHaveDefaultWeight) {
+  FairShareScheduler scheduler(/*num_slots=*/1);
+  scheduler.SetJobWeights({{1, 4.0}});
+  TF_ASSERT_OK(scheduler.Acquire(1, /*task_id=*/1));
+  // Job 1 is active, so it is kept, but its weight is reset.
+  scheduler.SetJobWeights({});
+  scheduler.Release(1, /*cost=*/100);
+  EXPECT_EQ(scheduler.VirtualTime(1), 100.0);
+}
+
+TEST(FairShareTaskIteratorTest, ProducesElements) {
+  FairShareScheduler scheduler(/*num_slots=*/1);
+  FairShareTaskIterator iterator(absl::make_unique<RangeTaskIterator>(3),
+                                 scheduler, /*job_id=*/7, /*task_id=*/8);
+  EXPECT_EQ(iterator.Cardinality(), 3);
+  for (int64_t i = 0; i < 3; ++i) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_ASSERT_OK(iterator.GetNext(element, end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    test::ExpectEqual(element[0], Tensor(i));
+  }
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(iterator.GetNext(element, end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -45,6 +45,7 @@ size_t GrpcDispatcherImpl::NumActiveJobs() { return impl_.NumActiveJobs(); }
 HANDLER(WorkerHeartbeat);
 HANDLER(WorkerUpdate);
 HANDLER(GetDatasetDef);
+HANDLER(GetConstantChunk);
 HANDLER(GetSplit);
 HANDLER(GetVersion);
 HANDLER(GetOrRegisterDataset);
@@ -54,6 +55,8 @@ HANDLER(GetOrCreateJob);
 HANDLER(ClientHeartbeat);
 HANDLER(GetWorkers);
 HANDLER(GetElementSpec);
+HANDLER(PrewarmDataset);
+HANDLER(GetAutoscalingSignals);
 #undef HANDLER
 
 }  // namespace data
@@ -44,6 +44,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(WorkerHeartbeat);
   HANDLER(WorkerUpdate);
   HANDLER(GetDatasetDef);
+  HANDLER(GetConstantChunk);
   HANDLER(GetSplit);
   HANDLER(GetVersion);
   HANDLER(GetOrRegisterDataset);
@@ -53,6 +54,8 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(ClientHeartbeat);
   HANDLER(GetWorkers);
   HANDLER(GetElementSpec);
+  HANDLER(PrewarmDataset);
+  HANDLER(GetAutoscalingSignals);
 #undef HANDLER
 
  private:
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -52,6 +53,18 @@ using ::tensorflow::data::testing::RangeSquareDataset;
 
 constexpr const char kHostAddress[] = "localhost";
 constexpr const char kProtocol[] = "grpc";
+constexpr const char kAdditionalWorkersMetric[] =
+    "/tensorflow/data/service/additional_workers";
+
+// Returns the number of additional workers recorded in the metrics.
+int64_t AdditionalWorkersMetric() {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  std::unique_ptr<monitoring::CollectedMetrics> metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  return metrics->point_set_map.at(kAdditionalWorkersMetric)
+      ->points.at(0)
+      ->int64_value;
+}
 
 class GrpcDispatcherImplTest : public ::testing::Test {
  protected:
@@ -107,11 +120,12 @@ class GrpcDispatcherImplTest : public ::testing::Test {
     return response;
   }
 
-  StatusOr<WorkerHeartbeatResponse> WorkerHeartbeat() {
+  StatusOr<WorkerHeartbeatResponse> WorkerHeartbeat(
+      const std::string& worker_address = kHostAddress) {
     WorkerHeartbeatRequest request;
     WorkerHeartbeatResponse response;
-    request.set_worker_address(kHostAddress);
-    request.set_transfer_address(kHostAddress);
+    request.set_worker_address(worker_address);
+    request.set_transfer_address(worker_address);
     ClientContext client_ctx;
     TF_RETURN_IF_ERROR(FromGrpcStatus(dispatcher_client_stub_->WorkerHeartbeat(
         &client_ctx, request, &response)));
@@ -121,14 +135,29 @@ class GrpcDispatcherImplTest : public ::testing::Test {
   StatusOr<ClientHeartbeatResponse> ClientHeartbeat(
       const int64_t job_client_id) {
     ClientHeartbeatRequest request;
-    ClientHeartbeatResponse response;
     request.set_job_client_id(job_client_id);
+    return ClientHeartbeat(request);
+  }
+
+  StatusOr<ClientHeartbeatResponse> ClientHeartbeat(
+      const ClientHeartbeatRequest& request) {
+    ClientHeartbeatResponse response;
     ClientContext client_ctx;
     TF_RETURN_IF_ERROR(FromGrpcStatus(dispatcher_client_stub_->ClientHeartbeat(
         &client_ctx, request, &response)));
     return response;
   }
 
+  StatusOr<GetAutoscalingSignalsResponse> GetAutoscalingSignals() {
+    GetAutoscalingSignalsRequest request;
+    GetAutoscalingSignalsResponse response;
+    ClientContext client_ctx;
+    TF_RETURN_IF_ERROR(
+        FromGrpcStatus(dispatcher_client_stub_->GetAutoscalingSignals(
+            &client_ctx, request, &response)));
+    return response;
+  }
+
   std::unique_ptr<DispatchGrpcDataServer> dispatcher_server_;
   std::unique_ptr<DispatcherService::Stub> dispatcher_client_stub_;
 };
@@ -156,6 +185,83 @@ TEST_F(GrpcDispatcherImplTest, ClientHeartbeat) {
   EXPECT_EQ(client_response.task_info(0).worker_address(), kHostAddress);
 }
 
+TEST_F(GrpcDispatcherImplTest, RejectMismatchedFingerprint) {
+  GetOrRegisterDatasetRequest request;
+  GetOrRegisterDatasetResponse response;
+  *request.mutable_dataset() = RangeSquareDataset(/*range=*/20);
+  request.set_fingerprint(12345);
+  ClientContext context;
+  Status status = FromGrpcStatus(dispatcher_client_stub_->GetOrRegisterDataset(
+      &context, request, &response));
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+TEST_F(GrpcDispatcherImplTest, AutoscalingSignals) {
+  TF_ASSERT_OK_AND_ASSIGN(GetOrRegisterDatasetResponse dataset_response,
+                          RegisterDataset());
+  TF_ASSERT_OK_AND_ASSIGN(GetOrCreateJobResponse job_response,
+                          CreateJob(dataset_response.dataset_id()));
+  TF_ASSERT_OK(WorkerHeartbeat().status());
+  ClientHeartbeatRequest request;
+  request.set_job_client_id(job_response.job_client_id());
+  request.set_stall_ratio(0.75);
+  request.set_buffered_elements(0);
+  request.set_buffer_capacity(16);
+  request.set_elements_per_second(100);
+  TF_ASSERT_OK(ClientHeartbeat(request).status());
+
+  TF_ASSERT_OK_AND_ASSIGN(GetAutoscalingSignalsResponse signals,
+                          GetAutoscalingSignals());
+  ASSERT_EQ(signals.jobs_size(), 1);
+  EXPECT_EQ(signals.jobs(0).num_workers(), 1);
+  EXPECT_DOUBLE_EQ(signals.jobs(0).stall_ratio(), 0.75);
+  EXPECT_DOUBLE_EQ(signals.jobs(0).buffer_occupancy(), 0.0);
+  EXPECT_DOUBLE_EQ(signals.jobs(0).elements_per_second(), 100);
+  EXPECT_EQ(signals.jobs(0).additional_workers(), 3);
+  EXPECT_EQ(signals.additional_workers(), 3);
+
+  // Act as the autoscaler, adding the workers asked for.
+  for (int64_t i = 0; i < signals.additional_workers(); ++i) {
+    TF_ASSERT_OK(WorkerHeartbeat(absl::StrCat("worker_", i)).status());
+  }
+  TF_ASSERT_OK_AND_ASSIGN(signals, GetAutoscalingSignals());
+  ASSERT_EQ(signals.jobs_size(), 1);
+  EXPECT_EQ(signals.jobs(0).num_workers(), 4);
+}
+
+TEST_F(GrpcDispatcherImplTest, ClientHeartbeatUpdatesAdditionalWorkers) {
+  TF_ASSERT_OK_AND_ASSIGN(GetOrRegisterDatasetResponse dataset_response,
+                          RegisterDataset());
+  TF_ASSERT_OK_AND_ASSIGN(GetOrCreateJobResponse job_response,
+                          CreateJob(dataset_response.dataset_id()));
+  TF_ASSERT_OK(WorkerHeartbeat().status());
+  ClientHeartbeatRequest request;
+  request.set_job_client_id(job_response.job_client_id());
+  request.set_stall_ratio(0.75);
+  request.set_buffered_elements(0);
+  request.set_buffer_capacity(16);
+  request.set_elements_per_second(100);
+  TF_ASSERT_OK(ClientHeartbeat(request).status());
+  // The metric is recorded without polling the autoscaling signals.
+  EXPECT_EQ(AdditionalWorkersMetric(), 3);
+
+  // Jobs without clients don't ask for workers.
+  ReleaseJobClientRequest release_request;
+  release_request.set_job_client_id(job_response.job_client_id());
+  ReleaseJobClientResponse release_response;
+  ClientContext context;
+  TF_ASSERT_OK(FromGrpcStatus(dispatcher_client_stub_->ReleaseJobClient(
+      &context, release_request, &release_response)));
+  EXPECT_EQ(AdditionalWorkersMetric(), 0);
+}
+
+TEST_F(GrpcDispatcherImplTest, NoAutoscalingSignalsWithoutJobs) {
+  TF_ASSERT_OK_AND_ASSIGN(GetAutoscalingSignalsResponse signals,
+                          GetAutoscalingSignals());
+  EXPECT_EQ(signals.jobs_size(), 0);
+  EXPECT_EQ(signals.additional_workers(), 0);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -60,6 +60,7 @@ void GrpcWorkerImpl::Stop() {
   }
 HANDLER(ProcessTask);
 HANDLER(GetElement);
+HANDLER(GetElementChunk);
 HANDLER(GetWorkerTasks);
 #undef HANDLER
 
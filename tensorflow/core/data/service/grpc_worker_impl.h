@@ -55,6 +55,7 @@ class GrpcWorkerImpl : public WorkerService::Service {
                         method##Response* response) override;
   HANDLER(ProcessTask);
   HANDLER(GetElement);
+  HANDLER(GetElementChunk);
   HANDLER(GetWorkerTasks);
 #undef HANDLER
 
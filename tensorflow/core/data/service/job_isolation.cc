@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/job_isolation.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Each allocation is preceded by a header holding the offset of the header
+// from the start of the underlying allocation and the requested size. The
+// offset is a multiple of the alignment, so the returned pointer stays aligned.
+constexpr size_t kHeaderBytes = 2 * sizeof(int64_t);
+
+int64_t* Header(const void* ptr) {
+  return reinterpret_cast<int64_t*>(const_cast<char*>(
+      static_cast<const char*>(ptr) - kHeaderBytes));
+}
+
+void UpdatePeak(std::atomic<int64_t>& peak, int64_t value) {
+  int64_t current = peak.load();
+  while (value > current && !peak.compare_exchange_weak(current, value)) {
+  }
+}
+
+}  // namespace
+
+MemoryLimitedAllocator::MemoryLimitedAllocator(const std::string& name,
+                                               Allocator* base,
+                                               int64_t limit_bytes)
+    : name_(name), base_(base), limit_bytes_(limit_bytes) {}
+
+void* MemoryLimitedAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* MemoryLimitedAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  const int64_t bytes_in_use = bytes_in_use_.fetch_add(num_bytes) + num_bytes;
+  if (limit_bytes_ > 0 && bytes_in_use > limit_bytes_) {
+    bytes_in_use_.fetch_sub(num_bytes);
+    VLOG(1) << name_ << " failed to allocate " << num_bytes << " bytes with "
+            << bytes_in_use - num_bytes << " of " << limit_bytes_
+            << " bytes in use";
+    return nullptr;
+  }
+  const size_t offset = std::max(alignment, kHeaderBytes);
+  void* base_ptr =
+      base_->AllocateRaw(alignment, offset + num_bytes, allocation_attr);
+  if (base_ptr == nullptr) {
+    bytes_in_use_.fetch_sub(num_bytes);
+    return nullptr;
+  }
+  void* ptr = static_cast<char*>(base_ptr) + offset;
+  int64_t* header = Header(ptr);
+  header[0] = offset;
+  header[1] = num_bytes;
+  UpdatePeak(peak_bytes_in_use_, bytes_in_use);
+  num_allocs_.fetch_add(1);
+  return ptr;
+}
+
+void MemoryLimitedAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  const int64_t* header = Header(ptr);
+  bytes_in_use_.fetch_sub(header[1]);
+  base_->DeallocateRaw(static_cast<char*>(ptr) - header[0]);
+}
+
+size_t MemoryLimitedAllocator::RequestedSize(const void* ptr) const {
+  return Header(ptr)[1];
+}
+
+absl::optional<AllocatorStats> MemoryLimitedAllocator::GetStats() {
+  AllocatorStats stats;
+  stats.num_allocs = num_allocs_.load();
+  stats.bytes_in_use = bytes_in_use_.load();
+  stats.peak_bytes_in_use = peak_bytes_in_use_.load();
+  if (limit_bytes_ > 0) {
+    stats.bytes_limit = limit_bytes_;
+  }
+  return stats;
+}
+
+JobIsolationDomain::JobIsolationDomain(int64_t job_id, int64_t cpu_limit,
+                                       int64_t memory_limit_bytes)
+    : job_id_(job_id),
+      allocator_(absl::make_unique<MemoryLimitedAllocator>(
+          absl::StrCat("tf_data_service_job_", job_id), cpu_allocator(),
+          memory_limit_bytes)),
+      thread_pool_(absl::make_unique<thread::ThreadPool>(
+          Env::Default(), absl::StrCat("tf_data_service_job_", job_id),
+          cpu_limit > 0 ? cpu_limit : port::MaxParallelism())),
+      background_thread_pool_(absl::make_unique<UnboundedThreadPool>(
+          Env::Default(),
+          absl::StrCat("tf_data_service_job_", job_id, "_background"))) {}
+
+JobIsolationDomain::~JobIsolationDomain() {
+  background_thread_pool_.reset();
+  thread_pool_.reset();
+  if (allocator_->bytes_in_use() > 0) {
+    // Tensors of the job may outlive its tasks, e.g. elements handed to a
+    // local client. The allocator must outlive them.
+    VLOG(1) << "Releasing the allocator of job " << job_id_ << " with "
+            << allocator_->bytes_in_use() << " bytes in use";
+    allocator_.release();
+  }
+}
+
+JobIsolationDomains::JobIsolationDomains(int64_t cpu_limit,
+                                         int64_t memory_limit_bytes)
+    : cpu_limit_(cpu_limit), memory_limit_bytes_(memory_limit_bytes) {}
+
+std::shared_ptr<JobIsolationDomain> JobIsolationDomains::Get(int64_t job_id)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  std::shared_ptr<JobIsolationDomain> domain = domains_[job_id].lock();
+  if (!domain) {
+    domain = std::make_shared<JobIsolationDomain>(job_id, cpu_limit_,
+                                                  memory_limit_bytes_);
+    domains_[job_id] = domain;
+  }
+  for (auto it = domains_.begin(); it != domains_.end();) {
+    if (it->second.expired()) {
+      domains_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  return domain;
+}
+
+}  // namespace data
+}  // namespace tensorflow
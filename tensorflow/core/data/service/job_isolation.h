@@ -0,0 +1,119 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_JOB_ISOLATION_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_JOB_ISOLATION_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// Allocator which caps the number of bytes in use at `limit_bytes`, failing
+// the allocations beyond it. Allocations are served by `base`.
+class MemoryLimitedAllocator : public Allocator {
+ public:
+  // A `limit_bytes` of 0 indicates no limit.
+  MemoryLimitedAllocator(const std::string& name, Allocator* base,
+                         int64_t limit_bytes);
+
+  std::string Name() override { return name_; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  absl::optional<AllocatorStats> GetStats() override;
+
+  // Returns the number of bytes currently allocated.
+  int64_t bytes_in_use() const { return bytes_in_use_.load(); }
+
+ private:
+  const std::string name_;
+  Allocator* const base_;  // Not owned.
+  const int64_t limit_bytes_;
+  std::atomic<int64_t> bytes_in_use_{0};
+  std::atomic<int64_t> peak_bytes_in_use_{0};
+  std::atomic<int64_t> num_allocs_{0};
+};
+
+// The resources dedicated to the tasks of one job on a worker: the threads
+// which run the ops of the job's input pipelines, the background threads of
+// their iterators, and the allocator of their tensors. Jobs in separate
+// domains do not compete for threads, and a job exceeding its memory budget
+// fails instead of exhausting the worker's memory.
+class JobIsolationDomain {
+ public:
+  // A `cpu_limit` of 0 uses as many threads as there are cores, and a
+  // `memory_limit_bytes` of 0 does not limit memory.
+  JobIsolationDomain(int64_t job_id, int64_t cpu_limit,
+                     int64_t memory_limit_bytes);
+  ~JobIsolationDomain();
+  JobIsolationDomain(const JobIsolationDomain&) = delete;
+  JobIsolationDomain& operator=(const JobIsolationDomain&) = delete;
+
+  int64_t job_id() const { return job_id_; }
+  thread::ThreadPool* thread_pool() const { return thread_pool_.get(); }
+  UnboundedThreadPool* background_thread_pool() const {
+    return background_thread_pool_.get();
+  }
+  MemoryLimitedAllocator* allocator() const { return allocator_.get(); }
+
+ private:
+  const int64_t job_id_;
+  std::unique_ptr<MemoryLimitedAllocator> allocator_;
+  // The thread pools are destroyed before `allocator_`, since their pending
+  // work may allocate.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+  std::unique_ptr<UnboundedThreadPool> background_thread_pool_;
+};
+
+// The isolation domains of the jobs processed by a worker. The tasks of a job
+// share its domain, which is released with the job's last task.
+class JobIsolationDomains {
+ public:
+  JobIsolationDomains(int64_t cpu_limit, int64_t memory_limit_bytes);
+  JobIsolationDomains(const JobIsolationDomains&) = delete;
+  JobIsolationDomains& operator=(const JobIsolationDomains&) = delete;
+
+  // Returns the domain of `job_id`, creating it if no task of the job holds
+  // it.
+  std::shared_ptr<JobIsolationDomain> Get(int64_t job_id)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const int64_t cpu_limit_;
+  const int64_t memory_limit_bytes_;
+
+  mutex mu_;
+  absl::flat_hash_map<int64_t, std::weak_ptr<JobIsolationDomain>> domains_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_JOB_ISOLATION_H_
@@ -0,0 +1,117 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/data/service/job_isolation.h"
+
+#include <memory>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/thread_factory.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(MemoryLimitedAllocatorTest, TracksBytesInUse) {
+  MemoryLimitedAllocator allocator("test", cpu_allocator(),
+                                   /*limit_bytes=*/0);
+  void* ptr1 = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* ptr2 = allocator.AllocateRaw(/*alignment=*/8, 28);
+  ASSERT_NE(ptr1, nullptr);
+  ASSERT_NE(ptr2, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr1) % Allocator::kAllocatorAlignment,
+            0);
+  EXPECT_EQ(allocator.RequestedSize(ptr1), 100);
+  EXPECT_EQ(allocator.RequestedSize(ptr2), 28);
+  EXPECT_EQ(allocator.bytes_in_use(), 128);
+
+  allocator.DeallocateRaw(ptr1);
+  EXPECT_EQ(allocator.bytes_in_use(), 28);
+  allocator.DeallocateRaw(ptr2);
+  EXPECT_EQ(allocator.bytes_in_use(), 0);
+
+  absl::optional<AllocatorStats> stats = allocator.GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->num_allocs, 2);
+  EXPECT_EQ(stats->peak_bytes_in_use, 128);
+  EXPECT_FALSE(stats->bytes_limit.has_value());
+}
+
+TEST(MemoryLimitedAllocatorTest, FailsBeyondLimit) {
+  MemoryLimitedAllocator allocator("test", cpu_allocator(),
+                                   /*limit_bytes=*/1000);
+  void* ptr = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 600);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(allocator.AllocateRaw(Allocator::kAllocatorAlignment, 600),
+            nullptr);
+  EXPECT_EQ(allocator.bytes_in_use(), 600);
+
+  allocator.DeallocateRaw(ptr);
+  ptr = allocator.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_NE(ptr, nullptr);
+  allocator.DeallocateRaw(ptr);
+  EXPECT_EQ(*allocator.GetStats()->bytes_limit, 1000);
+}
+
+TEST(JobIsolationDomainTest, CpuLimit) {
+  JobIsolationDomain domain(/*job_id=*/0, /*cpu_limit=*/3,
+                            /*memory_limit_bytes=*/0);
+  EXPECT_EQ(domain.thread_pool()->NumThreads(), 3);
+  EXPECT_EQ(domain.job_id(), 0);
+}
+
+TEST(JobIsolationDomainTest, BackgroundThreads) {
+  JobIsolationDomain domain(/*job_id=*/0, /*cpu_limit=*/1,
+                            /*memory_limit_bytes=*/0);
+  // Background threads don't take the threads of the job's thread pool.
+  BlockingCounter counter(2);
+  std::shared_ptr<ThreadFactory> thread_factory =
+      domain.background_thread_pool()->get_thread_factory();
+  std::unique_ptr<Thread> thread1 = thread_factory->StartThread(
+      "background", [&counter]() {
+        counter.DecrementCount();
+        counter.Wait();
+      });
+  std::unique_ptr<Thread> thread2 = thread_factory->StartThread(
+      "background", [&counter]() {
+        counter.DecrementCount();
+        counter.Wait();
+      });
+  counter.Wait();
+}
+
+TEST(JobIsolationDomainsTest, SharedPerJob) {
+  JobIsolationDomains domains(/*cpu_limit=*/1, /*memory_limit_bytes=*/1024);
+  std::shared_ptr<JobIsolationDomain> job0 = domains.Get(0);
+  std::shared_ptr<JobIsolationDomain> job1 = domains.Get(1);
+  EXPECT_EQ(domains.Get(0), job0);
+  EXPECT_NE(job0, job1);
+  EXPECT_EQ(job1->job_id(), 1);
+  EXPECT_EQ(*job1->allocator()->GetStats()->bytes_limit, 1024);
+}
+
+TEST(JobIsolationDomainsTest, ReleasedWithLastTask) {
+  JobIsolationDomains domains(/*cpu_limit=*/1, /*memory_limit_bytes=*/0);
+  std::weak_ptr<JobIsolationDomain> released = domains.Get(0);
+  EXPECT_TRUE(released.expired());
+  EXPECT_NE(domains.Get(0), nullptr);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/task_runner.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -37,6 +40,39 @@ namespace {
 // Time to wait before skipping a round if data still isn't available.
 const int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 
+Status ValidateRoundRobinRequest(const GetElementRequest& req,
+                                 int64_t num_consumers) {
+  if (req.consumer_index() < 0 || req.round_index() < 0) {
+    return errors::FailedPrecondition(
+        "RoundRobinTaskRunner needs to know the consumer index and element "
+        "index of each request.");
+  }
+  if (req.consumer_index() >= num_consumers) {
+    return errors::FailedPrecondition(
+        "Requesting data for consumer index ", req.consumer_index(),
+        ", but the task is configured for only ", num_consumers, " consumers");
+  }
+  return Status::OK();
+}
+
+// Returns a deep copy of `element`'s components, so that the copy sent to a
+// consumer does not share buffers with the element kept for retries.
+std::vector<Tensor> CopyComponents(const Element& element) {
+  std::vector<Tensor> components;
+  components.reserve(element.components.size());
+  for (const Tensor& component : element.components) {
+    components.push_back(tensor::DeepCopy(component));
+  }
+  return components;
+}
+
+std::vector<std::unique_ptr<TaskIterator>> SingleIterator(
+    std::unique_ptr<TaskIterator> iterator) {
+  std::vector<std::unique_ptr<TaskIterator>> iterators;
+  iterators.push_back(std::move(iterator));
+  return iterators;
+}
+
 }  // namespace
 
 StandaloneTaskIterator::StandaloneTaskIterator(
@@ -57,7 +93,24 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
                           const TaskDef& task_def,
                           std::unique_ptr<TaskIterator> iterator,
                           std::unique_ptr<TaskRunner>& out) {
+  return Create(worker_config, task_def, SingleIterator(std::move(iterator)),
+                out);
+}
+
+Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
+                          const TaskDef& task_def,
+                          std::vector<std::unique_ptr<TaskIterator>> iterators,
+                          std::unique_ptr<TaskRunner>& out) {
+  if (iterators.empty()) {
+    return errors::InvalidArgument("A task runner needs at least one iterator");
+  }
   if (task_def.optional_num_consumers_case() == TaskDef::kNumConsumers) {
+    if (iterators.size() > 1) {
+      return errors::InvalidArgument(
+          "Round robin reads require a single iterator per task, but got ",
+          iterators.size(), " iterator replicas");
+    }
+    std::unique_ptr<TaskIterator> iterator = std::move(iterators.front());
     int64_t cardinality = iterator->Cardinality();
     if (cardinality != kInfiniteCardinality &&
         cardinality != kUnknownCardinality) {
@@ -67,20 +120,38 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
           cardinality,
           ". Consider adding a `.repeat()` transformation to the dataset.");
     }
-    out = absl::make_unique<RoundRobinTaskRunner>(std::move(iterator),
-                                                  task_def.num_consumers(),
-                                                  task_def.worker_address());
+    if (worker_config.round_robin_max_skew_rounds() > 0) {
+      out = absl::make_unique<StreamingRoundRobinTaskRunner>(
+          std::move(iterator), task_def.num_consumers(),
+          worker_config.round_robin_max_skew_rounds(),
+          task_def.worker_address());
+    } else {
+      out = absl::make_unique<RoundRobinTaskRunner>(std::move(iterator),
+                                                    task_def.num_consumers(),
+                                                    task_def.worker_address());
+    }
   } else {
-    out =
-        absl::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
+    out = absl::make_unique<FirstComeFirstServedTaskRunner>(
+        std::move(iterators));
   }
   return Status::OK();
 }
 
 FirstComeFirstServedTaskRunner::FirstComeFirstServedTaskRunner(
     std::unique_ptr<TaskIterator> iterator)
-    : iterator_(std::move(iterator)), buffer_(/*buffer_size=*/1) {
-  RunPrefetchThread();
+    : FirstComeFirstServedTaskRunner(SingleIterator(std::move(iterator))) {}
+
+FirstComeFirstServedTaskRunner::FirstComeFirstServedTaskRunner(
+    std::vector<std::unique_ptr<TaskIterator>> iterators)
+    : iterators_(std::move(iterators)),
+      num_active_replicas_(iterators_.size()),
+      // Each replica may have one element ready ahead of the consumers.
+      buffer_(/*buffer_size=*/iterators_.size()) {
+  if (iterators_.size() > 1) {
+    VLOG(1) << "Producing the task's elements with " << iterators_.size()
+            << " iterator replicas";
+  }
+  RunPrefetchThreads();
 }
 
 FirstComeFirstServedTaskRunner::~FirstComeFirstServedTaskRunner() { Cancel(); }
@@ -91,36 +162,50 @@ Status FirstComeFirstServedTaskRunner::GetNext(const GetElementRequest& req,
   return Status::OK();
 }
 
-Status FirstComeFirstServedTaskRunner::PrefetchFn() {
+Status FirstComeFirstServedTaskRunner::PrefetchFn(int64_t replica) {
+  bool end_of_input = false;
   while (true) {
-    TF_RETURN_IF_ERROR(buffer_.Push(GetNextFromInputIterator()));
+    StatusOr<GetElementResult> result = GetNextFromInputIterator(replica);
+    if (!end_of_input && result.ok() && result->end_of_sequence) {
+      end_of_input = true;
+      mutex_lock l(mu_);
+      // The task ends once the last replica ends. Until then, consumers are
+      // served by the remaining replicas.
+      if (--num_active_replicas_ > 0) {
+        return Status::OK();
+      }
+    }
+    TF_RETURN_IF_ERROR(buffer_.Push(std::move(result)));
   }
   return Status::OK();
 }
 
-void FirstComeFirstServedTaskRunner::RunPrefetchThread() {
-  auto prefetch_fn = [this] {
-    Status status = PrefetchFn();
-    if (!status.ok()) {
-      buffer_.Cancel(status);
-    }
-  };
-  prefetch_thread_ = absl::WrapUnique(Env::Default()->StartThread(
-      /*thread_options=*/{}, /*name=*/"tf_data_service_fcfs_prefetch_thread",
-      prefetch_fn));
+void FirstComeFirstServedTaskRunner::RunPrefetchThreads() {
+  for (int64_t replica = 0; replica < iterators_.size(); ++replica) {
+    auto prefetch_fn = [this, replica] {
+      Status status = PrefetchFn(replica);
+      if (!status.ok()) {
+        buffer_.Cancel(status);
+      }
+    };
+    prefetch_threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        /*thread_options=*/{}, /*name=*/"tf_data_service_fcfs_prefetch_thread",
+        prefetch_fn)));
+  }
 }
 
 StatusOr<GetElementResult>
-FirstComeFirstServedTaskRunner::GetNextFromInputIterator()
+FirstComeFirstServedTaskRunner::GetNextFromInputIterator(int64_t replica)
     TF_LOCKS_EXCLUDED(mu_) {
   GetElementResult result;
   std::vector<Tensor> element;
   bool end_of_task;
   result.skip = false;
+  // Replicas produce elements concurrently; only the element index is shared.
+  TF_RETURN_IF_ERROR(iterators_[replica]->GetNext(element, end_of_task));
+  result.end_of_sequence = end_of_task;
   {
     mutex_lock l(mu_);
-    TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_task));
-    result.end_of_sequence = end_of_task;
     result.element_index = element_index_++;
   }
   if (!end_of_task) {
@@ -134,6 +219,98 @@ void FirstComeFirstServedTaskRunner::Cancel() {
   buffer_.Cancel(errors::Cancelled("tf.data service FCFS task is cancelled."));
 }
 
+CompressingTaskRunner::CompressingTaskRunner(
+    std::unique_ptr<TaskRunner> runner, const TaskDef& task_def,
+    int64_t num_threads, int64_t chunk_size_bytes)
+    : runner_(std::move(runner)),
+      pipelined_(task_def.optional_num_consumers_case() !=
+                 TaskDef::kNumConsumers),
+      chunk_size_bytes_(chunk_size_bytes),
+      buffer_(/*buffer_size=*/std::max<int64_t>(num_threads, 1)) {
+  if (!pipelined_) {
+    return;
+  }
+  for (int64_t i = 0; i < std::max<int64_t>(num_threads, 1); ++i) {
+    compression_threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        /*thread_options=*/{}, /*name=*/"tf_data_service_compression_thread",
+        [this] {
+          Status status = CompressionFn();
+          if (!status.ok()) {
+            buffer_.Cancel(status);
+          }
+        })));
+  }
+}
+
+CompressingTaskRunner::~CompressingTaskRunner() { Cancel(); }
+
+Status CompressingTaskRunner::GetNext(const GetElementRequest& req,
+                                      GetElementResult& result) {
+  if (!pipelined_) {
+    return GetNextCompressed(req, result);
+  }
+  TF_ASSIGN_OR_RETURN(result, buffer_.Pop());
+  return Status::OK();
+}
+
+void CompressingTaskRunner::Cancel() {
+  buffer_.Cancel(errors::Cancelled("tf.data service task is cancelled."));
+  runner_->Cancel();
+}
+
+Status CompressingTaskRunner::GetNextCompressed(const GetElementRequest& req,
+                                                GetElementResult& result) {
+  TF_RETURN_IF_ERROR(runner_->GetNext(req, result));
+  return Compress(result);
+}
+
+Status CompressingTaskRunner::Compress(GetElementResult& result) {
+  if (result.end_of_sequence || result.skip) {
+    return Status::OK();
+  }
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(
+      CompressElement(result.components, chunk_size_bytes_, &compressed));
+  Tensor tensor(DT_VARIANT, TensorShape({}));
+  tensor.scalar<Variant>()() = std::move(compressed);
+  result.components.clear();
+  result.components.push_back(std::move(tensor));
+  return Status::OK();
+}
+
+Status CompressingTaskRunner::CompressionFn() {
+  while (true) {
+    GetElementResult result;
+    Status s;
+    int64_t sequence_number;
+    {
+      mutex_lock l(input_mu_);
+      s = runner_->GetNext(GetElementRequest(), result);
+      sequence_number = next_input_sequence_number_++;
+    }
+    if (s.ok()) {
+      s = Compress(result);
+    }
+    mutex_lock l(mu_);
+    if (s.ok()) {
+      reorder_buffer_.emplace(sequence_number, std::move(result));
+    } else {
+      reorder_buffer_.emplace(sequence_number, s);
+    }
+    // Elements leave in the order they were read, so `end_of_sequence` is
+    // only sent after all elements before it.
+    while (!reorder_buffer_.empty() &&
+           reorder_buffer_.begin()->first == next_output_sequence_number_) {
+      StatusOr<GetElementResult> next =
+          std::move(reorder_buffer_.begin()->second);
+      reorder_buffer_.erase(reorder_buffer_.begin());
+      ++next_output_sequence_number_;
+      TF_RETURN_IF_ERROR(buffer_.Push(std::move(next)));
+    }
+  }
+  return Status::OK();
+}
+
 RoundRobinTaskRunner::RoundRobinTaskRunner(
     std::unique_ptr<TaskIterator> iterator, int64_t num_consumers,
     string worker_address)
@@ -146,17 +323,7 @@ RoundRobinTaskRunner::RoundRobinTaskRunner(
 }
 
 Status RoundRobinTaskRunner::ValidateRequest(const GetElementRequest& req) {
-  if (req.consumer_index() < 0 || req.round_index() < 0) {
-    return errors::FailedPrecondition(
-        "RoundRobinTaskRunner needs to know the consumer index and element "
-        "index of each request.");
-  }
-  if (req.consumer_index() >= num_consumers_) {
-    return errors::FailedPrecondition(
-        "Requesting data for consumer index ", req.consumer_index(),
-        ", but the task is configured for only ", num_consumers_, " consumers");
-  }
-  return Status::OK();
+  return ValidateRoundRobinRequest(req, num_consumers_);
 }
 
 Status RoundRobinTaskRunner::PrepareFullRound(int64_t wait_us)
@@ -244,10 +411,7 @@ Status RoundRobinTaskRunner::GetNext(const GetElementRequest& req,
   }
   auto& buffer_result = buffer_[req.consumer_index()];
   result.element_index = buffer_result->index;
-  std::vector<Tensor> element;
-  for (auto& component : buffer_result->components) {
-    element.push_back(tensor::DeepCopy(component));
-  }
+  std::vector<Tensor> element = CopyComponents(*buffer_result);
   if (VLOG_IS_ON(2)) {
     int64_t size = 0;
     for (auto& component : element) {
@@ -267,9 +431,167 @@ void RoundRobinTaskRunner::Cancel() {
   new_round_cv_.notify_all();
 }
 
+StreamingRoundRobinTaskRunner::StreamingRoundRobinTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, int64_t num_consumers,
+    int64_t max_skew_rounds, string worker_address)
+    : num_consumers_(num_consumers),
+      max_skew_rounds_(max_skew_rounds),
+      worker_address_(worker_address),
+      prefetch_thread_(std::move(iterator), num_consumers_,
+                       /*buffer_rounds=*/max_skew_rounds_ + 1) {
+  VLOG(1) << "Creating task runner for streaming data round-robin to "
+          << num_consumers << " consumers with a maximum skew of "
+          << max_skew_rounds << " rounds";
+}
+
+Status StreamingRoundRobinTaskRunner::GetNext(const GetElementRequest& req,
+                                              GetElementResult& result) {
+  TF_RETURN_IF_ERROR(ValidateRoundRobinRequest(req, num_consumers_));
+  result.end_of_sequence = false;
+  VLOG(2) << worker_address_ << ": Received request from consumer index "
+          << req.consumer_index() << " for round " << req.round_index();
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<const Round> round, GetRound(req));
+  result.skip = round->empty();
+  if (result.skip) {
+    VLOG(1) << worker_address_ << ": Buffer not ready, skipping round "
+            << req.round_index() << " for consumer " << req.consumer_index();
+    return Status::OK();
+  }
+  // Prepared rounds are immutable, so the element can be copied without
+  // holding `mu_`.
+  const Element& element = *(*round)[req.consumer_index()];
+  result.element_index = element.index;
+  result.components = CopyComponents(element);
+  VLOG(2) << worker_address_ << ": Returning element " << result.element_index
+          << " to consumer " << req.consumer_index() << " for round "
+          << req.round_index();
+  return Status::OK();
+}
+
+void StreamingRoundRobinTaskRunner::Cancel() {
+  mutex_lock l(mu_);
+  cancelled_ = true;
+  cv_.notify_all();
+}
+
+Status StreamingRoundRobinTaskRunner::WaitForTurn(const GetElementRequest& req,
+                                                  mutex_lock& l)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t round = req.round_index();
+  auto it = consumer_rounds_.find(req.consumer_index());
+  if (it == consumer_rounds_.end()) {
+    consumer_rounds_[req.consumer_index()] = round;
+    if (req.skipped_previous_round()) {
+      rounds_after_skip_.insert(round);
+    }
+    MaybeStart();
+    cv_.notify_all();
+  } else if (round > it->second) {
+    it->second = round;
+    EvictRounds();
+    cv_.notify_all();
+  }
+  while (!cancelled_ &&
+         (!started_ || round > MinConsumerRound() + max_skew_rounds_)) {
+    TF_RETURN_IF_ERROR(prefetch_thread_.GetStatus());
+    cv_.wait(l);
+  }
+  if (cancelled_) {
+    return errors::Cancelled("Worker is shutting down.");
+  }
+  if (round < first_round_) {
+    return errors::FailedPrecondition(
+        "Consumer ", req.consumer_index(), " requested data for round ",
+        round, ", but all consumers have already moved past round ",
+        first_round_ - 1,
+        ". This may indicate that the consumer was restarted with the same job "
+        "name.");
+  }
+  return Status::OK();
+}
+
+void StreamingRoundRobinTaskRunner::MaybeStart()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (started_ || consumer_rounds_.size() < num_consumers_) {
+    return;
+  }
+  started_ = true;
+  first_round_ = MinConsumerRound();
+  VLOG(1) << worker_address_ << ": Starting round-robin reads at round "
+          << first_round_;
+  // Consumers which skipped the first round before the worker restarted must
+  // not see it now, so no consumer gets it.
+  if (rounds_after_skip_.contains(first_round_ + 1)) {
+    VLOG(1) << worker_address_ << ": Skipping round " << first_round_;
+    rounds_.push_back(std::make_shared<const Round>());
+  }
+  rounds_after_skip_.clear();
+}
+
+int64_t StreamingRoundRobinTaskRunner::MinConsumerRound() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64_t min_round = kint64max;
+  for (const auto& consumer_round : consumer_rounds_) {
+    min_round = std::min(min_round, consumer_round.second);
+  }
+  return min_round;
+}
+
+void StreamingRoundRobinTaskRunner::EvictRounds()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!started_) {
+    return;
+  }
+  const int64_t min_round = MinConsumerRound();
+  while (!rounds_.empty() && first_round_ < min_round) {
+    rounds_.pop_front();
+    ++first_round_;
+  }
+}
+
+StatusOr<std::shared_ptr<const StreamingRoundRobinTaskRunner::Round>>
+StreamingRoundRobinTaskRunner::GetRound(const GetElementRequest& req)
+    TF_LOCKS_EXCLUDED(mu_) {
+  const int64_t round = req.round_index();
+  while (true) {
+    int64_t wait_us = -1;
+    {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(WaitForTurn(req, l));
+      const int64_t next_round = first_round_ + rounds_.size();
+      if (round < next_round) {
+        return rounds_[round - first_round_];
+      }
+      if (preparing_) {
+        cv_.wait(l);
+        continue;
+      }
+      preparing_ = true;
+      // Only the requested round may be skipped. The rounds before it have
+      // already been requested by this consumer, so other consumers may have
+      // started waiting for them.
+      if (req.allow_skip() && round == next_round) {
+        wait_us = kWaitBeforeSkipUs;
+      }
+    }
+    // Prepare the round without holding `mu_`, so that consumers reading
+    // rounds which are already prepared are not blocked.
+    Round buffer;
+    Status s = prefetch_thread_.FillBuffer(wait_us, buffer);
+    mutex_lock l(mu_);
+    preparing_ = false;
+    cv_.notify_all();
+    TF_RETURN_IF_ERROR(s);
+    rounds_.push_back(std::make_shared<const Round>(std::move(buffer)));
+    EvictRounds();
+  }
+}
+
 PrefetchThread::PrefetchThread(std::unique_ptr<TaskIterator> iterator,
-                               int64_t round_size)
-    : iterator_(std::move(iterator)), round_size_(round_size) {
+                               int64_t round_size, int64_t buffer_rounds)
+    : iterator_(std::move(iterator)),
+      round_size_(round_size),
+      buffer_rounds_(buffer_rounds) {
   thread_ = absl::WrapUnique(
       Env::Default()->StartThread({}, "round-robin-prefetch", [&] { Run(); }));
 }
@@ -284,7 +606,7 @@ void PrefetchThread::Run() {
   while (true) {
     {
       mutex_lock l(mu_);
-      while (!cancelled_ && buffer_.size() >= round_size_) {
+      while (!cancelled_ && buffer_.size() >= round_size_ * buffer_rounds_) {
         cv_.wait(l);
       }
       if (cancelled_) {
@@ -336,10 +658,10 @@ Status PrefetchThread::FillBuffer(int64_t wait_us,
     DCHECK_GE(wait_us, 0);
     return Status::OK();
   }
-  for (auto& elem : buffer_) {
-    out.push_back(std::move(elem));
+  for (int64_t i = 0; i < round_size_; ++i) {
+    out.push_back(std::move(buffer_.front()));
+    buffer_.pop_front();
   }
-  buffer_.clear();
   cv_.notify_all();
   return Status::OK();
 }
@@ -15,9 +15,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
+#include <deque>
+#include <map>
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
@@ -70,6 +74,14 @@ class TaskRunner {
                        const TaskDef& task_def,
                        std::unique_ptr<TaskIterator> iterator,
                        std::unique_ptr<TaskRunner>& out);
+  // Creates a `TaskRunner` which produces the elements of the task from
+  // several iterator replicas in parallel, and stores it in `out`. The
+  // replicas must produce disjoint parts of the task's elements. Only
+  // first-come first-served reads support more than one replica.
+  static Status Create(const experimental::WorkerConfig& worker_config,
+                       const TaskDef& task_def,
+                       std::vector<std::unique_ptr<TaskIterator>> iterators,
+                       std::unique_ptr<TaskRunner>& out);
   virtual ~TaskRunner() = default;
   // Gets the next element for the given request.
   virtual Status GetNext(const GetElementRequest& req,
@@ -80,10 +92,18 @@ class TaskRunner {
 
 // A task runner which provides elements on a first-come first-served basis.
 // It does not consider which consumer is making the request.
+//
+// The runner may be given several iterator replicas, each producing a
+// disjoint part of the task, e.g. by reading different splits from the
+// dispatcher. Each replica is prefetched by its own thread, so that pipelines
+// which do not end in a parallel transformation still use multiple cores. The
+// task reaches its end once all replicas are exhausted.
 class FirstComeFirstServedTaskRunner : public TaskRunner {
  public:
   explicit FirstComeFirstServedTaskRunner(
       std::unique_ptr<TaskIterator> iterator);
+  explicit FirstComeFirstServedTaskRunner(
+      std::vector<std::unique_ptr<TaskIterator>> iterators);
   ~FirstComeFirstServedTaskRunner() override;
 
   Status GetNext(const GetElementRequest& req,
@@ -91,26 +111,85 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   void Cancel() override;
 
  private:
-  // Function to continually prefetch the next element. Returns an error if the
-  // task has been cancelled.
-  Status PrefetchFn();
+  // Function to continually prefetch the next element of replica `replica`.
+  // Returns an error if the task has been cancelled.
+  Status PrefetchFn(int64_t replica);
 
-  // Runs `PrefetchFn` on a dedicated thread.
-  void RunPrefetchThread();
+  // Runs `PrefetchFn` on a dedicated thread for each replica.
+  void RunPrefetchThreads();
 
-  // Gets the next element from the input iterator.
-  StatusOr<GetElementResult> GetNextFromInputIterator() TF_LOCKS_EXCLUDED(mu_);
+  // Gets the next element from the iterator of replica `replica`.
+  StatusOr<GetElementResult> GetNextFromInputIterator(int64_t replica)
+      TF_LOCKS_EXCLUDED(mu_);
 
+  // Each iterator is only used by the prefetch thread of its replica.
+  const std::vector<std::unique_ptr<TaskIterator>> iterators_;
   mutex mu_;
-  std::unique_ptr<TaskIterator> iterator_ TF_GUARDED_BY(mu_);
   int64_t element_index_ TF_GUARDED_BY(mu_) = 0;
+  // Number of replicas which have not reached the end of their input.
+  int64_t num_active_replicas_ TF_GUARDED_BY(mu_);
 
   ThreadSafeBuffer<GetElementResult> buffer_;
-  std::unique_ptr<Thread> prefetch_thread_;
+  std::vector<std::unique_ptr<Thread>> prefetch_threads_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FirstComeFirstServedTaskRunner);
 };
 
+// A task runner which compresses the elements produced by another task runner
+// into `CompressedElement` variants, outside of the task's input pipeline.
+//
+// For first-come first-served reads, a pool of `num_threads` threads takes
+// elements from the wrapped runner, compresses them in parallel, and places
+// them in a buffer from which requests are served. For round-robin reads, each
+// request compresses its own element, since consumers must receive the
+// elements of their rounds. `end_of_sequence` is only produced once every
+// compression thread has reached the end, so that elements still being
+// compressed are not lost.
+//
+// Elements larger than `chunk_size_bytes` are compressed in independent
+// chunks, see `CompressElement`.
+class CompressingTaskRunner : public TaskRunner {
+ public:
+  CompressingTaskRunner(std::unique_ptr<TaskRunner> runner,
+                        const TaskDef& task_def, int64_t num_threads,
+                        int64_t chunk_size_bytes);
+  ~CompressingTaskRunner() override;
+
+  Status GetNext(const GetElementRequest& req,
+                 GetElementResult& result) override;
+  void Cancel() override;
+
+ private:
+  // Gets the next element of the wrapped runner and compresses it.
+  Status GetNextCompressed(const GetElementRequest& req,
+                           GetElementResult& result);
+  // Replaces the components of `result` with a single compressed element.
+  Status Compress(GetElementResult& result);
+  // Continually compresses elements into `buffer_`. Returns an error if the
+  // task has been cancelled.
+  Status CompressionFn();
+
+  const std::unique_ptr<TaskRunner> runner_;
+  const bool pipelined_;
+  const int64_t chunk_size_bytes_;
+  // Serializes reads from `runner_`, so that sequence numbers follow the order
+  // in which elements are produced.
+  mutex input_mu_;
+  int64_t next_input_sequence_number_ TF_GUARDED_BY(input_mu_) = 0;
+  mutex mu_;
+  // Compressed elements (or errors) which finished compressing before some
+  // earlier element, keyed by sequence number. Elements are moved to
+  // `buffer_` in sequence order.
+  std::map<int64_t, StatusOr<GetElementResult>> reorder_buffer_
+      TF_GUARDED_BY(mu_);
+  int64_t next_output_sequence_number_ TF_GUARDED_BY(mu_) = 0;
+  // Compressed elements ready to be sent, if `pipelined_`.
+  ThreadSafeBuffer<GetElementResult> buffer_;
+  std::vector<std::unique_ptr<Thread>> compression_threads_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CompressingTaskRunner);
+};
+
 // An element produced by a task.
 struct Element {
   explicit Element(std::vector<Tensor>&& components, int64_t index)
@@ -122,11 +201,12 @@ struct Element {
   int64_t index;
 };
 
-// Thread for prefetching a round worth of elements.
+// Thread for prefetching rounds of elements.
 class PrefetchThread {
  public:
+  // Prefetches up to `buffer_rounds` rounds of `round_size` elements each.
   explicit PrefetchThread(std::unique_ptr<TaskIterator> iterator,
-                          int64_t round_size);
+                          int64_t round_size, int64_t buffer_rounds = 1);
   ~PrefetchThread();
   // Runs the prefetch thread. It runs until an error is encountered or the
   // destructor is called.
@@ -142,14 +222,15 @@ class PrefetchThread {
  private:
   const std::unique_ptr<TaskIterator> iterator_;
   const int64_t round_size_;
+  const int64_t buffer_rounds_;
   mutex mu_;
   int64_t index_ TF_GUARDED_BY(mu_) = 0;
-  // Buffered results for the next round.
-  std::vector<std::unique_ptr<Element>> buffer_ TF_GUARDED_BY(mu_);
+  // Buffered results for the next rounds.
+  std::deque<std::unique_ptr<Element>> buffer_ TF_GUARDED_BY(mu_);
   // The status if the prefetch thread fails.
   Status status_ TF_GUARDED_BY(mu_) = Status::OK();
   // Thread which constantly tries to fill `buffer_` up with
-  // `num_consumers` elements.
+  // `buffer_rounds` rounds of elements.
   std::unique_ptr<Thread> thread_;
   // Condition variable notified when elements are added to or removed from
   // `buffer_`, or when `status_` is changed.
@@ -215,6 +296,74 @@ class RoundRobinTaskRunner : public TaskRunner {
   PrefetchThread prefetch_thread_;
 };
 
+// A task runner which provides the same round-robin order as
+// `RoundRobinTaskRunner` without serving rounds in lockstep. Rounds are
+// prepared ahead of time and kept until every consumer has moved past them,
+// so each consumer reads its element of a round as soon as it requests it.
+// Consumer `i` always receives the `i`th element of each round, regardless of
+// the order in which the requests arrive.
+//
+// A consumer may run at most `max_skew_rounds` rounds ahead of the slowest
+// consumer; requests beyond that block until the slowest consumer catches up.
+// This bounds the number of rounds held in memory to `max_skew_rounds + 1`.
+//
+// Like `RoundRobinTaskRunner`, the runner waits for a request from every
+// consumer before serving the first round, which is the minimum requested
+// round. Consumers which restarted one round ahead skip the first round.
+class StreamingRoundRobinTaskRunner : public TaskRunner {
+ public:
+  StreamingRoundRobinTaskRunner(std::unique_ptr<TaskIterator> iterator,
+                                int64_t num_consumers, int64_t max_skew_rounds,
+                                string worker_address);
+
+  Status GetNext(const GetElementRequest& req,
+                 GetElementResult& result) override;
+  void Cancel() override;
+
+ private:
+  // A prepared round, with one element per consumer. Empty if the round was
+  // skipped.
+  using Round = std::vector<std::unique_ptr<Element>>;
+
+  // Records that the consumer of `req` has reached its round, and waits until
+  // the round is within `max_skew_rounds_` of the slowest consumer.
+  Status WaitForTurn(const GetElementRequest& req, mutex_lock& l)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Starts serving once all consumers have sent their first request.
+  void MaybeStart() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the smallest round requested by any consumer.
+  int64_t MinConsumerRound() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Discards the rounds that all consumers have moved past.
+  void EvictRounds() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the prepared round requested by `req`, preparing it and any
+  // rounds before it if needed.
+  StatusOr<std::shared_ptr<const Round>> GetRound(const GetElementRequest& req)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  const int64_t num_consumers_;
+  const int64_t max_skew_rounds_;
+  const string worker_address_;
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Notified when a consumer advances, a round is prepared, or the runner is
+  // cancelled.
+  condition_variable cv_;
+  // The latest round requested by each consumer.
+  absl::flat_hash_map<int64_t, int64_t> consumer_rounds_ TF_GUARDED_BY(mu_);
+  // Rounds whose first request indicated the consumer skipped the previous
+  // round.
+  absl::flat_hash_set<int64_t> rounds_after_skip_ TF_GUARDED_BY(mu_);
+  bool started_ TF_GUARDED_BY(mu_) = false;
+  // Prepared rounds, starting with round `first_round_`. The next round to
+  // prepare is `first_round_ + rounds_.size()`.
+  std::deque<std::shared_ptr<const Round>> rounds_ TF_GUARDED_BY(mu_);
+  int64_t first_round_ TF_GUARDED_BY(mu_) = 0;
+  // Whether a request is preparing the next round.
+  bool preparing_ TF_GUARDED_BY(mu_) = false;
+  // Thread which prepares rounds ahead of the fastest consumer.
+  PrefetchThread prefetch_thread_;
+};
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -12,11 +12,13 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/task_runner.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -103,6 +105,62 @@ Status RunConsumer(int64_t consumer_index, int64_t start_index,
   }
   return Status::OK();
 }
+
+// Uncompresses the single-component element produced by a
+// `CompressingTaskRunner` and returns its value.
+int64_t UncompressValue(const GetElementResult& result) {
+  EXPECT_EQ(result.components.size(), 1);
+  const CompressedElement* compressed =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  EXPECT_NE(compressed, nullptr);
+  std::vector<Tensor> element;
+  TF_EXPECT_OK(UncompressElement(*compressed, &element));
+  return element[0].flat<int64_t>()(0);
+}
+
+// Runs `num_consumers` consumers in parallel, with consumer `i` reading rounds
+// `start_indices[i]` up to `end_index`. Stores the results in `output`.
+Status RunConsumersInParallel(int64_t num_consumers,
+                              const std::vector<int64_t>& start_indices,
+                              int64_t end_index, TaskRunner& task_runner,
+                              std::vector<std::vector<int64_t>>& output) {
+  output.assign(num_consumers, {});
+  std::vector<std::unique_ptr<Thread>> consumers;
+  mutex mu;
+  Status error;
+  for (int consumer = 0; consumer < num_consumers; ++consumer) {
+    consumers.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, absl::StrCat("consumer_", consumer), [&, consumer] {
+          std::vector<int64_t> results;
+          Status s = RunConsumer(consumer, start_indices[consumer], end_index,
+                                 task_runner, results);
+          mutex_lock l(mu);
+          if (!s.ok()) {
+            error = s;
+            return;
+          }
+          output[consumer] = std::move(results);
+        })));
+  }
+  // Wait for all consumers to finish.
+  consumers.clear();
+  mutex_lock l(mu);
+  return error;
+}
+
+// Requests the element of `round` for `consumer_index` and stores its value in
+// `value`.
+Status GetRoundElement(TaskRunner& task_runner, int64_t consumer_index,
+                       int64_t round, int64_t& value) {
+  GetElementRequest request;
+  request.set_round_index(round);
+  request.set_consumer_index(consumer_index);
+  request.set_allow_skip(false);
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(task_runner.GetNext(request, result));
+  value = result.components[0].flat<int64_t>()(0);
+  return Status::OK();
+}
 }  // namespace
 
 TEST(FirstComeFirstServedTaskRunnerTest, GetNext) {
@@ -180,6 +238,166 @@ TEST(FirstComeFirstServedTaskRunnerTest, Error) {
               testing::StatusIs(error::ABORTED));
 }
 
+TEST(FirstComeFirstServedTaskRunnerTest, ParallelReplicas) {
+  const int64_t num_replicas = 3;
+  const int64_t elements_per_replica = 20;
+  std::vector<std::unique_ptr<TaskIterator>> iterators;
+  std::vector<int64_t> expected;
+  for (int64_t replica = 0; replica < num_replicas; ++replica) {
+    std::vector<std::vector<Tensor>> elements;
+    for (int64_t i = 0; i < elements_per_replica; ++i) {
+      const int64_t value = replica * elements_per_replica + i;
+      elements.push_back({Tensor(value)});
+      expected.push_back(value);
+    }
+    iterators.push_back(
+        absl::make_unique<TestTaskIterator>(elements, /*repeat=*/false));
+  }
+  FirstComeFirstServedTaskRunner runner(std::move(iterators));
+  std::vector<int64_t> results;
+  for (int64_t i = 0; i < num_replicas * elements_per_replica; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+    ASSERT_FALSE(result.end_of_sequence);
+    results.push_back(result.components[0].flat<int64_t>()(0));
+  }
+  std::sort(results.begin(), results.end());
+  EXPECT_EQ(results, expected);
+  for (int i = 0; i < 3; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+    EXPECT_TRUE(result.end_of_sequence);
+  }
+}
+
+TEST(FirstComeFirstServedTaskRunnerTest, ReplicaError) {
+  std::vector<std::unique_ptr<TaskIterator>> iterators;
+  iterators.push_back(absl::make_unique<TestTaskIterator>(
+      std::vector<std::vector<Tensor>>(), /*repeat=*/false));
+  iterators.push_back(
+      absl::make_unique<TestErrorIterator>(errors::Aborted("Aborted")));
+  FirstComeFirstServedTaskRunner runner(std::move(iterators));
+  GetElementResult result;
+  EXPECT_THAT(runner.GetNext(GetElementRequest(), result),
+              testing::StatusIs(error::ABORTED));
+}
+
+TEST(TaskRunnerTest, RoundRobinRequiresSingleReplica) {
+  TaskDef task_def;
+  task_def.set_num_consumers(2);
+  std::vector<std::unique_ptr<TaskIterator>> iterators;
+  for (int i = 0; i < 2; ++i) {
+    iterators.push_back(absl::make_unique<TestTaskIterator>(
+        GetRangeDataset(10), /*repeat=*/true));
+  }
+  std::unique_ptr<TaskRunner> runner;
+  EXPECT_THAT(TaskRunner::Create(experimental::WorkerConfig(), task_def,
+                                 std::move(iterators), runner),
+              testing::StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(CompressingTaskRunnerTest, FirstComeFirstServed) {
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(20);
+  CompressingTaskRunner runner(
+      absl::make_unique<FirstComeFirstServedTaskRunner>(
+          absl::make_unique<TestTaskIterator>(elements, /*repeat=*/false)),
+      TaskDef(), /*num_threads=*/3, /*chunk_size_bytes=*/0);
+  std::vector<int64_t> results;
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+    ASSERT_FALSE(result.end_of_sequence);
+    results.push_back(UncompressValue(result));
+  }
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    EXPECT_EQ(results[i], i);
+  }
+  GetElementResult result;
+  TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
+TEST(CompressingTaskRunnerTest, EndOfSequenceAfterSlowCompression) {
+  // The last elements are large, so that their compression is still running
+  // when other compression threads reach the end of the task.
+  constexpr int64_t kNumElements = 12;
+  constexpr int64_t kNumLargeElements = 4;
+  constexpr int64_t kLargeElementSize = 1 << 20;
+  std::vector<std::vector<Tensor>> elements;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    const int64_t size =
+        i < kNumElements - kNumLargeElements ? 1 : kLargeElementSize;
+    Tensor tensor(DT_INT64, TensorShape({size}));
+    auto values = tensor.flat<int64_t>();
+    values(0) = i;
+    for (int64_t j = 1; j < size; ++j) {
+      values(j) = j * 2654435761;
+    }
+    elements.push_back({std::move(tensor)});
+  }
+  for (int trial = 0; trial < 10; ++trial) {
+    CompressingTaskRunner runner(
+        absl::make_unique<FirstComeFirstServedTaskRunner>(
+            absl::make_unique<TestTaskIterator>(elements, /*repeat=*/false)),
+        TaskDef(), /*num_threads=*/4, /*chunk_size_bytes=*/0);
+    std::vector<int64_t> results;
+    while (true) {
+      GetElementResult result;
+      TF_ASSERT_OK(runner.GetNext(GetElementRequest(), result));
+      if (result.end_of_sequence) {
+        break;
+      }
+      results.push_back(UncompressValue(result));
+    }
+    ASSERT_EQ(results.size(), kNumElements);
+    for (int64_t i = 0; i < kNumElements; ++i) {
+      EXPECT_EQ(results[i], i);
+    }
+  }
+}
+
+TEST(CompressingTaskRunnerTest, RoundRobin) {
+  TaskDef task_def;
+  task_def.set_num_consumers(2);
+  CompressingTaskRunner runner(
+      absl::make_unique<RoundRobinTaskRunner>(
+          absl::make_unique<TestTaskIterator>(GetRangeDataset(10),
+                                              /*repeat=*/true),
+          /*num_consumers=*/2, /*worker_address=*/"test_worker_address"),
+      task_def, /*num_threads=*/3, /*chunk_size_bytes=*/0);
+  std::vector<std::vector<int64_t>> per_consumer_results(2);
+  std::vector<std::unique_ptr<Thread>> consumers;
+  for (int64_t consumer = 0; consumer < 2; ++consumer) {
+    consumers.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, absl::StrCat("consumer_", consumer), [&, consumer] {
+          for (int64_t round = 0; round < 3; ++round) {
+            GetElementRequest request;
+            request.set_round_index(round);
+            request.set_consumer_index(consumer);
+            request.set_allow_skip(false);
+            GetElementResult result;
+            TF_EXPECT_OK(runner.GetNext(request, result));
+            per_consumer_results[consumer].push_back(UncompressValue(result));
+          }
+        })));
+  }
+  consumers.clear();
+  EXPECT_EQ(per_consumer_results,
+            (std::vector<std::vector<int64_t>>{{0, 2, 4}, {1, 3, 5}}));
+}
+
+TEST(CompressingTaskRunnerTest, Cancel) {
+  CompressingTaskRunner runner(
+      absl::make_unique<FirstComeFirstServedTaskRunner>(
+          absl::make_unique<TestTaskIterator>(GetRangeDataset(10),
+                                              /*repeat=*/true)),
+      TaskDef(), /*num_threads=*/2, /*chunk_size_bytes=*/0);
+  runner.Cancel();
+  GetElementResult result;
+  EXPECT_THAT(runner.GetNext(GetElementRequest(), result),
+              testing::StatusIs(error::CANCELLED));
+}
+
 class ConsumeParallelTest
     : public ::testing::Test,
       public ::testing::WithParamInterface<std::tuple<int64_t, int64_t>> {};
@@ -271,5 +489,152 @@ TEST(RoundRobinTaskRunner, ConsumeParallelPartialRound) {
               expected_consumer_results[consumer]);
   }
 }
+
+class StreamingConsumeParallelTest
+    : public ::testing::Test,
+      public ::testing::WithParamInterface<
+          std::tuple<int64_t, int64_t, int64_t>> {};
+
+TEST_P(StreamingConsumeParallelTest, ConsumeParallel) {
+  int64_t num_elements = std::get<0>(GetParam());
+  int64_t num_consumers = std::get<1>(GetParam());
+  int64_t max_skew_rounds = std::get<2>(GetParam());
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(num_elements);
+  StreamingRoundRobinTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/true),
+      num_consumers, max_skew_rounds,
+      /*worker_address=*/"test_worker_address");
+  std::vector<std::vector<int64_t>> per_consumer_results;
+  TF_ASSERT_OK(RunConsumersInParallel(
+      num_consumers, std::vector<int64_t>(num_consumers, 0),
+      /*end_index=*/num_elements, runner, per_consumer_results));
+  for (int i = 0; i < num_elements; ++i) {
+    int consumer = i % num_consumers;
+    int round = i / num_consumers;
+    EXPECT_EQ(per_consumer_results[consumer][round], i);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    StreamingConsumeParallelTests, StreamingConsumeParallelTest,
+    // tuples represent <num_elements, num_consumers, max_skew_rounds>
+    ::testing::Values(std::make_tuple(1000, 5, 0),
+                      std::make_tuple(1000, 5, 4),
+                      std::make_tuple(1003, 5, 16),
+                      std::make_tuple(1000, 20, 2),
+                      std::make_tuple(4, 20, 2), std::make_tuple(0, 20, 2)));
+
+TEST(StreamingRoundRobinTaskRunner, ConsumeParallelPartialRound) {
+  int64_t num_consumers = 5;
+  std::vector<int64_t> starting_rounds = {12, 11, 11, 12, 12};
+  std::vector<std::vector<int64_t>> expected_consumer_results = {
+      {5, 10, 15}, {1, 6, 11, 16}, {2, 7, 12, 17}, {8, 13, 18}, {9, 14, 19}};
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(30);
+  StreamingRoundRobinTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/true),
+      num_consumers, /*max_skew_rounds=*/2,
+      /*worker_address=*/"test_worker_address");
+  std::vector<std::vector<int64_t>> per_consumer_results;
+  TF_ASSERT_OK(RunConsumersInParallel(num_consumers, starting_rounds,
+                                      /*end_index=*/15, runner,
+                                      per_consumer_results));
+  EXPECT_EQ(per_consumer_results, expected_consumer_results);
+}
+
+TEST(StreamingRoundRobinTaskRunner, BoundedSkew) {
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(100);
+  StreamingRoundRobinTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/true),
+      /*num_consumers=*/2, /*max_skew_rounds=*/2,
+      /*worker_address=*/"test_worker_address");
+  // The runner starts serving once both consumers have sent a request.
+  std::vector<std::vector<int64_t>> first_round_results;
+  TF_ASSERT_OK(RunConsumersInParallel(/*num_consumers=*/2, {0, 0},
+                                      /*end_index=*/1, runner,
+                                      first_round_results));
+  EXPECT_EQ(first_round_results,
+            (std::vector<std::vector<int64_t>>{{0}, {1}}));
+  // Consumer 0 may run ahead of consumer 1 by up to two rounds.
+  int64_t value;
+  for (int64_t round = 1; round <= 2; ++round) {
+    TF_ASSERT_OK(GetRoundElement(runner, /*consumer_index=*/0, round, value));
+    EXPECT_EQ(value, 2 * round);
+  }
+
+  mutex mu;
+  bool done = false;
+  int64_t blocked_value = -1;
+  Status blocked_status;
+  std::unique_ptr<Thread> consumer(Env::Default()->StartThread(
+      {}, "consumer_0", [&] {
+        int64_t v;
+        Status s =
+            GetRoundElement(runner, /*consumer_index=*/0, /*round=*/3, v);
+        mutex_lock l(mu);
+        blocked_status = s;
+        blocked_value = v;
+        done = true;
+      }));
+  Env::Default()->SleepForMicroseconds(100 * 1000);
+  {
+    mutex_lock l(mu);
+    EXPECT_FALSE(done);
+  }
+  TF_ASSERT_OK(GetRoundElement(runner, /*consumer_index=*/1, /*round=*/1,
+                               value));
+  EXPECT_EQ(value, 3);
+  consumer.reset();
+  mutex_lock l(mu);
+  TF_ASSERT_OK(blocked_status);
+  EXPECT_EQ(blocked_value, 6);
+}
+
+TEST(StreamingRoundRobinTaskRunner, RequestEvictedRound) {
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(100);
+  StreamingRoundRobinTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/true),
+      /*num_consumers=*/2, /*max_skew_rounds=*/2,
+      /*worker_address=*/"test_worker_address");
+  std::vector<std::vector<int64_t>> first_round_results;
+  TF_ASSERT_OK(RunConsumersInParallel(/*num_consumers=*/2, {0, 0},
+                                      /*end_index=*/1, runner,
+                                      first_round_results));
+  int64_t value;
+  for (int64_t consumer = 0; consumer < 2; ++consumer) {
+    TF_ASSERT_OK(GetRoundElement(runner, consumer, /*round=*/1, value));
+    EXPECT_EQ(value, 2 + consumer);
+  }
+  // Both consumers have moved past round 0.
+  EXPECT_THAT(GetRoundElement(runner, /*consumer_index=*/0, /*round=*/0, value),
+              testing::StatusIs(error::FAILED_PRECONDITION));
+  // The current round can still be re-requested.
+  TF_ASSERT_OK(GetRoundElement(runner, /*consumer_index=*/0, /*round=*/1,
+                               value));
+  EXPECT_EQ(value, 2);
+}
+
+TEST(StreamingRoundRobinTaskRunner, Cancel) {
+  std::vector<std::vector<Tensor>> elements = GetRangeDataset(10);
+  StreamingRoundRobinTaskRunner runner(
+      absl::make_unique<TestTaskIterator>(elements, /*repeat=*/true),
+      /*num_consumers=*/2, /*max_skew_rounds=*/2,
+      /*worker_address=*/"test_worker_address");
+  runner.Cancel();
+  // Consumer 1 never requests data, so the request would block forever if the
+  // runner were not cancelled.
+  int64_t value;
+  EXPECT_THAT(GetRoundElement(runner, /*consumer_index=*/0, /*round=*/0, value),
+              testing::StatusIs(error::CANCELLED));
+}
+
+TEST(StreamingRoundRobinTaskRunner, Error) {
+  StreamingRoundRobinTaskRunner runner(
+      absl::make_unique<TestErrorIterator>(errors::Aborted("Aborted")),
+      /*num_consumers=*/1, /*max_skew_rounds=*/2,
+      /*worker_address=*/"test_worker_address");
+  int64_t value;
+  EXPECT_THAT(GetRoundElement(runner, /*consumer_index=*/0, /*round=*/0, value),
+              testing::StatusIs(error::ABORTED));
+}
 }  // namespace data
 }  // namespace tensorflow
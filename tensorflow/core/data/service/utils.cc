@@ -15,15 +15,60 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/utils.h"
 
+#include <array>
+#include <functional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+constexpr std::array<const char*, 8> kNodeNameSharingOps = {
+    "HashTable",
+    "HashTableV2",
+    "MutableHashTable",
+    "MutableHashTableV2",
+    "MutableDenseHashTable",
+    "MutableDenseHashTableV2",
+    "MutableHashTableOfTensors",
+    "MutableHashTableOfTensorsV2",
+};
+
+constexpr char kConstOp[] = "Const";
+constexpr char kValueAttr[] = "value";
+
+// Calls `fn` on every node of the graph and of its function library, stopping
+// at the first error. `fn` is told whether the node is in a function body.
+Status ForEachNode(DatasetDef& dataset,
+                   const std::function<Status(NodeDef&, bool)>& fn) {
+  GraphDef* graph = dataset.mutable_graph();
+  for (NodeDef& node : *graph->mutable_node()) {
+    TF_RETURN_IF_ERROR(fn(node, /*in_function=*/false));
+  }
+  for (FunctionDef& function : *graph->mutable_library()->mutable_function()) {
+    for (NodeDef& node : *function.mutable_node_def()) {
+      TF_RETURN_IF_ERROR(fn(node, /*in_function=*/true));
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
 
 Status WriteDatasetDef(const std::string& path, const DatasetDef& dataset_def) {
   std::unique_ptr<WritableFile> file;
@@ -50,5 +95,109 @@ Status ReadDatasetDef(const std::string& path, DatasetDef& dataset_def) {
   return Status::OK();
 }
 
+void PrepareDatasetGraph(GraphDef& graph) {
+  for (NodeDef& node : *graph.mutable_node()) {
+    for (const auto& op : kNodeNameSharingOps) {
+      // Set `use_node_name_sharing` to `true` so that resources aren't deleted
+      // prematurely. Otherwise, resources may be deleted when their ops are
+      // deleted at the end of the GraphRunner::Run used by standalone::Dataset.
+      if (node.op() == op) {
+        (*node.mutable_attr())["use_node_name_sharing"].set_b(true);
+      }
+      if (!node.device().empty()) {
+        *node.mutable_device() = "";
+      }
+    }
+  }
+  StripDevicePlacement(graph.mutable_library());
+}
+
+Status FingerprintDatasetGraph(const GraphDef& graph, uint64& fingerprint) {
+  return HashGraph(graph, &fingerprint);
+}
+
+uint64 FingerprintDatasetDef(const DatasetDef& dataset_def,
+                             uint64 graph_fingerprint) {
+  if (!dataset_def.compress_elements()) {
+    return graph_fingerprint;
+  }
+  return FingerprintCat64(graph_fingerprint,
+                          Fingerprint64("compress_elements"));
+}
+
+std::string LargeConstantKey(const std::string& serialized_constant) {
+  const Fprint128 fingerprint = Fingerprint128(serialized_constant);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+Status ExtractLargeConstants(
+    DatasetDef& dataset,
+    const std::function<Status(const std::string& key,
+                               const std::string& serialized_constant)>&
+        put_constant) {
+  return ForEachNode(dataset, [&](NodeDef& node, bool in_function) -> Status {
+    if (node.op() != kConstOp) {
+      return Status::OK();
+    }
+    auto it = node.mutable_attr()->find(kValueAttr);
+    if (it == node.mutable_attr()->end() || !it->second.has_tensor() ||
+        it->second.tensor().ByteSizeLong() < kMinLargeConstantBytes) {
+      return Status::OK();
+    }
+    TensorProto* constant = it->second.mutable_tensor();
+    std::string serialized;
+    if (!SerializeToStringDeterministic(*constant, &serialized)) {
+      return errors::Internal("Failed to serialize constant of node ",
+                              node.name());
+    }
+    const std::string key = LargeConstantKey(serialized);
+    TF_RETURN_IF_ERROR(put_constant(key, serialized));
+    TensorProto placeholder;
+    placeholder.set_dtype(constant->dtype());
+    *placeholder.mutable_tensor_shape() = constant->tensor_shape();
+    *constant = std::move(placeholder);
+    (*node.mutable_attr())[kLargeConstantKeyAttr].set_s(key);
+    return Status::OK();
+  });
+}
+
+Status ForEachLargeConstantReference(
+    DatasetDef& dataset,
+    const std::function<Status(const std::string& key, NodeDef& node,
+                               bool in_function)>& fn) {
+  return ForEachNode(dataset, [&](NodeDef& node, bool in_function) -> Status {
+    auto it = node.attr().find(kLargeConstantKeyAttr);
+    if (it == node.attr().end()) {
+      return Status::OK();
+    }
+    return fn(it->second.s(), node, in_function);
+  });
+}
+
+Status InlineLargeConstants(
+    DatasetDef& dataset,
+    const std::function<Status(const std::string& key, TensorProto& constant)>&
+        get_constant) {
+  return ForEachLargeConstantReference(
+      dataset,
+      [&](const std::string& key, NodeDef& node, bool in_function) -> Status {
+        // `key` refers to the attribute value, so copy it before erasing it.
+        const std::string constant_key = key;
+        node.mutable_attr()->erase(kLargeConstantKeyAttr);
+        return get_constant(
+            constant_key, *(*node.mutable_attr())[kValueAttr].mutable_tensor());
+      });
+}
+
+TaskDef SubShardTaskDef(const TaskDef& task_def, int64_t num_replicas,
+                        int64_t replica) {
+  TaskDef sub_shard_task_def = task_def;
+  sub_shard_task_def.set_num_workers(task_def.num_workers() * num_replicas);
+  sub_shard_task_def.set_worker_index(task_def.worker_index() * num_replicas +
+                                      replica);
+  return sub_shard_task_def;
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -15,7 +15,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_UTILS_H_
 
+#include <functional>
+#include <string>
+
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -32,6 +38,64 @@ Status WriteDatasetDef(const std::string& path, const DatasetDef& dataset_def);
 // `dataset_def`. Returns NOT_FOUND if the path cannot be found.
 Status ReadDatasetDef(const std::string& path, DatasetDef& dataset_def);
 
+// Prepares a dataset graph for registration with the dispatcher: strips device
+// placement and enables node name sharing for lookup table ops.
+void PrepareDatasetGraph(GraphDef& graph);
+
+// Computes the fingerprint the dispatcher uses to identify a registered
+// dataset. `graph` must have been prepared with `PrepareDatasetGraph`.
+Status FingerprintDatasetGraph(const GraphDef& graph, uint64& fingerprint);
+
+// Returns the fingerprint of `dataset_def` given the fingerprint of its graph.
+// Datasets with the same graph but different settings, e.g. worker-side
+// compression, have different fingerprints.
+uint64 FingerprintDatasetDef(const DatasetDef& dataset_def,
+                             uint64 graph_fingerprint);
+
+// Constant tensors whose serialized size is at least this many bytes are
+// stored outside of the dataset graph, keyed by the hash of their content.
+constexpr int64_t kMinLargeConstantBytes = 1 << 20;  // 1 MiB.
+
+// Attribute of a `Const` node whose value was moved out of the dataset graph.
+// Holds the content hash of the constant. The node keeps a `value` with the
+// dtype and shape of the constant, but without its content.
+constexpr char kLargeConstantKeyAttr[] = "_dataset_store_constant_key";
+
+// Returns the content hash used as the key of a large constant, given the
+// deterministically serialized `TensorProto` of the constant.
+std::string LargeConstantKey(const std::string& serialized_constant);
+
+// Replaces the values of large constants in `dataset` with references to their
+// content hashes, and calls `put_constant` with the deterministically
+// serialized `TensorProto` of each of them.
+Status ExtractLargeConstants(
+    DatasetDef& dataset,
+    const std::function<Status(const std::string& key,
+                               const std::string& serialized_constant)>&
+        put_constant);
+
+// Calls `fn` on every node of `dataset` which references a large constant, with
+// the content hash of the constant and whether the node is in the body of a
+// library function.
+Status ForEachLargeConstantReference(
+    DatasetDef& dataset,
+    const std::function<Status(const std::string& key, NodeDef& node,
+                               bool in_function)>& fn);
+
+// Reverses `ExtractLargeConstants`, fetching the referenced constants with
+// `get_constant`.
+Status InlineLargeConstants(
+    DatasetDef& dataset,
+    const std::function<Status(const std::string& key, TensorProto& constant)>&
+        get_constant);
+
+// Returns the task def of replica `replica` of `num_replicas` iterator replicas
+// of a statically sharded task. The replica processes a sub-shard of the
+// worker's shard, so that the replicas of all workers partition the dataset
+// provided that every worker runs `num_replicas` replicas.
+TaskDef SubShardTaskDef(const TaskDef& task_def, int64_t num_replicas,
+                        int64_t replica);
+
 }  // namespace data
 }  // namespace tensorflow
 
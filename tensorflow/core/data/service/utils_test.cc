@@ -14,8 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/utils.h"
 
+#include <set>
+
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
@@ -34,7 +38,7 @@ DatasetDef DatasetDefWithVersion(int32_t version) {
 }  // namespace
 
 TEST(Utils, ReadWriteDataset) {
-  std::string filename = testing::TmpDir();
+  std::string filename = tensorflow::testing::TmpDir();
   ASSERT_TRUE(Env::Default()->CreateUniqueFileName(&filename, "journal_dir"));
   int32_t version = 3;
   DatasetDef def = DatasetDefWithVersion(version);
@@ -45,7 +49,7 @@ TEST(Utils, ReadWriteDataset) {
 }
 
 TEST(Utils, OverwriteDataset) {
-  std::string filename = testing::TmpDir();
+  std::string filename = tensorflow::testing::TmpDir();
   ASSERT_TRUE(Env::Default()->CreateUniqueFileName(&filename, "journal_dir"));
   int32_t version_1 = 1;
   int32_t version_2 = 2;
@@ -59,12 +63,72 @@ TEST(Utils, OverwriteDataset) {
 }
 
 TEST(Utils, ReadDatasetNotFound) {
-  std::string filename = testing::TmpDir();
+  std::string filename = tensorflow::testing::TmpDir();
   ASSERT_TRUE(Env::Default()->CreateUniqueFileName(&filename, "journal_dir"));
   DatasetDef result;
   Status s = ReadDatasetDef(filename, result);
   EXPECT_EQ(s.code(), error::NOT_FOUND);
 }
 
+TEST(Utils, PrepareDatasetGraph) {
+  GraphDef graph;
+  NodeDef* node = graph.add_node();
+  node->set_name("table");
+  node->set_op("HashTableV2");
+  node->set_device("/job:worker/task:0/device:CPU:0");
+  PrepareDatasetGraph(graph);
+  EXPECT_TRUE(graph.node(0).device().empty());
+  EXPECT_TRUE(graph.node(0).attr().at("use_node_name_sharing").b());
+}
+
+TEST(Utils, FingerprintDatasetGraph) {
+  DatasetDef range_10 = testing::RangeDataset(10);
+  DatasetDef range_20 = testing::RangeDataset(20);
+  PrepareDatasetGraph(*range_10.mutable_graph());
+  PrepareDatasetGraph(*range_20.mutable_graph());
+  uint64 fingerprint_1;
+  uint64 fingerprint_2;
+  uint64 fingerprint_3;
+  TF_ASSERT_OK(FingerprintDatasetGraph(range_10.graph(), fingerprint_1));
+  TF_ASSERT_OK(FingerprintDatasetGraph(range_10.graph(), fingerprint_2));
+  TF_ASSERT_OK(FingerprintDatasetGraph(range_20.graph(), fingerprint_3));
+  EXPECT_EQ(fingerprint_1, fingerprint_2);
+  EXPECT_NE(fingerprint_1, fingerprint_3);
+}
+
+TEST(Utils, FingerprintDatasetDef) {
+  DatasetDef dataset = testing::RangeDataset(10);
+  PrepareDatasetGraph(*dataset.mutable_graph());
+  uint64 graph_fingerprint;
+  TF_ASSERT_OK(FingerprintDatasetGraph(dataset.graph(), graph_fingerprint));
+  EXPECT_EQ(FingerprintDatasetDef(dataset, graph_fingerprint),
+            graph_fingerprint);
+  DatasetDef compressed_dataset = dataset;
+  compressed_dataset.set_compress_elements(true);
+  EXPECT_NE(FingerprintDatasetDef(compressed_dataset, graph_fingerprint),
+            graph_fingerprint);
+}
+
+TEST(Utils, SubShardTaskDefPartitionsShards) {
+  constexpr int64_t kNumWorkers = 3;
+  constexpr int64_t kNumReplicas = 4;
+  std::set<int64_t> worker_indices;
+  for (int64_t worker_index = 0; worker_index < kNumWorkers; ++worker_index) {
+    TaskDef task_def;
+    task_def.set_task_id(worker_index);
+    task_def.set_num_workers(kNumWorkers);
+    task_def.set_worker_index(worker_index);
+    for (int64_t replica = 0; replica < kNumReplicas; ++replica) {
+      TaskDef sub_shard = SubShardTaskDef(task_def, kNumReplicas, replica);
+      EXPECT_EQ(sub_shard.task_id(), worker_index);
+      EXPECT_EQ(sub_shard.num_workers(), kNumWorkers * kNumReplicas);
+      EXPECT_GE(sub_shard.worker_index(), 0);
+      EXPECT_LT(sub_shard.worker_index(), kNumWorkers * kNumReplicas);
+      worker_indices.insert(sub_shard.worker_index());
+    }
+  }
+  EXPECT_EQ(worker_indices.size(), kNumWorkers * kNumReplicas);
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
@@ -47,10 +48,29 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Number of channels over which the chunks of a chunked element are fetched.
+constexpr int64_t kNumChunkStreams = 4;
+// Number of threads fetching chunks, shared by all clients in the process.
+constexpr int64_t kNumChunkFetchThreads = 16;
+// How long failed chunk fetches are retried. Workers drop chunked elements
+// which are not accessed for a minute.
+constexpr int64_t kChunkFetchRetryMicros = 30 * 1000 * 1000;  // 30 seconds.
+
+thread::ThreadPool* ChunkFetchThreadPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "tf_data_service_chunk_fetch",
+                             kNumChunkFetchThreads);
+  return pool;
+}
+
+}  // namespace
 
 void ByteBlockChecker::AddAndSleepCheck(int64_t total_bytes) {
   mutex_lock l(mu_);
@@ -118,6 +138,14 @@ class GrpcDataTransferClient : public DataTransferClient {
     args.SetMaxReceiveMessageSize(-1);
     auto channel = grpc::CreateCustomChannel(address, credentials, args);
     stub_ = WorkerService::NewStub(channel);
+    for (int64_t i = 0; i < kNumChunkStreams; ++i) {
+      // Channels with different arguments do not share a connection, so that
+      // chunks are fetched over separate TCP connections.
+      grpc::ChannelArguments chunk_args = args;
+      chunk_args.SetInt("tf_data_service_chunk_stream", i);
+      chunk_stubs_.push_back(WorkerService::NewStub(
+          grpc::CreateCustomChannel(address, credentials, chunk_args)));
+    }
   }
 
   Status GetElement(const GetElementRequest& req,
@@ -135,8 +163,10 @@ class GrpcDataTransferClient : public DataTransferClient {
       mutex_lock l(mu_);
       active_contexts_.insert(&ctx);
     }
+    GetElementRequest chunked_req = req;
+    chunked_req.set_allow_chunked_element(true);
     GetElementResponse resp;
-    grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    grpc::Status s = stub_->GetElement(&ctx, chunked_req, &resp);
 
     if(byte_block_checker_ != nullptr) {
       byte_block_checker_->AddAndSleepCheck(resp.ByteSizeLong() + req.ByteSizeLong());
@@ -159,6 +189,8 @@ class GrpcDataTransferClient : public DataTransferClient {
           }
         }
         break;
+      case GetElementResponse::kChunked:
+        break;
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
@@ -169,6 +201,13 @@ class GrpcDataTransferClient : public DataTransferClient {
     if (!s.ok()) {
       return grpc_util::WrapError("Failed to get element", s);
     }
+    if (resp.element_case() == GetElementResponse::kChunked) {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      CompressedElement compressed;
+      TF_RETURN_IF_ERROR(GetChunks(*resp.mutable_chunked(), compressed));
+      tensor.scalar<Variant>()() = std::move(compressed);
+      result.components.push_back(tensor);
+    }
     return Status::OK();
   }
 
@@ -182,8 +221,81 @@ class GrpcDataTransferClient : public DataTransferClient {
   }
 
  private:
+  // Fetches the chunks of the element described by `header` in parallel, and
+  // reassembles them into `compressed`.
+  Status GetChunks(ChunkedElementHeader& header,
+                   CompressedElement& compressed) {
+    compressed = std::move(*header.mutable_element());
+    const int64_t num_chunks = header.num_chunks();
+    compressed.mutable_chunks()->Reserve(num_chunks);
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      compressed.add_chunks();
+    }
+    std::vector<Status> statuses(num_chunks);
+    BlockingCounter counter(num_chunks);
+    const int64_t deadline_micros =
+        EnvTime::NowMicros() + kChunkFetchRetryMicros;
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      ChunkFetchThreadPool()->Schedule([&, i] {
+        statuses[i] = grpc_util::Retry(
+            [&] {
+              return GetChunk(header.chunked_element_id(), i,
+                              *compressed.mutable_chunks(i));
+            },
+            [this] {
+              mutex_lock l(mu_);
+              return !cancelled_;
+            },
+            "get element chunk", deadline_micros);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (const Status& status : statuses) {
+      TF_RETURN_IF_ERROR(status);
+    }
+    return Status::OK();
+  }
+
+  // Fetches one chunk of a chunked element into `data`. Chunks are spread
+  // over `chunk_stubs_` by index.
+  Status GetChunk(int64_t chunked_element_id, int64_t chunk_index,
+                  std::string& data) {
+    grpc::ClientContext ctx;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      active_contexts_.insert(&ctx);
+    }
+    GetElementChunkRequest req;
+    req.set_chunked_element_id(chunked_element_id);
+    req.set_chunk_index(chunk_index);
+    GetElementChunkResponse resp;
+    grpc::Status s =
+        chunk_stubs_[chunk_index % chunk_stubs_.size()]->GetElementChunk(
+            &ctx, req, &resp);
+    {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    }
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element chunk", s);
+    }
+    if (byte_block_checker_ != nullptr) {
+      byte_block_checker_->AddAndSleepCheck(resp.ByteSizeLong() +
+                                            req.ByteSizeLong());
+    }
+    data = std::move(*resp.mutable_data());
+    return Status::OK();
+  }
+
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
+  // Stubs over separate connections for fetching the chunks of chunked
+  // elements.
+  std::vector<std::unique_ptr<WorkerService::Stub>> chunk_stubs_;
   // Set of all currently active clients contexts. Used to support
   // cancellation.
   absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
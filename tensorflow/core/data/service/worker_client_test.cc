@@ -17,10 +17,13 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -33,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
@@ -99,7 +103,8 @@ class WorkerClientTest : public ::testing::Test {
   StatusOr<std::unique_ptr<DataServiceWorkerClient>> GetWorkerClient(
       const std::string& data_transfer_protocol) {
     return CreateDataServiceWorkerClient(
-        GetWorkerAddress(), /*protocol=*/kProtocol, data_transfer_protocol);
+        GetWorkerAddress(), /*protocol=*/kProtocol, data_transfer_protocol,
+        /*max_bandwidth_bps=*/0);
   }
 
   StatusOr<GetElementResult> GetElement(DataServiceWorkerClient& client,
@@ -215,6 +220,61 @@ TEST_F(WorkerClientTest, CancelClient) {
                        MatchesRegex("Client for worker.*has been cancelled.")));
 }
 
+class ChunkedWorkerClientTest : public WorkerClientTest {
+ protected:
+  void SetUp() override {
+    TestCluster::Config config;
+    config.num_workers = 1;
+    // Splits every element of `RangeSquareDataset` into 8 chunks.
+    config.element_chunk_size_bytes = 1;
+    test_cluster_ = absl::make_unique<TestCluster>(config);
+    TF_ASSERT_OK(test_cluster_->Initialize());
+    dispatcher_client_ = absl::make_unique<DataServiceDispatcherClient>(
+        test_cluster_->DispatcherAddress(), kProtocol);
+  }
+
+  // Creates a dataset whose elements are compressed, and therefore chunked,
+  // and returns the dataset ID.
+  StatusOr<int64_t> RegisterCompressedDataset(const int64_t range) {
+    DatasetDef dataset_def = RangeSquareDataset(range);
+    dataset_def.set_compress_elements(true);
+    int64_t dataset_id = 0;
+    TF_RETURN_IF_ERROR(dispatcher_client_->RegisterDataset(
+        dataset_def, /*element_spec=*/absl::nullopt, dataset_id));
+    return dataset_id;
+  }
+};
+
+TEST_F(ChunkedWorkerClientTest, GrpcReadChunkedElements) {
+  const int64_t range = 5;
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t dataset_id,
+                          RegisterCompressedDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t job_client_id, CreateJob(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id, GetTaskToRead(job_client_id));
+  // Reads over gRPC rather than from the in-process worker, so that chunks are
+  // fetched with GetElementChunk.
+  LocalWorkers::Remove(GetWorkerAddress());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcTransferProtocol));
+  for (int64_t i = 0; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    EXPECT_FALSE(result.end_of_sequence);
+    ASSERT_EQ(result.components.size(), 1);
+    const CompressedElement* compressed =
+        result.components[0].scalar<Variant>()().get<CompressedElement>();
+    ASSERT_NE(compressed, nullptr);
+    EXPECT_EQ(compressed->chunks_size(), 8);
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(UncompressElement(*compressed, &element));
+    ASSERT_EQ(element.size(), 1);
+    test::ExpectEqual(element[0], Tensor(int64_t{i * i}));
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
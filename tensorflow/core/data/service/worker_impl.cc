@@ -18,9 +18,11 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "grpcpp/create_channel.h"
 #include "absl/algorithm/container.h"
@@ -34,31 +36,42 @@ limitations under the License.
 #include "tensorflow/core/data/service/auto_shard_rewriter.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/constant_cache.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/dataset_store.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/fair_share_scheduler.h"
 #include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/job_isolation.h"
 #include "tensorflow/core/data/service/split_provider.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/utils.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -69,6 +82,31 @@ namespace {
 constexpr int64_t kRetryIntervalMicros = 5 * 1000 * 1000;        // 5 seconds.
 constexpr int64_t kDefaultHeartBeatIntervalMs = 30 * 1000;       // 30 seconds.
 constexpr int64_t kDefaultDispatcherTimeoutMs = 60 * 60 * 1000;  // 1 hour.
+// Large dataset constants are fetched from the dispatcher in chunks of this
+// size, with up to `kNumParallelConstantReads` chunks in flight.
+constexpr int64_t kConstantChunkBytes = 8 << 20;  // 8 MiB.
+constexpr int64_t kNumParallelConstantReads = 8;
+constexpr char kDefaultConstantCacheDir[] = "tf_data_constant_cache";
+// Number of threads which initialize tasks and prewarmed datasets ahead of the
+// first requests for their elements.
+constexpr int kNumTaskInitThreads = 4;
+// Upper bound on the number of iterator replicas of a task when autotuning, as
+// each replica instantiates its own copy of the pipeline.
+constexpr int64_t kMaxAutotunedTaskReplicas = 16;
+// Default number of threads per task which compress elements.
+constexpr int64_t kDefaultCompressionThreads = 4;
+// Default uncompressed size above which compressed elements are chunked.
+constexpr int64_t kDefaultElementChunkSizeBytes = 16 * 1024 * 1024;  // 16MB
+// Chunked elements whose chunks are not fetched within this time are dropped,
+// e.g. because their client failed.
+constexpr int64_t kChunkedElementTimeoutMicros = 60 * 1000 * 1000;  // 1 min.
+// Upper bound on the size of the chunks waiting to be fetched. Requests for
+// further chunked elements wait for earlier ones to be fetched.
+constexpr int64_t kMaxChunkedElementBytes = 1024 * 1024 * 1024;  // 1GB
+// The op which applies a tf.data UDF plugin, and its attr naming the shared
+// object that provides the UDF.
+constexpr char kDataUdfOp[] = "DataUdf";
+constexpr char kDataUdfLibraryAttr[] = "library";
 
 using WorkerConfig = experimental::WorkerConfig;
 
@@ -97,6 +135,36 @@ Status MoveElementToResponse(std::vector<Tensor>&& element,
   return Status::OK();
 }
 
+// Returns an error if `node` loads a UDF plugin that is not in the worker's
+// `data_udf_plugin_allowlist`. Otherwise, a DatasetDef sent by any client could
+// make the worker load an arbitrary shared object.
+Status CheckDataUdfPlugin(const NodeDef& node, const WorkerConfig& config) {
+  if (node.op() != kDataUdfOp) {
+    return Status::OK();
+  }
+  auto it = node.attr().find(kDataUdfLibraryAttr);
+  if (it == node.attr().end() || it->second.s().empty() ||
+      absl::c_linear_search(config.data_udf_plugin_allowlist(),
+                            it->second.s())) {
+    return Status::OK();
+  }
+  return errors::PermissionDenied(
+      "The dataset loads the tf.data UDF plugin ", it->second.s(),
+      ", which is not in the worker's `data_udf_plugin_allowlist`.");
+}
+
+Status CheckDataUdfPlugins(const GraphDef& graph, const WorkerConfig& config) {
+  for (const NodeDef& node : graph.node()) {
+    TF_RETURN_IF_ERROR(CheckDataUdfPlugin(node, config));
+  }
+  for (const FunctionDef& function : graph.library().function()) {
+    for (const NodeDef& node : function.node_def()) {
+      TF_RETURN_IF_ERROR(CheckDataUdfPlugin(node, config));
+    }
+  }
+  return Status::OK();
+}
+
 WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
   WorkerConfig new_config(config);
   if (new_config.heartbeat_interval_ms() == 0) {
@@ -105,6 +173,20 @@ WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
   if (new_config.dispatcher_timeout_ms() == 0) {
     new_config.set_dispatcher_timeout_ms(kDefaultDispatcherTimeoutMs);
   }
+  if (new_config.compression_threads() == 0) {
+    new_config.set_compression_threads(kDefaultCompressionThreads);
+  }
+  if (new_config.element_chunk_size_bytes() == 0) {
+    new_config.set_element_chunk_size_bytes(kDefaultElementChunkSizeBytes);
+  }
+  if (new_config.constant_cache_dir().empty()) {
+    std::vector<std::string> tmp_dirs;
+    Env::Default()->GetLocalTempDirectories(&tmp_dirs);
+    if (!tmp_dirs.empty()) {
+      new_config.set_constant_cache_dir(
+          io::JoinPath(tmp_dirs[0], kDefaultConstantCacheDir));
+    }
+  }
   return new_config;
 }
 }  // namespace
@@ -114,7 +196,17 @@ LocalWorkers::AddressToWorkerMap* LocalWorkers::local_workers_ =
     new AddressToWorkerMap();
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(const WorkerConfig& config)
-    : config_(ApplyWorkerDefaults(config)) {
+    : config_(ApplyWorkerDefaults(config)),
+      chunked_elements_(kChunkedElementTimeoutMicros,
+                        kMaxChunkedElementBytes) {
+  if (config_.isolate_jobs()) {
+    job_isolation_domains_ = absl::make_unique<JobIsolationDomains>(
+        config_.job_cpu_limit(), config_.job_memory_limit_bytes());
+  }
+  if (config_.fair_share_scheduling()) {
+    fair_share_scheduler_ =
+        absl::make_unique<FairShareScheduler>(port::MaxParallelism());
+  }
   metrics::RecordTFDataServiceWorkerCreated();
 }
 
@@ -135,6 +227,16 @@ Status DataServiceWorkerImpl::Start(const std::string& worker_address,
   dispatcher_ = absl::make_unique<DataServiceDispatcherClient>(
       config_.dispatcher_address(), config_.protocol());
   TF_RETURN_IF_ERROR(dispatcher_->Initialize());
+  constant_cache_ = absl::make_unique<ConstantCache>(
+      config_.constant_cache_dir(), kConstantChunkBytes,
+      kNumParallelConstantReads,
+      [this](const std::string& key, int64_t offset, int64_t length,
+             std::string& data, int64_t& total_size) {
+        return dispatcher_->GetConstantChunk(key, offset, length, data,
+                                             total_size);
+      });
+  task_init_thread_pool_ = absl::make_unique<thread::ThreadPool>(
+      Env::Default(), "tf_data_service_worker_task_init", kNumTaskInitThreads);
 
   Status s = Heartbeat();
   while (!s.ok()) {
@@ -171,6 +273,16 @@ void DataServiceWorkerImpl::Stop() {
   for (auto& task : tasks) {
     StopTask(*task);
   }
+  absl::flat_hash_map<int64_t, PrewarmedDataset> prewarmed_datasets;
+  {
+    mutex_lock l(mu_);
+    prewarmed_datasets.swap(prewarmed_datasets_);
+  }
+  for (auto& entry : prewarmed_datasets) {
+    if (entry.second.task_runner) {
+      entry.second.task_runner->Cancel();
+    }
+  }
   // At this point there are no outstanding requests in this RPC handler.
   // However, requests successfully returned from this RPC handler may still be
   // in progress within the gRPC server. If we shut down the gRPC server
@@ -192,6 +304,23 @@ Status DataServiceWorkerImpl::ValidateWorkerConfig() const {
                       config_.worker_tags().end(), ", "),
         "}");
   }
+  if (config_.job_cpu_limit() < 0 || config_.job_memory_limit_bytes() < 0) {
+    return errors::FailedPrecondition(
+        "Job CPU and memory limits must be non-negative. Got job_cpu_limit ",
+        config_.job_cpu_limit(), " and job_memory_limit_bytes ",
+        config_.job_memory_limit_bytes());
+  }
+  if (config_.compression_threads() < 0) {
+    return errors::FailedPrecondition(
+        "Compression threads must be non-negative. Got ",
+        config_.compression_threads());
+  }
+  if (config_.task_replicas() < 0 &&
+      config_.task_replicas() != model::kAutotune) {
+    return errors::FailedPrecondition(
+        "Task replicas must be non-negative or ", model::kAutotune,
+        " for autotuning. Got ", config_.task_replicas());
+  }
   return Status::OK();
 }
 
@@ -231,7 +360,6 @@ Status DataServiceWorkerImpl::GetElementResult(
       return errors::Unavailable("Task ", request->task_id(), " not found");
     }
     task = it->second.get();
-    TF_RETURN_IF_ERROR(EnsureTaskInitialized(*task));
     task->outstanding_requests++;
   }
   auto cleanup = gtl::MakeCleanup([&] {
@@ -239,6 +367,9 @@ Status DataServiceWorkerImpl::GetElementResult(
     task->outstanding_requests--;
     cv_.notify_all();
   });
+  // Initialize outside of `mu_` so that a slow pipeline instantiation does not
+  // block requests for other tasks.
+  TF_RETURN_IF_ERROR(EnsureTaskInitialized(*task));
   TF_RETURN_IF_ERROR(task->task_runner->GetNext(*request, *result));
 
   if (result->end_of_sequence) {
@@ -270,9 +401,102 @@ Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
   VLOG(0) << "Began processing for task " << task_def.task_id()
           << " with processing mode "
           << task_def.processing_mode_def().DebugString();
+  InitializeTaskAsync(task);
   return Status::OK();
 }
 
+void DataServiceWorkerImpl::InitializeTaskAsync(std::shared_ptr<Task> task)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!task_init_thread_pool_ || cancelled_) {
+    return;
+  }
+  task_init_thread_pool_->Schedule([this, task = std::move(task)]() {
+    Status s = EnsureTaskInitialized(*task);
+    if (!s.ok()) {
+      // The next request for the task's elements retries the initialization.
+      LOG(WARNING) << "Failed to initialize task " << task->task_def.task_id()
+                   << " ahead of time: " << s;
+    }
+  });
+}
+
+bool DataServiceWorkerImpl::CanUsePrewarmedDataset(const TaskDef& task_def) {
+  return IsNoShard(task_def.processing_mode_def()) &&
+         task_def.optional_num_consumers_case() != TaskDef::kNumConsumers;
+}
+
+void DataServiceWorkerImpl::PrewarmDataset(int64_t dataset_id)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // Prewarmed pipelines are not bound to a job, so they can't run in a job's
+  // isolation domain or fair share.
+  if (!task_init_thread_pool_ || cancelled_ || job_isolation_domains_ ||
+      fair_share_scheduler_ || prewarmed_datasets_.contains(dataset_id)) {
+    return;
+  }
+  prewarmed_datasets_[dataset_id];
+  task_init_thread_pool_->Schedule([this, dataset_id]() {
+    StatusOr<std::unique_ptr<TaskRunner>> task_runner =
+        MakePrewarmedTaskRunner(dataset_id);
+    mutex_lock l(mu_);
+    auto it = prewarmed_datasets_.find(dataset_id);
+    if (!task_runner.ok()) {
+      LOG(WARNING) << "Failed to prewarm dataset " << dataset_id << ": "
+                   << task_runner.status();
+      if (it != prewarmed_datasets_.end() && !it->second.task_runner) {
+        prewarmed_datasets_.erase(it);
+      }
+      return;
+    }
+    if (it == prewarmed_datasets_.end() || it->second.task_runner) {
+      // The dataset is no longer prewarmed.
+      task_runner.ValueOrDie()->Cancel();
+      return;
+    }
+    it->second.task_runner = std::move(task_runner).ValueOrDie();
+    VLOG(1) << "Prewarmed dataset " << dataset_id;
+  });
+}
+
+StatusOr<std::unique_ptr<TaskRunner>>
+DataServiceWorkerImpl::MakePrewarmedTaskRunner(int64_t dataset_id) {
+  TaskDef task_def;
+  task_def.set_dataset_id(dataset_id);
+  task_def.set_worker_address(worker_address_);
+  DatasetDef dataset_def;
+  TF_RETURN_IF_ERROR(dispatcher_->GetDatasetDef(dataset_id, dataset_def));
+  TF_RETURN_IF_ERROR(constant_cache_->ResolveConstants(dataset_def));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
+                      MakeDataset(dataset_def, task_def));
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
+                      MakeDatasetIterator(*dataset, task_def));
+  auto task_iterator = absl::make_unique<StandaloneTaskIterator>(
+      std::move(dataset), std::move(iterator));
+  // The task runner starts producing elements right away, so the first element
+  // is ready when a task takes the runner over.
+  std::unique_ptr<TaskRunner> task_runner;
+  TF_RETURN_IF_ERROR(TaskRunner::Create(config_, task_def,
+                                        std::move(task_iterator), task_runner));
+  return MaybeCompress(dataset_def, task_def, std::move(task_runner));
+}
+
+std::unique_ptr<TaskRunner> DataServiceWorkerImpl::TakePrewarmedTaskRunner(
+    const TaskDef& task_def) TF_LOCKS_EXCLUDED(mu_) {
+  if (!CanUsePrewarmedDataset(task_def)) {
+    return nullptr;
+  }
+  mutex_lock l(mu_);
+  auto it = prewarmed_datasets_.find(task_def.dataset_id());
+  if (it == prewarmed_datasets_.end() || !it->second.task_runner) {
+    return nullptr;
+  }
+  std::unique_ptr<TaskRunner> task_runner = std::move(it->second.task_runner);
+  // Prepare the pipeline of the next job, e.g. the next epoch, while this one
+  // runs.
+  prewarmed_datasets_.erase(it);
+  PrewarmDataset(task_def.dataset_id());
+  return task_runner;
+}
+
 Status DataServiceWorkerImpl::EnsureTaskInitialized(
     DataServiceWorkerImpl::Task& task) {
   if (task.task_def.worker_address() != worker_address_) {
@@ -283,23 +507,109 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
 
   mutex_lock l(task.mu);
   if (task.initialized) {
+    if (!task.task_runner) {
+      return errors::Unavailable("Task ", task.task_def.task_id(),
+                                 " was stopped");
+    }
+    return Status::OK();
+  }
+  task.task_runner = TakePrewarmedTaskRunner(task.task_def);
+  if (task.task_runner) {
+    task.initialized = true;
+    VLOG(3) << "Using prewarmed iterator for task "
+            << task.task_def.task_id();
     return Status::OK();
   }
   TF_ASSIGN_OR_RETURN(DatasetDef dataset_def, GetDatasetDef(task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
-                      MakeDataset(dataset_def, task.task_def));
-  TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
-                      MakeDatasetIterator(*dataset, task.task_def));
-  auto task_iterator = absl::make_unique<StandaloneTaskIterator>(
-      std::move(dataset), std::move(iterator));
-  TF_RETURN_IF_ERROR(TaskRunner::Create(
-      config_, task.task_def, std::move(task_iterator), task.task_runner));
+  TF_RETURN_IF_ERROR(constant_cache_->ResolveConstants(dataset_def));
+  if (job_isolation_domains_) {
+    task.isolation_domain =
+        job_isolation_domains_->Get(task.task_def.job_id());
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<TaskIterator>> iterators,
+                      MakeTaskIterators(dataset_def, task));
+  std::unique_ptr<TaskRunner> task_runner;
+  TF_RETURN_IF_ERROR(TaskRunner::Create(config_, task.task_def,
+                                        std::move(iterators), task_runner));
+  task.task_runner =
+      MaybeCompress(dataset_def, task.task_def, std::move(task_runner));
 
   task.initialized = true;
   VLOG(3) << "Created iterator for task " << task.task_def.task_id();
   return Status::OK();
 }
 
+std::unique_ptr<TaskRunner> DataServiceWorkerImpl::MaybeCompress(
+    const DatasetDef& dataset_def, const TaskDef& task_def,
+    std::unique_ptr<TaskRunner> task_runner) const {
+  if (!dataset_def.compress_elements()) {
+    return task_runner;
+  }
+  return absl::make_unique<CompressingTaskRunner>(
+      std::move(task_runner), task_def, config_.compression_threads(),
+      /*chunk_size_bytes=*/std::max<int64_t>(
+          config_.element_chunk_size_bytes(), 0));
+}
+
+int64_t DataServiceWorkerImpl::NumTaskReplicas(const TaskDef& task_def) const {
+  // Round-robin reads need a single deterministic element order, and replicas
+  // of an unsharded dataset would produce duplicate elements. File-based
+  // sharding is not sub-sharded, since the worker's shard may have fewer files
+  // than replicas.
+  const ProcessingModeDef::ShardingPolicy policy =
+      task_def.processing_mode_def().sharding_policy();
+  if (task_def.optional_num_consumers_case() == TaskDef::kNumConsumers ||
+      (policy != ProcessingModeDef::DYNAMIC &&
+       policy != ProcessingModeDef::DATA &&
+       policy != ProcessingModeDef::FILE_OR_DATA)) {
+    return 1;
+  }
+  if (config_.task_replicas() == model::kAutotune) {
+    // Statically sharded replicas sub-shard the worker's shard, which only
+    // partitions the dataset if all workers run the same number of replicas.
+    // The autotuned number depends on the cores of each worker.
+    if (IsStaticShard(task_def.processing_mode_def())) {
+      return 1;
+    }
+    const int64_t num_cores =
+        config_.isolate_jobs() && config_.job_cpu_limit() > 0
+            ? config_.job_cpu_limit()
+            : port::MaxParallelism();
+    return std::max<int64_t>(1,
+                             std::min(num_cores, kMaxAutotunedTaskReplicas));
+  }
+  return std::max<int64_t>(1, config_.task_replicas());
+}
+
+StatusOr<std::vector<std::unique_ptr<TaskIterator>>>
+DataServiceWorkerImpl::MakeTaskIterators(const DatasetDef& dataset_def,
+                                         const Task& task) const {
+  const int64_t num_replicas = NumTaskReplicas(task.task_def);
+  std::vector<std::unique_ptr<TaskIterator>> iterators;
+  iterators.reserve(num_replicas);
+  for (int64_t replica = 0; replica < num_replicas; ++replica) {
+    const TaskDef replica_task_def =
+        num_replicas > 1 && IsStaticShard(task.task_def.processing_mode_def())
+            ? SubShardTaskDef(task.task_def, num_replicas, replica)
+            : task.task_def;
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Dataset> dataset,
+                        MakeDataset(dataset_def, replica_task_def,
+                                    task.isolation_domain.get()));
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<standalone::Iterator> iterator,
+                        MakeDatasetIterator(*dataset, replica_task_def));
+    std::unique_ptr<TaskIterator> task_iterator =
+        absl::make_unique<StandaloneTaskIterator>(std::move(dataset),
+                                                  std::move(iterator));
+    if (fair_share_scheduler_) {
+      task_iterator = absl::make_unique<FairShareTaskIterator>(
+          std::move(task_iterator), *fair_share_scheduler_,
+          task.task_def.job_id(), task.task_def.task_id());
+    }
+    iterators.push_back(std::move(task_iterator));
+  }
+  return iterators;
+}
+
 StatusOr<DatasetDef> DataServiceWorkerImpl::GetDatasetDef(
     const TaskDef& task_def) const {
   switch (task_def.dataset_case()) {
@@ -307,7 +617,7 @@ StatusOr<DatasetDef> DataServiceWorkerImpl::GetDatasetDef(
       return task_def.dataset_def();
     case TaskDef::kPath: {
       DatasetDef def;
-      Status s = ReadDatasetDef(task_def.path(), def);
+      Status s = ReadStoredDatasetDef(task_def.path(), def);
       if (!s.ok()) {
         LOG(INFO) << "Failed to read dataset from " << task_def.path() << ": "
                   << s << ". Falling back to reading from dispatcher.";
@@ -361,8 +671,10 @@ Status DataServiceWorkerImpl::AddTargetThreadpool(GraphDef& graph_def) const {
 }
 
 StatusOr<std::unique_ptr<standalone::Dataset>>
-DataServiceWorkerImpl::MakeDataset(const DatasetDef& dataset_def,
-                                   const TaskDef& task_def) const {
+DataServiceWorkerImpl::MakeDataset(
+    const DatasetDef& dataset_def, const TaskDef& task_def,
+    const JobIsolationDomain* isolation_domain) const {
+  TF_RETURN_IF_ERROR(CheckDataUdfPlugins(dataset_def.graph(), config_));
   TF_ASSIGN_OR_RETURN(AutoShardRewriter auto_shard_rewriter,
                       AutoShardRewriter::Create(task_def));
   // `ApplyAutoShardRewrite` does nothing if auto-sharding is disabled.
@@ -370,9 +682,16 @@ DataServiceWorkerImpl::MakeDataset(const DatasetDef& dataset_def,
       GraphDef rewritten_graph,
       auto_shard_rewriter.ApplyAutoShardRewrite(dataset_def.graph()));
   TF_RETURN_IF_ERROR(AddTargetThreadpool(rewritten_graph));
+  standalone::Dataset::Params params;
+  if (isolation_domain) {
+    params.thread_pool = isolation_domain->thread_pool();
+    params.allocator = isolation_domain->allocator();
+    params.background_thread_pool =
+        isolation_domain->background_thread_pool();
+  }
   std::unique_ptr<standalone::Dataset> dataset;
-  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
-      standalone::Dataset::Params(), rewritten_graph, &dataset));
+  TF_RETURN_IF_ERROR(
+      standalone::Dataset::FromGraph(params, rewritten_graph, &dataset));
   return dataset;
 }
 
@@ -408,6 +727,9 @@ void DataServiceWorkerImpl::StopTask(Task& task) TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(task.mu);
     task.initialized = true;
   }
+  if (fair_share_scheduler_) {
+    fair_share_scheduler_->CancelTask(task.task_def.task_id());
+  }
   if (task.task_runner) {
     task.task_runner->Cancel();
   }
@@ -427,11 +749,43 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
   if (!response->end_of_sequence() && !response->skip_task()) {
     TF_RETURN_IF_ERROR(
         MoveElementToResponse(std::move(result.components), *response));
+    if (request->allow_chunked_element() &&
+        response->compressed().chunks_size() > 1) {
+      StashChunks(request->task_id(), *response);
+    }
     VLOG(3) << "Producing an element for task " << request->task_id();
   }
   return Status::OK();
 }
 
+void DataServiceWorkerImpl::StashChunks(int64_t task_id,
+                                        GetElementResponse& response) {
+  CompressedElement element;
+  element.Swap(response.mutable_compressed());
+  std::vector<std::string> chunks;
+  chunks.reserve(element.chunks_size());
+  for (std::string& chunk : *element.mutable_chunks()) {
+    chunks.push_back(std::move(chunk));
+  }
+  element.clear_chunks();
+
+  ChunkedElementHeader* header = response.mutable_chunked();
+  header->set_num_chunks(chunks.size());
+  *header->mutable_element() = std::move(element);
+  header->set_chunked_element_id(
+      chunked_elements_.Put(task_id, std::move(chunks)));
+}
+
+Status DataServiceWorkerImpl::GetElementChunk(
+    const GetElementChunkRequest* request, GetElementChunkResponse* response) {
+  VLOG(3) << "Received GetElementChunk request for chunk "
+          << request->chunk_index() << " of chunked element "
+          << request->chunked_element_id();
+  return chunked_elements_.GetChunk(request->chunked_element_id(),
+                                    request->chunk_index(),
+                                    *response->mutable_data());
+}
+
 Status DataServiceWorkerImpl::GetWorkerTasks(
     const GetWorkerTasksRequest* request, GetWorkerTasksResponse* response) {
   mutex_lock l(mu_);
@@ -518,6 +872,7 @@ void DataServiceWorkerImpl::HeartbeatThread() TF_LOCKS_EXCLUDED(mu_) {
     if (!s.ok()) {
       LOG(WARNING) << "Failed to send heartbeat to dispatcher: " << s;
     }
+    chunked_elements_.EvictExpired();
   }
 }
 
@@ -537,10 +892,32 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
                                       current_tasks.end()};
   TF_ASSIGN_OR_RETURN(WorkerHeartbeatResponse response,
                       dispatcher_->WorkerHeartbeat(request));
+  if (fair_share_scheduler_) {
+    fair_share_scheduler_->SetJobWeights(
+        {response.job_weights().begin(), response.job_weights().end()});
+  }
 
   std::vector<std::shared_ptr<Task>> tasks_to_delete;
+  std::vector<std::unique_ptr<TaskRunner>> prewarmed_to_delete;
   {
     mutex_lock l(mu_);
+    absl::flat_hash_set<int64_t> datasets_to_prewarm(
+        response.datasets_to_prewarm().begin(),
+        response.datasets_to_prewarm().end());
+    for (auto it = prewarmed_datasets_.begin();
+         it != prewarmed_datasets_.end();) {
+      if (datasets_to_prewarm.contains(it->first)) {
+        ++it;
+        continue;
+      }
+      if (it->second.task_runner) {
+        prewarmed_to_delete.push_back(std::move(it->second.task_runner));
+      }
+      prewarmed_datasets_.erase(it++);
+    }
+    for (int64_t dataset_id : datasets_to_prewarm) {
+      PrewarmDataset(dataset_id);
+    }
     for (const auto& task : response.new_tasks()) {
       VLOG(1) << "Received new task from dispatcher with id " << task.task_id();
       if (deleted_tasks_.contains(task.task_id())) {
@@ -562,11 +939,15 @@ Status DataServiceWorkerImpl::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       tasks_to_delete.push_back(std::move(tasks_[task_id]));
       tasks_.erase(task_id);
       finished_tasks_.insert(task_id);
+      chunked_elements_.DeleteTask(task_id);
     }
   }
   for (const auto& task : tasks_to_delete) {
     StopTask(*task);
   }
+  for (const auto& task_runner : prewarmed_to_delete) {
+    task_runner->Cancel();
+  }
   return Status::OK();
 }
 
@@ -583,6 +964,7 @@ void DataServiceWorkerImpl::DeleteLocalTask(const TaskInfo& task_info)
     tasks_.erase(task_info.task_id());
     pending_completed_tasks_.insert(task_info.task_id());
     deleted_tasks_.insert(task_info.task_id());
+    chunked_elements_.DeleteTask(task_info.task_id());
   }
 
   VLOG(2) << "Delete local task " << task_info.task_id() << " from worker "
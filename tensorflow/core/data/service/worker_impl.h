@@ -18,14 +18,19 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/chunked_element_store.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/constant_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/fair_share_scheduler.h"
+#include "tensorflow/core/data/service/job_isolation.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
@@ -36,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tensorflow/core/public/session.h"
 
@@ -78,6 +84,8 @@ class DataServiceWorkerImpl {
   /// Client-facing API.
   Status GetElement(const GetElementRequest* request,
                     GetElementResponse* response);
+  Status GetElementChunk(const GetElementChunkRequest* request,
+                         GetElementChunkResponse* response);
   Status GetWorkerTasks(const GetWorkerTasksRequest* request,
                         GetWorkerTasksResponse* response);
 
@@ -89,6 +97,15 @@ class DataServiceWorkerImpl {
     mutex mu;
     bool initialized TF_GUARDED_BY(mu) = false;
     int64_t outstanding_requests TF_GUARDED_BY(&DataServiceWorkerImpl::mu_) = 0;
+    // The resources of the task's job, if jobs are isolated. Declared before
+    // `task_runner` so that it outlives the task's pipeline.
+    std::shared_ptr<JobIsolationDomain> isolation_domain;
+    std::unique_ptr<TaskRunner> task_runner;
+  };
+
+  // A task runner built ahead of the task that will use it.
+  struct PrewarmedDataset {
+    // Null while the task runner is being built.
     std::unique_ptr<TaskRunner> task_runner;
   };
 
@@ -100,6 +117,25 @@ class DataServiceWorkerImpl {
   Status ProcessTaskInternal(const TaskDef& task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status EnsureTaskInitialized(Task& task);
+  // Initializes `task` on `task_init_thread_pool_`, so that its pipeline is
+  // ready before clients request its first elements.
+  void InitializeTaskAsync(std::shared_ptr<Task> task)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns whether tasks for `task_def` may use a prewarmed task runner.
+  static bool CanUsePrewarmedDataset(const TaskDef& task_def);
+  // Starts building a prewarmed task runner for `dataset_id`, unless there
+  // already is one.
+  void PrewarmDataset(int64_t dataset_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Builds a task runner for `dataset_id` which is not yet bound to a task.
+  StatusOr<std::unique_ptr<TaskRunner>> MakePrewarmedTaskRunner(
+      int64_t dataset_id);
+  // Returns the prewarmed task runner for `task_def`, or nullptr if there is
+  // none. Starts prewarming the dataset again for the next task.
+  std::unique_ptr<TaskRunner> TakePrewarmedTaskRunner(const TaskDef& task_def)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Moves the chunks of the compressed element in `response` to
+  // `chunked_elements_`, replacing the element by a `ChunkedElementHeader`.
+  void StashChunks(int64_t task_id, GetElementResponse& response);
   // Stops a task, cancelling the task's outstanding requests and waiting for
   // them to finish.
   void StopTask(Task& task) TF_LOCKS_EXCLUDED(mu_);
@@ -111,20 +147,41 @@ class DataServiceWorkerImpl {
   Status AddTargetThreadpool(GraphDef& graph_def) const;
   // Performs a heartbeat to the dispatcher.
   Status Heartbeat() TF_LOCKS_EXCLUDED(mu_);
-  // Gets the DatasetDef for `task_def`.
+  // Gets the DatasetDef for `task_def`. Large constants may be left as
+  // references, to be resolved by `constant_cache_`.
   StatusOr<DatasetDef> GetDatasetDef(const TaskDef& task_def) const;
-  // Creates a dataset from `dataset_def`.
+  // Creates a dataset from `dataset_def`. If `isolation_domain` is not null,
+  // the dataset runs with the domain's threads and allocator.
   StatusOr<std::unique_ptr<standalone::Dataset>> MakeDataset(
-      const DatasetDef& dataset_def, const TaskDef& task_def) const;
+      const DatasetDef& dataset_def, const TaskDef& task_def,
+      const JobIsolationDomain* isolation_domain = nullptr) const;
   // Creates an iterator for `dataset`.
   StatusOr<std::unique_ptr<standalone::Iterator>> MakeDatasetIterator(
       standalone::Dataset& dataset, const TaskDef& task_def) const;
+  // Wraps `task_runner` to compress the task's elements on dedicated threads
+  // if `dataset_def` requests worker-side compression.
+  std::unique_ptr<TaskRunner> MaybeCompress(
+      const DatasetDef& dataset_def, const TaskDef& task_def,
+      std::unique_ptr<TaskRunner> task_runner) const;
+  // Returns the number of iterator replicas to run for `task_def`.
+  int64_t NumTaskReplicas(const TaskDef& task_def) const;
+  // Creates the iterators of `task`, one per replica.
+  StatusOr<std::vector<std::unique_ptr<TaskIterator>>> MakeTaskIterators(
+      const DatasetDef& dataset_def, const Task& task) const;
 
   const experimental::WorkerConfig config_;
   // The worker's own address.
   std::string worker_address_;
   std::string transfer_address_;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
+  // Local cache of the large constants of the datasets processed by the worker.
+  std::unique_ptr<ConstantCache> constant_cache_;
+  // The resources of the jobs processed by the worker, if `isolate_jobs` is
+  // set.
+  std::unique_ptr<JobIsolationDomains> job_isolation_domains_;
+  // Arbitrates element production between jobs, if `fair_share_scheduling` is
+  // set.
+  std::unique_ptr<FairShareScheduler> fair_share_scheduler_;
 
   mutex mu_;
   condition_variable cv_;
@@ -149,6 +206,15 @@ class DataServiceWorkerImpl {
   condition_variable heartbeat_cv_ TF_GUARDED_BY(mu_);
   int64_t outstanding_requests_ TF_GUARDED_BY(mu_) = 0;
   CancellationManager cancellation_manager_;
+  // Chunked elements waiting for their chunks to be fetched.
+  ChunkedElementStore chunked_elements_;
+  // Prewarmed task runners, keyed by dataset id.
+  absl::flat_hash_map<int64_t, PrewarmedDataset> prewarmed_datasets_
+      TF_GUARDED_BY(mu_);
+  // Threads for initializing tasks and prewarmed datasets. Declared last so
+  // that it is destroyed, and its pending work finished, before the members
+  // the work uses.
+  std::unique_ptr<thread::ThreadPool> task_init_thread_pool_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DataServiceWorkerImpl);
 };
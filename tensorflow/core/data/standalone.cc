@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
 #include "tensorflow/core/data/root_dataset.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -69,8 +70,16 @@ Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
   TF_RETURN_IF_ERROR(ImportGraphDef({}, graph_def, &graph, nullptr));
 
   // Instantiate enough of the TF runtime to run `graph` on a single CPU device.
-  auto device_mgr = absl::make_unique<StaticDeviceMgr>(DeviceFactory::NewDevice(
-      "CPU", params.session_options, "/job:localhost/replica:0/task:0"));
+  std::unique_ptr<Device> cpu_device;
+  if (params.allocator != nullptr) {
+    cpu_device = absl::make_unique<ThreadPoolDevice>(
+        params.session_options, "/job:localhost/replica:0/task:0/device:CPU:0",
+        Bytes(256 << 20), DeviceLocality(), params.allocator);
+  } else {
+    cpu_device = DeviceFactory::NewDevice("CPU", params.session_options,
+                                          "/job:localhost/replica:0/task:0");
+  }
+  auto device_mgr = absl::make_unique<StaticDeviceMgr>(std::move(cpu_device));
   Device* device = device_mgr->ListDevices()[0];
   // Create a copy of the `FunctionLibraryDefinition` to extend lifetime beyond
   // the lifetime of `graph`.
@@ -107,10 +116,16 @@ Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
   TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(outputs[0], &dataset));
 
   data::DatasetBase* finalized_dataset;
-  std::unique_ptr<thread::ThreadPool> pool(
-      NewThreadPoolFromSessionOptions(params.session_options));
+  std::unique_ptr<thread::ThreadPool> pool;
+  thread::ThreadPool* runner_threadpool = params.thread_pool;
+  if (runner_threadpool == nullptr) {
+    pool.reset(NewThreadPoolFromSessionOptions(params.session_options));
+    runner_threadpool = pool.get();
+  }
   std::function<void(std::function<void()>)> runner =
-      [&pool](std::function<void()> c) { pool->Schedule(std::move(c)); };
+      [runner_threadpool](std::function<void()> c) {
+        runner_threadpool->Schedule(std::move(c));
+      };
   OpKernelContext::Params op_params =
       CreateParams(pflr.get(), device_mgr.get(), &runner);
   OpKernelContext ctx(&op_params, /*num_outputs=*/0);
@@ -118,7 +133,9 @@ Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
   core::ScopedUnref unref(finalized_dataset);
   *result = WrapUnique(new Dataset(finalized_dataset, device_mgr.release(),
                                    pflr.release(), flib_def.release(),
-                                   pool.release(), std::move(runner)));
+                                   pool.release(), runner_threadpool,
+                                   params.background_thread_pool,
+                                   std::move(runner)));
   return Status::OK();
 }  // static
 
@@ -140,8 +157,12 @@ Status Dataset::MakeIterator(
   params.resource_mgr = &resource_mgr_;
   std::move(split_providers.begin(), split_providers.end(),
             std::back_inserter(params.split_providers));
-  params.thread_factory = unbounded_thread_pool_.get_thread_factory();
-  params.thread_pool = &unbounded_thread_pool_;
+  params.thread_factory = background_thread_pool_->get_thread_factory();
+  params.thread_pool = background_thread_pool_;
+  if (!interop_threadpool_) {
+    // Size autotuned parallelism to the thread pool given by the caller.
+    params.runner_threadpool_size = runner_threadpool_->NumThreads();
+  }
   ctx = absl::make_unique<IteratorContext>(std::move(params));
 
   // Create the iterator from the dataset.
@@ -167,14 +188,20 @@ const DatasetBase* Dataset::Get() const { return dataset_; }
 Dataset::Dataset(DatasetBase* dataset, DeviceMgr* device_mgr,
                  ProcessFunctionLibraryRuntime* pflr,
                  FunctionLibraryDefinition* flib_def, thread::ThreadPool* pool,
+                 thread::ThreadPool* runner_threadpool,
+                 UnboundedThreadPool* background_thread_pool,
                  std::function<void(std::function<void()>)> runner)
     : dataset_(dataset),
       device_mgr_(device_mgr),
       flib_def_(flib_def),
       pflr_(pflr),
       interop_threadpool_(pool),
+      runner_threadpool_(runner_threadpool),
       runner_(std::move(runner)),
-      unbounded_thread_pool_(Env::Default(), "tf_data_standalone") {
+      unbounded_thread_pool_(Env::Default(), "tf_data_standalone"),
+      background_thread_pool_(background_thread_pool != nullptr
+                                  ? background_thread_pool
+                                  : &unbounded_thread_pool_) {
   dataset_->Ref();
   function_handle_cache_ =
       absl::make_unique<FunctionHandleCache>(pflr_->GetFLR("/device:CPU:0"));
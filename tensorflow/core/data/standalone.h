@@ -90,6 +90,18 @@ class Dataset {
   // Parameters for `Dataset` creation (e.g. TensorFlow runtime configuration).
   struct Params {
     SessionOptions session_options;
+    // If set, the ops of the dataset run on this thread pool instead of a
+    // thread pool created from `session_options`. Not owned, and must outlive
+    // the dataset.
+    thread::ThreadPool* thread_pool = nullptr;
+    // If set, the tensors of the dataset are allocated by this allocator
+    // instead of the default CPU allocator. Not owned, and must outlive the
+    // tensors produced by the dataset.
+    Allocator* allocator = nullptr;
+    // If set, the background threads of the dataset's iterators are started
+    // by this thread pool instead of one owned by the dataset. Not owned, and
+    // must outlive the dataset.
+    UnboundedThreadPool* background_thread_pool = nullptr;
   };
 
   // Creates a new `Dataset` instance by running the given dataset graph.
@@ -115,6 +127,8 @@ class Dataset {
   Dataset(DatasetBase* dataset, DeviceMgr* device_mgr,
           ProcessFunctionLibraryRuntime* pflr,
           FunctionLibraryDefinition* flib_def, thread::ThreadPool* pool,
+          thread::ThreadPool* runner_threadpool,
+          UnboundedThreadPool* background_thread_pool,
           std::function<void(std::function<void()>)> runner);
 
   DatasetBase* dataset_;  // owned
@@ -122,11 +136,14 @@ class Dataset {
   std::unique_ptr<FunctionLibraryDefinition> flib_def_;
   std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
   std::unique_ptr<thread::ThreadPool> interop_threadpool_;
+  thread::ThreadPool* runner_threadpool_;  // Not owned.
   std::unique_ptr<FunctionHandleCache> function_handle_cache_;
   std::function<void(std::function<void()>)> runner_;
   ResourceMgr resource_mgr_;
   CancellationManager cancellation_manager_;
   UnboundedThreadPool unbounded_thread_pool_;
+  // Either `unbounded_thread_pool_` or the pool given by the caller.
+  UnboundedThreadPool* background_thread_pool_;  // Not owned.
 };
 
 }  // namespace standalone
@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/data/standalone.h"
 
+#include <atomic>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -301,6 +306,48 @@ TEST(Scalar, Standalone) {
   }
 }
 
+// Counts the allocations served by the CPU allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocs;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  std::atomic<int64_t> num_allocs{0};
+};
+
+TEST(Scalar, CallerThreadPoolAndAllocator) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kMapGraphProto, &graph_def);
+  thread::ThreadPool pool(Env::Default(), "standalone_test", 2);
+  CountingAllocator allocator;
+  Dataset::Params params;
+  params.thread_pool = &pool;
+  params.allocator = &allocator;
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph(params, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+  bool end_of_input = false;
+  std::vector<int64_t> outputs;
+  while (true) {
+    std::vector<tensorflow::Tensor> element;
+    TF_ASSERT_OK(iterator->GetNext(&element, &end_of_input));
+    if (end_of_input) {
+      break;
+    }
+    outputs.push_back(element[0].scalar<int64_t>()());
+  }
+  EXPECT_EQ(outputs,
+            std::vector<int64_t>({0, 1, 4, 9, 16, 25, 36, 49, 64, 81}));
+  EXPECT_GT(allocator.num_allocs, 0);
+}
+
 }  // namespace
 }  // namespace standalone
 }  // namespace data
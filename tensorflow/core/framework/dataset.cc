@@ -414,6 +414,20 @@ Status IteratorBase::InitializeBase(IteratorContext* ctx,
   return Status::OK();
 }
 
+Status IteratorBase::GetNextN(IteratorContext* ctx, int max_elements,
+                              std::vector<std::vector<Tensor>>* out_elements,
+                              bool* end_of_sequence) {
+  *end_of_sequence = false;
+  for (int i = 0; i < max_elements && !*end_of_sequence; ++i) {
+    std::vector<Tensor> element;
+    TF_RETURN_IF_ERROR(GetNext(ctx, &element, end_of_sequence));
+    if (!*end_of_sequence) {
+      out_elements->push_back(std::move(element));
+    }
+  }
+  return Status::OK();
+}
+
 int64_t GetAllocatedBytes(const std::vector<Tensor>& element) {
   int64_t allocated_bytes = 0;
   DatasetBase* dataset;
@@ -972,6 +986,69 @@ Status DatasetBaseIterator::SkipInternal(IteratorContext* ctx, int num_to_skip,
   return Status::OK();
 }
 
+Status DatasetBaseIterator::GetNextN(
+    IteratorContext* ctx, int max_elements,
+    std::vector<std::vector<Tensor>>* out_elements, bool* end_of_sequence) {
+  profiler::TraceMe activity([&] { return BuildTraceMeName(); },
+                             profiler::TraceMeLevel::kInfo);
+  DVLOG(3) << prefix() << " GetNextN enter";
+  if (collect_resource_usage(ctx)) {
+    int64_t now_nanos = EnvTime::NowNanos();
+    auto output = node_->output();
+    if (output) {
+      output->record_stop(now_nanos);
+    }
+    node_->record_start(now_nanos);
+  }
+  const size_t num_existing_elements = out_elements->size();
+  *end_of_sequence = false;
+  Status s;
+  if (max_elements > 0) {
+    s = GetNextNInternal(ctx, max_elements, out_elements, end_of_sequence);
+  }
+  if (TF_PREDICT_TRUE(s.ok())) {
+    DCHECK(*end_of_sequence || out_elements->size() - num_existing_elements ==
+                                    static_cast<size_t>(max_elements));
+    for (size_t i = num_existing_elements; i < out_elements->size(); ++i) {
+      DCHECK_EQ((*out_elements)[i].size(),
+                dataset()->output_dtypes().size());
+      RecordElement(ctx, &(*out_elements)[i]);
+    }
+  }
+  if (collect_resource_usage(ctx)) {
+    int64_t now_nanos = EnvTime::NowNanos();
+    node_->record_stop(now_nanos);
+    auto output = node_->output();
+    if (output) {
+      output->record_start(now_nanos);
+    }
+  }
+  if (TF_PREDICT_FALSE(errors::IsOutOfRange(s))) {
+    s = errors::Internal("Iterator \"", params_.prefix,
+                         "\" returned `OutOfRange`. This indicates an "
+                         "implementation error as `OutOfRange` errors are not "
+                         "expected to be returned here. Original message: ",
+                         s.error_message());
+    LOG(ERROR) << s;
+  }
+  DVLOG(3) << prefix() << " GetNextN exit";
+  return s;
+}
+
+Status DatasetBaseIterator::GetNextNInternal(
+    IteratorContext* ctx, int max_elements,
+    std::vector<std::vector<Tensor>>* out_elements, bool* end_of_sequence) {
+  *end_of_sequence = false;
+  for (int i = 0; i < max_elements && !*end_of_sequence; ++i) {
+    std::vector<Tensor> element;
+    TF_RETURN_IF_ERROR(GetNextInternal(ctx, &element, end_of_sequence));
+    if (!*end_of_sequence) {
+      out_elements->push_back(std::move(element));
+    }
+  }
+  return Status::OK();
+}
+
 void DatasetOpKernel::Compute(OpKernelContext* ctx) {
   DatasetBase* dataset = nullptr;
   MakeDataset(ctx, &dataset);
@@ -727,6 +727,22 @@ class IteratorBase {
   virtual Status Skip(IteratorContext* ctx, int num_to_skip,
                       bool* end_of_sequence, int* num_skipped) = 0;
 
+  // Gets up to `max_elements` next outputs from the range that this iterator
+  // is traversing, appending them to `*out_elements`. Each appended output
+  // follows the contract of `GetNext`.
+  //
+  // If `false` is stored in `*end_of_sequence`, exactly `max_elements` outputs
+  // were appended. Otherwise, the end of the range was reached and fewer
+  // outputs, possibly none, may have been appended.
+  //
+  // The default implementation calls `GetNext` repeatedly. Iterators that can
+  // produce several outputs at a lower per-output cost override it.
+  //
+  // This method is thread-safe.
+  virtual Status GetNextN(IteratorContext* ctx, int max_elements,
+                          std::vector<std::vector<Tensor>>* out_elements,
+                          bool* end_of_sequence);
+
   // Returns a vector of DataType values, representing the respective
   // element types of each tuple component in the outputs of this
   // iterator.
@@ -1113,6 +1129,10 @@ class DatasetBaseIterator : public IteratorBase {
   Status Skip(IteratorContext* ctx, int num_to_skip, bool* end_of_sequence,
               int* num_skipped) final;
 
+  Status GetNextN(IteratorContext* ctx, int max_elements,
+                  std::vector<std::vector<Tensor>>* out_elements,
+                  bool* end_of_sequence) final;
+
   Status Save(SerializationContext* ctx, IteratorStateWriter* writer) final {
     VLOG(2) << "Attempting to save checkpoints on iterator (prefix: "
             << prefix() << ") from " << dataset()->DebugString();
@@ -1139,6 +1159,16 @@ class DatasetBaseIterator : public IteratorBase {
   virtual Status SkipInternal(IteratorContext* ctx, int num_to_skip,
                               bool* end_of_sequence, int* num_skipped);
 
+  // Internal implementation of GetNextN that is wrapped in tracing logic.
+  //
+  // See the docstring of `GetNextN` method regarding the contract for
+  // `out_elements` and `end_of_sequence`. The default implementation calls
+  // `GetNextInternal` repeatedly, which already saves the tracing and modeling
+  // overhead of `GetNext` for all but the first output.
+  virtual Status GetNextNInternal(
+      IteratorContext* ctx, int max_elements,
+      std::vector<std::vector<Tensor>>* out_elements, bool* end_of_sequence);
+
   string full_name(const string& name) const {
     return FullName(params_.prefix, name);
   }
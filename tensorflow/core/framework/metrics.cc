@@ -122,6 +122,12 @@ auto* tf_data_service_workers_created_counter =
     monitoring::Counter<0>::New("/tensorflow/data/service/workers_created",
                                 "Number of tf.data service workers created");
 
+auto* tf_data_service_additional_workers_gauge =
+    monitoring::Gauge<int64, 0>::New(
+        "/tensorflow/data/service/additional_workers",
+        "Number of workers to add for tf.data service consumers to stop "
+        "waiting for data.");
+
 auto* tf_data_filename_counter = monitoring::Counter<2>::New(
     "/tensorflow/data/filename", "The file name read by a tf.data Dataset.",
     "name", "filename");
@@ -266,6 +272,10 @@ void RecordTFDataServiceWorkerCreated() {
   tf_data_service_workers_created_counter->GetCell()->IncrementBy(1);
 }
 
+void RecordTFDataServiceAdditionalWorkers(int64_t num_workers) {
+  tf_data_service_additional_workers_gauge->GetCell()->Set(num_workers);
+}
+
 void RecordTFDataFilename(const string& name, const string& filename) {
   tf_data_filename_counter->GetCell(name, filename)->IncrementBy(1);
 }
@@ -97,6 +97,10 @@ void RecordTFDataOptimization(const string& name, int64_t num_changes);
 // Records that a tf.data service worker has been created.
 void RecordTFDataServiceWorkerCreated();
 
+// Records the number of workers the tf.data service dispatcher estimates
+// should be added for its jobs' consumers to stop waiting for data.
+void RecordTFDataServiceAdditionalWorkers(int64_t num_workers);
+
 // Records the file name read by a tf.data Dataset.
 //
 // The `name` argument identifies the Dataset type (e.g. "TFRecordDataset").
@@ -36,7 +36,7 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 18> kTFDataOptimizations = {
+constexpr std::array<const char*, 19> kTFDataOptimizations = {
     "noop_elimination",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
@@ -54,7 +54,8 @@ constexpr std::array<const char*, 18> kTFDataOptimizations = {
     "inject_prefetch",
     "disable_prefetch_legacy_autotune",
     "enable_gradient_descent",
-    "make_deterministic"};
+    "make_deterministic",
+    "preprocessing_fusion"};
 
 // Parses a list of string optimizer configurations into a map from
 // optimizer name -> rewriter config for that optimizer.
@@ -0,0 +1,53 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/preprocessing_fusion.h"
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/optimizers/remapper.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status PreprocessingFusion::OptimizeAndCollectStats(Cluster* cluster,
+                                                    const GrapplerItem& item,
+                                                    GraphDef* output,
+                                                    OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+
+  // The input pipeline graph itself only consists of dataset ops, so only
+  // the bodies of user-defined functions are optimized.
+  if (!graph_utils::IsItemDerivedFromFunctionDef(item, graph))
+    return Status::OK();
+
+  GraphDef optimized_graph;
+  int num_fusions;
+  TF_RETURN_IF_ERROR(
+      FusePreprocessingOps(item, &optimized_graph, &num_fusions));
+  stats->num_changes += num_fusions;
+  output->Swap(&optimized_graph);
+  return Status::OK();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(PreprocessingFusion, "preprocessing_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
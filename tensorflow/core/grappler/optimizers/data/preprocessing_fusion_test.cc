@@ -0,0 +1,115 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/preprocessing_fusion.h"
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem MakeNormalizeItem(const string& sink_op) {
+  using test::function::NDef;
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_UINT8}}),
+       NDef("offset", "Const", {},
+            {{"value", test::AsScalar<float>(127.5f)}, {"dtype", DT_FLOAT}}),
+       NDef("scale", "Const", {},
+            {{"value", test::AsScalar<float>(1.f / 127.5f)},
+             {"dtype", DT_FLOAT}}),
+       NDef("cast", "Cast", {"x"}, {{"SrcT", DT_UINT8}, {"DstT", DT_FLOAT}}),
+       NDef("sub", "Sub", {"cast", "offset"}, {{"T", DT_FLOAT}}),
+       NDef("mul", "Mul", {"sub", "scale"}, {{"T", DT_FLOAT}}),
+       NDef("Sink", sink_op, {"mul"}, {{"T", DT_FLOAT}})},
+      // FunctionLib
+      {});
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+class FromFunctionDef : public ::testing::TestWithParam<string> {};
+
+TEST_P(FromFunctionDef, PreprocessingFusionTest) {
+  const string op = GetParam();
+  bool from_function_def = (op == "_Retval");
+
+  GrapplerItem item = MakeNormalizeItem(op);
+  PreprocessingFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // Only the bodies of user-defined functions are optimized.
+  EXPECT_EQ(graph_utils::ContainsNodeWithOp("_FusedCastNormalize", output),
+            from_function_def);
+  EXPECT_EQ(graph_utils::ContainsGraphNodeWithName("cast", output),
+            !from_function_def);
+  EXPECT_EQ(graph_utils::ContainsGraphNodeWithName("sub", output),
+            !from_function_def);
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("mul", output));
+  if (from_function_def) {
+    const NodeDef& fused =
+        output.node(graph_utils::FindGraphNodeWithName("mul", output));
+    ASSERT_EQ(fused.input_size(), 3);
+    EXPECT_EQ(fused.input(0), "x");
+    EXPECT_EQ(fused.input(1), "offset");
+    EXPECT_EQ(fused.input(2), "scale");
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, FromFunctionDef,
+                         ::testing::Values("Identity", "_Retval"));
+
+TEST(PreprocessingFusionTest, CountsFusions) {
+  GrapplerItem item = MakeNormalizeItem("_Retval");
+  PreprocessingFusion optimizer;
+  GraphDef output;
+  PreprocessingFusion::OptimizationStats stats;
+  TF_ASSERT_OK(
+      optimizer.OptimizeAndCollectStats(nullptr, item, &output, &stats));
+  // Cast+Sub+Mul is one fusion, although it removes two nodes.
+  EXPECT_EQ(stats.num_changes, 1);
+}
+
+TEST(PreprocessingFusionTest, SkipsOtherRemapperFusions) {
+  using test::function::NDef;
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("y", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("bias", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("matmul", "MatMul", {"x", "y"}, {{"T", DT_FLOAT}}),
+       NDef("bias_add", "BiasAdd", {"matmul", "bias"}, {{"T", DT_FLOAT}}),
+       NDef("Sink", "_Retval", {"bias_add"}, {{"T", DT_FLOAT}})},
+      // FunctionLib
+      {});
+  item.fetch.push_back("Sink");
+  item.optimization_options().allow_non_differentiable_rewrites = true;
+  PreprocessingFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("matmul", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("_FusedMatMul", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
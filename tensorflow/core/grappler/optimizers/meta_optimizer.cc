@@ -41,10 +41,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimization_cache.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/shape_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/static_scheduler.h"
 #include "tensorflow/core/grappler/utils/canonicalizer.h"
 #include "tensorflow/core/grappler/utils/colocation.h"
 #include "tensorflow/core/grappler/utils/functions.h"
@@ -239,6 +241,7 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("static_scheduler", "static_scheduling", new StaticScheduler());
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -372,6 +375,10 @@ Status MetaOptimizer::InitializeOptimizers(
         cfg_.scoped_allocator_optimization(), cfg_.scoped_allocator_opts()));
   }
 #endif
+  // The schedule depends on the final graph, so this must run last.
+  if (BOTH_ARE_ON(static_scheduling)) {
+    optimizers->push_back(MakeUnique<StaticScheduler>());
+  }
 
 #undef USER_IS_ON
 #undef USER_NOT_OFF
@@ -513,6 +520,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(static_scheduling)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -557,6 +565,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("static_scheduler", "static_scheduling")
 #undef PRINT_CFG
     }
   }
@@ -589,7 +598,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "pin_to_host_optimization" ||
-        pair.first == "scoped_allocator_optimization") {
+        pair.first == "scoped_allocator_optimization" ||
+        pair.first == "static_scheduling") {
       // These optimizers are turned off by default.
       strings::StrAppend(
           &logs, pair.first, string(32 - pair.first.size(), ' '),
@@ -918,6 +928,23 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       "Deleted $0 unreachable functions from the graph (library size = $1)",
       old_library_size - new_library_size, new_library_size);
 
+  // Serve the optimized graph from the optimization cache if this item was
+  // optimized before with the same configuration.
+  std::unique_ptr<OptimizationCache> cache;
+  string cache_key;
+  if (!cfg_.experimental_optimization_cache_dir().empty()) {
+    cache = absl::make_unique<OptimizationCache>(
+        cfg_.experimental_optimization_cache_dir());
+    cache_key = OptimizationCache::Key(item, cluster, config_proto_);
+    if (cache->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Found optimized graph for grappler item " << item.id
+              << " in the optimization cache (key = " << cache_key << ")";
+      metrics::UpdateGrapplerPassTime("*",
+                                      Env::Default()->NowMicros() - start_us);
+      return Status::OK();
+    }
+  }
+
   // Save a few small fields from item before we move it.
   bool optimize_function_library =
       item.optimization_options().optimize_function_library;
@@ -1126,6 +1153,14 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
         *optimized_graph);
   }
 
+  if (cache) {
+    Status s = cache->Insert(cache_key, *optimized_graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to add the optimized graph to the optimization "
+                   << "cache (key = " << cache_key << "): " << s;
+    }
+  }
+
   const uint64 end_us = Env::Default()->NowMicros();
   metrics::UpdateGrapplerPassTime("*", end_us - start_us);
 
@@ -1170,6 +1205,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.static_scheduling() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          !rewrite_cfg.optimizers().empty() ||
@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimization_cache.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr char kEntrySuffix[] = ".graph.pb";
+
+void AppendProto(const protobuf::MessageLite& proto, string* key_material) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  absl::StrAppend(key_material, serialized.size(), ":", serialized);
+}
+
+void AppendStrings(std::vector<string> strings, string* key_material) {
+  std::sort(strings.begin(), strings.end());
+  absl::StrAppend(key_material, strings.size(), ":");
+  for (const string& s : strings) {
+    absl::StrAppend(key_material, s.size(), ":", s);
+  }
+}
+
+}  // namespace
+
+OptimizationCache::OptimizationCache(const string& cache_dir)
+    : cache_dir_(cache_dir) {}
+
+string OptimizationCache::Key(const GrapplerItem& item, const Cluster* cluster,
+                              const ConfigProto& config) {
+  string key_material =
+      absl::StrCat(TF_VERSION_STRING, ";", tf_git_version(), ";",
+                   TF_GRAPH_DEF_VERSION, ";");
+
+  // The graph dominates the size of the key material, so it contributes its
+  // fingerprint rather than its contents.
+  string serialized_graph;
+  SerializeToStringDeterministic(item.graph, &serialized_graph);
+  const Fprint128 graph_fingerprint = Fingerprint128(serialized_graph);
+  absl::StrAppend(&key_material, graph_fingerprint.low64, ",",
+                  graph_fingerprint.high64, ";");
+
+  std::vector<string> feeds;
+  for (const auto& feed : item.feed) {
+    feeds.push_back(absl::StrCat(feed.first, "/",
+                                 DataTypeString(feed.second.dtype()),
+                                 feed.second.shape().DebugString()));
+  }
+  AppendStrings(feeds, &key_material);
+  AppendStrings(item.fetch, &key_material);
+  AppendStrings(item.init_ops, &key_material);
+  AppendStrings(item.keep_ops, &key_material);
+  absl::StrAppend(&key_material, item.save_op, ";", item.restore_op, ";",
+                  item.save_restore_loc_tensor, ";");
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AppendProto(queue_runner, &key_material);
+  }
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  absl::StrAppend(&key_material, options.allow_non_differentiable_rewrites,
+                  options.allow_pruning_stateful_and_dataset_ops,
+                  options.optimize_function_library, options.is_eager_mode,
+                  ";");
+  AppendStrings(std::vector<string>(item.devices().begin(),
+                                    item.devices().end()),
+                &key_material);
+
+  if (cluster != nullptr) {
+    // Sort devices by name, so that the key does not depend on hash map
+    // iteration order.
+    const std::map<string, DeviceProperties> devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    for (const auto& device : devices) {
+      absl::StrAppend(&key_material, device.first, ";");
+      AppendProto(device.second, &key_material);
+    }
+  }
+
+  // The location of the cache does not affect the optimized graph.
+  ConfigProto config_copy = config;
+  config_copy.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_experimental_optimization_cache_dir();
+  AppendProto(config_copy, &key_material);
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return strings::Printf("%016llx%016llx",
+                         static_cast<unsigned long long>(fingerprint.high64),
+                         static_cast<unsigned long long>(fingerprint.low64));
+}
+
+bool OptimizationCache::Lookup(const string& key,
+                               GraphDef* optimized_graph) const {
+  const string path = EntryPath(key);
+  if (!Env::Default()->FileExists(path).ok()) {
+    return false;
+  }
+  Status s = ReadBinaryProto(Env::Default(), path, optimized_graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read optimization cache entry " << path << ": "
+                 << s;
+    optimized_graph->Clear();
+    return false;
+  }
+  return true;
+}
+
+Status OptimizationCache::Insert(const string& key,
+                                 const GraphDef& optimized_graph) const {
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(cache_dir_));
+  const string path = EntryPath(key);
+  // Write to a uniquely named temporary file first, so that concurrent readers
+  // never see a partially written entry.
+  string tmp_path = path;
+  if (!Env::Default()->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            path);
+  }
+  Status s = WriteBinaryProto(Env::Default(), tmp_path, optimized_graph);
+  if (s.ok()) {
+    s = Env::Default()->RenameFile(tmp_path, path);
+  }
+  if (!s.ok()) {
+    Env::Default()->DeleteFile(tmp_path).IgnoreError();
+  }
+  return s;
+}
+
+string OptimizationCache::EntryPath(const string& key) const {
+  return io::JoinPath(cache_dir_, absl::StrCat(key, kEntrySuffix));
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,60 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZATION_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZATION_CACHE_H_
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// On-disk cache of graphs optimized by the meta optimizer.
+//
+// Entries are keyed by a fingerprint of everything the optimized graph depends
+// on: the input item, the available devices, the session config (including
+// the RewriterConfig) and the TensorFlow version. Entries are written
+// atomically, so processes sharing a cache directory, e.g. the workers of a
+// job, may populate and read it concurrently.
+class OptimizationCache {
+ public:
+  explicit OptimizationCache(const string& cache_dir);
+
+  // Returns the cache key for optimizing `item` on `cluster` (which may be
+  // null) with `config`.
+  static string Key(const GrapplerItem& item, const Cluster* cluster,
+                    const ConfigProto& config);
+
+  // Reads the optimized graph cached for `key` into `optimized_graph`.
+  // Returns false if there is no such entry.
+  bool Lookup(const string& key, GraphDef* optimized_graph) const;
+
+  // Caches `optimized_graph` for `key`.
+  Status Insert(const string& key, const GraphDef& optimized_graph) const;
+
+ private:
+  string EntryPath(const string& key) const;
+
+  const string cache_dir_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZATION_CACHE_H_
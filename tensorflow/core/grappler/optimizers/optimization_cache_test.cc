@@ -0,0 +1,121 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimization_cache.h"
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem TestItem() {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"/device:CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+string NewCacheDir(const string& name) {
+  const string cache_dir = io::JoinPath(testing::TmpDir(), name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return cache_dir;
+}
+
+TEST(OptimizationCacheTest, KeyIsDeterministic) {
+  const GrapplerItem item = TestItem();
+  ConfigProto config;
+  EXPECT_EQ(OptimizationCache::Key(item, nullptr, config),
+            OptimizationCache::Key(TestItem(), nullptr, config));
+}
+
+TEST(OptimizationCacheTest, KeyDependsOnGraph) {
+  const GrapplerItem item = TestItem();
+  GrapplerItem other_item = item;
+  other_item.graph.mutable_node(0)->set_name("renamed");
+  ConfigProto config;
+  EXPECT_NE(OptimizationCache::Key(item, nullptr, config),
+            OptimizationCache::Key(other_item, nullptr, config));
+}
+
+TEST(OptimizationCacheTest, KeyDependsOnFetchesAndDevices) {
+  const GrapplerItem item = TestItem();
+  ConfigProto config;
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch.push_back("other");
+  EXPECT_NE(OptimizationCache::Key(item, nullptr, config),
+            OptimizationCache::Key(other_fetch, nullptr, config));
+
+  GrapplerItem other_devices = item;
+  TF_ASSERT_OK(other_devices.AddDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0"));
+  EXPECT_NE(OptimizationCache::Key(item, nullptr, config),
+            OptimizationCache::Key(other_devices, nullptr, config));
+}
+
+TEST(OptimizationCacheTest, KeyDependsOnConfigButNotCacheDir) {
+  const GrapplerItem item = TestItem();
+  ConfigProto config;
+  ConfigProto other_config;
+  other_config.mutable_graph_options()->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(OptimizationCache::Key(item, nullptr, config),
+            OptimizationCache::Key(item, nullptr, other_config));
+
+  ConfigProto cache_config;
+  cache_config.mutable_graph_options()->mutable_rewrite_options()
+      ->set_experimental_optimization_cache_dir("/some/dir");
+  EXPECT_EQ(OptimizationCache::Key(item, nullptr, config),
+            OptimizationCache::Key(item, nullptr, cache_config));
+}
+
+TEST(OptimizationCacheTest, InsertAndLookup) {
+  OptimizationCache cache(NewCacheDir("insert_and_lookup"));
+  const GrapplerItem item = TestItem();
+  const string key = OptimizationCache::Key(item, nullptr, ConfigProto());
+
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(key, &graph));
+
+  TF_ASSERT_OK(cache.Insert(key, item.graph));
+  ASSERT_TRUE(cache.Lookup(key, &graph));
+  EXPECT_EQ(graph.SerializeAsString(), item.graph.SerializeAsString());
+  EXPECT_FALSE(cache.Lookup("other_key", &graph));
+}
+
+TEST(OptimizationCacheTest, SharedCacheDirectory) {
+  const string cache_dir = NewCacheDir("shared");
+  const GrapplerItem item = TestItem();
+  const string key = OptimizationCache::Key(item, nullptr, ConfigProto());
+  TF_ASSERT_OK(OptimizationCache(cache_dir).Insert(key, item.graph));
+
+  GraphDef graph;
+  ASSERT_TRUE(OptimizationCache(cache_dir).Lookup(key, &graph));
+  EXPECT_EQ(graph.node_size(), item.graph.node_size());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -68,15 +68,25 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedCastNormalize[] = "_FusedCastNormalize";
+constexpr char kFusedTransposeCast[] = "_FusedTransposeCast";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
 
 constexpr char kWidth[] = "width";
 constexpr char kFill[] = "fill";
+constexpr char kTruncate[] = "Truncate";
+constexpr char kNumBuckets[] = "num_buckets";
 
 constexpr int kMissingIndex = -1;
 
+// Maximum number of elementwise ops fused into a _FusedCastNormalize.
+constexpr int kMaxCastNormalizeOps = 8;
+
+// Maximum input rank supported by the _FusedTransposeCast kernel.
+constexpr int kMaxTransposeCastRank = 5;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status,
                            RewriterConfig::CpuLayout cpu_layout_conversion,
@@ -94,6 +104,9 @@ struct RemapperContext {
   bool inferred_graph_properties;
   RewriterConfig::CpuLayout cpu_layout_conversion;
   bool xla_auto_clustering_on;
+  // Whether nodes without a device run on CPU, e.g. in the bodies of tf.data
+  // functions. Otherwise CPU-only fusions require nodes placed on CPU.
+  bool unplaced_nodes_on_cpu = false;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -138,6 +151,33 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Cast followed by a chain of Add/Sub/Mul/RealDiv by constants, e.g. the
+// normalization of decoded images, that can be replaced with a
+// _FusedCastNormalize.
+struct CastNormalize {
+  int cast = kMissingIndex;
+  // Binary ops in the order they are applied, and the regular fanin port of
+  // their constant operand.
+  std::vector<int> ops;
+  std::vector<int> arg_ports;
+};
+
+// StringToHashBucketFast (or _TensorToHashBucketFast) followed by a Mod whose
+// divisor divides the number of buckets, i.e. the hash can be computed modulo
+// the divisor directly.
+struct HashBucketWithMod {
+  int hash_bucket = kMissingIndex;
+  int mod = kMissingIndex;
+  int64_t num_buckets = 0;
+};
+
+// Transpose followed by a widening Cast, that can be replaced with a
+// _FusedTransposeCast.
+struct TransposeWithCast {
+  int transpose = kMissingIndex;
+  int cast = kMissingIndex;
+};
+
 // Contraction node followed by a BiasAdd.
 struct ContractionWithBiasAdd {
   ContractionWithBiasAdd() = default;
@@ -1173,6 +1213,224 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsCastNormalizeOp(const NodeDef& node) {
+  return IsAdd(node) || IsSub(node) || IsMul(node) || IsRealDiv(node);
+}
+
+bool IsOnCpu(const RemapperContext& ctx, const NodeDef& node) {
+  return NodeIsOnCpu(&node) ||
+         (ctx.unplaced_nodes_on_cpu && node.device().empty());
+}
+
+bool IsCastNormalizeSrcType(DataType dtype) {
+  switch (dtype) {
+    case DT_UINT8:
+    case DT_INT8:
+    case DT_UINT16:
+    case DT_INT16:
+    case DT_INT32:
+    case DT_INT64:
+    case DT_HALF:
+    case DT_BFLOAT16:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the rank of the value of a Const node, or -1 if `node` is not a
+// Const.
+int ConstRank(const NodeDef& node) {
+  if (!IsConstant(node)) return -1;
+  const auto it = node.attr().find("value");
+  if (it == node.attr().end()) return -1;
+  return it->second.tensor().tensor_shape().dim_size();
+}
+
+// Returns the regular fanin port of the constant scalar or vector operand of a
+// cast-normalize op, or kMissingIndex if there is none. The constant of Sub and
+// RealDiv must be the second operand.
+int FindCastNormalizeArgPort(const utils::MutableNodeView& node_view) {
+  const NodeDef* node_def = node_view.node();
+  const bool is_commutative = IsAdd(*node_def) || IsMul(*node_def);
+  for (int port = 1; port >= (is_commutative ? 0 : 1); --port) {
+    const NodeDef* arg = node_view.GetRegularFanin(port).node_view()->node();
+    const int rank = ConstRank(*arg);
+    if (rank == 0 || rank == 1) return port;
+  }
+  return kMissingIndex;
+}
+
+bool FindCastNormalize(const RemapperContext& ctx, int node_index,
+                       CastNormalize* matched) {
+  // Root of the pattern must be the last Add/Sub/Mul/RealDiv of the chain.
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  if (!IsCastNormalizeOp(*root_def) || !IsOnCpu(ctx, *root_def) ||
+      (!HasDataType(root_def, DT_FLOAT) && !HasDataType(root_def, DT_DOUBLE)))
+    return false;
+
+  std::vector<int> ops;
+  std::vector<int> arg_ports;
+  const auto* node_view = root_view;
+  while (true) {
+    const auto* node_def = node_view->node();
+    if (!IsCastNormalizeOp(*node_def) || node_view->NumRegularFanins() != 2 ||
+        HasControlFaninOrFanout(*node_view) ||
+        node_def->device() != root_def->device() ||
+        !HaveSameDataType(node_def, root_def))
+      return false;
+    // Intermediate results must not be used outside of the chain.
+    if (node_view != root_view && (!HasAtMostOneFanoutAtPort0(*node_view) ||
+                                   IsInPreserveSet(ctx, node_def)))
+      return false;
+
+    const int arg_port = FindCastNormalizeArgPort(*node_view);
+    if (arg_port == kMissingIndex) return false;
+    ops.push_back(node_view->node_index());
+    arg_ports.push_back(arg_port);
+
+    const auto* input_view =
+        node_view->GetRegularFanin(1 - arg_port).node_view();
+    if (IsCast(*input_view->node())) {
+      node_view = input_view;
+      break;
+    }
+    if (ops.size() == kMaxCastNormalizeOps) return false;
+    node_view = input_view;
+  }
+
+  const auto* cast_def = node_view->node();
+  bool truncate = false;
+  if (HasControlFaninOrFanout(*node_view) ||
+      !HasAtMostOneFanoutAtPort0(*node_view) ||
+      IsInPreserveSet(ctx, cast_def) ||
+      cast_def->device() != root_def->device() ||
+      node_view->NumRegularFanins() < 1 ||
+      GetDataTypeFromAttr(*cast_def, "DstT") !=
+          GetDataTypeFromAttr(*root_def, "T") ||
+      !IsCastNormalizeSrcType(GetDataTypeFromAttr(*cast_def, "SrcT")) ||
+      (TryGetNodeAttr(*cast_def, kTruncate, &truncate) && truncate))
+    return false;
+
+  // Vector operands are only fused if they broadcast along the innermost
+  // dimension of the input, which requires the input shape.
+  int64_t num_channels = -1;
+  for (int i = 0; i < ops.size(); ++i) {
+    const auto* op_view = ctx.graph_view.GetNode(ops[i]);
+    const NodeDef* arg =
+        op_view->GetRegularFanin(arg_ports[i]).node_view()->node();
+    if (ConstRank(*arg) == 0) continue;
+    if (num_channels < 0) {
+      if (!ctx.inferred_graph_properties) return false;
+      const auto& props =
+          ctx.graph_properties.GetInputProperties(cast_def->name());
+      if (props.empty() || props[0].shape().unknown_rank() ||
+          props[0].shape().dim_size() == 0)
+        return false;
+      const auto& shape = props[0].shape();
+      num_channels = shape.dim(shape.dim_size() - 1).size();
+      if (num_channels < 0) return false;
+    }
+    const auto& arg_shape = arg->attr().at("value").tensor().tensor_shape();
+    if (arg_shape.dim(0).size() != num_channels) return false;
+  }
+
+  // Ops were collected from the root towards the Cast.
+  matched->cast = node_view->node_index();
+  matched->ops.assign(ops.rbegin(), ops.rend());
+  matched->arg_ports.assign(arg_ports.rbegin(), arg_ports.rend());
+
+  return true;
+}
+
+bool FindHashBucketWithMod(const RemapperContext& ctx, int node_index,
+                           HashBucketWithMod* matched) {
+  // Root of the pattern must be a Mod/FloorMod/TruncateMod.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!(IsMod(*node_def) || IsFloorMod(*node_def) ||
+        IsTruncateMod(*node_def)) ||
+      !HasDataType(node_def, DT_INT64) || HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2)
+    return false;
+
+  const auto* hash_view = node_view->GetRegularFanin(0).node_view();
+  const auto* hash_def = hash_view->node();
+  if (!(IsStringToHashBucketFast(*hash_def) ||
+        hash_def->op() == kTensorToHashBucket) ||
+      HasControlFaninOrFanout(*hash_view) ||
+      !HasAtMostOneFanoutAtPort0(*hash_view) || IsInPreserveSet(ctx, hash_def))
+    return false;
+
+  // The divisor must be a positive scalar constant.
+  const auto* divisor_def = node_view->GetRegularFanin(1).node_view()->node();
+  Tensor divisor;
+  if (ConstRank(*divisor_def) != 0 ||
+      !GetNodeAttr(*divisor_def, "value", &divisor).ok() ||
+      divisor.dtype() != DT_INT64)
+    return false;
+  const int64_t num_buckets = divisor.scalar<int64_t>()();
+
+  // Hash buckets are non-negative, so all kinds of Mod agree, and
+  // (hash % n) % m == hash % m if m divides n.
+  int64_t hash_num_buckets;
+  if (num_buckets <= 0 ||
+      !TryGetNodeAttr(*hash_def, kNumBuckets, &hash_num_buckets) ||
+      hash_num_buckets % num_buckets != 0)
+    return false;
+
+  matched->hash_bucket = hash_view->node_index();
+  matched->mod = node_index;
+  matched->num_buckets = num_buckets;
+
+  return true;
+}
+
+bool FindTransposeWithCast(const RemapperContext& ctx, int node_index,
+                           TransposeWithCast* matched) {
+  // Root of the pattern must be a widening Cast to float.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  bool truncate = false;
+  if (!IsCast(*node_def) || !IsOnCpu(ctx, *node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() < 1 ||
+      !HasDataType(node_def, DT_FLOAT, "DstT") ||
+      (TryGetNodeAttr(*node_def, kTruncate, &truncate) && truncate))
+    return false;
+  const DataType src_dtype = GetDataTypeFromAttr(*node_def, "SrcT");
+  if (src_dtype == DT_FLOAT || src_dtype == DT_DOUBLE ||
+      !IsCastNormalizeSrcType(src_dtype))
+    return false;
+
+  const auto* transpose_view = node_view->GetRegularFanin(0).node_view();
+  const auto* transpose_def = transpose_view->node();
+  if (!IsTranspose(*transpose_def) ||
+      HasControlFaninOrFanout(*transpose_view) ||
+      !HasAtMostOneFanoutAtPort0(*transpose_view) ||
+      IsInPreserveSet(ctx, transpose_def) ||
+      transpose_def->device() != node_def->device() ||
+      transpose_view->NumRegularFanins() != 2)
+    return false;
+
+  // The fused kernel only supports inputs of rank up to
+  // kMaxTransposeCastRank, so the rank must be known statically.
+  if (!ctx.inferred_graph_properties) return false;
+  const auto& props =
+      ctx.graph_properties.GetInputProperties(transpose_def->name());
+  if (props.empty() || props[0].shape().unknown_rank() ||
+      props[0].shape().dim_size() > kMaxTransposeCastRank)
+    return false;
+
+  matched->transpose = transpose_view->node_index();
+  matched->cast = node_index;
+
+  return true;
+}
+
 void CopyConv2DAttributes(const NodeDef& conv2d, NodeDef* fused_conv2d,
                           const NodeDef* activation = nullptr) {
   DCHECK(IsConv2D(conv2d)) << "Input node must be a Conv2D";
@@ -1976,6 +2234,111 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddFusedCastNormalizeNode(RemapperContext* ctx,
+                                 const CastNormalize& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& cast = graph->node(matched.cast);
+  const NodeDef& root = graph->node(matched.ops.back());
+  VLOG(2) << "Fuse Cast with " << matched.ops.size()
+          << " elementwise ops: cast=" << cast.name()
+          << " root=" << root.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedCastNormalize);
+  fused_op.set_device(root.device());
+  fused_op.add_input(cast.input(0));  // 0: x
+
+  auto* attr = fused_op.mutable_attr();
+  std::vector<string> fused_ops;
+  for (int i = 0; i < matched.ops.size(); ++i) {
+    const NodeDef& op = graph->node(matched.ops[i]);
+    fused_op.add_input(op.input(matched.arg_ports[i]));  // 1...: args
+    fused_ops.push_back(op.op());
+  }
+  (*attr)["SrcT"] = cast.attr().at("SrcT");
+  (*attr)["DstT"] = cast.attr().at("DstT");
+  SetAttrValue(static_cast<int64_t>(matched.ops.size()), &(*attr)["num_args"]);
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.ops.back()] = true;
+  (*nodes_to_delete)[matched.cast] = true;
+  for (int i = 0; i + 1 < matched.ops.size(); ++i) {
+    (*nodes_to_delete)[matched.ops[i]] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddHashBucketWithModNode(RemapperContext* ctx,
+                                const HashBucketWithMod& matched,
+                                std::vector<bool>* invalidated_nodes,
+                                std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& hash_bucket = graph->node(matched.hash_bucket);
+  const NodeDef& mod = graph->node(matched.mod);
+  VLOG(2) << "Fuse " << hash_bucket.op() << " with " << mod.op() << ":"
+          << " hash_bucket=" << hash_bucket.name() << " mod=" << mod.name()
+          << " num_buckets=" << matched.num_buckets;
+
+  NodeDef fused_op = hash_bucket;
+  fused_op.set_name(mod.name());
+  SetAttrValue(matched.num_buckets, &(*fused_op.mutable_attr())[kNumBuckets]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.mod] = true;
+  (*nodes_to_delete)[matched.hash_bucket] = true;
+
+  return Status::OK();
+}
+
+Status AddFusedTransposeCastNode(RemapperContext* ctx,
+                                 const TransposeWithCast& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& transpose = graph->node(matched.transpose);
+  const NodeDef& cast = graph->node(matched.cast);
+  VLOG(2) << "Fuse Transpose with Cast: transpose=" << transpose.name()
+          << " cast=" << cast.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(cast.name());
+  fused_op.set_op(kFusedTransposeCast);
+  fused_op.set_device(cast.device());
+  fused_op.add_input(transpose.input(0));  // 0: x
+  fused_op.add_input(transpose.input(1));  // 1: perm
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["SrcT"] = cast.attr().at("SrcT");
+  (*attr)["DstT"] = cast.attr().at("DstT");
+  (*attr)["Tperm"] = transpose.attr().at("Tperm");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.cast] = true;
+  (*nodes_to_delete)[matched.transpose] = true;
+
+  return Status::OK();
+}
+
 bool IsConv2DOrMatMul(const NodeDef& node) {
   return IsConv2D(node) || IsMatMul(node);
 }
@@ -2114,17 +2477,129 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for a Cast+Add/Sub/Mul/RealDiv fusion with per-channel operands.
+  const auto is_cast_normalize_candidate = [&]() -> bool {
+    const auto* op_view = node_view;
+    for (int i = 0; i < kMaxCastNormalizeOps; ++i) {
+      if (!IsCastNormalizeOp(*op_view->node()) ||
+          op_view->NumRegularFanins() != 2)
+        return false;
+      const int arg_port = FindCastNormalizeArgPort(*op_view);
+      if (arg_port == kMissingIndex) return false;
+      const auto* arg = op_view->GetRegularFanin(arg_port).node_view()->node();
+      if (ConstRank(*arg) == 1) return true;
+      op_view = op_view->GetRegularFanin(1 - arg_port).node_view();
+    }
+    return false;
+  };
+
+  // Candidate for a Transpose+Cast fusion, which needs the input rank.
+  const auto is_transpose_cast_candidate = [&]() -> bool {
+    if (!IsCast(*node_def) || node_view->NumRegularFanins() < 1) return false;
+    return IsTranspose(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
-           IsContractionWithAdd(ctx, node_index);
+           IsContractionWithAdd(ctx, node_index) ||
+           is_cast_normalize_candidate() || is_transpose_cast_candidate();
 
   return is_relu_biasadd_conv2d_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
-         is_batch_norm_grad_fusion_candidate();
+         is_batch_norm_grad_fusion_candidate() ||
+         is_cast_normalize_candidate() || is_transpose_cast_candidate();
+}
+
+// Applies the fusions of elementwise input-preprocessing ops whose root is
+// node `node_index`, and sets `fused` if one of them matched.
+Status TryFusePreprocessingOps(RemapperContext* ctx, int node_index,
+                               bool allow_non_differentiable_rewrites,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete,
+                               bool* fused) {
+  *fused = true;
+
+  // Remap Cast+{Add,Sub,Mul,RealDiv}* into the _FusedCastNormalize.
+  CastNormalize cast_normalize;
+  if (allow_non_differentiable_rewrites &&
+      FindCastNormalize(*ctx, node_index, &cast_normalize)) {
+    return AddFusedCastNormalizeNode(ctx, cast_normalize, invalidated_nodes,
+                                     nodes_to_delete);
+  }
+
+  // Remap StringToHashBucketFast+Mod into a StringToHashBucketFast.
+  HashBucketWithMod hash_bucket_with_mod;
+  if (FindHashBucketWithMod(*ctx, node_index, &hash_bucket_with_mod)) {
+    return AddHashBucketWithModNode(ctx, hash_bucket_with_mod,
+                                    invalidated_nodes, nodes_to_delete);
+  }
+
+  // Remap Transpose+Cast into the _FusedTransposeCast.
+  TransposeWithCast transpose_with_cast;
+  if (allow_non_differentiable_rewrites &&
+      FindTransposeWithCast(*ctx, node_index, &transpose_with_cast)) {
+    return AddFusedTransposeCastNode(ctx, transpose_with_cast,
+                                     invalidated_nodes, nodes_to_delete);
+  }
+
+  *fused = false;
+  return Status::OK();
 }
 
 }  // namespace
 
+Status FusePreprocessingOps(const GrapplerItem& item,
+                            GraphDef* optimized_graph, int* num_fusions) {
+  GrapplerItem mutable_item = item;
+  Status status;
+  RemapperContext ctx(&mutable_item, &status,
+                      RewriterConfig::NO_CONVERSION_ON_CPU,
+                      /*xla_auto_clustering_on=*/false);
+  TF_RETURN_IF_ERROR(status);
+  ctx.unplaced_nodes_on_cpu = true;
+  TF_RETURN_IF_ERROR(
+      ctx.graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+
+  const int num_nodes = item.graph.node_size();
+  std::vector<bool> invalidated_nodes(num_nodes);
+  std::vector<bool> nodes_to_delete(num_nodes);
+  const bool allow_non_differentiable_rewrites =
+      item.optimization_options().allow_non_differentiable_rewrites;
+
+  *num_fusions = 0;
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    if (invalidated_nodes[i] || nodes_to_delete[i]) {
+      continue;
+    }
+
+    if (!ctx.inferred_graph_properties && RequiresInferredShapes(ctx, i)) {
+      TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+          /*assume_valid_feeds=*/false,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/true,
+          /*include_output_tensor_values=*/false));
+      ctx.inferred_graph_properties = true;
+    }
+
+    bool fused;
+    TF_RETURN_IF_ERROR(TryFusePreprocessingOps(
+        &ctx, i, allow_non_differentiable_rewrites, &invalidated_nodes,
+        &nodes_to_delete, &fused));
+    if (fused) ++*num_fusions;
+  }
+
+  utils::Mutation* mutation = ctx.graph_view.GetMutationBuilder();
+  for (int i = 0; i < num_nodes; ++i) {
+    if (nodes_to_delete[i]) {
+      mutation->RemoveNode(ctx.graph_view.GetNode(i));
+    }
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  *optimized_graph = std::move(mutable_item.graph);
+  return Status::OK();
+}
+
 Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
                           GraphDef* optimized_graph) {
   GrapplerItem mutable_item = item;
@@ -2283,6 +2758,12 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    bool fused_preprocessing_ops;
+    TF_RETURN_IF_ERROR(TryFusePreprocessingOps(
+        &ctx, i, allow_non_differentiable_rewrites, &invalidated_nodes,
+        &nodes_to_delete, &fused_preprocessing_ops));
+    if (fused_preprocessing_ops) continue;
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -49,6 +49,14 @@ class Remapper : public GraphOptimizer {
   bool xla_auto_clustering_on_;
 };
 
+// Applies only the fusions of elementwise input-preprocessing ops, which have
+// CPU kernels only, to `item`: Cast followed by normalization, hashing followed
+// by Mod, and Transpose followed by Cast. Nodes without a device are assumed to
+// run on CPU, as in the bodies of tf.data functions. Sets `num_fusions` to the
+// number of fused patterns.
+Status FusePreprocessingOps(const GrapplerItem& item,
+                            GraphDef* optimized_graph, int* num_fusions);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -754,6 +754,309 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseCastNormalize) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({2, 4, 4, 3});
+  auto input = Placeholder(s.WithOpName("input"), DT_UINT8, input_shape);
+  auto mean = ops::Const(s.WithOpName("mean"), {123.f, 117.f, 104.f}, {3});
+  auto scale = ops::Const(s.WithOpName("scale"), 1.f / 58.f);
+  auto two = ops::Const(s.WithOpName("two"), 2.f);
+
+  auto cast = ops::Cast(s.WithOpName("cast"), input, DT_FLOAT);
+  auto sub = ops::Sub(s.WithOpName("sub"), cast, mean);
+  auto mul = ops::Mul(s.WithOpName("mul"), scale, sub);
+  auto div = ops::RealDiv(s.WithOpName("div"), mul, two);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), div);
+
+  auto input_t = GenerateRandomTensor<DT_UINT8>({2, 4, 4, 3});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "cast");
+    EXPECT_NE(node.name(), "sub");
+    EXPECT_NE(node.name(), "mul");
+    if (node.name() == "div") {
+      EXPECT_EQ(node.op(), "_FusedCastNormalize");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "mean");
+      EXPECT_EQ(node.input(2), "scale");
+      EXPECT_EQ(node.input(3), "two");
+      EXPECT_EQ(node.attr().at("num_args").i(), 3);
+      const auto& fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "Sub");
+      EXPECT_EQ(fused_ops[1], "Mul");
+      EXPECT_EQ(fused_ops[2], "RealDiv");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseCastNormalizeRequiresCpuPlacement) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({8, 3});
+  auto input = Placeholder(s.WithOpName("input"), DT_UINT8, input_shape);
+  auto offset = ops::Const(s.WithOpName("offset"), 1.f);
+  auto cast = ops::Cast(s.WithOpName("cast"), input, DT_FLOAT);
+  auto sub = ops::Sub(s.WithOpName("sub"), cast, offset);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), sub);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Unplaced nodes may end up on GPU, where the fused op has no kernel.
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedCastNormalize");
+  }
+
+  // Unplaced nodes are fused if they are known to run on CPU.
+  int num_fusions;
+  TF_ASSERT_OK(FusePreprocessingOps(item, &output, &num_fusions));
+  EXPECT_EQ(num_fusions, 1);
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "cast");
+    if (node.name() == "sub") {
+      EXPECT_EQ(node.op(), "_FusedCastNormalize");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+}
+
+TEST_F(RemapperTest, FuseCastNormalizeStopsAtSharedIntermediate) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({8, 3});
+  auto input = Placeholder(s.WithOpName("input"), DT_INT32, input_shape);
+  auto offset = ops::Const(s.WithOpName("offset"), 1.f);
+  auto scale = ops::Const(s.WithOpName("scale"), 0.5f);
+
+  auto cast = ops::Cast(s.WithOpName("cast"), input, DT_FLOAT);
+  auto sub = ops::Sub(s.WithOpName("sub"), cast, offset);
+  auto mul = ops::Mul(s.WithOpName("mul"), sub, scale);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), sub);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), mul);
+
+  auto input_t = GenerateRandomTensor<DT_INT32>({8, 3});
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The output of "sub" is used twice, so only Cast+Sub are fused.
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "sub") {
+      EXPECT_EQ(node.op(), "_FusedCastNormalize");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "offset");
+      found++;
+    }
+    if (node.name() == "mul") {
+      EXPECT_EQ(node.op(), "Mul");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+  test::ExpectTensorEqual<float>(tensors[1], tensors_expected[1]);
+}
+
+TEST_F(RemapperTest, FuseHashBucketWithMod) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_STRING,
+                           ops::Placeholder::Shape({16}));
+  auto to_bucket =
+      ops::StringToHashBucketFast(s.WithOpName("to_bucket"), input, 1000);
+  auto divisor = ops::Const(s.WithOpName("divisor"), int64_t{10});
+  auto mod = ops::FloorMod(s.WithOpName("mod"), to_bucket, divisor);
+  auto other_divisor = ops::Const(s.WithOpName("other_divisor"), int64_t{7});
+  auto other_to_bucket = ops::StringToHashBucketFast(
+      s.WithOpName("other_to_bucket"), input, 1000);
+  auto other_mod =
+      ops::FloorMod(s.WithOpName("other_mod"), other_to_bucket, other_divisor);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), mod);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), other_mod);
+
+  Tensor input_t(DT_STRING, TensorShape({16}));
+  for (int i = 0; i < 16; ++i) {
+    input_t.flat<tstring>()(i) = "feature_" + std::to_string(i);
+  }
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "to_bucket");
+    if (node.name() == "mod") {
+      EXPECT_EQ(node.op(), "StringToHashBucketFast");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.attr().at("num_buckets").i(), 10);
+      found++;
+    }
+    // 1000 buckets can not be folded into 7 buckets.
+    if (node.name() == "other_mod") {
+      EXPECT_EQ(node.op(), "FloorMod");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectTensorEqual<int64_t>(tensors[0], tensors_expected[0]);
+  test::ExpectTensorEqual<int64_t>(tensors[1], tensors_expected[1]);
+}
+
+TEST_F(RemapperTest, FuseTransposeWithCast) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({2, 8, 6, 3});
+  auto input = Placeholder(s.WithOpName("input"), DT_UINT8, input_shape);
+  auto perm = ops::Const(s.WithOpName("perm"), {0, 3, 1, 2}, {4});
+  auto transpose = ops::Transpose(s.WithOpName("transpose"), input, perm);
+  auto cast = ops::Cast(s.WithOpName("cast"), transpose, DT_FLOAT);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), cast);
+
+  auto input_t = GenerateRandomTensor<DT_UINT8>({2, 8, 6, 3});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "transpose");
+    if (node.name() == "cast") {
+      EXPECT_EQ(node.op(), "_FusedTransposeCast");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "perm");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
+TEST_F(RemapperTest, DontFuseTransposeWithCastOfRank6) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // _FusedTransposeCast only supports inputs of rank up to 5.
+  auto input_shape = ops::Placeholder::Shape({2, 1, 3, 1, 2, 3});
+  auto input = Placeholder(s.WithOpName("input"), DT_UINT8, input_shape);
+  auto perm = ops::Const(s.WithOpName("perm"), {5, 4, 3, 2, 1, 0}, {6});
+  auto transpose = ops::Transpose(s.WithOpName("transpose"), input, perm);
+  auto cast = ops::Cast(s.WithOpName("cast"), transpose, DT_FLOAT);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), cast);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "transpose") {
+      EXPECT_EQ(node.op(), "Transpose");
+      found++;
+    }
+    if (node.name() == "cast") {
+      EXPECT_EQ(node.op(), "Cast");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
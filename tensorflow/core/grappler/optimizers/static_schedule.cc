@@ -16,14 +16,19 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
 #include <deque>
+#include <set>
+#include <tuple>
+#include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
@@ -199,5 +204,160 @@ Status EstimateRequiredTimes(
   return Status::OK();
 }
 
+Status ComputeSchedulePriorities(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, int>* priorities) {
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> completion_times;
+  TF_RETURN_IF_ERROR(
+      EstimateEarliestExecutionTimes(item, cluster, &completion_times));
+  // Every node must complete by the end of the step, so the slack of a node
+  // is the time by which it can be delayed without delaying the whole step.
+  Costs::NanoSeconds makespan(1);
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> deadlines;
+  for (const auto& node_time : completion_times) {
+    makespan = std::max(makespan, node_time.second);
+  }
+  for (const NodeDef& node : item.graph.node()) {
+    deadlines[&node] = makespan;
+  }
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  TF_RETURN_IF_ERROR(
+      EstimateRequiredTimes(item, cluster, deadlines, &required_times));
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+
+  const int num_nodes = item.graph.node_size();
+  std::unordered_map<string, int> node_index;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_index[item.graph.node(i).name()] = i;
+  }
+
+  // Regular and control edges, one entry per input, as well as the distinct
+  // producers of the data inputs of each node.
+  std::vector<std::vector<int>> fanouts(num_nodes);
+  std::vector<std::vector<int>> data_fanins(num_nodes);
+  std::vector<int> num_data_fanouts(num_nodes, 0);
+  std::vector<int> pending_inputs(num_nodes, 0);
+  std::vector<bool> is_communication(num_nodes, false);
+  std::vector<int64_t> output_bytes(num_nodes, 0);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = item.graph.node(i);
+    gtl::FlatSet<int> unique_data_fanins;
+    for (const string& input : node.input()) {
+      auto it = node_index.find(NodeName(input));
+      if (it == node_index.end()) {
+        return errors::InvalidArgument(
+            strings::StrCat("Unknown input node ", input));
+      }
+      const int fanin = it->second;
+      fanouts[fanin].push_back(i);
+      if (IsControlInput(input) || !unique_data_fanins.insert(fanin).second) {
+        continue;
+      }
+      data_fanins[i].push_back(fanin);
+      ++num_data_fanouts[fanin];
+      const string& fanin_device = item.graph.node(fanin).device();
+      if (!fanin_device.empty() && !node.device().empty() &&
+          fanin_device != node.device()) {
+        is_communication[fanin] = true;
+      }
+    }
+    // Merge nodes are ready as soon as one of their inputs is available.
+    pending_inputs[i] =
+        (IsMerge(node) && node.input_size() > 0) ? 1 : node.input_size();
+    if (IsSend(node) || IsRecv(node)) {
+      is_communication[i] = true;
+    }
+    for (const auto& output : properties.GetOutputProperties(node.name())) {
+      output_bytes[i] += std::max<int64_t>(0, CalculateTensorSize(output));
+    }
+  }
+  node_index.clear();
+
+  // Slack is only compared coarsely, so that the memory heuristic can break
+  // the ties between nodes that are about as critical.
+  constexpr int64_t kNumSlackBuckets = 64;
+  const int64_t slack_bucket_size =
+      std::max<int64_t>(1, makespan.count() / kNumSlackBuckets);
+  std::vector<int64_t> slack(num_nodes, kNumSlackBuckets);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef* node = &item.graph.node(i);
+    const Costs::NanoSeconds required_time = required_times[node];
+    auto it = completion_times.find(node);
+    if (it != completion_times.end() &&
+        required_time != Costs::NanoSeconds::max()) {
+      slack[i] = std::min<int64_t>(
+          kNumSlackBuckets,
+          std::max<int64_t>(0, (required_time - it->second).count()) /
+              slack_bucket_size);
+    }
+  }
+
+  // The number of consumers of each node that have not been scheduled yet:
+  // the outputs of a node are freed once it drops to zero.
+  std::vector<int> remaining_consumers = num_data_fanouts;
+  std::vector<bool> scheduled(num_nodes, false);
+  auto net_memory = [&](int i) {
+    int64_t bytes = output_bytes[i];
+    for (int fanin : data_fanins[i]) {
+      if (remaining_consumers[fanin] == 1) {
+        bytes -= output_bytes[fanin];
+      }
+    }
+    return bytes;
+  };
+
+  using Key = std::tuple<bool, int64_t, int64_t, int>;
+  std::set<Key> ready_nodes;
+  std::vector<Key> ready_keys(num_nodes);
+  auto make_ready = [&](int i) {
+    ready_keys[i] = Key(!is_communication[i], slack[i], net_memory(i), i);
+    ready_nodes.insert(ready_keys[i]);
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (pending_inputs[i] == 0) {
+      make_ready(i);
+    }
+  }
+
+  int priority = 0;
+  while (!ready_nodes.empty()) {
+    const int i = std::get<3>(*ready_nodes.begin());
+    ready_nodes.erase(ready_nodes.begin());
+    scheduled[i] = true;
+    (*priorities)[&item.graph.node(i)] = ++priority;
+
+    for (int fanin : data_fanins[i]) {
+      if (--remaining_consumers[fanin] != 1) continue;
+      // The last consumer of `fanin` now frees its outputs: update its key if
+      // it is already ready.
+      for (int consumer : fanouts[fanin]) {
+        if (scheduled[consumer] || pending_inputs[consumer] > 0) continue;
+        if (ready_nodes.erase(ready_keys[consumer]) > 0) {
+          make_ready(consumer);
+        }
+      }
+    }
+    for (int fanout : fanouts[i]) {
+      // Avoid going through loops more than once.
+      if (pending_inputs[fanout] == 0) continue;
+      if (--pending_inputs[fanout] == 0) {
+        make_ready(fanout);
+      }
+    }
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!scheduled[i]) {
+      (*priorities)[&item.graph.node(i)] = ++priority;
+    }
+  }
+  return Status::OK();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -44,6 +44,19 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Compute a static execution order for the nodes in the graph, and return the
+// position of each node in this order (starting at 1) as its priority.
+// Among the nodes whose inputs are available, the order favors:
+//  * communication, i.e. Send/Recv nodes and nodes whose output is consumed on
+//    another device, so that transfers overlap with computation;
+//  * nodes on the critical path, i.e. with the least slack between the
+//    earliest and the required completion times;
+//  * nodes that free more memory than they allocate.
+// Nodes that can't be reached without going through a loop are ordered last.
+Status ComputeSchedulePriorities(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, int>* priorities);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
+#include <set>
+
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
@@ -196,6 +198,74 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
                                       "Sign_2", "Sign_3", "y"}));
 }
 
+TEST_F(StaticScheduleTest, SchedulePriorities) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  std::unordered_map<const NodeDef*, int> priorities;
+  TF_EXPECT_OK(ComputeSchedulePriorities(item, cluster.get(), &priorities));
+  EXPECT_EQ(item.graph.node_size(), priorities.size());
+
+  // The priorities form a permutation of [1, num_nodes] that is consistent
+  // with the dependencies of the graph.
+  std::set<int> distinct_priorities;
+  std::unordered_map<string, int> priority_by_name;
+  for (const auto& node_priority : priorities) {
+    distinct_priorities.insert(node_priority.second);
+    priority_by_name[node_priority.first->name()] = node_priority.second;
+  }
+  EXPECT_EQ(item.graph.node_size(), distinct_priorities.size());
+  EXPECT_EQ(1, *distinct_priorities.begin());
+  EXPECT_EQ(item.graph.node_size(), *distinct_priorities.rbegin());
+  for (const NodeDef& node : item.graph.node()) {
+    for (const string& input : node.input()) {
+      EXPECT_LT(priority_by_name[NodeName(input)], priority_by_name[node.name()])
+          << input << " -> " << node.name();
+    }
+  }
+}
+
+TEST_F(StaticScheduleTest, SchedulePrioritiesFavorCommunication) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  const string cpu0 = "/job:localhost/replica:0/task:0/cpu:0";
+  const string cpu1 = "/job:localhost/replica:0/task:0/cpu:1";
+
+  Output x = ops::Const(s.WithOpName("x").WithDevice(cpu0), 0.0f, {10, 10});
+  // A long local chain, which is on the critical path...
+  Output a = ops::Sqrt(s.WithOpName("a").WithDevice(cpu0), x);
+  Output b = ops::Sqrt(s.WithOpName("b").WithDevice(cpu0), a);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice(cpu0), b);
+  // ...and a short branch whose result is sent to another device.
+  Output send = ops::Identity(s.WithOpName("send").WithDevice(cpu0), x);
+  Output recv = ops::Identity(s.WithOpName("recv").WithDevice(cpu1), send);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  std::unordered_map<string, DeviceProperties> devices;
+  devices[cpu0] = cpu_device;
+  devices[cpu1] = cpu_device;
+  VirtualCluster cluster(devices);
+
+  std::unordered_map<const NodeDef*, int> priorities;
+  TF_EXPECT_OK(ComputeSchedulePriorities(item, &cluster, &priorities));
+  std::unordered_map<string, int> priority_by_name;
+  for (const auto& node_priority : priorities) {
+    priority_by_name[node_priority.first->name()] = node_priority.second;
+  }
+  EXPECT_EQ(1, priority_by_name["x"]);
+  EXPECT_EQ(2, priority_by_name["send"]);
+  EXPECT_LT(priority_by_name["a"], priority_by_name["recv"]);
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
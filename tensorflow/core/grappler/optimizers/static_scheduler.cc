@@ -0,0 +1,52 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/grappler/optimizers/static_scheduler.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/static_schedule.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status StaticScheduler::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output) {
+  if (cluster == nullptr) {
+    return errors::Aborted("cluster == nullptr.");
+  }
+  if (item.graph.node_size() < 2) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  std::unordered_map<const NodeDef*, int> priorities;
+  TF_RETURN_IF_ERROR(ComputeSchedulePriorities(item, cluster, &priorities));
+
+  *output = item.graph;
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    (*output->mutable_node(i)->mutable_attr())[kSchedulePriorityAttr].set_i(
+        priorities[&item.graph.node(i)]);
+  }
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
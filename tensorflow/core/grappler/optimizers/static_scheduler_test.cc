@@ -0,0 +1,69 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/grappler/optimizers/static_scheduler.h"
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem TestItem() {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+TEST(StaticSchedulerTest, AnnotatesAllNodes) {
+  const GrapplerItem item = TestItem();
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  VirtualCluster cluster(
+      {{"/job:localhost/replica:0/task:0/cpu:0", cpu_device}});
+
+  StaticScheduler optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  ASSERT_EQ(item.graph.node_size(), output.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    const NodeDef& node = output.node(i);
+    EXPECT_EQ(item.graph.node(i).name(), node.name());
+    ASSERT_EQ(1, node.attr().count(kSchedulePriorityAttr)) << node.name();
+    EXPECT_GE(node.attr().at(kSchedulePriorityAttr).i(), 1);
+    EXPECT_LE(node.attr().at(kSchedulePriorityAttr).i(), output.node_size());
+  }
+}
+
+TEST(StaticSchedulerTest, RequiresCluster) {
+  StaticScheduler optimizer;
+  GraphDef output;
+  Status status = optimizer.Optimize(nullptr, TestItem(), &output);
+  EXPECT_TRUE(errors::IsAborted(status)) << status;
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
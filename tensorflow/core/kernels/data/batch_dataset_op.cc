@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/batch_dataset_op.h"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/data/dataset_utils.h"
@@ -189,16 +191,11 @@ class BatchDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
         batch_elements.reserve(dataset()->reserve_size_);
-        *end_of_sequence = false;
-        for (int i = 0; i < dataset()->batch_size_ && !*end_of_sequence; ++i) {
-          std::vector<Tensor> batch_element_tuple;
-          TF_RETURN_IF_ERROR(
-              input_impl_->GetNext(ctx, &batch_element_tuple, end_of_sequence));
-          if (!*end_of_sequence) {
-            batch_elements.emplace_back(std::move(batch_element_tuple));
-          } else {
-            input_impl_.reset();
-          }
+        TF_RETURN_IF_ERROR(input_impl_->GetNextN(
+            ctx, static_cast<int>(dataset()->batch_size_), &batch_elements,
+            end_of_sequence));
+        if (*end_of_sequence) {
+          input_impl_.reset();
         }
       }
 
@@ -229,6 +226,49 @@ class BatchDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                            std::vector<std::vector<Tensor>>* out_elements,
+                            bool* end_of_sequence) override {
+      const int64_t batch_size = dataset()->batch_size_;
+      if (batch_size > std::numeric_limits<int>::max() / max_elements) {
+        return DatasetIterator<Dataset>::GetNextNInternal(
+            ctx, max_elements, out_elements, end_of_sequence);
+      }
+      // Reads the inputs of all batches at once.
+      std::vector<std::vector<Tensor>> input_elements;
+      {
+        mutex_lock l(mu_);
+        if (!input_impl_) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(input_impl_->GetNextN(
+            ctx, max_elements * batch_size, &input_elements, end_of_sequence));
+        if (*end_of_sequence) {
+          input_impl_.reset();
+        }
+      }
+
+      for (size_t start = 0; start < input_elements.size();
+           start += batch_size) {
+        const size_t end =
+            std::min<size_t>(start + batch_size, input_elements.size());
+        if (dataset()->drop_remainder_ &&
+            static_cast<int64_t>(end - start) < batch_size) {
+          break;
+        }
+        std::vector<std::vector<Tensor>> batch_elements(
+            std::make_move_iterator(input_elements.begin() + start),
+            std::make_move_iterator(input_elements.begin() + end));
+        std::vector<Tensor> batch;
+        TF_RETURN_IF_ERROR(CopyBatch(
+            CopyBatchParams(ctx), batch_elements, dataset()->parallel_copy_,
+            /*allocation_callback=*/nullptr, &batch));
+        out_elements->push_back(std::move(batch));
+      }
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -149,6 +149,9 @@ std::vector<GetNextTestCase<BatchDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
                          GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(BatchDatasetOpTest, BatchDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(BatchDatasetOpTest, DatasetNodeName) {
   auto batch_dataset_params = BatchDatasetParams1();
   TF_ASSERT_OK(Initialize(batch_dataset_params));
@@ -106,6 +106,16 @@ class ConcatenateDatasetOp::Dataset : public DatasetBase {
     return to_concatenate_->CheckExternalState();
   }
 
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    const int64_t input_cardinality = input_->Cardinality();
+    if (index < input_cardinality) {
+      return input_->Get(ctx, index, out_tensors);
+    }
+    return to_concatenate_->Get(ctx, index - input_cardinality, out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -0,0 +1,695 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/dynamic_batch_dataset_op.h"
+
+#include <algorithm>
+#include <deque>
+#include <numeric>
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+
+// See documentation in ../../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kMaxTokens;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kLookahead;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kRowLength;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    DynamicBatchDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kPackSequences;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const DynamicBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    DynamicBatchDatasetOp::kNumPaddedShapes;
+
+constexpr char kInputExhausted[] = "input_exhausted";
+constexpr char kBufferSize[] = "buffer_size";
+
+namespace {
+
+// The number of tokens of a batch of `num_elements` elements padded to
+// `length`. Empty elements count as one token, so that they cannot form
+// unbounded batches.
+int64_t PaddedTokens(int64_t num_elements, int64_t length) {
+  return num_elements * std::max<int64_t>(length, 1);
+}
+
+}  // namespace
+
+class DynamicBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, int64_t max_tokens, int64_t lookahead,
+          int64_t row_length, int64_t length_component, bool pack_sequences,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, const DatasetBase* input)
+      : DatasetBase(DatasetContext(ctx)),
+        max_tokens_(max_tokens),
+        lookahead_(lookahead),
+        row_length_(row_length),
+        length_component_(length_component),
+        pack_sequences_(pack_sequences),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        input_(input),
+        output_dtypes_(input->output_dtypes()),
+        traceme_metadata_(
+            {{"max_tokens",
+              strings::Printf("%lld", static_cast<long long>(max_tokens))},
+             {"lookahead",
+              strings::Printf("%lld", static_cast<long long>(lookahead))},
+             {"pack_sequences", pack_sequences ? "true" : "false"}}) {
+    input_->Ref();
+
+    output_shapes_.reserve(padded_shapes_.size() + 1);
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      if (pack_sequences_) {
+        PartialTensorShape row_shape({row_length_});
+        for (int dim = 1; dim < padded_shape.dims(); ++dim) {
+          row_shape.AddDim(padded_shape.dim_size(dim));
+        }
+        output_shapes_.push_back(
+            PartialTensorShape({-1}).Concatenate(row_shape));
+      } else {
+        output_shapes_.push_back(
+            PartialTensorShape({-1}).Concatenate(padded_shape));
+      }
+    }
+    if (pack_sequences_) {
+      output_dtypes_.push_back(DT_INT32);
+      output_shapes_.push_back(PartialTensorShape({-1, row_length_}));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_dtypes_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t Cardinality() const override {
+    int64_t n = input_->Cardinality();
+    if (n == kInfiniteCardinality || n == 0) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* max_tokens = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_tokens_, &max_tokens));
+    Node* lookahead = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(lookahead_, &lookahead));
+    Node* row_length = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(row_length_, &row_length));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (int i = 0; i < padded_shapes_.size(); i++) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shapes_[i].dims()}));
+      for (int j = 0; j < padded_shapes_[i].dims(); j++) {
+        t.vec<int64_t>()(j) = padded_shapes_[i].dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+    AttrValue pack_sequences;
+    b->BuildAttrValue(pack_sequences_, &pack_sequences);
+    AttrValue output_types;
+    b->BuildAttrValue(input_->output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, max_tokens},
+         {2, lookahead},
+         {3, row_length}},
+        {{4, padded_shapes}, {5, padding_values}},
+        {{kLengthComponent, length_component},
+         {kPackSequences, pack_sequences},
+         {kToutputTypes, output_types},
+         {kNumPaddedShapes, N}},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (input_impl_ &&
+             static_cast<int64_t>(buffer_.size()) < dataset()->lookahead_) {
+        BufferedElement element;
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &element.components, &end_of_input));
+        if (end_of_input) {
+          input_impl_.reset();
+          break;
+        }
+        TF_RETURN_IF_ERROR(ValidateElement(&element));
+        buffer_.push_back(std::move(element));
+      }
+      if (buffer_.empty()) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      *end_of_sequence = false;
+      if (dataset()->pack_sequences_) {
+        return PackBatch(ctx, out_tensors);
+      }
+      return PadBatch(ctx, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kInputExhausted), ""));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kBufferSize), buffer_.size()));
+      for (int64_t i = 0; i < buffer_.size(); ++i) {
+        for (int64_t j = 0; j < buffer_[i].components.size(); ++j) {
+          TF_RETURN_IF_ERROR(writer->WriteTensor(
+              full_name(strings::StrCat("buffer[", i, "][", j, "]")),
+              buffer_[i].components[j]));
+        }
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (reader->Contains(full_name(kInputExhausted))) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      int64_t buffer_size;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kBufferSize), &buffer_size));
+      buffer_.clear();
+      for (int64_t i = 0; i < buffer_size; ++i) {
+        BufferedElement element;
+        element.components.resize(dataset()->padded_shapes_.size());
+        for (int64_t j = 0; j < element.components.size(); ++j) {
+          TF_RETURN_IF_ERROR(reader->ReadTensor(
+              ctx->flr(),
+              full_name(strings::StrCat("buffer[", i, "][", j, "]")),
+              &element.components[j]));
+        }
+        TF_RETURN_IF_ERROR(ValidateElement(&element));
+        buffer_.push_back(std::move(element));
+      }
+      return Status::OK();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    struct BufferedElement {
+      std::vector<Tensor> components;
+      int64_t length = 0;
+    };
+
+    // Checks that `element` can be batched and sets its length.
+    Status ValidateElement(BufferedElement* element) const {
+      const std::vector<PartialTensorShape>& padded_shapes =
+          dataset()->padded_shapes_;
+      if (element->components.size() != padded_shapes.size()) {
+        return errors::InvalidArgument(
+            "Expected an element with ", padded_shapes.size(),
+            " components but got ", element->components.size());
+      }
+      for (size_t i = 0; i < padded_shapes.size(); ++i) {
+        const TensorShape& shape = element->components[i].shape();
+        if (shape.dims() != padded_shapes[i].dims()) {
+          return errors::InvalidArgument(
+              "All elements must have the same rank as the padded shape for "
+              "component ",
+              i, ": expected rank ", padded_shapes[i].dims(),
+              " but got element with rank ", shape.dims());
+        }
+      }
+      element->length =
+          element->components[dataset()->length_component_].dim_size(0);
+      if (!dataset()->pack_sequences_) {
+        return Status::OK();
+      }
+      if (element->length > dataset()->row_length_) {
+        return errors::InvalidArgument(
+            "Cannot pack an element of length ", element->length,
+            " into rows of length ", dataset()->row_length_);
+      }
+      // Packed components are concatenated along their 0th dimension, so all
+      // of them must have the element's length and the padded inner shape.
+      for (size_t i = 0; i < padded_shapes.size(); ++i) {
+        const TensorShape& shape = element->components[i].shape();
+        if (shape.dim_size(0) != element->length) {
+          return errors::InvalidArgument(
+              "To be packed, all components of an element must have the same "
+              "size in their 0th dimension, but component ",
+              i, " has size ", shape.dim_size(0), " instead of ",
+              element->length);
+        }
+        for (int dim = 1; dim < shape.dims(); ++dim) {
+          if (shape.dim_size(dim) != padded_shapes[i].dim_size(dim)) {
+            return errors::InvalidArgument(
+                "To be packed, component ", i, " of an element must have "
+                "inner shape ",
+                padded_shapes[i].DebugString(), " but got ",
+                shape.DebugString());
+          }
+        }
+      }
+      return Status::OK();
+    }
+
+    // Selects the elements of the next padded batch: the oldest buffered
+    // element, together with the buffered elements closest to it in length
+    // that keep the padded batch within the token budget. At each step, the
+    // candidate that adds the least padding is taken.
+    std::vector<size_t> SelectBatch() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<size_t> order(buffer_.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return buffer_[a].length < buffer_[b].length;
+      });
+      const int64_t anchor =
+          std::find(order.begin(), order.end(), 0) - order.begin();
+      std::vector<size_t> selected = {0};
+      int64_t max_length = buffer_[0].length;
+      int64_t shorter = anchor - 1;
+      int64_t longer = anchor + 1;
+      const int64_t num_buffered = order.size();
+      while (true) {
+        const int64_t n = selected.size();
+        bool take_shorter =
+            shorter >= 0 &&
+            PaddedTokens(n + 1, max_length) <= dataset()->max_tokens_;
+        bool take_longer =
+            longer < num_buffered &&
+            PaddedTokens(n + 1, buffer_[order[longer]].length) <=
+                dataset()->max_tokens_;
+        if (!take_shorter && !take_longer) break;
+        if (take_shorter && take_longer) {
+          const int64_t shorter_padding =
+              max_length - buffer_[order[shorter]].length;
+          const int64_t longer_padding =
+              (buffer_[order[longer]].length - max_length) * n;
+          take_shorter = shorter_padding <= longer_padding;
+        }
+        if (take_shorter) {
+          selected.push_back(order[shorter--]);
+        } else {
+          max_length = buffer_[order[longer]].length;
+          selected.push_back(order[longer++]);
+        }
+      }
+      // Keep the elements of the batch in arrival order.
+      std::sort(selected.begin(), selected.end());
+      return selected;
+    }
+
+    // Emits the elements selected by `SelectBatch()` as a padded batch.
+    Status PadBatch(IteratorContext* ctx, std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const std::vector<size_t> selected = SelectBatch();
+      const int64_t num_elements = selected.size();
+      const size_t num_components = dataset()->padded_shapes_.size();
+
+      // Determine the shapes of the padded components before moving any
+      // element out of the buffer.
+      std::vector<TensorShape> batch_shapes(num_components);
+      for (size_t i = 0; i < num_components; ++i) {
+        const PartialTensorShape& padded_shape = dataset()->padded_shapes_[i];
+        batch_shapes[i].AddDim(num_elements);
+        for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+          batch_shapes[i].AddDim(std::max<int64_t>(padded_shape.dim_size(dim),
+                                                   0));
+        }
+        for (size_t index : selected) {
+          const TensorShape& shape = buffer_[index].components[i].shape();
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            if (padded_shape.dim_size(dim) == -1) {
+              batch_shapes[i].set_dim(
+                  dim + 1,
+                  std::max(batch_shapes[i].dim_size(dim + 1),
+                           shape.dim_size(dim)));
+            } else if (shape.dim_size(dim) > padded_shape.dim_size(dim)) {
+              return errors::DataLoss(
+                  "Attempted to pad to a smaller size than the input "
+                  "element.");
+            }
+          }
+        }
+      }
+
+      for (size_t i = 0; i < num_components; ++i) {
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  dataset()->output_dtypes_[i],
+                                  batch_shapes[i]);
+        Tensor& batch = out_tensors->back();
+        TF_RETURN_IF_ERROR(
+            batch_util::SetElementZero(&batch, dataset()->padding_values_[i]));
+        TensorShape row_shape = batch_shapes[i];
+        row_shape.RemoveDim(0);
+        for (int64_t j = 0; j < num_elements; ++j) {
+          Tensor& component = buffer_[selected[j]].components[i];
+          if (component.shape() == row_shape) {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+                std::move(component), &batch, j));
+          } else {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToLargerSlice(component, &batch, j));
+          }
+        }
+      }
+      RemoveFromBuffer(selected);
+      return Status::OK();
+    }
+
+    // Packs the oldest buffered element, followed by the other buffered
+    // elements from the longest to the shortest, into the first row of length
+    // `row_length` with enough room left, and emits the rows that were used.
+    Status PackBatch(IteratorContext* ctx, std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t row_length = dataset()->row_length_;
+      const int64_t max_rows = dataset()->max_tokens_ / row_length;
+      struct Placement {
+        size_t index;
+        int64_t row;
+        int64_t offset;
+        int32 segment_id;
+      };
+      std::vector<Placement> placements;
+      std::vector<int64_t> row_used(max_rows, 0);
+      std::vector<int32> row_segments(max_rows, 0);
+      auto place = [&](size_t index) {
+        const int64_t length = buffer_[index].length;
+        for (int64_t row = 0; row < max_rows; ++row) {
+          if (row_used[row] + length <= row_length) {
+            placements.push_back(
+                {index, row, row_used[row], ++row_segments[row]});
+            row_used[row] += length;
+            return;
+          }
+        }
+      };
+      std::vector<size_t> order(buffer_.size() - 1);
+      std::iota(order.begin(), order.end(), 1);
+      std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return buffer_[a].length > buffer_[b].length;
+      });
+      place(0);
+      for (size_t index : order) {
+        place(index);
+      }
+      // Rows are filled in order, so the rows in use form a prefix.
+      int64_t num_rows = 0;
+      for (const Placement& placement : placements) {
+        num_rows = std::max(num_rows, placement.row + 1);
+      }
+
+      const size_t num_components = dataset()->padded_shapes_.size();
+      for (size_t i = 0; i < num_components; ++i) {
+        const PartialTensorShape& padded_shape = dataset()->padded_shapes_[i];
+        TensorShape batch_shape({num_rows, row_length});
+        TensorShape flat_shape({num_rows * row_length});
+        for (int dim = 1; dim < padded_shape.dims(); ++dim) {
+          batch_shape.AddDim(padded_shape.dim_size(dim));
+          flat_shape.AddDim(padded_shape.dim_size(dim));
+        }
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  dataset()->output_dtypes_[i], batch_shape);
+        Tensor& batch = out_tensors->back();
+        TF_RETURN_IF_ERROR(
+            batch_util::SetElementZero(&batch, dataset()->padding_values_[i]));
+        // View the rows as one sequence, so that each element is copied as a
+        // single contiguous run of slices.
+        Tensor flat_batch;
+        if (!flat_batch.CopyFrom(batch, flat_shape)) {
+          return errors::Internal("Failed to reshape packed batch of shape ",
+                                  batch_shape.DebugString(), " to ",
+                                  flat_shape.DebugString());
+        }
+        for (const Placement& placement : placements) {
+          const BufferedElement& element = buffer_[placement.index];
+          TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+              element.components[i], /*src_offset=*/0,
+              /*dst_offset=*/placement.row * row_length + placement.offset,
+              /*num_slices=*/element.length, &flat_batch));
+        }
+      }
+
+      out_tensors->emplace_back(ctx->allocator({}), DT_INT32,
+                                TensorShape({num_rows, row_length}));
+      auto segment_ids = out_tensors->back().matrix<int32>();
+      segment_ids.setZero();
+      for (const Placement& placement : placements) {
+        for (int64_t j = 0; j < buffer_[placement.index].length; ++j) {
+          segment_ids(placement.row, placement.offset + j) =
+              placement.segment_id;
+        }
+      }
+
+      std::vector<size_t> selected;
+      selected.reserve(placements.size());
+      for (const Placement& placement : placements) {
+        selected.push_back(placement.index);
+      }
+      std::sort(selected.begin(), selected.end());
+      RemoveFromBuffer(selected);
+      return Status::OK();
+    }
+
+    // Removes the elements at the sorted indices `selected` from the buffer.
+    void RemoveFromBuffer(const std::vector<size_t>& selected)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (auto it = selected.rbegin(); it != selected.rend(); ++it) {
+        buffer_.erase(buffer_.begin() + *it);
+      }
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // Elements read ahead from the input, in arrival order.
+    std::deque<BufferedElement> buffer_ TF_GUARDED_BY(mu_);
+  };
+
+  const int64_t max_tokens_;
+  const int64_t lookahead_;
+  const int64_t row_length_;
+  const int64_t length_component_;
+  const bool pack_sequences_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const DatasetBase* const input_;
+  DataTypeVector output_dtypes_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+DynamicBatchDatasetOp::DynamicBatchDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kPackSequences, &pack_sequences_));
+}
+
+void DynamicBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                        DatasetBase* input,
+                                        DatasetBase** output) {
+  int64_t max_tokens;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kMaxTokens, &max_tokens));
+  OP_REQUIRES(ctx, max_tokens > 0,
+              errors::InvalidArgument("max_tokens must be greater than zero."));
+  int64_t lookahead;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kLookahead, &lookahead));
+  OP_REQUIRES(ctx, lookahead > 0,
+              errors::InvalidArgument("lookahead must be greater than zero."));
+  int64_t row_length;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kRowLength, &row_length));
+  if (pack_sequences_) {
+    OP_REQUIRES(ctx, row_length > 0 && row_length <= max_tokens,
+                errors::InvalidArgument(
+                    "row_length must be in [1, max_tokens] to pack sequences, "
+                    "but got ",
+                    row_length));
+  }
+
+  const size_t num_components = input->output_shapes().size();
+  OP_REQUIRES(ctx,
+              length_component_ >= 0 &&
+                  length_component_ < static_cast<int64_t>(num_components),
+              errors::InvalidArgument(
+                  "length_component must be in [0, ", num_components,
+                  ") but got ", length_component_));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == num_components,
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      num_components, ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(num_components);
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    if (pack_sequences_) {
+      // The 0th dimension is the packing dimension; the others are copied as
+      // they are and must be known.
+      OP_REQUIRES(ctx, padded_shape.dims() > 0,
+                  errors::InvalidArgument(
+                      "To pack sequences, all padded shapes must have rank at "
+                      "least 1"));
+      for (int dim = 1; dim < padded_shape.dims(); ++dim) {
+        OP_REQUIRES(ctx, padded_shape.dim_size(dim) >= 0,
+                    errors::InvalidArgument(
+                        "To pack sequences, all padded shapes must be known "
+                        "beyond their 0th dimension, but got ",
+                        padded_shape.DebugString()));
+      }
+    }
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+  OP_REQUIRES(ctx, padded_shapes[length_component_].dims() > 0,
+              errors::InvalidArgument(
+                  "The padded shape of the length component must have rank "
+                  "at least 1"));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == num_components,
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  num_components, ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, max_tokens, lookahead, row_length,
+                        length_component_, pack_sequences_,
+                        std::move(padded_shapes), std::move(padding_values),
+                        input);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("DynamicBatchDataset").Device(DEVICE_CPU),
+                        DynamicBatchDatasetOp);
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
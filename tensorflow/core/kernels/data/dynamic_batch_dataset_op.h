@@ -0,0 +1,64 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_DYNAMIC_BATCH_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_DYNAMIC_BATCH_DATASET_OP_H_
+
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+
+// Batches variable-length elements under a budget on the number of tokens
+// per batch rather than on the number of elements, so that every batch costs
+// roughly the same compute.
+//
+// Elements are drawn into a lookahead buffer, and each batch is formed around
+// the oldest buffered element from the buffered elements of the most similar
+// lengths. Without packing, a batch of `n` elements padded to length `l` costs
+// `n * l` tokens. With packing, several elements are concatenated into each
+// row of fixed length, and a `segment_ids` component marks which element each
+// position belongs to.
+class DynamicBatchDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "DynamicBatch";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kMaxTokens = "max_tokens";
+  static constexpr const char* const kLookahead = "lookahead";
+  static constexpr const char* const kRowLength = "row_length";
+  static constexpr const char* const kPaddedShapes = "padded_shapes";
+  static constexpr const char* const kPaddingValues = "padding_values";
+  static constexpr const char* const kLengthComponent = "length_component";
+  static constexpr const char* const kPackSequences = "pack_sequences";
+  static constexpr const char* const kToutputTypes = "Toutput_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kNumPaddedShapes = "N";
+
+  explicit DynamicBatchDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+  int64_t length_component_;
+  bool pack_sequences_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_DYNAMIC_BATCH_DATASET_OP_H_
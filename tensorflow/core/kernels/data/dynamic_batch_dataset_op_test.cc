@@ -0,0 +1,324 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/dynamic_batch_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNodeName[] = "dynamic_batch_dataset";
+
+class DynamicBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  DynamicBatchDatasetParams(T input_dataset_params, int64_t max_tokens,
+                            int64_t lookahead, int64_t row_length,
+                            std::vector<Tensor> padded_shapes,
+                            std::vector<Tensor> padded_values,
+                            bool pack_sequences, DataTypeVector output_dtypes,
+                            std::vector<PartialTensorShape> output_shapes,
+                            string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        max_tokens_(max_tokens),
+        lookahead_(lookahead),
+        row_length_(row_length),
+        padded_shapes_(std::move(padded_shapes)),
+        padded_values_(std::move(padded_values)),
+        pack_sequences_(pack_sequences) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = {
+        CreateTensor<int64_t>(TensorShape({}), {max_tokens_}),
+        CreateTensor<int64_t>(TensorShape({}), {lookahead_}),
+        CreateTensor<int64_t>(TensorShape({}), {row_length_})};
+    for (auto& padded_shape : padded_shapes_) {
+      input_tensors.emplace_back(padded_shape);
+    }
+    for (auto& padded_value : padded_values_) {
+      input_tensors.emplace_back(padded_value);
+    }
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {DynamicBatchDatasetOp::kInputDataset,
+                    DynamicBatchDatasetOp::kMaxTokens,
+                    DynamicBatchDatasetOp::kLookahead,
+                    DynamicBatchDatasetOp::kRowLength};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(
+          strings::StrCat(DynamicBatchDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int i = 0; i < padded_values_.size(); ++i) {
+      input_names->emplace_back(
+          strings::StrCat(DynamicBatchDatasetOp::kPaddingValues, "_", i));
+    }
+    return Status::OK();
+  }
+
+  // `output_dtypes_` holds the dtypes of the input components, which are
+  // followed by the segment ids in the output when packing.
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{DynamicBatchDatasetOp::kLengthComponent, 0},
+                    {DynamicBatchDatasetOp::kPackSequences, pack_sequences_},
+                    {DynamicBatchDatasetOp::kToutputTypes, output_dtypes_},
+                    {DynamicBatchDatasetOp::kOutputShapes, output_shapes_},
+                    {DynamicBatchDatasetOp::kNumPaddedShapes,
+                     static_cast<int64_t>(padded_shapes_.size())}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return DynamicBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t max_tokens_;
+  int64_t lookahead_;
+  int64_t row_length_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padded_values_;
+  bool pack_sequences_;
+};
+
+class DynamicBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+// Elements of length 2, 1 and 4, in that order:
+// [0, 1], [2, 3], [4, 5], [6], [7], [8], [9], [10, ..., 13], [14, ..., 17].
+ConcatenateDatasetParams VariableLengthDatasetParams() {
+  auto length_2 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{3, 2},
+                                            {{0, 1, 2, 3, 4, 5}}),
+      /*node_name=*/"tensor_slice_0");
+  auto length_1 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{4, 1}, {{6, 7, 8, 9}}),
+      /*node_name=*/"tensor_slice_1");
+  auto first_length_4 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{1, 4},
+                                            {{10, 11, 12, 13}}),
+      /*node_name=*/"tensor_slice_2");
+  auto second_length_4 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{1, 4},
+                                            {{14, 15, 16, 17}}),
+      /*node_name=*/"tensor_slice_3");
+  auto first = ConcatenateDatasetParams(
+      std::move(length_2), std::move(length_1),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/"concatenate_0");
+  auto second = ConcatenateDatasetParams(
+      std::move(first_length_4), std::move(second_length_4),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({4})},
+      /*node_name=*/"concatenate_1");
+  return ConcatenateDatasetParams(std::move(first), std::move(second),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate_2");
+}
+
+DynamicBatchDatasetParams PaddedParams(int64_t max_tokens, int64_t lookahead) {
+  return DynamicBatchDatasetParams(
+      VariableLengthDatasetParams(), max_tokens, lookahead,
+      /*row_length=*/0,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*pack_sequences=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+DynamicBatchDatasetParams PackedParams(int64_t max_tokens,
+                                       int64_t row_length) {
+  return DynamicBatchDatasetParams(
+      VariableLengthDatasetParams(), max_tokens, /*lookahead=*/9, row_length,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*pack_sequences=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/
+      {PartialTensorShape({-1, row_length}),
+       PartialTensorShape({-1, row_length})},
+      /*node_name=*/kNodeName);
+}
+
+// Test case 1: the whole input is buffered, so elements of similar lengths
+// are batched together.
+DynamicBatchDatasetParams DynamicBatchDatasetParams1() {
+  return PaddedParams(/*max_tokens=*/4, /*lookahead=*/9);
+}
+
+// Test case 2: a short lookahead batches elements nearly in order.
+DynamicBatchDatasetParams DynamicBatchDatasetParams2() {
+  return PaddedParams(/*max_tokens=*/4, /*lookahead=*/2);
+}
+
+// Test case 3: two rows of length 4 per batch, with packing.
+DynamicBatchDatasetParams DynamicBatchDatasetParams3() {
+  return PackedParams(/*max_tokens=*/8, /*row_length=*/4);
+}
+
+std::vector<GetNextTestCase<DynamicBatchDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/DynamicBatchDatasetParams1(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 2}, {4, 5, 9, -1}),
+            CreateTensor<int64_t>(TensorShape{3, 1}, {6, 7, 8}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {10, 11, 12, 13}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {14, 15, 16, 17})}},
+          {/*dataset_params=*/DynamicBatchDatasetParams2(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 2}, {4, 5, 6, -1}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {7, 8}),
+            CreateTensor<int64_t>(TensorShape{1, 1}, {9}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {10, 11, 12, 13}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {14, 15, 16, 17})}},
+          {/*dataset_params=*/DynamicBatchDatasetParams3(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 4},
+                                  {0, 1, 2, 3, 10, 11, 12, 13}),
+            CreateTensor<int32>(TensorShape{2, 4}, {1, 1, 2, 2, 1, 1, 1, 1}),
+            CreateTensor<int64_t>(TensorShape{2, 4},
+                                  {4, 5, 6, 7, 14, 15, 16, 17}),
+            CreateTensor<int32>(TensorShape{2, 4}, {1, 1, 2, 3, 1, 1, 1, 1}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {8, 9, -1, -1}),
+            CreateTensor<int32>(TensorShape{1, 4}, {1, 2, 0, 0})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(DynamicBatchDatasetOpTest, DynamicBatchDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(DynamicBatchDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = DynamicBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(DynamicBatchDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = DynamicBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(DynamicBatchDatasetOp::kDatasetType)));
+}
+
+std::vector<DatasetOutputDtypesTestCase<DynamicBatchDatasetParams>>
+DatasetOutputDtypesTestCases() {
+  return {{/*dataset_params=*/DynamicBatchDatasetParams1(),
+           /*expected_output_dtypes=*/{DT_INT64}},
+          {/*dataset_params=*/DynamicBatchDatasetParams3(),
+           /*expected_output_dtypes=*/{DT_INT64, DT_INT32}}};
+}
+
+DATASET_OUTPUT_DTYPES_TEST_P(DynamicBatchDatasetOpTest,
+                             DynamicBatchDatasetParams,
+                             DatasetOutputDtypesTestCases())
+
+std::vector<DatasetOutputShapesTestCase<DynamicBatchDatasetParams>>
+DatasetOutputShapesTestCases() {
+  return {{/*dataset_params=*/DynamicBatchDatasetParams1(),
+           /*expected_output_shapes=*/{PartialTensorShape({-1, -1})}},
+          {/*dataset_params=*/DynamicBatchDatasetParams3(),
+           /*expected_output_shapes=*/{PartialTensorShape({-1, 4}),
+                                       PartialTensorShape({-1, 4})}}};
+}
+
+DATASET_OUTPUT_SHAPES_TEST_P(DynamicBatchDatasetOpTest,
+                             DynamicBatchDatasetParams,
+                             DatasetOutputShapesTestCases())
+
+std::vector<CardinalityTestCase<DynamicBatchDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/DynamicBatchDatasetParams1(),
+           /*expected_cardinality=*/kUnknownCardinality}};
+}
+
+DATASET_CARDINALITY_TEST_P(DynamicBatchDatasetOpTest,
+                           DynamicBatchDatasetParams, CardinalityTestCases())
+
+TEST_F(DynamicBatchDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = DynamicBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(
+      name_utils::IteratorPrefix(DynamicBatchDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<DynamicBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/DynamicBatchDatasetParams1(),
+           /*breakpoints=*/{0, 2, 5},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 2}, {4, 5, 9, -1}),
+            CreateTensor<int64_t>(TensorShape{3, 1}, {6, 7, 8}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {10, 11, 12, 13}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {14, 15, 16, 17})}},
+          {/*dataset_params=*/DynamicBatchDatasetParams2(),
+           /*breakpoints=*/{0, 1, 3},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 2}, {4, 5, 6, -1}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {7, 8}),
+            CreateTensor<int64_t>(TensorShape{1, 1}, {9}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {10, 11, 12, 13}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {14, 15, 16, 17})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(DynamicBatchDatasetOpTest,
+                                 DynamicBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(DynamicBatchDatasetOpTest, ElementLongerThanRow) {
+  auto dataset_params = PackedParams(/*max_tokens=*/8, /*row_length=*/3);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      tensorflow::error::INVALID_ARGUMENT);
+}
+
+class ParameterizedInvalidArgumentTest
+    : public DynamicBatchDatasetOpTest,
+      public ::testing::WithParamInterface<DynamicBatchDatasetParams> {};
+
+TEST_P(ParameterizedInvalidArgumentTest, InvalidArgument) {
+  auto dataset_params = GetParam();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    DynamicBatchDatasetOpTest, ParameterizedInvalidArgumentTest,
+    ::testing::ValuesIn(
+        {PaddedParams(/*max_tokens=*/0, /*lookahead=*/2),
+         PaddedParams(/*max_tokens=*/4, /*lookahead=*/0),
+         PackedParams(/*max_tokens=*/4, /*row_length=*/8)}));
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
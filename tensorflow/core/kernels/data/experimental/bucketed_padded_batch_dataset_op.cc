@@ -0,0 +1,598 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/bucketed_padded_batch_dataset_op.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kBucketBatchSizes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kLengthComponent;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kPadToBucketBoundary;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kNumPaddedShapes;
+
+constexpr char kInputExhausted[] = "input_exhausted";
+constexpr char kFlushIndex[] = "flush_index";
+
+class BucketedPaddedBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<int64_t> bucket_boundaries,
+          std::vector<int64_t> bucket_batch_sizes, bool drop_remainder,
+          int64_t length_component, bool pad_to_bucket_boundary,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, const DatasetBase* input)
+      : DatasetBase(DatasetContext(ctx)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        drop_remainder_(drop_remainder),
+        length_component_(length_component),
+        pad_to_bucket_boundary_(pad_to_bucket_boundary),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        input_(input),
+        traceme_metadata_(
+            {{"num_buckets",
+              strings::Printf("%lld", static_cast<long long>(
+                                          bucket_batch_sizes_.size()))},
+             {"drop_remainder", drop_remainder ? "true" : "false"}}) {
+    input_->Ref();
+
+    // The batch dimension is only static if every bucket emits batches of the
+    // same size and partial batches are dropped. Padded dimensions vary from
+    // bucket to bucket.
+    int64_t batch_dim = -1;
+    if (drop_remainder_ &&
+        std::all_of(bucket_batch_sizes_.begin(), bucket_batch_sizes_.end(),
+                    [this](int64_t batch_size) {
+                      return batch_size == bucket_batch_sizes_[0];
+                    })) {
+      batch_dim = bucket_batch_sizes_[0];
+    }
+    output_shapes_.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      output_shapes_.push_back(
+          PartialTensorShape({batch_dim}).Concatenate(padded_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t Cardinality() const override {
+    int64_t n = input_->Cardinality();
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* bucket_batch_sizes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_batch_sizes_, &bucket_batch_sizes));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (int i = 0; i < padded_shapes_.size(); i++) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shapes_[i].dims()}));
+      for (int j = 0; j < padded_shapes_[i].dims(); j++) {
+        t.vec<int64_t>()(j) = padded_shapes_[i].dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+    AttrValue length_component;
+    b->BuildAttrValue(length_component_, &length_component);
+    AttrValue pad_to_bucket_boundary;
+    b->BuildAttrValue(pad_to_bucket_boundary_, &pad_to_bucket_boundary);
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this,
+                      {{0, input_graph_node},
+                       {1, bucket_boundaries},
+                       {2, bucket_batch_sizes},
+                       {5, drop_remainder}},
+                      {{3, padded_shapes}, {4, padding_values}},
+                      {{kLengthComponent, length_component},
+                       {kPadToBucketBoundary, pad_to_bucket_boundary},
+                       {kToutputTypes, output_types},
+                       {kNumPaddedShapes, N}},
+                      output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->bucket_batch_sizes_.size()) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      while (input_impl_) {
+        std::vector<Tensor> element;
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+        if (end_of_input) {
+          input_impl_.reset();
+          break;
+        }
+        int64_t bucket_id;
+        TF_RETURN_IF_ERROR(AddToBucket(ctx, std::move(element), &bucket_id));
+        if (buckets_[bucket_id].size ==
+            dataset()->bucket_batch_sizes_[bucket_id]) {
+          EmitBucket(bucket_id, out_tensors);
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+      }
+
+      // The input is exhausted: emit what is left in each bucket, one partial
+      // batch per call, in bucket order.
+      for (; flush_index_ < buckets_.size(); ++flush_index_) {
+        if (buckets_[flush_index_].size == 0) continue;
+        if (dataset()->drop_remainder_) {
+          buckets_[flush_index_] = Bucket();
+          continue;
+        }
+        EmitBucket(flush_index_++, out_tensors);
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kInputExhausted), ""));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kFlushIndex), flush_index_));
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        const Bucket& bucket = buckets_[i];
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(strings::StrCat("buckets[", i, "]_size")), bucket.size));
+        // The padding of the unfilled rows is saved along with the filled
+        // rows, so that the batch tensors can be restored as they are.
+        for (int64_t j = 0; j < bucket.batch.size(); ++j) {
+          TF_RETURN_IF_ERROR(writer->WriteTensor(
+              full_name(strings::StrCat("buckets[", i, "][", j, "]")),
+              bucket.batch[j]));
+        }
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (reader->Contains(full_name(kInputExhausted))) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kFlushIndex), &flush_index_));
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        bucket = Bucket();
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(strings::StrCat("buckets[", i, "]_size")),
+            &bucket.size));
+        if (bucket.size == 0) continue;
+        bucket.batch.resize(dataset()->padded_shapes_.size());
+        for (int64_t j = 0; j < bucket.batch.size(); ++j) {
+          TF_RETURN_IF_ERROR(reader->ReadTensor(
+              ctx->flr(),
+              full_name(strings::StrCat("buckets[", i, "][", j, "]")),
+              &bucket.batch[j]));
+        }
+      }
+      return Status::OK();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // A partially filled batch. `batch` holds one tensor per tuple component,
+    // each with the bucket's batch size as its 0th dimension, and is empty
+    // while `size` is zero.
+    struct Bucket {
+      std::vector<Tensor> batch;
+      int64_t size = 0;
+    };
+
+    // Pads `element` into the next row of the batch of its bucket, and returns
+    // the bucket in `bucket_id`.
+    Status AddToBucket(IteratorContext* ctx, std::vector<Tensor> element,
+                       int64_t* bucket_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const size_t num_components = dataset()->padded_shapes_.size();
+      if (element.size() != num_components) {
+        return errors::InvalidArgument("Expected an element with ",
+                                       num_components,
+                                       " components but got ", element.size());
+      }
+      const Tensor& length_tensor = element[dataset()->length_component_];
+      if (length_tensor.dims() == 0) {
+        return errors::InvalidArgument(
+            "Component ", dataset()->length_component_,
+            " of each element must have rank at least 1 to be bucketed by its "
+            "length, but got a scalar");
+      }
+      const std::vector<int64_t>& boundaries = dataset()->bucket_boundaries_;
+      *bucket_id = std::upper_bound(boundaries.begin(), boundaries.end(),
+                                    length_tensor.dim_size(0)) -
+                   boundaries.begin();
+
+      // Validate every component before writing any of them, so that an
+      // invalid element does not leave a partially written row behind.
+      std::vector<TensorShape> row_shapes(num_components);
+      for (size_t i = 0; i < num_components; ++i) {
+        TF_RETURN_IF_ERROR(
+            RowShape(*bucket_id, i, element[i].shape(), &row_shapes[i]));
+      }
+
+      Bucket& bucket = buckets_[*bucket_id];
+      const int64_t batch_size = dataset()->bucket_batch_sizes_[*bucket_id];
+      if (bucket.size == 0) {
+        bucket.batch.clear();
+        bucket.batch.reserve(num_components);
+      }
+      for (size_t i = 0; i < num_components; ++i) {
+        if (bucket.size == 0) {
+          TensorShape batch_shape({batch_size});
+          batch_shape.AppendShape(row_shapes[i]);
+          bucket.batch.emplace_back(ctx->allocator({}), output_dtypes()[i],
+                                    batch_shape);
+          TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+              &bucket.batch.back(), dataset()->padding_values_[i]));
+        } else {
+          TF_RETURN_IF_ERROR(
+              MaybeGrow(ctx, i, row_shapes[i], bucket.size, &bucket.batch[i]));
+        }
+        Tensor& batch = bucket.batch[i];
+        TensorShape batch_row_shape = batch.shape();
+        batch_row_shape.RemoveDim(0);
+        // Take the fast path if the element fills the whole row.
+        if (element[i].shape() == batch_row_shape) {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+              std::move(element[i]), &batch, bucket.size));
+        } else {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+              element[i], &batch, bucket.size));
+        }
+      }
+      ++bucket.size;
+      return Status::OK();
+    }
+
+    // Computes the smallest row shape of component `component` in bucket
+    // `bucket_id` that holds an element of shape `element_shape`.
+    Status RowShape(int64_t bucket_id, size_t component,
+                    const TensorShape& element_shape,
+                    TensorShape* row_shape) const {
+      const PartialTensorShape& padded_shape =
+          dataset()->padded_shapes_[component];
+      if (element_shape.dims() != padded_shape.dims()) {
+        return errors::InvalidArgument(
+            "All elements must have the same rank as the padded shape for "
+            "component ",
+            component, ": expected rank ", padded_shape.dims(),
+            " but got element with rank ", element_shape.dims());
+      }
+      const std::vector<int64_t>& boundaries = dataset()->bucket_boundaries_;
+      const bool bounded = dataset()->pad_to_bucket_boundary_ &&
+                           bucket_id < static_cast<int64_t>(boundaries.size());
+      for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+        const int64_t element_dim = element_shape.dim_size(dim);
+        int64_t row_dim = padded_shape.dim_size(dim);
+        if (row_dim == -1) {
+          row_dim = bounded ? boundaries[bucket_id] - 1 : element_dim;
+        }
+        if (element_dim > row_dim) {
+          if (padded_shape.dim_size(dim) == -1) {
+            return errors::InvalidArgument(
+                "Dimension ", dim, " of component ", component, " has size ",
+                element_dim, ", which exceeds the bucket boundary ",
+                boundaries[bucket_id], " minus one");
+          }
+          return errors::DataLoss(
+              "Attempted to pad to a smaller size than the input element.");
+        }
+        row_shape->AddDim(row_dim);
+      }
+      return Status::OK();
+    }
+
+    // Reallocates `batch` if its rows are smaller than `row_shape` along some
+    // unknown padded dimension, moving its first `size` rows over.
+    Status MaybeGrow(IteratorContext* ctx, size_t component,
+                     const TensorShape& row_shape, int64_t size,
+                     Tensor* batch) {
+      TensorShape old_row_shape = batch->shape();
+      old_row_shape.RemoveDim(0);
+      TensorShape new_batch_shape({batch->dim_size(0)});
+      bool grow = false;
+      for (int dim = 0; dim < row_shape.dims(); ++dim) {
+        const int64_t old_dim = old_row_shape.dim_size(dim);
+        grow |= row_shape.dim_size(dim) > old_dim;
+        new_batch_shape.AddDim(std::max(old_dim, row_shape.dim_size(dim)));
+      }
+      if (!grow) {
+        return Status::OK();
+      }
+      Tensor new_batch(ctx->allocator({}), batch->dtype(), new_batch_shape);
+      TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+          &new_batch, dataset()->padding_values_[component]));
+      Tensor row(ctx->allocator({}), batch->dtype(), old_row_shape);
+      for (int64_t i = 0; i < size; ++i) {
+        TF_RETURN_IF_ERROR(batch_util::MaybeMoveSliceToElement(batch, &row, i));
+        TF_RETURN_IF_ERROR(
+            batch_util::CopyElementToLargerSlice(row, &new_batch, i));
+      }
+      *batch = std::move(new_batch);
+      return Status::OK();
+    }
+
+    // Emits the batch of bucket `bucket_id`, trimmed to its filled rows, and
+    // empties the bucket.
+    void EmitBucket(int64_t bucket_id, std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[bucket_id];
+      out_tensors->reserve(bucket.batch.size());
+      for (Tensor& batch : bucket.batch) {
+        if (bucket.size == batch.dim_size(0)) {
+          out_tensors->push_back(std::move(batch));
+        } else {
+          out_tensors->push_back(batch.Slice(0, bucket.size));
+        }
+      }
+      bucket = Bucket();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    // The next bucket to flush once the input is exhausted.
+    int64_t flush_index_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const std::vector<int64_t> bucket_boundaries_;
+  const std::vector<int64_t> bucket_batch_sizes_;
+  const bool drop_remainder_;
+  const int64_t length_component_;
+  const bool pad_to_bucket_boundary_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const DatasetBase* const input_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+BucketedPaddedBatchDatasetOp::BucketedPaddedBatchDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLengthComponent, &length_component_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kPadToBucketBoundary, &pad_to_bucket_boundary_));
+}
+
+void BucketedPaddedBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                               DatasetBase* input,
+                                               DatasetBase** output) {
+  std::vector<int64_t> bucket_boundaries;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBoundaries,
+                                                   &bucket_boundaries));
+  for (size_t i = 0; i < bucket_boundaries.size(); ++i) {
+    OP_REQUIRES(ctx,
+                bucket_boundaries[i] > (i == 0 ? 0 : bucket_boundaries[i - 1]),
+                errors::InvalidArgument(
+                    "Bucket boundaries must be positive and strictly "
+                    "increasing, but got ",
+                    absl::StrJoin(bucket_boundaries, ", ")));
+  }
+  std::vector<int64_t> bucket_batch_sizes;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBatchSizes,
+                                                   &bucket_batch_sizes));
+  OP_REQUIRES(ctx, bucket_batch_sizes.size() == bucket_boundaries.size() + 1,
+              errors::InvalidArgument(
+                  "Expected one batch size per bucket, i.e. ",
+                  bucket_boundaries.size() + 1, " batch sizes, but got ",
+                  bucket_batch_sizes.size()));
+  for (int64_t batch_size : bucket_batch_sizes) {
+    OP_REQUIRES(
+        ctx, batch_size > 0,
+        errors::InvalidArgument("Batch sizes must be greater than zero."));
+  }
+
+  bool drop_remainder;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  const size_t num_components = input->output_shapes().size();
+  OP_REQUIRES(ctx,
+              length_component_ >= 0 &&
+                  length_component_ < static_cast<int64_t>(num_components),
+              errors::InvalidArgument(
+                  "length_component must be in [0, ", num_components,
+                  ") but got ", length_component_));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == num_components,
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      num_components, ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(num_components);
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+  OP_REQUIRES(ctx, padded_shapes[length_component_].dims() > 0,
+              errors::InvalidArgument(
+                  "The padded shape of the length component must have rank "
+                  "at least 1"));
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == num_components,
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  num_components, ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, std::move(bucket_boundaries),
+                        std::move(bucket_batch_sizes), drop_remainder,
+                        length_component_, pad_to_bucket_boundary_,
+                        std::move(padded_shapes), std::move(padding_values),
+                        input);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("BucketedPaddedBatchDataset").Device(DEVICE_CPU),
+                        BucketedPaddedBatchDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,388 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/bucketed_padded_batch_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucketed_padded_batch_dataset";
+
+class BucketedPaddedBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketedPaddedBatchDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      std::vector<int64_t> bucket_batch_sizes,
+      std::vector<Tensor> padded_shapes, std::vector<Tensor> padded_values,
+      bool drop_remainder, bool pad_to_bucket_boundary,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padded_shapes_(std::move(padded_shapes)),
+        padded_values_(std::move(padded_values)),
+        drop_remainder_(drop_remainder),
+        pad_to_bucket_boundary_(pad_to_bucket_boundary) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors;
+    input_tensors.emplace_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+        bucket_boundaries_));
+    input_tensors.emplace_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_batch_sizes_.size())}),
+        bucket_batch_sizes_));
+    for (auto& padded_shape : padded_shapes_) {
+      input_tensors.emplace_back(padded_shape);
+    }
+    for (auto& padded_value : padded_values_) {
+      input_tensors.emplace_back(padded_value);
+    }
+    input_tensors.emplace_back(
+        CreateTensor<bool>(TensorShape({}), {drop_remainder_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketedPaddedBatchDatasetOp::kInputDataset,
+                    BucketedPaddedBatchDatasetOp::kBucketBoundaries,
+                    BucketedPaddedBatchDatasetOp::kBucketBatchSizes};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketedPaddedBatchDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int i = 0; i < padded_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketedPaddedBatchDatasetOp::kPaddingValues, "_", i));
+    }
+    input_names->push_back(BucketedPaddedBatchDatasetOp::kDropRemainder);
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {BucketedPaddedBatchDatasetOp::kLengthComponent, 0},
+        {BucketedPaddedBatchDatasetOp::kPadToBucketBoundary,
+         pad_to_bucket_boundary_},
+        {BucketedPaddedBatchDatasetOp::kToutputTypes, output_dtypes_},
+        {BucketedPaddedBatchDatasetOp::kOutputShapes, output_shapes_},
+        {BucketedPaddedBatchDatasetOp::kNumPaddedShapes,
+         static_cast<int64_t>(padded_shapes_.size())}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return BucketedPaddedBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  std::vector<int64_t> bucket_batch_sizes_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padded_values_;
+  bool drop_remainder_;
+  bool pad_to_bucket_boundary_;
+};
+
+class BucketedPaddedBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+// Elements of length 2, 1 and 4, in that order:
+// [0, 1], [2, 3], [4, 5], [6], [7], [8], [9], [10, ..., 13], [14, ..., 17].
+ConcatenateDatasetParams VariableLengthDatasetParams() {
+  auto length_2 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{3, 2},
+                                            {{0, 1, 2, 3, 4, 5}}),
+      /*node_name=*/"tensor_slice_0");
+  auto length_1 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{4, 1}, {{6, 7, 8, 9}}),
+      /*node_name=*/"tensor_slice_1");
+  auto first_length_4 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{1, 4},
+                                            {{10, 11, 12, 13}}),
+      /*node_name=*/"tensor_slice_2");
+  auto second_length_4 = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{1, 4},
+                                            {{14, 15, 16, 17}}),
+      /*node_name=*/"tensor_slice_3");
+  auto first = ConcatenateDatasetParams(
+      std::move(length_2), std::move(length_1),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/"concatenate_0");
+  auto second = ConcatenateDatasetParams(
+      std::move(first_length_4), std::move(second_length_4),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({4})},
+      /*node_name=*/"concatenate_1");
+  return ConcatenateDatasetParams(std::move(first), std::move(second),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate_2");
+}
+
+// One bucket per length, padded to the longest element of each batch.
+BucketedPaddedBatchDatasetParams BucketedPaddedBatchDatasetParams1() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{2, 3},
+      /*bucket_batch_sizes=*/{2, 2, 2},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*pad_to_bucket_boundary=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Same as test case 1 but drop_remainder = true.
+BucketedPaddedBatchDatasetParams BucketedPaddedBatchDatasetParams2() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{2, 3},
+      /*bucket_batch_sizes=*/{2, 2, 2},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/true,
+      /*pad_to_bucket_boundary=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({2, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Elements of length 1 and 2 share a bucket padded to its boundary.
+BucketedPaddedBatchDatasetParams BucketedPaddedBatchDatasetParams3() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{4},
+      /*bucket_batch_sizes=*/{3, 2},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*pad_to_bucket_boundary=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// All elements share a bucket whose batches grow as longer elements arrive.
+BucketedPaddedBatchDatasetParams BucketedPaddedBatchDatasetParams4() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{5},
+      /*bucket_batch_sizes=*/{4, 1},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*pad_to_bucket_boundary=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketedPaddedBatchDatasetParams InvalidBucketBoundariesParams() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{3, 2},
+      /*bucket_batch_sizes=*/{2, 2, 2},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*pad_to_bucket_boundary=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketedPaddedBatchDatasetParams InvalidBucketBatchSizesParams() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{2, 3},
+      /*bucket_batch_sizes=*/{2, 2},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*pad_to_bucket_boundary=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketedPaddedBatchDatasetParams ShortPaddingParams() {
+  return BucketedPaddedBatchDatasetParams(
+      VariableLengthDatasetParams(),
+      /*bucket_boundaries=*/{2, 3},
+      /*bucket_batch_sizes=*/{2, 2, 2},
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*drop_remainder=*/false,
+      /*pad_to_bucket_boundary=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, 1})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<BucketedPaddedBatchDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/BucketedPaddedBatchDatasetParams1(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {8, 9}),
+            CreateTensor<int64_t>(TensorShape{2, 4},
+                                  {10, 11, 12, 13, 14, 15, 16, 17}),
+            CreateTensor<int64_t>(TensorShape{1, 2}, {4, 5})}},
+          {/*dataset_params=*/BucketedPaddedBatchDatasetParams2(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {8, 9}),
+            CreateTensor<int64_t>(TensorShape{2, 4},
+                                  {10, 11, 12, 13, 14, 15, 16, 17})}},
+          {/*dataset_params=*/BucketedPaddedBatchDatasetParams3(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{3, 3},
+                                  {0, 1, -1, 2, 3, -1, 4, 5, -1}),
+            CreateTensor<int64_t>(TensorShape{3, 3},
+                                  {6, -1, -1, 7, -1, -1, 8, -1, -1}),
+            CreateTensor<int64_t>(TensorShape{2, 4},
+                                  {10, 11, 12, 13, 14, 15, 16, 17}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {9, -1, -1})}},
+          {/*dataset_params=*/BucketedPaddedBatchDatasetParams4(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{4, 2}, {0, 1, 2, 3, 4, 5, 6, -1}),
+            CreateTensor<int64_t>(TensorShape{4, 4},
+                                  {7, -1, -1, -1, 8, -1, -1, -1, 9, -1, -1, -1,
+                                   10, 11, 12, 13}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {14, 15, 16, 17})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketedPaddedBatchDatasetOpTest,
+                         BucketedPaddedBatchDatasetParams, GetNextTestCases())
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = BucketedPaddedBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = BucketedPaddedBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketedPaddedBatchDatasetOp::kDatasetType)));
+}
+
+std::vector<DatasetOutputShapesTestCase<BucketedPaddedBatchDatasetParams>>
+DatasetOutputShapesTestCases() {
+  return {{/*dataset_params=*/BucketedPaddedBatchDatasetParams1(),
+           /*expected_output_shapes=*/{PartialTensorShape({-1, -1})}},
+          {/*dataset_params=*/BucketedPaddedBatchDatasetParams2(),
+           /*expected_output_shapes=*/{PartialTensorShape({2, -1})}},
+          {/*dataset_params=*/BucketedPaddedBatchDatasetParams3(),
+           /*expected_output_shapes=*/{PartialTensorShape({-1, -1})}}};
+}
+
+DATASET_OUTPUT_SHAPES_TEST_P(BucketedPaddedBatchDatasetOpTest,
+                             BucketedPaddedBatchDatasetParams,
+                             DatasetOutputShapesTestCases())
+
+std::vector<CardinalityTestCase<BucketedPaddedBatchDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/BucketedPaddedBatchDatasetParams1(),
+           /*expected_cardinality=*/kUnknownCardinality}};
+}
+
+DATASET_CARDINALITY_TEST_P(BucketedPaddedBatchDatasetOpTest,
+                           BucketedPaddedBatchDatasetParams,
+                           CardinalityTestCases())
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = BucketedPaddedBatchDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(
+      name_utils::IteratorPrefix(BucketedPaddedBatchDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketedPaddedBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/BucketedPaddedBatchDatasetParams1(),
+           /*breakpoints=*/{0, 1, 4, 7},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 2}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {6, 7}),
+            CreateTensor<int64_t>(TensorShape{2, 1}, {8, 9}),
+            CreateTensor<int64_t>(TensorShape{2, 4},
+                                  {10, 11, 12, 13, 14, 15, 16, 17}),
+            CreateTensor<int64_t>(TensorShape{1, 2}, {4, 5})}},
+          {/*dataset_params=*/BucketedPaddedBatchDatasetParams4(),
+           /*breakpoints=*/{0, 1, 2, 5},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{4, 2}, {0, 1, 2, 3, 4, 5, 6, -1}),
+            CreateTensor<int64_t>(TensorShape{4, 4},
+                                  {7, -1, -1, -1, 8, -1, -1, -1, 9, -1, -1, -1,
+                                   10, 11, 12, 13}),
+            CreateTensor<int64_t>(TensorShape{1, 4}, {14, 15, 16, 17})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketedPaddedBatchDatasetOpTest,
+                                 BucketedPaddedBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, ShortPadding) {
+  auto dataset_params = ShortPaddingParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      tensorflow::error::DATA_LOSS);
+}
+
+class ParameterizedInvalidArgumentTest
+    : public BucketedPaddedBatchDatasetOpTest,
+      public ::testing::WithParamInterface<BucketedPaddedBatchDatasetParams> {
+};
+
+TEST_P(ParameterizedInvalidArgumentTest, InvalidArgument) {
+  auto dataset_params = GetParam();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
+INSTANTIATE_TEST_SUITE_P(BucketedPaddedBatchDatasetOpTest,
+                         ParameterizedInvalidArgumentTest,
+                         ::testing::ValuesIn(
+                             {InvalidBucketBoundariesParams(),
+                              InvalidBucketBatchSizesParams()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/dataset.pb.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
@@ -49,12 +50,15 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
@@ -82,6 +86,7 @@ namespace data {
 /* static */ constexpr const char* const DataServiceDatasetOp::kPartialOffloadEnabled;
 /* static */ constexpr const char* const DataServiceDatasetOp::kRatioLocal;
 /* static */ constexpr const char* const DataServiceDatasetOp::kMaxBandwidthBps;
+/* static */ constexpr const char* const DataServiceDatasetOp::kUncompress;
 /* static */ constexpr const char* const
     DataServiceDatasetOp::kIterationCounter;
 /* static */ constexpr const char* const DataServiceDatasetOp::kOutputTypes;
@@ -105,6 +110,40 @@ bool IsColocatedTask(const TaskInfo& task) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
   });
 }
+
+// Threads for uncompressing the chunks of chunked elements, shared by all
+// iterators in the process.
+thread::ThreadPool* ChunkUncompressionThreadPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "tf_data_service_uncompression",
+                             port::MaxParallelism());
+  return pool;
+}
+
+// Replaces the `CompressedElement` variant in `element` by its uncompressed
+// components. The chunks of chunked elements are uncompressed in parallel.
+Status UncompressComponents(std::vector<Tensor>& element) {
+  if (element.size() != 1 || element[0].dtype() != DT_VARIANT ||
+      !TensorShapeUtils::IsScalar(element[0].shape())) {
+    return errors::Internal(
+        "Expected the tf.data service worker to produce a compressed element");
+  }
+  const CompressedElement* compressed =
+      element[0].scalar<Variant>()().get<CompressedElement>();
+  if (compressed == nullptr) {
+    return errors::Internal("Expected a CompressedElement variant, but got ",
+                            element[0].scalar<Variant>()().TypeName());
+  }
+  std::vector<Tensor> uncompressed;
+  TF_RETURN_IF_ERROR(UncompressElement(
+      *compressed,
+      [](std::function<void()> fn) {
+        ChunkUncompressionThreadPool()->Schedule(std::move(fn));
+      },
+      &uncompressed));
+  element = std::move(uncompressed);
+  return Status::OK();
+}
 }  // namespace
 
 // Dataset for reading data from the tf.data service non-deterministically.
@@ -124,7 +163,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
           const TargetWorkers target_workers,
           bool partial_offload_enabled,
           float ratio_local,
-          int64_t max_bandwidth_bps,
+          int64_t max_bandwidth_bps, bool uncompress,
           IterationCounter* iteration_counter, bool owns_resource,
           ResourceHandle iteration_counter_handle,
           const DataTypeVector& output_types,
@@ -146,6 +185,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         partial_offload_enabled_(partial_offload_enabled),
         ratio_local_(ratio_local),
         max_bandwidth_bps_(max_bandwidth_bps),
+        uncompress_(uncompress),
         iteration_counter_(iteration_counter),
         owns_resource_(owns_resource),
         iteration_counter_handle_(iteration_counter_handle),
@@ -266,6 +306,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     AttrValue ratio_local;
     b->BuildAttrValue(ratio_local_, &ratio_local);
 
+    AttrValue uncompress;
+    b->BuildAttrValue(uncompress_, &uncompress);
+
     AttrValue task_refresh_interval_hint_ms;
     b->BuildAttrValue(task_refresh_interval_ms_,
                       &task_refresh_interval_hint_ms);
@@ -280,7 +323,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
          std::make_pair(kDataTransferProtocol, data_transfer_protocol),
          std::make_pair(kTargetWorkers, target_workers),
          std::make_pair(kPartialOffloadEnabled, partial_offload_enabled),
-         std::make_pair(kRatioLocal, ratio_local)},
+         std::make_pair(kRatioLocal, ratio_local),
+         std::make_pair(kUncompress, uncompress)},
         output));
     return Status::OK();
   }
@@ -356,7 +400,9 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       do {
         while (!ResultReady() && !Finished() && !cancelled_ && status_.ok()) {
           VLOG(3) << "Blocking in GetNext: " << DebugString();
+          const int64_t wait_start_micros = Env::Default()->NowMicros();
           get_next_cv_.wait(l);
+          stalled_micros_ += Env::Default()->NowMicros() - wait_start_micros;
         }
         if (cancelled_) {
           VLOG(3) << "Returning from GetNext due to cancellation";
@@ -385,6 +431,7 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                   << ": Result " << get_next_index_++;
         }
         out_tensors->swap(result.element);
+        ++elements_since_heartbeat_;
       }
       return Status::OK();
     }
@@ -662,6 +709,22 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     void Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       ClientHeartbeatRequest req;
       req.set_job_client_id(job_client_id_);
+      {
+        mutex_lock l(mu_);
+        const int64_t now_micros = Env::Default()->NowMicros();
+        if (last_heartbeat_micros_ >= 0 &&
+            now_micros > last_heartbeat_micros_) {
+          const double elapsed_micros = now_micros - last_heartbeat_micros_;
+          req.set_stall_ratio(stalled_micros_ / elapsed_micros);
+          req.set_elements_per_second(elements_since_heartbeat_ * 1e6 /
+                                      elapsed_micros);
+        }
+        req.set_buffered_elements(results_.size());
+        req.set_buffer_capacity(max_outstanding_requests_);
+        stalled_micros_ = 0;
+        elements_since_heartbeat_ = 0;
+        last_heartbeat_micros_ = now_micros;
+      }
       if (StrictRoundRobin()) {
         mutex_lock l(mu_);
         req.set_current_round(current_round_);
@@ -1074,6 +1137,15 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
                 << " microseconds";
         Env::Default()->SleepForMicroseconds(backoff_until - now_micros);
       }
+      if (dataset()->uncompress_ && !get_element_result.end_of_sequence &&
+          !get_element_result.skip) {
+        // Uncompress on the fetching thread, so that elements are uncompressed
+        // in parallel before they reach `results_`.
+        tensorflow::profiler::TraceMe activity(
+            "UncompressElement", tensorflow::profiler::TraceMeLevel::kInfo);
+        TF_RETURN_IF_ERROR(
+            UncompressComponents(get_element_result.components));
+      }
       ProcessGetElementResponse(enqueue_result, get_element_result, result,
                                 *task);
       return Status::OK();
@@ -1158,6 +1230,12 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
     int64_t job_client_id_;
     std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
     int64_t get_next_index_ TF_GUARDED_BY(mu_) = 0;
+    // Time GetNext spent waiting for elements, and the number of elements it
+    // returned, since the last heartbeat. Heartbeats report the consumer's
+    // load to the dispatcher.
+    int64_t stalled_micros_ TF_GUARDED_BY(mu_) = 0;
+    int64_t elements_since_heartbeat_ TF_GUARDED_BY(mu_) = 0;
+    int64_t last_heartbeat_micros_ TF_GUARDED_BY(mu_) = -1;
 
     bool job_finished_ = false;
     bool should_finish_job_ TF_GUARDED_BY(mu_) = true;
@@ -1182,6 +1260,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
   const bool partial_offload_enabled_;
   const float ratio_local_;
   const int64_t max_bandwidth_bps_;
+  // Whether to uncompress the elements received from the workers.
+  const bool uncompress_;
   IterationCounter* const iteration_counter_;  // Owned
   const bool owns_resource_;
   const ResourceHandle iteration_counter_handle_;
@@ -1201,6 +1281,9 @@ DataServiceDatasetOp::DataServiceDatasetOp(OpKernelConstruction* ctx)
                                    &partial_offload_enabled_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kRatioLocal,
                                    &ratio_local_));
+  if (ctx->HasAttr(kUncompress)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kUncompress, &uncompress_));
+  }
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   if (ctx->HasAttr(kDataTransferProtocol)) {
@@ -1339,7 +1422,7 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
       ctx, op_version_, dataset_id, processing_mode, address, protocol,
       data_transfer_protocol_, job_name, consumer_index, num_consumers,
       max_outstanding_requests, task_refresh_interval_hint_ms_, target_workers_, 
-      partial_offload_enabled_, ratio_local_, max_bandwidth_bps,
+      partial_offload_enabled_, ratio_local_, max_bandwidth_bps, uncompress_,
       iteration_counter, owns_resource, iteration_counter_handle, output_types_,
       output_shapes_);
 }
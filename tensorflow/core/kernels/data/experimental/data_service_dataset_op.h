@@ -72,6 +72,7 @@ class DataServiceDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kPartialOffloadEnabled = "partial_offload_enabled";
   static constexpr const char* const kRatioLocal = "ratio_local";
   static constexpr const char* const kMaxBandwidthBps = "max_bandwidth_bps";
+  static constexpr const char* const kUncompress = "uncompress";
   static constexpr const char* const kIterationCounter = "iteration_counter";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
@@ -95,6 +96,7 @@ class DataServiceDatasetOp : public DatasetOpKernel {
   bool partial_offload_enabled_;
   float ratio_local_;
   int64_t max_bandwidth_bps_;
+  bool uncompress_ = false;
 };
 
 }  // namespace data
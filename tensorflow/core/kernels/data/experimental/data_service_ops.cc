@@ -49,6 +49,9 @@ RegisterDatasetOp::RegisterDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kElementSpec, &element_spec));
     element_spec_.emplace(element_spec);
   }
+  if (ctx->HasAttr(kCompressOnWorker)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompressOnWorker, &compress_on_worker_));
+  }
 }
 
 void RegisterDatasetOp::Compute(OpKernelContext* ctx) {
@@ -85,6 +88,7 @@ void RegisterDatasetOp::Compute(OpKernelContext* ctx) {
             "Original error: ",
             s));
   }
+  dataset_def.set_compress_elements(compress_on_worker_);
 
   DataServiceDispatcherClient client(address, protocol);
   int64_t dataset_id;
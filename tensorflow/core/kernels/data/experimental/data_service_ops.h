@@ -28,6 +28,8 @@ namespace data {
 // The address and protocol inputs are used to connect to the dispatcher.
 // The external state policy attribute determines whether to ignore, warn, or
 // error out when the dataset contains external state.
+// If `compress_on_worker` is set, tf.data service workers compress the
+// dataset's elements before sending them.
 // The op produces a dataset id for identifying the registered dataset.
 class RegisterDatasetOp : public OpKernel {
  public:
@@ -36,6 +38,7 @@ class RegisterDatasetOp : public OpKernel {
   static constexpr const char* const kExternalStatePolicy =
       "external_state_policy";
   static constexpr const char* const kElementSpec = "element_spec";
+  static constexpr const char* const kCompressOnWorker = "compress_on_worker";
   static constexpr const char* const kTimeoutMs = "timeout_ms";
 
   explicit RegisterDatasetOp(OpKernelConstruction* ctx);
@@ -45,6 +48,7 @@ class RegisterDatasetOp : public OpKernel {
  private:
   SerializationContext::ExternalStatePolicy external_state_policy_;
   absl::optional<std::string> element_spec_;
+  bool compress_on_worker_ = false;
 };
 
 }  // namespace data
@@ -0,0 +1,81 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/data_udf_op.h"
+
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const DataUdfOp::kUdfName;
+/* static */ constexpr const char* const DataUdfOp::kLibrary;
+/* static */ constexpr const char* const DataUdfOp::kConfig;
+/* static */ constexpr const char* const DataUdfOp::kOutputTypes;
+/* static */ constexpr const char* const DataUdfOp::kOutputShapes;
+
+DataUdfOp::DataUdfOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+  string udf_name;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kUdfName, &udf_name));
+  string library;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kLibrary, &library));
+  string config;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kConfig, &config));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES(ctx, output_types_.size() == output_shapes_.size(),
+              errors::InvalidArgument(
+                  "output_types and output_shapes must have the same length, "
+                  "got ",
+                  output_types_.size(), " and ", output_shapes_.size()));
+  // The library is loaded once per process, so that the op works in any
+  // process running the graph, e.g. a tf.data service worker.
+  if (!library.empty()) {
+    OP_REQUIRES_OK(ctx, LoadDataUdfPlugin(library));
+  }
+  OP_REQUIRES_OK(ctx, CDataUdf::Create(udf_name, config, &udf_));
+}
+
+void DataUdfOp::Compute(OpKernelContext* ctx) {
+  std::vector<Tensor> inputs;
+  inputs.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    inputs.push_back(ctx->input(i));
+  }
+  std::vector<Tensor> outputs;
+  OP_REQUIRES_OK(ctx, udf_->Compute(inputs, output_types_.size(), &outputs));
+  for (int i = 0; i < outputs.size(); ++i) {
+    OP_REQUIRES(
+        ctx, outputs[i].dtype() == output_types_[i],
+        errors::InvalidArgument("UDF output ", i, " was expected to be a ",
+                                DataTypeString(output_types_[i]),
+                                " tensor but got a ",
+                                DataTypeString(outputs[i].dtype()), " tensor."));
+    OP_REQUIRES(ctx, output_shapes_[i].IsCompatibleWith(outputs[i].shape()),
+                errors::InvalidArgument(
+                    "UDF output ", i, " was expected to have a shape ",
+                    "compatible with ", output_shapes_[i].DebugString(),
+                    " but got ", outputs[i].shape().DebugString(), "."));
+    ctx->set_output(i, std::move(outputs[i]));
+  }
+}
+
+REGISTER_KERNEL_BUILDER(Name("DataUdf").Device(DEVICE_CPU), DataUdfOp);
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -87,6 +87,7 @@ namespace data {
 /* static */ constexpr const char* const FastflowOffloadingFetchOp::kPartialOffloadEnabled;
 /* static */ constexpr const char* const FastflowOffloadingFetchOp::kRatioLocal;
 /* static */ constexpr const char* const FastflowOffloadingFetchOp::kMaxBandwidthBps;
+/* static */ constexpr const char* const FastflowOffloadingFetchOp::kNumEpochs;
 /* static */ constexpr const char* const
       FastflowOffloadingFetchOp::kIterationCounter;
 /* static */ constexpr const char* const FastflowOffloadingFetchOp::kOutputTypes;
@@ -105,11 +106,47 @@ constexpr const char kDistributedEpoch[] = "distributed_epoch";
 // Same timeout used by the RegisterDatasetOp.
 constexpr absl::Duration kGetMetadataRetryTimeout = absl::Hours(1);
 
+// Number of elements to prefetch from the job of the next iteration when
+// `max_outstanding_requests` is autotuned.
+constexpr int64_t kDefaultNextJobPrefetchElements = 16;
+
+// A prefetched next job which no iterator adopts within this time is released,
+// so that it does not hold worker resources after training has stopped.
+constexpr int64_t kNextJobIdleTimeoutMicros = int64_t{10} * 60 * 1000 * 1000;
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](absl::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
   });
 }
+
+// Returns whether a non-round-robin reader targeting `target_workers` should
+// read from `task`.
+bool ShouldReadFromTask(const TaskInfo& task, TargetWorkers target_workers) {
+  const bool is_local_task =
+      (LocalWorkers::Get(task.worker_address()) != nullptr);
+  if (target_workers == TARGET_WORKERS_LOCAL && !is_local_task) {
+    return false;
+  }
+
+  // Cross-TF/TPU host reads may cause resource contention on the TF/TPU
+  // hosts. tf.data service avoids reading from non-local TF-hosted workers.
+  const bool is_cross_tf_host_read = !is_local_task && IsColocatedTask(task);
+  if (target_workers == TARGET_WORKERS_AUTO && is_cross_tf_host_read) {
+    return false;
+  }
+  return true;
+}
+
+// Returns whether a non-round-robin reader targeting `target_workers` should
+// delete the local `task` once it is done, because no other client reads it.
+bool ShouldDeleteLocalTask(const TaskInfo& task,
+                           TargetWorkers target_workers) {
+  if (target_workers == TARGET_WORKERS_LOCAL) {
+    return true;
+  }
+  return target_workers == TARGET_WORKERS_AUTO && IsColocatedTask(task);
+}
 }  // namespace
 
 // Dataset for reading data from the tf.data service non-deterministically.
@@ -129,7 +166,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
           const TargetWorkers target_workers,
           bool partial_offload_enabled,
           float ratio_local,
-          int64_t max_bandwidth_bps,
+          int64_t max_bandwidth_bps, int64_t num_epochs,
           IterationCounter* iteration_counter, bool owns_resource,
           ResourceHandle iteration_counter_handle,
           const DataTypeVector& output_types,
@@ -151,6 +188,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
         partial_offload_enabled_(partial_offload_enabled),
         ratio_local_(ratio_local),
         max_bandwidth_bps_(max_bandwidth_bps),
+        num_epochs_(num_epochs),
         iteration_counter_(iteration_counter),
         owns_resource_(owns_resource),
         iteration_counter_handle_(iteration_counter_handle),
@@ -172,10 +210,18 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
-    return absl::make_unique<Iterator>(
-        Iterator::Params{this,
-                         name_utils::IteratorPrefix(kDatasetType, prefix)},
-        iteration_counter_->GetAndIncrement());
+    const std::string iterator_prefix =
+        name_utils::IteratorPrefix(kDatasetType, prefix);
+    const int64_t iterator_index = iteration_counter_->GetAndIncrement();
+    // The prefetched job is only adopted by the iterator it was prefetched
+    // for. Otherwise, e.g. when several iterators are created concurrently,
+    // it is released.
+    std::unique_ptr<NextJobPrefetcher> next_job = TakeNextJob();
+    if (next_job && next_job->iterator_index() != iterator_index) {
+      next_job.reset();
+    }
+    return absl::make_unique<Iterator>(Iterator::Params{this, iterator_prefix},
+                                       iterator_index, std::move(next_job));
   }
 
   const DataTypeVector& output_dtypes() const override { return output_types_; }
@@ -271,6 +317,9 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
     AttrValue ratio_local;
     b->BuildAttrValue(ratio_local_, &ratio_local);
 
+    AttrValue num_epochs;
+    b->BuildAttrValue(num_epochs_, &num_epochs);
+
     AttrValue task_refresh_interval_hint_ms;
     b->BuildAttrValue(task_refresh_interval_ms_,
                       &task_refresh_interval_hint_ms);
@@ -285,17 +334,340 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
          std::make_pair(kDataTransferProtocol, data_transfer_protocol),
          std::make_pair(kTargetWorkers, target_workers),
          std::make_pair(kPartialOffloadEnabled, partial_offload_enabled),
-         std::make_pair(kRatioLocal, ratio_local)},
+         std::make_pair(kRatioLocal, ratio_local),
+         std::make_pair(kNumEpochs, num_epochs)},
         output));
     return Status::OK();
   }
 
  private:
+  // Creates the job of the next iterator and prefetches its first elements,
+  // so that a new epoch starts streaming while the previous iterator is still
+  // draining its job. The job and the prefetched elements are handed over to
+  // the next iterator made from this dataset. Only used for non-round-robin
+  // reads.
+  class NextJobPrefetcher {
+   public:
+    NextJobPrefetcher(const Dataset* dataset, int64_t iterator_index)
+        : dataset_(dataset),
+          iterator_index_(iterator_index),
+          max_elements_(dataset->max_outstanding_requests_ == model::kAutotune
+                            ? kDefaultNextJobPrefetchElements
+                            : std::max<int64_t>(
+                                  dataset->max_outstanding_requests_, 1)),
+          start_micros_(Env::Default()->NowMicros()),
+          dispatcher_(dataset->address_, dataset->protocol_) {
+      VLOG(1) << "Prefetching the job of data service iterator "
+              << iterator_index_;
+      manager_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+          {}, "tf_data_next_job_prefetcher", [this]() { RunManagerThread(); }));
+    }
+
+    ~NextJobPrefetcher() {
+      std::vector<std::unique_ptr<Thread>> fetch_threads;
+      {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        if (!taken_) {
+          for (const auto& task : tasks_) {
+            task->worker->TryCancel();
+          }
+        }
+        cv_.notify_all();
+      }
+      manager_thread_.reset();
+      {
+        mutex_lock l(mu_);
+        fetch_threads.swap(fetch_threads_);
+      }
+      fetch_threads.clear();
+      mutex_lock l(mu_);
+      if (!taken_) {
+        ReleaseJob();
+      }
+    }
+
+    int64_t iterator_index() const { return iterator_index_; }
+
+    // Returns whether the job was released because no iterator adopted it.
+    bool expired() const TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      return released_;
+    }
+
+    // Stops prefetching and hands over the job to the caller. The elements
+    // prefetched so far are appended to `elements`.
+    Status TakeJob(int64_t& job_client_id,
+                   std::vector<std::vector<Tensor>>& elements)
+        TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      while (!job_created_ && status_.ok()) {
+        cv_.wait(l);
+      }
+      TF_RETURN_IF_ERROR(status_);
+      if (released_) {
+        return errors::Cancelled("The prefetched job was already released");
+      }
+      // Requests in flight are allowed to finish, since the elements they
+      // return are no longer available from the workers.
+      taken_ = true;
+      cancelled_ = true;
+      cv_.notify_all();
+      while (outstanding_requests_ > 0) {
+        cv_.wait(l);
+      }
+      job_client_id = job_client_id_;
+      for (auto& element : elements_) {
+        elements.push_back(std::move(element));
+      }
+      elements_.clear();
+      return Status::OK();
+    }
+
+   private:
+    struct Task {
+      Task(const TaskInfo& info,
+           std::unique_ptr<DataServiceWorkerClient> worker)
+          : info(info), worker(std::move(worker)) {}
+
+      const TaskInfo info;
+      const std::unique_ptr<DataServiceWorkerClient> worker;
+    };
+
+    void RunManagerThread() TF_LOCKS_EXCLUDED(mu_) {
+      absl::optional<JobKey> key;
+      if (!dataset_->job_name_.empty()) {
+        key.emplace();
+        key.value().set_job_name(std::string(dataset_->job_name_));
+        key.value().set_job_name_index(iterator_index_);
+      }
+      int64_t job_client_id;
+      Status s = grpc_util::Retry(
+          [&]() {
+            return dispatcher_.GetOrCreateJob(
+                dataset_->dataset_id_, dataset_->processing_mode_, key,
+                dataset_->num_consumers_, dataset_->target_workers_,
+                job_client_id);
+          },
+          [&]() {
+            mutex_lock l(mu_);
+            return !cancelled_;
+          },
+          strings::StrCat("create the next job with dispatcher at ",
+                          dataset_->address_),
+          /*deadline_micros=*/kint64max);
+      {
+        mutex_lock l(mu_);
+        if (!s.ok()) {
+          status_ = s;
+          cv_.notify_all();
+          return;
+        }
+        job_client_id_ = job_client_id;
+        job_created_ = true;
+        cv_.notify_all();
+      }
+      while (true) {
+        Heartbeat();
+        mutex_lock l(mu_);
+        // Named jobs are kept until the dataset is destroyed, since their
+        // iterator indices must stay aligned across consumers.
+        if (!cancelled_ && dataset_->job_name_.empty() &&
+            Env::Default()->NowMicros() - start_micros_ >
+                kNextJobIdleTimeoutMicros) {
+          VLOG(1) << "Releasing the unused job of data service iterator "
+                  << iterator_index_;
+          cancelled_ = true;
+          for (const auto& task : tasks_) {
+            task->worker->TryCancel();
+          }
+          cv_.notify_all();
+          while (outstanding_requests_ > 0) {
+            cv_.wait(l);
+          }
+          ReleaseJob();
+          return;
+        }
+        if (cancelled_) {
+          return;
+        }
+        cv_.wait_for(l, std::chrono::milliseconds(
+                            dataset_->task_refresh_interval_ms_));
+        if (cancelled_) {
+          return;
+        }
+      }
+    }
+
+    // Keeps the job client alive and starts fetching from new tasks.
+    void Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
+      ClientHeartbeatRequest req;
+      req.set_job_client_id(job_client_id_);
+      ClientHeartbeatResponse resp;
+      Status s = dispatcher_.ClientHeartbeat(req, resp);
+      if (!s.ok()) {
+        VLOG(1) << "Failed to heartbeat for the next job: " << s;
+        return;
+      }
+      mutex_lock l(mu_);
+      for (const TaskInfo& task_info : resp.task_info()) {
+        if (cancelled_ || task_ids_.contains(task_info.task_id()) ||
+            !ShouldReadFromTask(task_info, dataset_->target_workers_)) {
+          continue;
+        }
+        StatusOr<std::unique_ptr<DataServiceWorkerClient>> worker =
+            CreateDataServiceWorkerClient(task_info.transfer_address(),
+                                          dataset_->protocol_,
+                                          dataset_->data_transfer_protocol_,
+                                          dataset_->max_bandwidth_bps_);
+        if (!worker.ok()) {
+          VLOG(1) << "Failed to create a client for task "
+                  << task_info.task_id() << ": " << worker.status();
+          continue;
+        }
+        task_ids_.insert(task_info.task_id());
+        auto task = std::make_shared<Task>(task_info,
+                                           std::move(worker).ValueOrDie());
+        tasks_.push_back(task);
+        fetch_threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+            {}, "tf_data_next_job_fetcher",
+            [this, task]() { RunFetchThread(task); })));
+      }
+    }
+
+    // Fetches elements from `task` until `max_elements_` elements are
+    // buffered or prefetching stops.
+    void RunFetchThread(std::shared_ptr<Task> task) TF_LOCKS_EXCLUDED(mu_) {
+      for (int num_retries = 0;;) {
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && static_cast<int64_t>(elements_.size()) +
+                                        outstanding_requests_ >=
+                                    max_elements_) {
+            cv_.wait(l);
+          }
+          if (cancelled_) {
+            return;
+          }
+          ++outstanding_requests_;
+        }
+        GetElementRequest req;
+        req.set_task_id(task->info.task_id());
+        GetElementResult result;
+        Status s = task->worker->GetElement(req, result);
+        mutex_lock l(mu_);
+        --outstanding_requests_;
+        cv_.notify_all();
+        if (!s.ok()) {
+          // The task may not have been started by its worker yet. The iterator
+          // which adopts the job reports persistent errors.
+          if (cancelled_ || (!errors::IsUnavailable(s) &&
+                             !errors::IsCancelled(s) && !errors::IsAborted(s))) {
+            return;
+          }
+          cv_.wait_for(l, std::chrono::microseconds(
+                              ::tensorflow::ComputeBackoffMicroseconds(
+                                  num_retries++)));
+          continue;
+        }
+        num_retries = 0;
+        if (result.end_of_sequence) {
+          return;
+        }
+        if (!result.skip) {
+          elements_.push_back(std::move(result.components));
+        }
+      }
+    }
+
+    void ReleaseJob() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!job_created_ || released_) {
+        return;
+      }
+      released_ = true;
+      Status s = dispatcher_.ReleaseJobClient(job_client_id_);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to release job client id: " << s;
+      }
+      for (const auto& task : tasks_) {
+        std::shared_ptr<DataServiceWorkerImpl> worker =
+            LocalWorkers::Get(task->info.worker_address());
+        if (worker &&
+            ShouldDeleteLocalTask(task->info, dataset_->target_workers_)) {
+          worker->DeleteLocalTask(task->info);
+        }
+      }
+    }
+
+    const Dataset* const dataset_;
+    const int64_t iterator_index_;
+    const int64_t max_elements_;
+    const int64_t start_micros_;
+    DataServiceDispatcherClient dispatcher_;
+
+    mutable mutex mu_;
+    condition_variable cv_;
+    // Set when prefetching stops, either because the job is taken or because
+    // it is released.
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    bool taken_ TF_GUARDED_BY(mu_) = false;
+    bool released_ TF_GUARDED_BY(mu_) = false;
+    bool job_created_ TF_GUARDED_BY(mu_) = false;
+    int64_t job_client_id_ = -1;
+    // Error from creating the job.
+    Status status_ TF_GUARDED_BY(mu_);
+    absl::flat_hash_set<int64_t> task_ids_ TF_GUARDED_BY(mu_);
+    std::vector<std::shared_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
+    int64_t outstanding_requests_ TF_GUARDED_BY(mu_) = 0;
+    std::vector<std::vector<Tensor>> elements_ TF_GUARDED_BY(mu_);
+    std::vector<std::unique_ptr<Thread>> fetch_threads_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<Thread> manager_thread_;
+  };
+
+  // Starts prefetching the job of the iterator with index `iterator_index`,
+  // unless a job is already being prefetched. The index is only reserved
+  // when that iterator is created.
+  void PrefetchNextJob(int64_t iterator_index) const
+      TF_LOCKS_EXCLUDED(next_job_mu_) {
+    // Destroying a prefetcher joins its threads, so an expired prefetcher is
+    // destroyed after `next_job_mu_` is released.
+    std::unique_ptr<NextJobPrefetcher> expired_job;
+    mutex_lock l(next_job_mu_);
+    if (next_job_ && !next_job_->expired()) {
+      return;
+    }
+    expired_job.swap(next_job_);
+    next_job_ = absl::make_unique<NextJobPrefetcher>(this, iterator_index);
+  }
+
+  // Stops prefetching the next job and releases it.
+  void CancelNextJob() const TF_LOCKS_EXCLUDED(next_job_mu_) {
+    std::unique_ptr<NextJobPrefetcher> next_job;
+    mutex_lock l(next_job_mu_);
+    next_job.swap(next_job_);
+  }
+
+  // Returns the prefetched next job, or nullptr if there is none.
+  std::unique_ptr<NextJobPrefetcher> TakeNextJob() const
+      TF_LOCKS_EXCLUDED(next_job_mu_) {
+    std::unique_ptr<NextJobPrefetcher> next_job;
+    {
+      mutex_lock l(next_job_mu_);
+      next_job.swap(next_job_);
+    }
+    if (next_job && next_job->expired()) {
+      return nullptr;
+    }
+    return next_job;
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
-    explicit Iterator(const Params& params, int64_t iterator_index)
+    Iterator(const Params& params, int64_t iterator_index,
+             std::unique_ptr<NextJobPrefetcher> next_job)
         : DatasetIterator<Dataset>(params),
           iterator_index_(iterator_index),
+          next_job_(std::move(next_job)),
           max_outstanding_requests_(params.dataset->max_outstanding_requests_) {
         VLOG(0) << "New iterator created " << iterator_index << " for job " << job_client_id_;
     }
@@ -325,10 +697,45 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
       VLOG(0) << "Connecting to " << dataset()->address_
               << " in FastFlowOffloadingFetch op";
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
-          ctx->cancellation_manager(), [this]() { CancelThreads(); },
+          ctx->cancellation_manager(),
+          [this]() {
+            // Iterators are also cancelled when they are destroyed at the end
+            // of an epoch. Only cancellation before the end of the epoch means
+            // that training stopped and the next epoch's job is not needed.
+            bool end_of_epoch;
+            {
+              mutex_lock l(mu_);
+              end_of_epoch = returned_end_of_sequence_;
+            }
+            if (!end_of_epoch) {
+              dataset()->CancelNextJob();
+            }
+            CancelThreads();
+          },
           &deregister_fn_));
       dispatcher_ = absl::make_unique<DataServiceDispatcherClient>(
           dataset()->address_, dataset()->protocol_);
+      if (next_job_) {
+        std::vector<std::vector<Tensor>> elements;
+        Status s = next_job_->TakeJob(job_client_id_, elements);
+        next_job_.reset();
+        if (s.ok()) {
+          VLOG(1) << "Iterator " << iterator_index_
+                  << " adopted prefetched job client " << job_client_id_
+                  << " with " << elements.size() << " elements";
+          mutex_lock l(mu_);
+          for (auto& element : elements) {
+            Result result;
+            result.ready = true;
+            result.element = std::move(element);
+            results_.push(std::move(result));
+          }
+          initialized_ = true;
+          return Status::OK();
+        }
+        LOG(WARNING) << "Failed to adopt the prefetched job of iterator "
+                     << iterator_index_ << ": " << s;
+      }
       int64_t deadline_micros = kint64max;
       absl::optional<JobKey> key;
       if (!dataset()->job_name_.empty()) {
@@ -355,13 +762,19 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
       VLOG(1) << "Calling GetNext in data service dataset's iterator" << iterator_index_ << " ;" << job_client_id_;
+      // Declared before `l`, so that a next job requested while waiting for
+      // this element is started after `mu_` is released.
+      auto start_next_job =
+          gtl::MakeCleanup([this]() { StartRequestedNextJob(); });
       mutex_lock l(mu_);
       EnsureThreadsStarted(ctx);
       Result result;
       do {
         while (!ResultReady() && !Finished() && !cancelled_ && status_.ok()) {
           VLOG(3) << "Blocking in GetNext: " << DebugString();
+          const int64_t wait_start_micros = Env::Default()->NowMicros();
           get_next_cv_.wait(l);
+          stalled_micros_ += Env::Default()->NowMicros() - wait_start_micros;
         }
         if (cancelled_) {
           if (exception_partial_offload_) {
@@ -377,6 +790,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
         }
         if (results_.empty()) {
           *end_of_sequence = true;
+          returned_end_of_sequence_ = true;
           VLOG(3) << "Returning from GetNext with end_of_sequence";
           return Status::OK();
         }
@@ -394,6 +808,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
                   << ": Result " << get_next_index_++;
         }
         out_tensors->swap(result.element);
+        ++elements_since_heartbeat_;
       }
       return Status::OK();
     }
@@ -575,13 +990,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
       if (StrictRoundRobin()) {
         return false;
       }
-
-      if (dataset()->target_workers_ == TARGET_WORKERS_LOCAL) {
-        return true;
-      }
-
-      return dataset()->target_workers_ == TARGET_WORKERS_AUTO &&
-             IsColocatedTask(task);
+      return data::ShouldDeleteLocalTask(task, dataset()->target_workers_);
     }
 
     // Periodically refresh the task list.
@@ -646,10 +1055,40 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
         return;
       }
       job_finished_ = true;
+      MaybePrefetchNextJob();
       get_next_cv_.notify_all();
       worker_thread_cv_.notify_all();
     }
 
+    // Once the job starts draining, requests the job of the next epoch so
+    // that its first elements are ready when the next iterator is created.
+    // There is no next epoch after the last of `num_epochs` epochs.
+    void MaybePrefetchNextJob() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (StrictRoundRobin() || next_job_requested_ || cancelled_) {
+        return;
+      }
+      if (dataset()->num_epochs_ >= 0 &&
+          iterator_index_ + 1 >= dataset()->num_epochs_) {
+        return;
+      }
+      next_job_requested_ = true;
+      start_next_job_ = true;
+    }
+
+    // Starts the next job requested by `MaybePrefetchNextJob`. This is called
+    // without holding `mu_`, since starting the job may destroy an expired
+    // prefetcher and wait for its threads.
+    void StartRequestedNextJob() TF_LOCKS_EXCLUDED(mu_) {
+      {
+        mutex_lock l(mu_);
+        if (!start_next_job_ || cancelled_) {
+          return;
+        }
+        start_next_job_ = false;
+      }
+      dataset()->PrefetchNextJob(iterator_index_ + 1);
+    }
+
     Status AddTask(const TaskInfo& task_info) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       TF_ASSIGN_OR_RETURN(
           std::unique_ptr<DataServiceWorkerClient> worker,
@@ -689,6 +1128,22 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
     void Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
       ClientHeartbeatRequest req;
       req.set_job_client_id(job_client_id_);
+      {
+        mutex_lock l(mu_);
+        const int64_t now_micros = Env::Default()->NowMicros();
+        if (last_heartbeat_micros_ >= 0 &&
+            now_micros > last_heartbeat_micros_) {
+          const double elapsed_micros = now_micros - last_heartbeat_micros_;
+          req.set_stall_ratio(stalled_micros_ / elapsed_micros);
+          req.set_elements_per_second(elements_since_heartbeat_ * 1e6 /
+                                      elapsed_micros);
+        }
+        req.set_buffered_elements(results_.size());
+        req.set_buffer_capacity(max_outstanding_requests_);
+        stalled_micros_ = 0;
+        elements_since_heartbeat_ = 0;
+        last_heartbeat_micros_ = now_micros;
+      }
       if (StrictRoundRobin()) {
         mutex_lock l(mu_);
         req.set_current_round(current_round_);
@@ -814,23 +1269,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
       if (StrictRoundRobin()) {
         return true;
       }
-
-      const bool is_local_task =
-          (LocalWorkers::Get(task.worker_address()) != nullptr);
-      if (dataset()->target_workers_ == TARGET_WORKERS_LOCAL &&
-          !is_local_task) {
-        return false;
-      }
-
-      // Cross-TF/TPU host reads may cause resource contention on the TF/TPU
-      // hosts. tf.data service avoids reading from non-local TF-hosted workers.
-      const bool is_cross_tf_host_read =
-          !is_local_task && IsColocatedTask(task);
-      if (dataset()->target_workers_ == TARGET_WORKERS_AUTO &&
-          is_cross_tf_host_read) {
-        return false;
-      }
-      return true;
+      return data::ShouldReadFromTask(task, dataset()->target_workers_);
     }
 
     void UpdateBufferSize() TF_LOCKS_EXCLUDED(mu_) {
@@ -1070,6 +1509,7 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
       } else {
         task.end_of_sequence = true;
         finished_tasks_++;
+        MaybePrefetchNextJob();
         if (task.is_local_task) {
           cnt_local_tasks--;
         } else {
@@ -1208,6 +1648,8 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
     }
 
     const int64_t iterator_index_;
+    // The prefetched job of this iterator, adopted in `Initialize`.
+    std::unique_ptr<NextJobPrefetcher> next_job_;
 
     mutable mutex mu_;
     condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
@@ -1292,8 +1734,20 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
     int64_t job_client_id_;
     std::unique_ptr<DataServiceDispatcherClient> dispatcher_;
     int64_t get_next_index_ TF_GUARDED_BY(mu_) = 0;
+    // Time GetNext spent waiting for elements, and the number of elements it
+    // returned, since the last heartbeat. Heartbeats report the consumer's
+    // load to the dispatcher.
+    int64_t stalled_micros_ TF_GUARDED_BY(mu_) = 0;
+    int64_t elements_since_heartbeat_ TF_GUARDED_BY(mu_) = 0;
+    int64_t last_heartbeat_micros_ TF_GUARDED_BY(mu_) = -1;
 
     bool job_finished_ = false;
+    // Whether this iterator has started prefetching the next epoch's job.
+    bool next_job_requested_ TF_GUARDED_BY(mu_) = false;
+    // Whether the next epoch's job was requested but not started yet.
+    bool start_next_job_ TF_GUARDED_BY(mu_) = false;
+    // Whether `GetNext` has reached the end of the epoch.
+    bool returned_end_of_sequence_ TF_GUARDED_BY(mu_) = false;
     bool should_finish_job_ TF_GUARDED_BY(mu_) = true;
 
     std::vector<std::unique_ptr<Thread>> worker_threads_ TF_GUARDED_BY(mu_);
@@ -1316,12 +1770,20 @@ class FastflowOffloadingFetchOp::Dataset : public DatasetBase {
   const bool partial_offload_enabled_;
   const float ratio_local_;
   const int64_t max_bandwidth_bps_;
+  // The number of epochs the iterators read, or -1 if unknown.
+  const int64_t num_epochs_;
   IterationCounter* const iteration_counter_;  // Owned
   const bool owns_resource_;
   const ResourceHandle iteration_counter_handle_;
   ResourceMgr* const resource_mgr_;  // Not owned
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
+
+  mutable mutex next_job_mu_;
+  // Declared last, so that the prefetcher stops before the fields it reads are
+  // destroyed.
+  mutable std::unique_ptr<NextJobPrefetcher> next_job_
+      TF_GUARDED_BY(next_job_mu_);
 };
 
 FastflowOffloadingFetchOp::FastflowOffloadingFetchOp(OpKernelConstruction* ctx)
@@ -1335,6 +1797,9 @@ FastflowOffloadingFetchOp::FastflowOffloadingFetchOp(OpKernelConstruction* ctx)
                                    &partial_offload_enabled_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kRatioLocal,
                                    &ratio_local_));
+  if (ctx->HasAttr(kNumEpochs)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kNumEpochs, &num_epochs_));
+  }
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   if (ctx->HasAttr(kDataTransferProtocol)) {
@@ -1473,7 +1938,7 @@ void FastflowOffloadingFetchOp::MakeDataset(OpKernelContext* ctx,
       ctx, op_version_, dataset_id, processing_mode, address, protocol,
       data_transfer_protocol_, job_name, consumer_index, num_consumers,
       max_outstanding_requests, task_refresh_interval_hint_ms_, target_workers_, 
-      partial_offload_enabled_, ratio_local_, max_bandwidth_bps,
+      partial_offload_enabled_, ratio_local_, max_bandwidth_bps, num_epochs_,
       iteration_counter, owns_resource, iteration_counter_handle, output_types_,
       output_shapes_);
 }
@@ -77,6 +77,7 @@ class FastflowOffloadingFetchOp : public DatasetOpKernel {
   static constexpr const char* const kPartialOffloadEnabled = "partial_offload_enabled";
   static constexpr const char* const kRatioLocal = "ratio_local";
   static constexpr const char* const kMaxBandwidthBps = "max_bandwidth_bps";
+  static constexpr const char* const kNumEpochs = "num_epochs";
   static constexpr const char* const kIterationCounter = "iteration_counter";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
@@ -100,6 +101,7 @@ class FastflowOffloadingFetchOp : public DatasetOpKernel {
   bool partial_offload_enabled_;
   float ratio_local_;
   int64_t max_bandwidth_bps_;
+  int64_t num_epochs_ = -1;
 };
 
 }  // namespace data
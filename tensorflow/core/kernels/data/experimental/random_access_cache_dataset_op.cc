@@ -0,0 +1,206 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/random_access_cache_dataset_op.h"
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    RandomAccessCacheDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    RandomAccessCacheDatasetOp::kInputDataset;
+/* static */ constexpr const char* const RandomAccessCacheDatasetOp::kCapacity;
+/* static */ constexpr const char* const
+    RandomAccessCacheDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    RandomAccessCacheDatasetOp::kOutputShapes;
+
+bool ElementLruCache::Lookup(int64_t index, std::vector<Tensor>* element) {
+  mutex_lock l(mu_);
+  auto it = index_.find(index);
+  if (it == index_.end()) {
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *element = it->second->second;
+  return true;
+}
+
+void ElementLruCache::Insert(int64_t index,
+                             const std::vector<Tensor>& element) {
+  if (capacity_ <= 0) {
+    return;
+  }
+  mutex_lock l(mu_);
+  auto it = index_.find(index);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    it->second->second = element;
+    return;
+  }
+  if (static_cast<int64_t>(entries_.size()) >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(index, element);
+  index_[index] = entries_.begin();
+}
+
+int64_t ElementLruCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+class RandomAccessCacheDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t capacity)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        capacity_(capacity),
+        cache_(capacity) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t Cardinality() const override { return input_->Cardinality(); }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+  // Serves repeated accesses to the same index from the cache instead of
+  // recomputing the element through the input pipeline.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    if (cache_.Lookup(index, out_tensors)) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(input_->Get(ctx, index, out_tensors));
+    cache_.Insert(index, *out_tensors);
+    return Status::OK();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* capacity_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(capacity_, &capacity_node));
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_graph_node, capacity_node}, output));
+    return Status::OK();
+  }
+
+ private:
+  // Sequential iteration passes the input elements through unchanged; only
+  // random access goes through the cache.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return SaveInput(ctx, writer, input_impl_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return RestoreInput(ctx, reader, input_impl_);
+    }
+
+   private:
+    std::unique_ptr<IteratorBase> input_impl_;
+  };
+
+  const DatasetBase* const input_;
+  const int64_t capacity_;
+  mutable ElementLruCache cache_;
+};
+
+RandomAccessCacheDatasetOp::RandomAccessCacheDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {}
+
+void RandomAccessCacheDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                             DatasetBase* input,
+                                             DatasetBase** output) {
+  int64_t capacity;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kCapacity, &capacity));
+  OP_REQUIRES(ctx, capacity >= 0,
+              errors::InvalidArgument("`capacity` must be >= 0, got ",
+                                      capacity, "."));
+  *output = new Dataset(ctx, input, capacity);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("RandomAccessCacheDataset").Device(DEVICE_CPU),
+                        RandomAccessCacheDatasetOp);
+}  // namespace
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
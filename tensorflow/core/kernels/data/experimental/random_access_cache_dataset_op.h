@@ -0,0 +1,82 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_RANDOM_ACCESS_CACHE_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_RANDOM_ACCESS_CACHE_DATASET_OP_H_
+
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A thread-safe cache of up to `capacity` dataset elements keyed by index,
+// which evicts the least recently used element when full.
+class ElementLruCache {
+ public:
+  explicit ElementLruCache(int64_t capacity) : capacity_(capacity) {}
+
+  // Copies the element at `index` into `element` and returns true if it is
+  // cached, and returns false otherwise.
+  bool Lookup(int64_t index, std::vector<Tensor>* element)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  void Insert(int64_t index, const std::vector<Tensor>& element)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  using Entry = std::pair<int64_t, std::vector<Tensor>>;
+
+  const int64_t capacity_;
+  mutable mutex mu_;
+  // Cached elements, most recently used first.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64_t, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+};
+
+// See tensorflow/core/api_def/base_api/api_def_RandomAccessCacheDataset.pbtxt
+// for the API definition that corresponds to this kernel.
+class RandomAccessCacheDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  static constexpr const char* const kDatasetType = "RandomAccessCache";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kCapacity = "capacity";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+
+  explicit RandomAccessCacheDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_RANDOM_ACCESS_CACHE_DATASET_OP_H_
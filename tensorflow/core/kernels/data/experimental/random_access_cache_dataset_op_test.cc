@@ -0,0 +1,185 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/random_access_cache_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "random_access_cache_dataset";
+
+class RandomAccessCacheDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  RandomAccessCacheDatasetParams(T input_dataset_params, int64_t capacity,
+                                 DataTypeVector output_dtypes,
+                                 std::vector<PartialTensorShape> output_shapes,
+                                 string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        capacity_(capacity) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {capacity_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {RandomAccessCacheDatasetOp::kInputDataset,
+                    RandomAccessCacheDatasetOp::kCapacity};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{RandomAccessCacheDatasetOp::kOutputTypes, output_dtypes_},
+                    {RandomAccessCacheDatasetOp::kOutputShapes,
+                     output_shapes_}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return RandomAccessCacheDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t capacity_;
+};
+
+class RandomAccessCacheDatasetOpTest : public DatasetOpsTestBase {};
+
+RandomAccessCacheDatasetParams CacheParams() {
+  return RandomAccessCacheDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*capacity=*/2,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+RandomAccessCacheDatasetParams NoCacheParams() {
+  return RandomAccessCacheDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*capacity=*/0,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+RandomAccessCacheDatasetParams InvalidCapacityParams() {
+  return RandomAccessCacheDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*capacity=*/-1,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<RandomAccessCacheDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/CacheParams(),
+           /*expected_outputs=*/CreateTensors<int64_t>(
+               TensorShape({}), {{0}, {2}, {4}, {6}, {8}})},
+          {/*dataset_params=*/NoCacheParams(),
+           /*expected_outputs=*/CreateTensors<int64_t>(
+               TensorShape({}), {{0}, {2}, {4}, {6}, {8}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(RandomAccessCacheDatasetOpTest,
+                         RandomAccessCacheDatasetParams, GetNextTestCases())
+
+TEST_F(RandomAccessCacheDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = CacheParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(RandomAccessCacheDatasetOp::kDatasetType)));
+}
+
+TEST_F(RandomAccessCacheDatasetOpTest, Cardinality) {
+  auto dataset_params = CacheParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(5));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<RandomAccessCacheDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/CacheParams(),
+           /*breakpoints=*/{0, 2, 7},
+           /*expected_outputs=*/CreateTensors<int64_t>(
+               TensorShape({}), {{0}, {2}, {4}, {6}, {8}})}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(RandomAccessCacheDatasetOpTest,
+                                 RandomAccessCacheDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(RandomAccessCacheDatasetOpTest, RandomAccess) {
+  auto dataset_params = CacheParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  for (int64_t index : {3, 1, 3, 4, 1, 0}) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(dataset_->Get(dataset_ctx_.get(), index, &element));
+    ASSERT_EQ(element.size(), 1);
+    test::ExpectEqual(element[0],
+                      CreateTensor<int64_t>(TensorShape({}), {2 * index}));
+  }
+  std::vector<Tensor> element;
+  EXPECT_EQ(dataset_->Get(dataset_ctx_.get(), 5, &element).code(),
+            error::OUT_OF_RANGE);
+}
+
+TEST_F(RandomAccessCacheDatasetOpTest, InvalidCapacity) {
+  auto dataset_params = InvalidCapacityParams();
+  EXPECT_EQ(Initialize(dataset_params).code(), error::INVALID_ARGUMENT);
+}
+
+TEST(ElementLruCacheTest, EvictsLeastRecentlyUsed) {
+  ElementLruCache cache(/*capacity=*/2);
+  std::vector<Tensor> element;
+  EXPECT_FALSE(cache.Lookup(0, &element));
+
+  cache.Insert(0, {CreateTensor<int64_t>(TensorShape({}), {0})});
+  cache.Insert(1, {CreateTensor<int64_t>(TensorShape({}), {10})});
+  // Touch 0, so that inserting 2 evicts 1.
+  ASSERT_TRUE(cache.Lookup(0, &element));
+  test::ExpectEqual(element[0], CreateTensor<int64_t>(TensorShape({}), {0}));
+  cache.Insert(2, {CreateTensor<int64_t>(TensorShape({}), {20})});
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup(0, &element));
+  EXPECT_FALSE(cache.Lookup(1, &element));
+  ASSERT_TRUE(cache.Lookup(2, &element));
+  test::ExpectEqual(element[0], CreateTensor<int64_t>(TensorShape({}), {20}));
+}
+
+TEST(ElementLruCacheTest, ZeroCapacity) {
+  ElementLruCache cache(/*capacity=*/0);
+  cache.Insert(0, {CreateTensor<int64_t>(TensorShape({}), {0})});
+  std::vector<Tensor> element;
+  EXPECT_FALSE(cache.Lookup(0, &element));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
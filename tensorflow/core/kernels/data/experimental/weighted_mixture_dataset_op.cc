@@ -0,0 +1,826 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/weighted_mixture_dataset_op.h"
+
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const WeightedMixtureDatasetOp::kDatasetType;
+/* static */ constexpr const char* const WeightedMixtureDatasetOp::kWeights;
+/* static */ constexpr const char* const
+    WeightedMixtureDatasetOp::kDataInputDatasets;
+/* static */ constexpr const char* const WeightedMixtureDatasetOp::kSeed;
+/* static */ constexpr const char* const WeightedMixtureDatasetOp::kSeed2;
+/* static */ constexpr const char* const WeightedMixtureDatasetOp::kBufferSize;
+/* static */ constexpr const char* const
+    WeightedMixtureDatasetOp::kStopOnEmptyDataset;
+/* static */ constexpr const char* const WeightedMixtureDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    WeightedMixtureDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    WeightedMixtureDatasetOp::kNumInputDatasets;
+
+namespace {
+
+// Number of input indices sampled at a time. The weights are re-read from the
+// resource whenever a new batch of indices is sampled.
+constexpr int kSampleBatchSize = 64;
+
+constexpr char kNumRandomSamples[] = "num_random_samples";
+constexpr char kNumActiveInputs[] = "num_active_inputs";
+constexpr char kPendingIndices[] = "pending_indices";
+constexpr char kExhausted[] = "exhausted";
+constexpr char kEndOfInput[] = "end_of_input";
+constexpr char kBuffer[] = "buffer";
+constexpr char kStatus[] = "status";
+constexpr char kSize[] = "size";
+
+PartialTensorShape MostSpecificCompatibleShape(const PartialTensorShape& ts1,
+                                               const PartialTensorShape& ts2) {
+  PartialTensorShape output_tensorshape;
+  if (ts1.dims() != ts2.dims() || ts1.unknown_rank() || ts2.unknown_rank())
+    return output_tensorshape;
+  auto dims1 = ts1.dim_sizes();
+  auto dims2 = ts2.dim_sizes();
+  for (int d = 0; d < ts1.dims(); ++d) {
+    if (dims1[d] == dims2[d])
+      output_tensorshape.Concatenate(dims1[d]);
+    else
+      output_tensorshape.Concatenate(-1);
+  }
+  return output_tensorshape;
+}
+
+}  // namespace
+
+/* static */ Status MixtureDistribution::Create(
+    const std::vector<double>& weights,
+    std::unique_ptr<MixtureDistribution>* out_distribution) {
+  if (weights.empty()) {
+    return errors::InvalidArgument("Mixture weights must not be empty.");
+  }
+  double sum = 0.0;
+  for (size_t i = 0; i < weights.size(); ++i) {
+    if (!std::isfinite(weights[i]) || weights[i] < 0.0) {
+      return errors::InvalidArgument(
+          "Mixture weights must be finite and non-negative, but weight ", i,
+          " is ", weights[i], ".");
+    }
+    sum += weights[i];
+  }
+  if (!(sum > 0.0) || !std::isfinite(sum)) {
+    return errors::InvalidArgument(
+        "Mixture weights must have a finite positive sum, got ", sum, ".");
+  }
+  std::vector<double> probabilities(weights.size());
+  std::vector<float> normalized_weights(weights.size());
+  for (size_t i = 0; i < weights.size(); ++i) {
+    probabilities[i] = weights[i] / sum;
+    normalized_weights[i] = static_cast<float>(probabilities[i]);
+  }
+  out_distribution->reset(
+      new MixtureDistribution(std::move(probabilities), normalized_weights));
+  return Status::OK();
+}
+
+MixtureDistribution::MixtureDistribution(std::vector<double> probabilities,
+                                         const std::vector<float>& weights)
+    : probabilities_(std::move(probabilities)), sampler_(weights) {}
+
+MixtureWeightsResource::MixtureWeightsResource(int64_t num_inputs)
+    : num_inputs_(num_inputs) {
+  std::unique_ptr<MixtureDistribution> distribution;
+  TF_CHECK_OK(MixtureDistribution::Create(
+      std::vector<double>(num_inputs_, 1.0), &distribution));
+  distribution_ = std::move(distribution);
+}
+
+Status MixtureWeightsResource::SetWeights(const std::vector<double>& weights) {
+  if (static_cast<int64_t>(weights.size()) != num_inputs_) {
+    return errors::InvalidArgument("Expected ", num_inputs_,
+                                   " mixture weights, got ", weights.size(),
+                                   ".");
+  }
+  std::unique_ptr<MixtureDistribution> distribution;
+  TF_RETURN_IF_ERROR(MixtureDistribution::Create(weights, &distribution));
+  std::shared_ptr<const MixtureDistribution> new_distribution =
+      std::move(distribution);
+  mutex_lock l(mu_);
+  distribution_.swap(new_distribution);
+  return Status::OK();
+}
+
+std::shared_ptr<const MixtureDistribution>
+MixtureWeightsResource::distribution() const {
+  tf_shared_lock l(mu_);
+  return distribution_;
+}
+
+class WeightedMixtureDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const Tensor& weights_handle,
+          MixtureWeightsResource* weights,
+          std::vector<DatasetBase*> data_inputs, int64_t seed, int64_t seed2,
+          int64_t buffer_size, bool stop_on_empty_dataset)
+      : DatasetBase(DatasetContext(ctx)),
+        weights_handle_(weights_handle),
+        weights_(weights),
+        data_inputs_(std::move(data_inputs)),
+        seeds_(seed, seed2),
+        buffer_size_(buffer_size),
+        stop_on_empty_dataset_(stop_on_empty_dataset) {
+    weights_->Ref();
+    output_shapes_ = data_inputs_[0]->output_shapes();
+    data_inputs_[0]->Ref();
+    for (size_t i = 1; i < data_inputs_.size(); ++i) {
+      const DatasetBase* data_input = data_inputs_[i];
+      data_input->Ref();
+      for (size_t j = 0; j < output_shapes_.size(); ++j) {
+        output_shapes_[j] = MostSpecificCompatibleShape(
+            output_shapes_[j], data_input->output_shapes()[j]);
+      }
+    }
+  }
+
+  ~Dataset() override {
+    weights_->Unref();
+    for (DatasetBase* data_input : data_inputs_) {
+      data_input->Unref();
+    }
+  }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return data_inputs_[0]->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t Cardinality() const override {
+    bool any_infinite = false;
+    bool all_infinite = true;
+    for (const auto& input : data_inputs_) {
+      if (input->Cardinality() == kInfiniteCardinality) {
+        any_infinite = true;
+      } else {
+        all_infinite = false;
+      }
+    }
+    // With `stop_on_empty_dataset`, any finite input may end the mixture.
+    if (stop_on_empty_dataset_ ? all_infinite : any_infinite) {
+      return kInfiniteCardinality;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    for (const auto& data_input : data_inputs_) {
+      inputs->push_back(data_input);
+    }
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override {
+    for (const auto& input : data_inputs_) {
+      TF_RETURN_IF_ERROR(input->CheckExternalState());
+    }
+    // The weights are serialized as a handle to a resource which may be
+    // updated at any time, so they cannot be reproduced from the graph.
+    return errors::FailedPrecondition(
+        DebugString(), " depends on the mutable ", weights_->DebugString(),
+        ".");
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* weights_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddTensor(weights_handle_, &weights_node));
+    std::vector<Node*> data_input_nodes(data_inputs_.size());
+    for (size_t i = 0; i < data_inputs_.size(); ++i) {
+      TF_RETURN_IF_ERROR(
+          b->AddInputDataset(ctx, data_inputs_[i], &data_input_nodes[i]));
+    }
+    Node* seed_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.first, &seed_node));
+    Node* seed2_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.second, &seed2_node));
+    Node* buffer_size_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size_node));
+
+    AttrValue stop_on_empty_dataset_attr;
+    b->BuildAttrValue(stop_on_empty_dataset_, &stop_on_empty_dataset_attr);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        /*inputs=*/
+        {{0, weights_node},
+         {2, seed_node},
+         {3, seed2_node},
+         {4, buffer_size_node}},
+        /*list_inputs=*/{{1, data_input_nodes}},
+        /*attrs=*/
+        {std::make_pair(kStopOnEmptyDataset, stop_on_empty_dataset_attr)},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  // Elements are prefetched from every input into a per-input buffer by tasks
+  // scheduled on the runner, and the consumer only synchronizes with the input
+  // it sampled. The input indices are sampled `kSampleBatchSize` at a time
+  // from the distribution currently held by the weights resource, so neither
+  // the sampling nor the weight lookup is contended per element.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          seeds_(MaybeOverrideSeeds(params.dataset->seeds_)),
+          parent_generator_(seeds_.first, seeds_.second),
+          generator_(&parent_generator_),
+          exhausted_(params.dataset->data_inputs_.size(), false),
+          num_active_inputs_(params.dataset->data_inputs_.size()) {}
+
+    ~Iterator() override {
+      if (cancellation_manager_) CancelFills(/*wait=*/true);
+      inputs_.clear();
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      cancellation_manager_ = absl::make_unique<CancellationManager>();
+      TF_RETURN_IF_ERROR(RegisterCancellationCallback(
+          ctx->cancellation_manager(),
+          [this]() { CancelFills(/*wait=*/false); }, &deregister_fn_));
+      IteratorContext::Params params(ctx);
+      params.cancellation_manager = cancellation_manager_.get();
+      IteratorContext input_ctx(params);
+      for (size_t i = 0; i < dataset()->data_inputs_.size(); ++i) {
+        auto input = absl::make_unique<Input>();
+        TF_RETURN_IF_ERROR(dataset()->data_inputs_[i]->MakeIterator(
+            &input_ctx, this, strings::StrCat(prefix(), "[", i, "]"),
+            &input->impl));
+        inputs_.push_back(std::move(input));
+      }
+      return Status::OK();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      EnsureFillsStarted(ctx);
+      while (true) {
+        int64_t index;
+        {
+          mutex_lock l(sample_mu_);
+          index = NextIndex();
+        }
+        if (index < 0) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        bool end_of_input = false;
+        TF_RETURN_IF_ERROR(
+            GetFromInput(ctx, index, out_tensors, &end_of_input));
+        if (!end_of_input) {
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+
+        mutex_lock l(sample_mu_);
+        if (dataset()->stop_on_empty_dataset_) {
+          num_active_inputs_ = 0;
+          pending_indices_.clear();
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        if (!exhausted_[index]) {
+          exhausted_[index] = true;
+          --num_active_inputs_;
+        }
+        VLOG(2) << "WeightedMixture sampled an exhausted input: " << index;
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeAsyncInterleaveManyNode(std::move(args),
+                                                /*parameters=*/{});
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      WaitForFills();
+      mutex_lock l(sample_mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumRandomSamples),
+                                             num_random_samples_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seeds_.first));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kSeed2), seeds_.second));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumActiveInputs),
+                                             num_active_inputs_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), strings::StrCat(kPendingIndices, kSize),
+                              pending_indices_.size()));
+      for (size_t i = 0; i < pending_indices_.size(); ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), strings::StrCat(kPendingIndices, "[", i, "]"),
+            pending_indices_[i]));
+      }
+      for (size_t i = 0; i < inputs_.size(); ++i) {
+        Input& input = *inputs_[i];
+        mutex_lock input_lock(input.mu);
+        if (exhausted_[i]) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat(kExhausted, "[", i, "]")), ""));
+        }
+        if (input.end_of_input) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat(kEndOfInput, "[", i, "]")), ""));
+        }
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input.impl));
+        TF_RETURN_IF_ERROR(WriteStatus(
+            prefix(), strings::StrCat(kStatus, "[", i, "]"), input.status,
+            writer));
+        const string buffer_prefix =
+            strings::StrCat(prefix(), "::", kBuffer, "[", i, "]");
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(buffer_prefix, kSize, input.buffer.size()));
+        for (size_t j = 0; j < input.buffer.size(); ++j) {
+          const std::vector<Tensor>& element = input.buffer[j];
+          const string element_prefix =
+              strings::StrCat(buffer_prefix, "[", j, "]");
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(element_prefix, kSize, element.size()));
+          for (size_t k = 0; k < element.size(); ++k) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                element_prefix, strings::StrCat("[", k, "]"), element[k]));
+          }
+        }
+      }
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      WaitForFills();
+      mutex_lock l(sample_mu_);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumRandomSamples),
+                                            &num_random_samples_));
+      int64_t seed;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed));
+      int64_t seed2;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2));
+      seeds_ = {seed, seed2};
+      ResetRngs();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumActiveInputs),
+                                            &num_active_inputs_));
+      int64_t num_pending;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(
+          prefix(), strings::StrCat(kPendingIndices, kSize), &num_pending));
+      pending_indices_.clear();
+      for (int64_t i = 0; i < num_pending; ++i) {
+        int64_t index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), strings::StrCat(kPendingIndices, "[", i, "]"), &index));
+        if (index < 0 || index >= static_cast<int64_t>(inputs_.size())) {
+          return errors::DataLoss("Invalid pending input index ", index,
+                                  " in checkpoint.");
+        }
+        pending_indices_.push_back(index);
+      }
+      for (size_t i = 0; i < inputs_.size(); ++i) {
+        Input& input = *inputs_[i];
+        mutex_lock input_lock(input.mu);
+        exhausted_[i] = reader->Contains(
+            full_name(strings::StrCat(kExhausted, "[", i, "]")));
+        input.end_of_input = reader->Contains(
+            full_name(strings::StrCat(kEndOfInput, "[", i, "]")));
+        input.filling = false;
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input.impl));
+        TF_RETURN_IF_ERROR(ReadStatus(prefix(),
+                                      strings::StrCat(kStatus, "[", i, "]"),
+                                      reader, &input.status));
+        const string buffer_prefix =
+            strings::StrCat(prefix(), "::", kBuffer, "[", i, "]");
+        int64_t buffer_size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(buffer_prefix, kSize, &buffer_size));
+        input.buffer.clear();
+        for (int64_t j = 0; j < buffer_size; ++j) {
+          const string element_prefix =
+              strings::StrCat(buffer_prefix, "[", j, "]");
+          int64_t num_components;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(element_prefix, kSize, &num_components));
+          std::vector<Tensor> element(num_components);
+          for (int64_t k = 0; k < num_components; ++k) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                ctx->flr(), element_prefix, strings::StrCat("[", k, "]"),
+                &element[k]));
+          }
+          input.buffer.push_back(std::move(element));
+        }
+      }
+      fills_started_ = false;
+      return Status::OK();
+    }
+
+   private:
+    struct Input {
+      mutex mu;
+      condition_variable cond;
+      // Only accessed by the fill task while `filling` is set, and otherwise
+      // only while no fill task is outstanding.
+      std::unique_ptr<IteratorBase> impl;
+      std::deque<std::vector<Tensor>> buffer TF_GUARDED_BY(mu);
+      Status status TF_GUARDED_BY(mu);
+      bool end_of_input TF_GUARDED_BY(mu) = false;
+      bool filling TF_GUARDED_BY(mu) = false;
+    };
+
+    void CancelFills(bool wait) TF_LOCKS_EXCLUDED(fill_mu_) {
+      cancellation_manager_->StartCancel();
+      {
+        mutex_lock l(fill_mu_);
+        cancelled_ = true;
+      }
+      for (auto& input : inputs_) {
+        mutex_lock l(input->mu);
+        input->cond.notify_all();
+      }
+      if (wait) WaitForFills();
+    }
+
+    void WaitForFills() TF_LOCKS_EXCLUDED(fill_mu_) {
+      mutex_lock l(fill_mu_);
+      while (num_fills_ > 0) {
+        fill_cond_.wait(l);
+      }
+    }
+
+    void EnsureFillsStarted(IteratorContext* ctx) {
+      {
+        mutex_lock l(sample_mu_);
+        if (fills_started_) return;
+        fills_started_ = true;
+        if (!ctx_) {
+          IteratorContext::Params params(ctx);
+          params.cancellation_manager = cancellation_manager_.get();
+          ctx_ = std::make_shared<IteratorContext>(params);
+        }
+      }
+      for (size_t i = 0; i < inputs_.size(); ++i) {
+        bool start_fill;
+        {
+          mutex_lock l(inputs_[i]->mu);
+          start_fill = MaybeStartFillLocked(inputs_[i].get());
+        }
+        if (start_fill) ScheduleFill(i);
+      }
+    }
+
+    // Marks `input` as being filled if its buffer has room and its input
+    // iterator can make progress. The caller must then call `ScheduleFill`
+    // after releasing `input->mu`.
+    bool MaybeStartFillLocked(Input* input)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(input->mu) {
+      if (input->filling || cancelled_ || input->end_of_input ||
+          !input->status.ok() ||
+          input->buffer.size() >= dataset()->buffer_size_) {
+        return false;
+      }
+      input->filling = true;
+      return true;
+    }
+
+    void ScheduleFill(int64_t index) TF_LOCKS_EXCLUDED(fill_mu_) {
+      {
+        mutex_lock l(fill_mu_);
+        if (!cancelled_) {
+          ++num_fills_;
+        } else {
+          Input& input = *inputs_[index];
+          mutex_lock input_lock(input.mu);
+          input.filling = false;
+          input.cond.notify_all();
+          return;
+        }
+      }
+      (*ctx_->runner())([this, index]() { FillInput(index); });
+    }
+
+    // Pulls elements from input `index` until its buffer is full, the input
+    // is exhausted or fails, or the iterator is cancelled.
+    void FillInput(int64_t index) {
+      RecordStart(ctx_.get());
+      auto cleanup = gtl::MakeCleanup([this]() {
+        RecordStop(ctx_.get());
+        mutex_lock l(fill_mu_);
+        --num_fills_;
+        fill_cond_.notify_all();
+      });
+      Input& input = *inputs_[index];
+      while (true) {
+        {
+          mutex_lock l(input.mu);
+          if (cancelled_ || input.end_of_input || !input.status.ok() ||
+              input.buffer.size() >= dataset()->buffer_size_) {
+            input.filling = false;
+            input.cond.notify_all();
+            return;
+          }
+        }
+        std::vector<Tensor> element;
+        bool end_of_input = false;
+        Status s = input.impl->GetNext(ctx_.get(), &element, &end_of_input);
+        mutex_lock l(input.mu);
+        if (!s.ok()) {
+          input.status = s;
+        } else if (end_of_input) {
+          input.end_of_input = true;
+        } else {
+          input.buffer.push_back(std::move(element));
+        }
+        input.cond.notify_all();
+      }
+    }
+
+    // Takes the next element buffered for input `index`, waiting for its fill
+    // task if necessary. Errors are reported once, in input order.
+    Status GetFromInput(IteratorContext* ctx, int64_t index,
+                        std::vector<Tensor>* out_tensors, bool* end_of_input) {
+      Input& input = *inputs_[index];
+      bool start_fill = false;
+      auto cleanup = gtl::MakeCleanup([this, index, &start_fill]() {
+        if (start_fill) ScheduleFill(index);
+      });
+      mutex_lock l(input.mu);
+      while (true) {
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        if (!input.buffer.empty()) {
+          *out_tensors = std::move(input.buffer.front());
+          input.buffer.pop_front();
+          start_fill = MaybeStartFillLocked(&input);
+          *end_of_input = false;
+          return Status::OK();
+        }
+        if (!input.status.ok()) {
+          Status s = input.status;
+          input.status = Status::OK();
+          start_fill = MaybeStartFillLocked(&input);
+          return s;
+        }
+        if (input.end_of_input) {
+          *end_of_input = true;
+          return Status::OK();
+        }
+        RecordStop(ctx);
+        input.cond.wait(l);
+        RecordStart(ctx);
+      }
+    }
+
+    // Returns the next sampled input index that is not exhausted, or -1 if
+    // every remaining input has zero weight.
+    int64_t NextIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(sample_mu_) {
+      while (num_active_inputs_ > 0) {
+        if (pending_indices_.empty()) {
+          distribution_ = dataset()->weights_->distribution();
+          if (!HasActiveWeight()) break;
+          SampleIndices();
+        }
+        const int64_t index = pending_indices_.front();
+        pending_indices_.pop_front();
+        if (!exhausted_[index]) return index;
+        if (!HasActiveWeight()) break;
+      }
+      pending_indices_.clear();
+      return -1;
+    }
+
+    // Samples the next `kSampleBatchSize` input indices. Each batch is drawn
+    // from a generator keyed by the iterator's generator, so that the number
+    // of samples the alias table consumes does not need to be checkpointed.
+    void SampleIndices() TF_EXCLUSIVE_LOCKS_REQUIRED(sample_mu_) {
+      const uint64 key = static_cast<uint64>(generator_()) |
+                         static_cast<uint64>(generator_()) << 32;
+      num_random_samples_ += 2;
+      random::PhiloxRandom philox(key);
+      random::SimplePhilox rng(&philox);
+      for (int i = 0; i < kSampleBatchSize; ++i) {
+        pending_indices_.push_back(distribution_->Sample(&rng));
+      }
+    }
+
+    bool HasActiveWeight() const TF_EXCLUSIVE_LOCKS_REQUIRED(sample_mu_) {
+      for (size_t i = 0; i < exhausted_.size(); ++i) {
+        if (!exhausted_[i] && distribution_->probabilities()[i] > 0.0) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void ResetRngs() TF_EXCLUSIVE_LOCKS_REQUIRED(sample_mu_) {
+      // Reset the generators based on the current iterator seeds.
+      parent_generator_ = random::PhiloxRandom(seeds_.first, seeds_.second);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      generator_.Skip(num_random_samples_);
+    }
+
+    // Guards the sampled input indices and the random number generators.
+    mutex sample_mu_;
+    std::pair<int64_t, int64_t> seeds_ TF_GUARDED_BY(sample_mu_);
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(sample_mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(sample_mu_);
+    int64_t num_random_samples_ TF_GUARDED_BY(sample_mu_) = 0;
+    std::shared_ptr<const MixtureDistribution> distribution_
+        TF_GUARDED_BY(sample_mu_);
+    std::deque<int64_t> pending_indices_ TF_GUARDED_BY(sample_mu_);
+    std::vector<bool> exhausted_ TF_GUARDED_BY(sample_mu_);
+    int64_t num_active_inputs_ TF_GUARDED_BY(sample_mu_);
+    bool fills_started_ TF_GUARDED_BY(sample_mu_) = false;
+
+    // Counts the outstanding fill tasks.
+    mutex fill_mu_;
+    condition_variable fill_cond_;
+    int64_t num_fills_ TF_GUARDED_BY(fill_mu_) = 0;
+    std::atomic<bool> cancelled_{false};
+
+    // Controls cancellation of the input iterators. Must be ordered before
+    // `inputs_` so that the input iterators are destroyed first.
+    std::unique_ptr<CancellationManager> cancellation_manager_;
+    std::vector<std::unique_ptr<Input>> inputs_;
+    // Context used by the fill tasks, created on the first `GetNext` call.
+    std::shared_ptr<IteratorContext> ctx_;
+    // Method for deregistering the cancellation callback.
+    std::function<void()> deregister_fn_;
+  };
+
+  const Tensor weights_handle_;
+  MixtureWeightsResource* const weights_;
+  const std::vector<DatasetBase*> data_inputs_;
+  std::vector<PartialTensorShape> output_shapes_;
+  const std::pair<int64_t, int64_t> seeds_;
+  const int64_t buffer_size_;
+  const bool stop_on_empty_dataset_;
+};
+
+WeightedMixtureDatasetOp::WeightedMixtureDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kStopOnEmptyDataset, &stop_on_empty_dataset_));
+}
+
+void WeightedMixtureDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                           DatasetBase** output) {
+  core::RefCountPtr<MixtureWeightsResource> weights;
+  OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &weights));
+
+  OpInputList inputs;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kDataInputDatasets, &inputs));
+  std::vector<DatasetBase*> data_inputs;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    DatasetBase* input;
+    OP_REQUIRES_OK(ctx, GetDatasetFromVariantTensor(inputs[i], &input));
+    data_inputs.push_back(input);
+
+    OP_REQUIRES(ctx, data_inputs[0]->output_dtypes() == input->output_dtypes(),
+                errors::InvalidArgument(
+                    "All inputs must have the same output_dtypes. First input "
+                    "has types ",
+                    DataTypeVectorString(data_inputs[0]->output_dtypes()),
+                    ", and input ", i, " has types ",
+                    DataTypeVectorString(input->output_dtypes())));
+  }
+  OP_REQUIRES(ctx,
+              weights->num_inputs() ==
+                  static_cast<int64_t>(data_inputs.size()),
+              errors::InvalidArgument(
+                  "The mixture weights are defined over ",
+                  weights->num_inputs(), " inputs, but ", data_inputs.size(),
+                  " input datasets were given."));
+
+  int64_t seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+  int64_t buffer_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBufferSize, &buffer_size));
+  OP_REQUIRES(ctx, buffer_size > 0,
+              errors::InvalidArgument("`buffer_size` must be > 0, got ",
+                                      buffer_size, "."));
+
+  *output = new Dataset(ctx, ctx->input(0), weights.get(),
+                        std::move(data_inputs), seed, seed2, buffer_size,
+                        stop_on_empty_dataset_);
+}
+
+namespace {
+
+class MixtureWeightsHandleOp
+    : public ResourceOpKernel<MixtureWeightsResource> {
+ public:
+  explicit MixtureWeightsHandleOp(OpKernelConstruction* ctx)
+      : ResourceOpKernel<MixtureWeightsResource>(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_inputs", &num_inputs_));
+  }
+
+ private:
+  Status CreateResource(MixtureWeightsResource** ret) override
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *ret = new MixtureWeightsResource(num_inputs_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(MixtureWeightsResource* resource) override {
+    if (resource->num_inputs() != num_inputs_) {
+      return errors::InvalidArgument(
+          "Shared mixture weights are defined over ", resource->num_inputs(),
+          " inputs, but ", num_inputs_, " were requested.");
+    }
+    return Status::OK();
+  }
+
+  int64_t num_inputs_;
+};
+
+class AssignMixtureWeightsOp : public OpKernel {
+ public:
+  explicit AssignMixtureWeightsOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<MixtureWeightsResource> resource;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 0), &resource));
+    const Tensor& weights_t = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(weights_t.shape()),
+                errors::InvalidArgument("`weights` must be a vector, got ",
+                                        weights_t.shape().DebugString()));
+    auto weights_flat = weights_t.vec<double>();
+    OP_REQUIRES_OK(ctx, resource->SetWeights(std::vector<double>(
+                            weights_flat.data(),
+                            weights_flat.data() + weights_flat.size())));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("WeightedMixtureDataset").Device(DEVICE_CPU),
+                        WeightedMixtureDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("MixtureWeightsHandle").Device(DEVICE_CPU),
+                        MixtureWeightsHandleOp);
+REGISTER_KERNEL_BUILDER(Name("AssignMixtureWeights").Device(DEVICE_CPU),
+                        AssignMixtureWeightsOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
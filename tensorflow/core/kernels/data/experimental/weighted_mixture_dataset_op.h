@@ -0,0 +1,114 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_WEIGHTED_MIXTURE_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_WEIGHTED_MIXTURE_DATASET_OP_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/random/distribution_sampler.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Normalized mixture weights, together with an alias table for sampling an
+// input index in constant time.
+class MixtureDistribution {
+ public:
+  // Creates a distribution over `weights`, which must be finite, non-negative
+  // and have a positive sum.
+  static Status Create(const std::vector<double>& weights,
+                       std::unique_ptr<MixtureDistribution>* out_distribution);
+
+  int64_t Sample(random::SimplePhilox* rng) const {
+    return sampler_.Sample(rng);
+  }
+
+  int64_t size() const { return probabilities_.size(); }
+
+  const std::vector<double>& probabilities() const { return probabilities_; }
+
+ private:
+  MixtureDistribution(std::vector<double> probabilities,
+                      const std::vector<float>& weights);
+
+  const std::vector<double> probabilities_;
+  const random::DistributionSampler sampler_;
+};
+
+// Holds the mixture weights of a `WeightedMixtureDataset`. The weights may be
+// replaced at any time; iterators pick up the new weights the next time they
+// sample a batch of input indices.
+class MixtureWeightsResource : public ResourceBase {
+ public:
+  // Creates a resource with uniform weights over `num_inputs` inputs.
+  explicit MixtureWeightsResource(int64_t num_inputs);
+
+  int64_t num_inputs() const { return num_inputs_; }
+
+  Status SetWeights(const std::vector<double>& weights)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  std::shared_ptr<const MixtureDistribution> distribution() const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  string DebugString() const override { return "MixtureWeightsResource"; }
+
+ private:
+  const int64_t num_inputs_;
+  mutable mutex mu_;
+  std::shared_ptr<const MixtureDistribution> distribution_ TF_GUARDED_BY(mu_);
+};
+
+// See tensorflow/core/api_def/base_api/api_def_WeightedMixtureDataset.pbtxt
+// for the API definition that corresponds to this kernel.
+class WeightedMixtureDatasetOp : public DatasetOpKernel {
+ public:
+  // Names of op parameters, public so that they can be accessed by test cases.
+  // Make sure that these are kept in sync with the REGISTER_OP call in
+  // tensorflow/core/ops/experimental_dataset_ops.cc
+  static constexpr const char* const kDatasetType = "WeightedMixture";
+  static constexpr const char* const kWeights = "weights";
+  static constexpr const char* const kDataInputDatasets = "data_input_datasets";
+  static constexpr const char* const kSeed = "seed";
+  static constexpr const char* const kSeed2 = "seed2";
+  static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kStopOnEmptyDataset =
+      "stop_on_empty_dataset";
+  static constexpr const char* const kOutputTypes = "output_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kNumInputDatasets = "N";
+
+  explicit WeightedMixtureDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+  bool stop_on_empty_dataset_ = false;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_WEIGHTED_MIXTURE_DATASET_OP_H_
@@ -0,0 +1,382 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/data/experimental/weighted_mixture_dataset_op.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/resource_handle.h"
+#include "tensorflow/core/kernels/data/repeat_dataset_op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "weighted_mixture_dataset";
+
+// The op takes the weights handle before the input datasets, whereas
+// `DatasetOpsTestBase` passes `input_dataset_params_` first, so the input
+// datasets are given as variant tensors instead.
+class WeightedMixtureDatasetParams : public DatasetParams {
+ public:
+  WeightedMixtureDatasetParams(Tensor weights_handle,
+                               std::vector<Tensor> data_input_datasets,
+                               int64_t seed, int64_t seed2,
+                               int64_t buffer_size, bool stop_on_empty_dataset,
+                               DataTypeVector output_dtypes,
+                               std::vector<PartialTensorShape> output_shapes,
+                               string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        weights_handle_(std::move(weights_handle)),
+        data_input_datasets_(std::move(data_input_datasets)),
+        seed_(seed),
+        seed2_(seed2),
+        buffer_size_(buffer_size),
+        stop_on_empty_dataset_(stop_on_empty_dataset) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = {weights_handle_};
+    for (const Tensor& data_input_dataset : data_input_datasets_) {
+      input_tensors.push_back(data_input_dataset);
+    }
+    input_tensors.push_back(CreateTensor<int64_t>(TensorShape({}), {seed_}));
+    input_tensors.push_back(CreateTensor<int64_t>(TensorShape({}), {seed2_}));
+    input_tensors.push_back(
+        CreateTensor<int64_t>(TensorShape({}), {buffer_size_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {WeightedMixtureDatasetOp::kWeights};
+    for (int i = 0; i < data_input_datasets_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          WeightedMixtureDatasetOp::kDataInputDatasets, "_", i));
+    }
+    input_names->emplace_back(WeightedMixtureDatasetOp::kSeed);
+    input_names->emplace_back(WeightedMixtureDatasetOp::kSeed2);
+    input_names->emplace_back(WeightedMixtureDatasetOp::kBufferSize);
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {WeightedMixtureDatasetOp::kStopOnEmptyDataset, stop_on_empty_dataset_},
+        {WeightedMixtureDatasetOp::kOutputTypes, output_dtypes_},
+        {WeightedMixtureDatasetOp::kOutputShapes, output_shapes_},
+        {WeightedMixtureDatasetOp::kNumInputDatasets,
+         static_cast<int64_t>(data_input_datasets_.size())}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override {
+    return WeightedMixtureDatasetOp::kDatasetType;
+  }
+
+ private:
+  Tensor weights_handle_;
+  std::vector<Tensor> data_input_datasets_;
+  int64_t seed_;
+  int64_t seed2_;
+  int64_t buffer_size_;
+  bool stop_on_empty_dataset_;
+};
+
+class RepeatDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  RepeatDatasetParams(T input_dataset_params, int64_t count)
+      : DatasetParams({DT_INT64}, {PartialTensorShape({})}, "repeat_dataset"),
+        count_(count) {
+    input_dataset_params_.push_back(absl::make_unique<T>(input_dataset_params));
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {count_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {RepeatDatasetOp::kInputDataset, RepeatDatasetOp::kCount};
+    return Status::OK();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return Status::OK();
+  }
+
+  string dataset_type() const override { return RepeatDatasetOp::kDatasetType; }
+
+ private:
+  int64_t count_;
+};
+
+class WeightedMixtureDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK(InitializeRuntime(RangeDatasetParams(0, 1, 1)));
+  }
+
+  // Creates a mixture of `inputs`, with uniform weights held by `weights_`,
+  // and an iterator over it.
+  Status MakeMixture(const std::vector<std::shared_ptr<DatasetParams>>& inputs,
+                     bool stop_on_empty_dataset) {
+    mixture_iterator_.reset();
+    std::vector<Tensor> input_tensors;
+    for (const auto& input : inputs) {
+      std::unique_ptr<TestDataset> input_dataset;
+      TF_RETURN_IF_ERROR(MakeDataset(*input, &input_dataset));
+      Tensor input_tensor(DT_VARIANT, TensorShape({}));
+      TF_RETURN_IF_ERROR(
+          StoreDatasetInVariantTensor(input_dataset->dataset(), &input_tensor));
+      input_tensors.push_back(std::move(input_tensor));
+      input_datasets_.push_back(std::move(input_dataset));
+    }
+    weights_.reset(new MixtureWeightsResource(inputs.size()));
+    weights_->Ref();
+    Tensor weights_handle(DT_RESOURCE, TensorShape({}));
+    weights_handle.scalar<ResourceHandle>()() =
+        ResourceHandle::MakeRefCountingHandle(weights_.get(), device_->name());
+    mixture_params_ = absl::make_unique<WeightedMixtureDatasetParams>(
+        std::move(weights_handle), std::move(input_tensors), /*seed=*/42,
+        /*seed2=*/7, /*buffer_size=*/2, stop_on_empty_dataset,
+        /*output_dtypes=*/DataTypeVector({DT_INT64}),
+        /*output_shapes=*/
+        std::vector<PartialTensorShape>{PartialTensorShape({})}, kNodeName);
+    TF_RETURN_IF_ERROR(MakeDataset(*mixture_params_, &mixture_));
+    return MakeIterator(*mixture_params_, *mixture_, &mixture_iterator_);
+  }
+
+  // Reads up to `num_elements` values from `mixture_iterator_`, or all the
+  // remaining values if `num_elements` is negative.
+  Status ReadValues(int num_elements, std::vector<int64_t>* values) {
+    bool end_of_sequence = false;
+    for (int i = 0; i != num_elements; ++i) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(mixture_iterator_->iterator()->GetNext(
+          mixture_iterator_->ctx(), &next, &end_of_sequence));
+      if (end_of_sequence) break;
+      values->push_back(next[0].scalar<int64_t>()());
+    }
+    return Status::OK();
+  }
+
+  std::vector<std::unique_ptr<TestDataset>> input_datasets_;
+  core::RefCountPtr<MixtureWeightsResource> weights_;
+  std::unique_ptr<WeightedMixtureDatasetParams> mixture_params_;
+  std::unique_ptr<TestDataset> mixture_;
+  std::unique_ptr<TestIterator> mixture_iterator_;
+};
+
+std::shared_ptr<DatasetParams> RangeInput(int64_t start, int64_t stop) {
+  return std::make_shared<RangeDatasetParams>(start, stop, /*step=*/1);
+}
+
+std::shared_ptr<DatasetParams> InfiniteInput() {
+  return std::make_shared<RepeatDatasetParams>(
+      RangeDatasetParams(/*start=*/0, /*stop=*/3, /*step=*/1), /*count=*/-1);
+}
+
+std::vector<int64_t> Values(int64_t start, int64_t stop) {
+  std::vector<int64_t> values;
+  for (int64_t i = start; i < stop; ++i) values.push_back(i);
+  return values;
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, GetNextUntilExhausted) {
+  TF_ASSERT_OK(MakeMixture(
+      {RangeInput(0, 10), RangeInput(10, 20), RangeInput(20, 30)},
+      /*stop_on_empty_dataset=*/false));
+  std::vector<int64_t> values;
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/-1, &values));
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(values, Values(0, 30));
+  // The iterator stays at the end of the sequence.
+  values.clear();
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/1, &values));
+  EXPECT_TRUE(values.empty());
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, ZeroWeightInputIsRejected) {
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 100), RangeInput(100, 110)},
+                           /*stop_on_empty_dataset=*/false));
+  TF_ASSERT_OK(weights_->SetWeights({0.0, 1.0}));
+  std::vector<int64_t> values;
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/-1, &values));
+  // The sequence ends once every input with a positive weight is exhausted.
+  EXPECT_EQ(values, Values(100, 110));
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, StopOnEmptyDataset) {
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 3), RangeInput(10, 100)},
+                           /*stop_on_empty_dataset=*/true));
+  std::vector<int64_t> values;
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/-1, &values));
+  std::vector<int64_t> first_values;
+  std::vector<int64_t> second_values;
+  for (int64_t value : values) {
+    (value < 10 ? first_values : second_values).push_back(value);
+  }
+  EXPECT_EQ(first_values, Values(0, 3));
+  EXPECT_LT(second_values.size(), 90);
+  EXPECT_EQ(second_values, Values(10, 10 + second_values.size()));
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, SetWeightsMidIteration) {
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 100), RangeInput(100, 200)},
+                           /*stop_on_empty_dataset=*/false));
+  TF_ASSERT_OK(weights_->SetWeights({1.0, 0.0}));
+  std::vector<int64_t> values;
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/5, &values));
+  EXPECT_EQ(values, Values(0, 5));
+
+  // Indices sampled before the update are still served from the first input.
+  TF_ASSERT_OK(weights_->SetWeights({0.0, 1.0}));
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/-1, &values));
+  const int64_t num_first =
+      std::find(values.begin(), values.end(), 100) - values.begin();
+  EXPECT_GE(num_first, 5);
+  EXPECT_LT(num_first, 100);
+  EXPECT_EQ(std::vector<int64_t>(values.begin(), values.begin() + num_first),
+            Values(0, num_first));
+  EXPECT_EQ(std::vector<int64_t>(values.begin() + num_first, values.end()),
+            Values(100, 200));
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, SaveAndRestore) {
+  TF_ASSERT_OK(MakeMixture(
+      {RangeInput(0, 10), RangeInput(10, 20), RangeInput(20, 30)},
+      /*stop_on_empty_dataset=*/false));
+  std::vector<int64_t> values;
+  TF_ASSERT_OK(ReadValues(/*num_elements=*/-1, &values));
+  std::vector<Tensor> expected_outputs;
+  for (int64_t value : values) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {value}));
+  }
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      mixture_->dataset(), mixture_iterator_->ctx(),
+      mixture_params_->iterator_prefix(), expected_outputs,
+      /*breakpoints=*/{0, 4, 11, 30}, /*compare_order=*/true));
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, Cardinality) {
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 3), RangeInput(10, 13)},
+                           /*stop_on_empty_dataset=*/false));
+  EXPECT_EQ(mixture_->dataset()->Cardinality(), kUnknownCardinality);
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 3), InfiniteInput()},
+                           /*stop_on_empty_dataset=*/false));
+  EXPECT_EQ(mixture_->dataset()->Cardinality(), kInfiniteCardinality);
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 3), InfiniteInput()},
+                           /*stop_on_empty_dataset=*/true));
+  EXPECT_EQ(mixture_->dataset()->Cardinality(), kUnknownCardinality);
+  TF_ASSERT_OK(MakeMixture({InfiniteInput(), InfiniteInput()},
+                           /*stop_on_empty_dataset=*/true));
+  EXPECT_EQ(mixture_->dataset()->Cardinality(), kInfiniteCardinality);
+}
+
+TEST_F(WeightedMixtureDatasetOpTest, WeightsAreExternalState) {
+  TF_ASSERT_OK(MakeMixture({RangeInput(0, 3), RangeInput(10, 13)},
+                           /*stop_on_empty_dataset=*/false));
+  EXPECT_EQ(mixture_->dataset()->CheckExternalState().code(),
+            error::FAILED_PRECONDITION);
+}
+
+// Returns the frequency of each index among `num_samples` indices sampled from
+// `distribution`.
+std::vector<double> SampleFrequencies(const MixtureDistribution& distribution,
+                                      int num_samples) {
+  random::PhiloxRandom philox(/*seed=*/42, /*seed2=*/7);
+  random::SimplePhilox rng(&philox);
+  std::vector<double> counts(distribution.size(), 0.0);
+  for (int i = 0; i < num_samples; ++i) {
+    const int64_t index = distribution.Sample(&rng);
+    EXPECT_GE(index, 0);
+    EXPECT_LT(index, distribution.size());
+    counts[index] += 1.0;
+  }
+  for (double& count : counts) count /= num_samples;
+  return counts;
+}
+
+TEST(MixtureDistributionTest, MatchesWeights) {
+  std::unique_ptr<MixtureDistribution> distribution;
+  TF_ASSERT_OK(
+      MixtureDistribution::Create({1.0, 2.0, 3.0, 4.0}, &distribution));
+  EXPECT_EQ(distribution->size(), 4);
+  const std::vector<double> frequencies =
+      SampleFrequencies(*distribution, /*num_samples=*/100000);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(distribution->probabilities()[i], (i + 1) / 10.0, 1e-9);
+    EXPECT_NEAR(frequencies[i], (i + 1) / 10.0, 0.01);
+  }
+}
+
+TEST(MixtureDistributionTest, ZeroWeightIsNeverSampled) {
+  std::unique_ptr<MixtureDistribution> distribution;
+  TF_ASSERT_OK(
+      MixtureDistribution::Create({0.0, 1.0, 0.0, 3.0}, &distribution));
+  const std::vector<double> frequencies =
+      SampleFrequencies(*distribution, /*num_samples=*/10000);
+  EXPECT_EQ(frequencies[0], 0.0);
+  EXPECT_EQ(frequencies[2], 0.0);
+  EXPECT_NEAR(frequencies[3], 0.75, 0.02);
+}
+
+TEST(MixtureDistributionTest, InvalidWeights) {
+  std::unique_ptr<MixtureDistribution> distribution;
+  EXPECT_EQ(MixtureDistribution::Create({}, &distribution).code(),
+            error::INVALID_ARGUMENT);
+  EXPECT_EQ(MixtureDistribution::Create({1.0, -1.0}, &distribution).code(),
+            error::INVALID_ARGUMENT);
+  EXPECT_EQ(MixtureDistribution::Create({0.0, 0.0}, &distribution).code(),
+            error::INVALID_ARGUMENT);
+  EXPECT_EQ(
+      MixtureDistribution::Create({1.0, std::nan("")}, &distribution).code(),
+      error::INVALID_ARGUMENT);
+}
+
+TEST(MixtureWeightsResourceTest, SetWeights) {
+  core::RefCountPtr<MixtureWeightsResource> resource(
+      new MixtureWeightsResource(/*num_inputs=*/2));
+  std::shared_ptr<const MixtureDistribution> initial =
+      resource->distribution();
+  EXPECT_EQ(initial->probabilities(), std::vector<double>({0.5, 0.5}));
+
+  TF_ASSERT_OK(resource->SetWeights({3.0, 1.0}));
+  EXPECT_EQ(resource->distribution()->probabilities(),
+            std::vector<double>({0.75, 0.25}));
+  // Distributions handed out before the update stay valid and unchanged.
+  EXPECT_EQ(initial->probabilities(), std::vector<double>({0.5, 0.5}));
+
+  EXPECT_EQ(resource->SetWeights({1.0, 1.0, 1.0}).code(),
+            error::INVALID_ARGUMENT);
+  EXPECT_EQ(resource->SetWeights({0.0, 0.0}).code(), error::INVALID_ARGUMENT);
+  EXPECT_EQ(resource->distribution()->probabilities(),
+            std::vector<double>({0.75, 0.25}));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
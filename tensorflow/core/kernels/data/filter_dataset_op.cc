@@ -193,6 +193,71 @@ class FilterDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                            std::vector<std::vector<Tensor>>* out_elements,
+                            bool* end_of_sequence) override {
+      auto stats_aggregator = ctx->stats_aggregator();
+      int num_matched = 0;
+      int num_dropped = 0;
+      *end_of_sequence = false;
+      std::vector<std::vector<Tensor>> input_elements;
+      while (num_matched < max_elements && !*end_of_sequence) {
+        input_elements.clear();
+        {
+          tf_shared_lock l(mu_);
+          if (!input_impl_) {
+            *end_of_sequence = true;
+            break;
+          }
+          TF_RETURN_IF_ERROR(input_impl_->GetNextN(
+              ctx, max_elements - num_matched, &input_elements,
+              end_of_sequence));
+        }
+        if (*end_of_sequence) {
+          mutex_lock l(mu_);
+          input_impl_.reset();
+        }
+        for (std::vector<Tensor>& element : input_elements) {
+          std::vector<Tensor> result;
+          TF_RETURN_IF_ERROR(instantiated_captured_func_->RunWithBorrowedArgs(
+              ctx, element, &result, model_node()));
+          if (result.size() != 1 || result[0].dtype() != DT_BOOL ||
+              result[0].NumElements() != 1) {
+            return errors::InvalidArgument(
+                "Filter predicate `f` must return a scalar bool.");
+          }
+          if (result[0].scalar<bool>()()) {
+            out_elements->push_back(std::move(element));
+            ++num_matched;
+          } else {
+            ++num_dropped;
+          }
+        }
+      }
+      if (stats_aggregator) {
+        mutex_lock l(mu_);
+        if (num_dropped > 0) {
+          dropped_elements_ += num_dropped;
+          stats_aggregator->AddScalar(
+              stats_utils::DroppedElementsScalarName(dataset()->node_name()),
+              static_cast<float>(dropped_elements_), num_elements());
+          stats_aggregator->IncrementCounter(dataset()->node_name(),
+                                             stats_utils::kDroppedElements,
+                                             static_cast<float>(num_dropped));
+        }
+        if (num_matched > 0) {
+          filtered_elements_ += num_matched;
+          stats_aggregator->AddScalar(
+              stats_utils::FilterdElementsScalarName(dataset()->node_name()),
+              static_cast<float>(filtered_elements_), num_elements());
+          stats_aggregator->IncrementCounter(dataset()->node_name(),
+                                             stats_utils::kFilteredElements,
+                                             static_cast<float>(num_matched));
+        }
+      }
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
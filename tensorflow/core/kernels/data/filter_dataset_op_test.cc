@@ -182,6 +182,9 @@ std::vector<GetNextTestCase<FilterDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(FilterDatasetOpTest, FilterDatasetParams,
                          GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(FilterDatasetOpTest, FilterDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(FilterDatasetOpTest, DatasetNodeName) {
   auto dataset_params = FilterDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
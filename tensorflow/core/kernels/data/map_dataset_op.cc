@@ -171,26 +171,28 @@ class MapDatasetOp::Dataset : public DatasetBase {
       if (*end_of_sequence) {
         return Status::OK();
       }
+      return CallMapFunc(ctx, std::move(args), out_tensors, end_of_sequence);
+    }
 
-      Status s = instantiated_captured_func_->Run(ctx, std::move(args),
-                                                  out_tensors, model_node());
-      if (errors::IsOutOfRange(s)) {
-        if (dataset()->preserve_cardinality_) {
-          // To guarantee that the transformation preserves the cardinality of
-          // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
-          // former may be interpreted by a caller as the end of sequence.
-          return errors::InvalidArgument(
-              "Function invocation produced OutOfRangeError: ",
-              s.error_message());
-        } else {
-          // `f` may deliberately raise `errors::OutOfRange` to indicate
-          // that we should terminate the iteration early.
-          *end_of_sequence = true;
+    Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                            std::vector<std::vector<Tensor>>* out_elements,
+                            bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> args;
+      bool end_of_input = false;
+      TF_RETURN_IF_ERROR(
+          input_impl_->GetNextN(ctx, max_elements, &args, &end_of_input));
+      out_elements->reserve(out_elements->size() + args.size());
+      for (std::vector<Tensor>& element_args : args) {
+        std::vector<Tensor> element;
+        TF_RETURN_IF_ERROR(CallMapFunc(ctx, std::move(element_args), &element,
+                                       end_of_sequence));
+        if (*end_of_sequence) {
           return Status::OK();
         }
-      } else {
-        return s;
+        out_elements->push_back(std::move(element));
       }
+      *end_of_sequence = end_of_input;
+      return Status::OK();
     }
 
    protected:
@@ -214,6 +216,33 @@ class MapDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Applies the map function to `args`. Sets `*end_of_sequence` if the
+    // function ended the iteration early by raising `OutOfRange`.
+    Status CallMapFunc(IteratorContext* ctx, std::vector<Tensor>&& args,
+                       std::vector<Tensor>* out_tensors,
+                       bool* end_of_sequence) {
+      *end_of_sequence = false;
+      Status s = instantiated_captured_func_->Run(ctx, std::move(args),
+                                                  out_tensors, model_node());
+      if (errors::IsOutOfRange(s)) {
+        if (dataset()->preserve_cardinality_) {
+          // To guarantee that the transformation preserves the cardinality of
+          // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
+          // former may be interpreted by a caller as the end of sequence.
+          return errors::InvalidArgument(
+              "Function invocation produced OutOfRangeError: ",
+              s.error_message());
+        } else {
+          // `f` may deliberately raise `errors::OutOfRange` to indicate
+          // that we should terminate the iteration early.
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+      } else {
+        return s;
+      }
+    }
+
     std::unique_ptr<IteratorBase> input_impl_;
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
   };
@@ -105,6 +105,9 @@ std::vector<GetNextTestCase<MapDatasetParams>> GetNextTestCases() {
 
 ITERATOR_GET_NEXT_TEST_P(MapDatasetOpTest, MapDatasetParams, GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(MapDatasetOpTest, MapDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(MapDatasetOpTest, DatasetNodeName) {
   auto dataset_params = MapDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -15,47 +15,115 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "tensorflow/core/framework/model.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+// Number of consumed elements between two adjustments of the buffer limit.
+constexpr int64_t kAdjustmentPeriod = 32;
+// Weight of the latest sample in the running estimates.
+constexpr double kSmoothing = 0.1;
+}  // namespace
 
 PrefetchAutotuner::PrefetchAutotuner(int64_t initial_buffer_size,
                                      int64_t buffer_size_min)
-    : buffer_limit_(initial_buffer_size) {
-  if (initial_buffer_size == model::kAutotune) {
-    mode_ = Mode::kUpswing;
-    buffer_limit_ = std::max(int64_t{1}, buffer_size_min);
+    : PrefetchAutotuner(initial_buffer_size, buffer_size_min, Options()) {}
+
+PrefetchAutotuner::PrefetchAutotuner(int64_t initial_buffer_size,
+                                     int64_t buffer_size_min,
+                                     const Options& options)
+    : enabled_(initial_buffer_size == model::kAutotune),
+      options_(options),
+      buffer_size_min_(std::max(int64_t{1}, buffer_size_min)),
+      buffer_limit_(enabled_ ? buffer_size_min_ : initial_buffer_size) {}
+
+void PrefetchAutotuner::Moments::Update(double value) {
+  if (count++ == 0) {
+    mean = value;
+    return;
   }
+  const double delta = value - mean;
+  mean += kSmoothing * delta;
+  variance = (1 - kSmoothing) * (variance + kSmoothing * delta * delta);
 }
 
-namespace {
-// Determines what strategy to use for increasing the buffer size limit. For
-// limits less than the threshold, an exponential increase is used, while for
-// limits greater than or equal to the threshold, a linear increase is used.
-size_t kBufferLimitThreshold = 2048;
-}  // namespace
+void PrefetchAutotuner::RecordProduction(int64_t produce_us,
+                                         int64_t element_bytes) {
+  if (!enabled_) {
+    return;
+  }
+  producer_.Update(produce_us);
+  element_bytes_ = producer_.count == 1 ? element_bytes
+                                        : (1 - kSmoothing) * element_bytes_ +
+                                              kSmoothing * element_bytes;
+}
 
-void PrefetchAutotuner::RecordConsumption(size_t current_buffer_size) {
-  switch (mode_) {
-    case Mode::kDisabled:
-      return;
-    case Mode::kUpswing:
-      if (static_cast<int64_t>(current_buffer_size) == buffer_limit_) {
-        mode_ = Mode::kDownswing;
-      }
-      return;
-    case Mode::kDownswing:
-      if (current_buffer_size == 0) {
-        if (buffer_limit_ >= static_cast<int64_t>(kBufferLimitThreshold)) {
-          buffer_limit_ += kBufferLimitThreshold;
-        } else {
-          buffer_limit_ *= 2;
-        }
-        mode_ = Mode::kUpswing;
+void PrefetchAutotuner::RecordConsumption(int64_t consume_us,
+                                          size_t current_buffer_size) {
+  if (!enabled_) {
+    return;
+  }
+  if (consume_us >= 0) {
+    consumer_.Update(consume_us);
+  }
+  const int64_t buffer_size = static_cast<int64_t>(current_buffer_size);
+  min_buffer_size_ = num_consumed_ == 0
+                         ? buffer_size
+                         : std::min(min_buffer_size_, buffer_size);
+  if (++num_consumed_ >= kAdjustmentPeriod) {
+    Adjust();
+    num_consumed_ = 0;
+    num_empty_ = 0;
+  }
+}
+
+void PrefetchAutotuner::RecordEmpty() {
+  if (enabled_) {
+    ++num_empty_;
+  }
+}
+
+void PrefetchAutotuner::Adjust() {
+  int64_t target = buffer_limit_;
+  // How much faster the producer is than the consumer, per element.
+  const double drift = consumer_.mean - producer_.mean;
+  if (producer_.count > 0 && consumer_.count > 0 && drift > 0) {
+    // The producer falls behind the consumer by more than the `buffer_limit_`
+    // elements' worth of consumer time with probability
+    // exp(-2 * drift * buffer_limit_ * consumer_.mean / variance).
+    const double variance = producer_.variance + consumer_.variance;
+    const double required = variance *
+                            -std::log(1.0 - options_.wait_percentile) /
+                            (2.0 * drift * consumer_.mean);
+    // Grow at most twofold per period, so that estimates from a few noisy
+    // samples do not inflate the buffer.
+    target = static_cast<int64_t>(
+        std::ceil(std::min(required, 2.0 * buffer_limit_)));
+    if (num_empty_ > (1.0 - options_.wait_percentile) * num_consumed_) {
+      target = std::max(target, buffer_limit_ + 1);
+    }
+    if (target < buffer_limit_) {
+      // Only give up headroom that was not used during the last period, half
+      // of it at a time.
+      const int64_t unused = min_buffer_size_ - 1;
+      if (num_empty_ > 0 || unused <= 0) {
+        target = buffer_limit_;
+      } else {
+        target = std::max(target,
+                          buffer_limit_ - std::max(int64_t{1}, unused / 2));
       }
-      return;
+    }
+  }
+  if (options_.ram_budget > 0 && element_bytes_ > 0) {
+    const int64_t ram_limit =
+        static_cast<int64_t>(options_.ram_budget / element_bytes_);
+    target = std::min(target, std::max(int64_t{1}, ram_limit));
   }
+  buffer_limit_ = std::max(target, buffer_size_min_);
 }
 
 }  // namespace data
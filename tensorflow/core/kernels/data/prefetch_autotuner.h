@@ -23,47 +23,82 @@ namespace data {
 
 // PrefetchAutotuner dynamically adjusts the buffer size of a prefetch iterator.
 //
-// PrefetchAutotuner attempts to find the minimum buffer size such that there is
-// always at least 1 element in the prefetch queue every time the downstream
-// iterator calls GetNext().
+// PrefetchAutotuner attempts to find the minimum buffer size such that the
+// downstream iterator finds an element in the prefetch queue for at least the
+// `wait_percentile` fraction of its GetNext() calls.
+//
+// It tracks the mean and variance of the time the producer takes to produce an
+// element and of the time the consumer takes between two requests. If the
+// producer is faster on average, the amount by which it falls behind the
+// consumer is a random walk with negative drift, whose running maximum exceeds
+// a level with exponentially decreasing probability. The buffer is sized so
+// that it is exceeded with probability at most `1 - wait_percentile`. Waits
+// observed beyond the target grow the buffer past that estimate, and buffers
+// whose headroom goes unused shrink towards it.
 //
 // One common failure mode of input pipelines is being throughput bound. No
 // amount of prefetching can address that performance mode. In order to guard
 // against this condition, PrefetchAutotuner will only increase the buffer_limit
-// if the prefetching thread is able to successfully fill the buffer at its
-// current size.
+// if the producer is faster than the consumer on average.
 //
-// Note: in the current implementation, we never decrease the buffer_limit().
-// This should change in the future!
+// If `ram_budget` is set, the buffer_limit is capped so that the buffered
+// elements, at their average size, fit in that many bytes.
 //
 // PrefetchAutotuner is NOT thread safe.
 class PrefetchAutotuner {
  public:
-  explicit PrefetchAutotuner(int64_t initial_buffer_size,
-                             int64_t buffer_size_min);
+  struct Options {
+    // Target fraction of GetNext() calls that find an element in the buffer.
+    double wait_percentile = 0.99;
+    // Maximum number of bytes held in the buffer, or 0 for no maximum.
+    int64_t ram_budget = 0;
+  };
+
+  PrefetchAutotuner(int64_t initial_buffer_size, int64_t buffer_size_min);
+  PrefetchAutotuner(int64_t initial_buffer_size, int64_t buffer_size_min,
+                    const Options& options);
 
   int64_t buffer_limit() const { return buffer_limit_; }
 
-  void RecordConsumption(size_t current_buffer_size);
-  void RecordEmpty() { RecordConsumption(0); }
+  // Records that the producer spent `produce_us` producing an element of
+  // `element_bytes` bytes.
+  void RecordProduction(int64_t produce_us, int64_t element_bytes);
+
+  // Records that the consumer took an element from a buffer holding
+  // `current_buffer_size` elements, including the taken one. `consume_us` is
+  // the time the consumer spent since its previous request, or negative if
+  // unknown.
+  void RecordConsumption(int64_t consume_us, size_t current_buffer_size);
+
+  // Records that the consumer found the buffer empty and had to wait.
+  void RecordEmpty();
 
  private:
-  // PrefetchAutotuner operates as a state machine.
-  enum class Mode {
-    // Disables the autotuning.
-    kDisabled,
-
-    // We have increased the size of the buffer, and will transition to
-    // kDownswing if we successfully fill the buffer.
-    kUpswing,
-
-    // We have successfully filled a buffer of this size. If we ever block the
-    // downstream iterator, we should increase the buffer size.
-    kDownswing,
+  // Running estimate of the mean and variance of a duration.
+  struct Moments {
+    void Update(double value);
+
+    int64_t count = 0;
+    double mean = 0.0;
+    double variance = 0.0;
   };
 
+  // Recomputes `buffer_limit_` from the statistics of the last period.
+  void Adjust();
+
+  const bool enabled_;
+  const Options options_;
+  const int64_t buffer_size_min_;
   int64_t buffer_limit_;
-  Mode mode_ = Mode::kDisabled;
+
+  Moments producer_;
+  Moments consumer_;
+  double element_bytes_ = 0.0;
+
+  // Statistics of the consumption period since the last adjustment.
+  int64_t num_consumed_ = 0;
+  int64_t num_empty_ = 0;
+  int64_t min_buffer_size_ = 0;
 };
 
 }  // namespace data
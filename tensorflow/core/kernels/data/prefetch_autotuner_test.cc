@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 
+#include <functional>
+
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -22,85 +24,106 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+constexpr int64_t kElementBytes = 1000;
+
+// Simulates `num_elements` elements going through the buffer, the i-th taking
+// `produce_us(i)` to produce and being requested `consume_us` after the
+// previous one. The consumer sees a full buffer unless `record_empty`.
+void Simulate(PrefetchAutotuner* t,
+              const std::function<int64_t(int)>& produce_us,
+              int64_t consume_us, int num_elements, bool record_empty = false) {
+  for (int i = 0; i < num_elements; ++i) {
+    t->RecordProduction(produce_us(i), kElementBytes);
+    if (record_empty) {
+      t->RecordEmpty();
+    }
+    t->RecordConsumption(consume_us, t->buffer_limit());
+  }
+}
+
+int64_t Steady(int i) { return 50; }
+
+int64_t Jittery(int i) { return i % 2 == 0 ? 160 : 0; }
+
 TEST(PrefetchAutotuner, Disabled) {
   PrefetchAutotuner t(2, 0);
   EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(0);
-  t.RecordConsumption(2);
-  t.RecordConsumption(0);
-  t.RecordConsumption(2);
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/320,
+           /*record_empty=*/true);
   EXPECT_EQ(2, t.buffer_limit());
 }
 
-TEST(PrefetchAutotuner, Enabled) {
+TEST(PrefetchAutotuner, StartWithMin) {
   PrefetchAutotuner t(model::kAutotune, 0);
   EXPECT_EQ(1, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to stay the same.
-  EXPECT_EQ(1, t.buffer_limit());
-  t.RecordConsumption(1);
+  PrefetchAutotuner t_min(model::kAutotune, 2);
+  EXPECT_EQ(2, t_min.buffer_limit());
+  // A steady producer needs no headroom, but the minimum is kept.
+  Simulate(&t_min, Steady, /*consume_us=*/100, /*num_elements=*/320);
+  EXPECT_EQ(2, t_min.buffer_limit());
+}
+
+TEST(PrefetchAutotuner, SteadyProducer) {
+  PrefetchAutotuner t(model::kAutotune, 0);
+  Simulate(&t, Steady, /*consume_us=*/100, /*num_elements=*/320);
   EXPECT_EQ(1, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
-  EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(2);
-  EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(1);
+}
+
+TEST(PrefetchAutotuner, JitteryProducer) {
+  PrefetchAutotuner t(model::kAutotune, 0);
+  // The buffer grows at most twofold per adjustment.
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/32);
   EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/32);
   EXPECT_EQ(4, t.buffer_limit());
-  t.RecordConsumption(4);
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/576);
+  EXPECT_EQ(7, t.buffer_limit());
+}
+
+TEST(PrefetchAutotuner, LowerPercentileNeedsSmallerBuffer) {
+  PrefetchAutotuner::Options options;
+  options.wait_percentile = 0.9;
+  PrefetchAutotuner t(model::kAutotune, 0, options);
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/640);
   EXPECT_EQ(4, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
-  EXPECT_EQ(8, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to stay the same!
-  EXPECT_EQ(8, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to stay the same!
-  EXPECT_EQ(8, t.buffer_limit());
 }
 
-TEST(PrefetchAutotuner, EnabledSteady) {
+TEST(PrefetchAutotuner, ShrinksUnusedHeadroom) {
   PrefetchAutotuner t(model::kAutotune, 0);
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/640);
+  EXPECT_EQ(7, t.buffer_limit());
+  // Once the producer is steady, the full buffer is never drawn upon.
+  Simulate(&t, Steady, /*consume_us=*/100, /*num_elements=*/32);
+  EXPECT_EQ(4, t.buffer_limit());
+  Simulate(&t, Steady, /*consume_us=*/100, /*num_elements=*/288);
   EXPECT_EQ(1, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to stay the same!
-  EXPECT_EQ(1, t.buffer_limit());
-  t.RecordConsumption(1);
-  EXPECT_EQ(1, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
-  EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(2);
+}
+
+TEST(PrefetchAutotuner, GrowsOnWaits) {
+  PrefetchAutotuner t(model::kAutotune, 0);
+  Simulate(&t, Steady, /*consume_us=*/100, /*num_elements=*/32,
+           /*record_empty=*/true);
   EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
-  EXPECT_EQ(4, t.buffer_limit());
+  Simulate(&t, Steady, /*consume_us=*/100, /*num_elements=*/32,
+           /*record_empty=*/true);
+  EXPECT_EQ(3, t.buffer_limit());
+}
 
-  // Never reach zero again.
-  std::vector<size_t> consumption_values = {2, 3, 1, 4, 1, 2, 3, 1};
-  for (int i = 0; i < consumption_values.size(); ++i) {
-    t.RecordConsumption(consumption_values[i]);
-    EXPECT_EQ(4, t.buffer_limit())
-        << "Failed at index " << i << " with value: " << consumption_values[i];
-  }
+TEST(PrefetchAutotuner, ThroughputBound) {
+  PrefetchAutotuner t(model::kAutotune, 0);
+  // No amount of buffering helps a producer slower than the consumer.
+  Simulate(
+      &t, [](int i) -> int64_t { return 200; }, /*consume_us=*/100,
+      /*num_elements=*/320, /*record_empty=*/true);
+  EXPECT_EQ(1, t.buffer_limit());
 }
 
-TEST(PrefetchAutotuner, StartWithMin) {
-  PrefetchAutotuner t(model::kAutotune, 2);
-  EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to stay the same!
-  EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(2);  // Expect buffer limit to stay the same!
-  EXPECT_EQ(2, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
-  EXPECT_EQ(4, t.buffer_limit());
-  t.RecordConsumption(4);  // Expect buffer limit to stay the same!
-  EXPECT_EQ(4, t.buffer_limit());
-  t.RecordConsumption(0);  // Expect buffer limit to increase.
-  EXPECT_EQ(8, t.buffer_limit());
-
-  // Never reach zero again.
-  std::vector<size_t> consumption_values = {3, 5, 7, 1, 4, 6, 8, 3, 5, 1, 2, 4};
-  for (int i = 0; i < consumption_values.size(); ++i) {
-    t.RecordConsumption(consumption_values[i]);
-    EXPECT_EQ(8, t.buffer_limit())
-        << "Failed at index " << i << " with value: " << consumption_values[i];
-  }
+TEST(PrefetchAutotuner, RamBudget) {
+  PrefetchAutotuner::Options options;
+  options.ram_budget = 3 * kElementBytes;
+  PrefetchAutotuner t(model::kAutotune, 0, options);
+  Simulate(&t, Jittery, /*consume_us=*/100, /*num_elements=*/640);
+  EXPECT_EQ(3, t.buffer_limit());
 }
 
 }  // namespace
@@ -47,6 +47,9 @@ namespace data {
 /* static */ constexpr const char* const PrefetchDatasetOp::kSlackPeriod;
 /* static */ constexpr const char* const PrefetchDatasetOp::kLegacyAutotune;
 /* static */ constexpr const char* const PrefetchDatasetOp::kBufferSizeMin;
+/* static */ constexpr const char* const
+    PrefetchDatasetOp::kAutotuneWaitPercentile;
+/* static */ constexpr const char* const PrefetchDatasetOp::kAutotuneRamBudget;
 
 namespace {
 
@@ -63,13 +66,16 @@ constexpr char kErrorMessageSuffix[] = ".error_message";
 class PrefetchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
-          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min)
+          int64_t slack_period, bool legacy_autotune, int64_t buffer_size_min,
+          float autotune_wait_percentile, int64_t autotune_ram_budget)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         slack_period_(slack_period),
         legacy_autotune_(legacy_autotune),
-        buffer_size_min_(buffer_size_min) {
+        buffer_size_min_(buffer_size_min),
+        autotune_wait_percentile_(autotune_wait_percentile),
+        autotune_ram_budget_(autotune_ram_budget) {
     input_->Ref();
   }
 
@@ -118,13 +124,21 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(legacy_autotune_, &legacy_autotune_attr);
     AttrValue buffer_size_min_attr;
     b->BuildAttrValue(buffer_size_min_, &buffer_size_min_attr);
-
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_graph_node, buffer_size},
-                      {std::make_pair(kSlackPeriod, slack_period_attr),
-                       std::make_pair(kLegacyAutotune, legacy_autotune_attr),
-                       std::make_pair(kBufferSizeMin, buffer_size_min_attr)},
-                      output));
+    AttrValue autotune_wait_percentile_attr;
+    b->BuildAttrValue(autotune_wait_percentile_,
+                      &autotune_wait_percentile_attr);
+    AttrValue autotune_ram_budget_attr;
+    b->BuildAttrValue(autotune_ram_budget_, &autotune_ram_budget_attr);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, buffer_size},
+        {std::make_pair(kSlackPeriod, slack_period_attr),
+         std::make_pair(kLegacyAutotune, legacy_autotune_attr),
+         std::make_pair(kBufferSizeMin, buffer_size_min_attr),
+         std::make_pair(kAutotuneWaitPercentile,
+                        autotune_wait_percentile_attr),
+         std::make_pair(kAutotuneRamBudget, autotune_ram_budget_attr)},
+        output));
     return Status::OK();
   }
 
@@ -136,7 +150,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           mu_(std::make_shared<mutex>()),
           cond_var_(std::make_shared<condition_variable>()),
           buffer_size_min_(params.dataset->buffer_size_min_),
-          auto_tuner_(params.dataset->buffer_size_, buffer_size_min_),
+          auto_tuner_(params.dataset->buffer_size_, buffer_size_min_,
+                      AutotunerOptions(*params.dataset)),
           legacy_autotune_(params.dataset->legacy_autotune_),
           // If `legacy_autotune_`, initialize the `buffer_size_` value to be 0
           // to avoid the created node to be collected as tunable nodes in the
@@ -176,11 +191,14 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
         // Wait until the next element in the buffer has been
         // produced, or we are shutting down.
+        const int64_t request_us = EnvTime::NowMicros();
         if (legacy_autotune_) {
+          if (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_ &&
+              auto_tuner_.buffer_limit() != 0) {
+            auto_tuner_.RecordEmpty();
+          }
           while (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_ &&
                  auto_tuner_.buffer_limit() != 0) {
-            auto_tuner_.RecordEmpty();
-            buffer_size_->value = auto_tuner_.buffer_limit();
             RecordStop(ctx);
             cond_var_->wait(l);
             RecordStart(ctx);
@@ -199,7 +217,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
 
         if (!buffer_.empty()) {
-          return Consume(ctx, out_tensors, end_of_sequence);
+          return Consume(ctx, request_us, out_tensors, end_of_sequence);
         }
 
         if (prefetch_thread_finished_) {
@@ -356,6 +374,13 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       const uint64 uid;
     };
 
+    static PrefetchAutotuner::Options AutotunerOptions(const Dataset& dataset) {
+      PrefetchAutotuner::Options options;
+      options.wait_percentile = dataset.autotune_wait_percentile_;
+      options.ram_budget = dataset.autotune_ram_budget_;
+      return options;
+    }
+
     int64_t buffer_limit() const TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       if (legacy_autotune_) {
         return auto_tuner_.buffer_limit();
@@ -370,8 +395,9 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       cond_var_->notify_all();
     }
 
-    Status Consume(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                   bool* end_of_sequence) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status Consume(IteratorContext* ctx, int64_t request_us,
+                   std::vector<Tensor>* out_tensors, bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       const auto& stats_aggregator = ctx->stats_aggregator();
       if (stats_aggregator) {
         double buffer_limit_ = buffer_limit();
@@ -420,8 +446,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         RecordBufferDequeue(ctx, buffer_.front().value);
       }
       if (legacy_autotune_) {
-        auto_tuner_.RecordConsumption(buffer_.size());
+        auto_tuner_.RecordConsumption(
+            last_consumed_us_ >= 0 ? request_us - last_consumed_us_ : -1,
+            buffer_.size());
         buffer_size_->value = auto_tuner_.buffer_limit();
+        last_consumed_us_ = EnvTime::NowMicros();
       }
       buffer_.pop_front();
       *end_of_sequence = false;
@@ -487,6 +516,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         mutex_lock input_l(input_mu_);
         bool end_of_sequence;
         BufferElement buffer_element;
+        const int64_t produce_start_us = EnvTime::NowMicros();
         {
           profiler::TraceMe traceme(
               [&] {
@@ -509,6 +539,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           mutex_lock l(*mu_);
           RecordBufferEnqueue(ctx.get(), buffer_element.value);
           buffer_element.created_us = EnvTime::NowMicros();
+          if (legacy_autotune_) {
+            auto_tuner_.RecordProduction(
+                buffer_element.created_us - produce_start_us,
+                GetAllocatedBytes(buffer_element.value));
+          }
           buffer_.push_back(std::move(buffer_element));
           cond_var_->notify_all();
         }
@@ -570,6 +605,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     const std::shared_ptr<condition_variable> cond_var_;
     const int64_t buffer_size_min_;
     PrefetchAutotuner auto_tuner_ TF_GUARDED_BY(*mu_);
+    // When the last element was consumed, or -1 before the first one.
+    int64_t last_consumed_us_ TF_GUARDED_BY(*mu_) = -1;
     std::deque<BufferElement> buffer_ TF_GUARDED_BY(*mu_);
     std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(*mu_);
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
@@ -598,6 +635,12 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
   // parameter.
   const int64_t buffer_size_min_ = 0;
 
+  // If legacy autotuning is used, determines the fraction of `GetNext` calls
+  // that should not wait for an element, and the maximum number of bytes
+  // buffered (0 for no maximum).
+  const float autotune_wait_percentile_ = 0.99;
+  const int64_t autotune_ram_budget_ = 0;
+
   TraceMeMetadata traceme_metadata_;
 };
 
@@ -612,6 +655,23 @@ PrefetchDatasetOp::PrefetchDatasetOp(OpKernelConstruction* ctx)
   if (ctx->HasAttr(kBufferSizeMin)) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr(kBufferSizeMin, &buffer_size_min_));
   }
+  if (ctx->HasAttr(kAutotuneWaitPercentile)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kAutotuneWaitPercentile,
+                                     &autotune_wait_percentile_));
+    OP_REQUIRES(ctx,
+                autotune_wait_percentile_ > 0 && autotune_wait_percentile_ < 1,
+                errors::InvalidArgument(
+                    "autotune_wait_percentile must be in (0, 1), got ",
+                    autotune_wait_percentile_));
+  }
+  if (ctx->HasAttr(kAutotuneRamBudget)) {
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr(kAutotuneRamBudget, &autotune_ram_budget_));
+    OP_REQUIRES(ctx, autotune_ram_budget_ >= 0,
+                errors::InvalidArgument(
+                    "autotune_ram_budget must be >= 0, got ",
+                    autotune_ram_budget_));
+  }
 }
 
 void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -629,7 +689,8 @@ void PrefetchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, buffer_size, slack_period_,
-                        legacy_autotune_, buffer_size_min_);
+                        legacy_autotune_, buffer_size_min_,
+                        autotune_wait_percentile_, autotune_ram_budget_);
 }
 
 namespace {
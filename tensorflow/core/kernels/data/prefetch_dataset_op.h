@@ -32,6 +32,9 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kSlackPeriod = "slack_period";
   static constexpr const char* const kLegacyAutotune = "legacy_autotune";
   static constexpr const char* const kBufferSizeMin = "buffer_size_min";
+  static constexpr const char* const kAutotuneWaitPercentile =
+      "autotune_wait_percentile";
+  static constexpr const char* const kAutotuneRamBudget = "autotune_ram_budget";
 
   explicit PrefetchDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +47,8 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
   int64_t slack_period_ = 0;
   bool legacy_autotune_ = true;
   int64_t buffer_size_min_ = 0;
+  float autotune_wait_percentile_ = 0.99;
+  int64_t autotune_ram_budget_ = 0;
 };
 
 }  // namespace data
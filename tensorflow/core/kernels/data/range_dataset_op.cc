@@ -84,6 +84,21 @@ class RangeCounter {
     return result;
   }
 
+  // Appends up to `n` next values of the counter to `values`. Sets
+  // `*end_of_counter` if fewer than `n` values remained.
+  void GetNextN(int n, std::vector<int64_t>* values, bool* end_of_counter) {
+    mutex_lock l(mu_);
+    *end_of_counter = false;
+    for (int i = 0; i < n; ++i) {
+      if ((step_ > 0 && next_ >= stop_) || (step_ < 0 && next_ <= stop_)) {
+        *end_of_counter = true;
+        return;
+      }
+      values->push_back(next_);
+      next_ += step_;
+    }
+  }
+
   int64_t Peek() const {
     mutex_lock l(mu_);
     return next_;
@@ -267,6 +282,26 @@ class RangeDatasetOp::Dataset : public DatasetBase {
       return ConvertOutputTypes(output_dtypes(), out_tensors, value);
     }
 
+    Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                            std::vector<std::vector<Tensor>>* out_elements,
+                            bool* end_of_sequence) override {
+      if (split_provider_ != nullptr) {
+        return DatasetIterator<Dataset>::GetNextNInternal(
+            ctx, max_elements, out_elements, end_of_sequence);
+      }
+      std::vector<int64_t> values;
+      counter_->GetNextN(max_elements, &values, end_of_sequence);
+      out_elements->reserve(out_elements->size() + values.size());
+      for (int64_t value : values) {
+        std::vector<Tensor> element;
+        element.reserve(1);
+        TF_RETURN_IF_ERROR(
+            ConvertOutputTypes(output_dtypes(), &element, value));
+        out_elements->push_back(std::move(element));
+      }
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
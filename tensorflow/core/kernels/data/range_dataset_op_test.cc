@@ -56,6 +56,9 @@ std::vector<GetNextTestCase<RangeDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(RangeDatasetOpTest, RangeDatasetParams,
                          GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(RangeDatasetOpTest, RangeDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(RangeDatasetOpTest, DatasetNodeName) {
   auto range_dataset_params = PositiveStepRangeDatasetParams();
   TF_ASSERT_OK(Initialize(range_dataset_params));
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shard_dataset_op.h"
 
+#include <limits>
+
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -204,6 +206,46 @@ class ShardDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                            std::vector<std::vector<Tensor>>* out_elements,
+                            bool* end_of_sequence) override {
+      const int64_t num_shards = dataset()->num_shards_;
+      // Reading the elements of the other shards instead of skipping them only
+      // pays off if they are cheap to produce, which is not the case for the
+      // files sharded with `require_non_empty`.
+      if (dataset()->require_non_empty_ ||
+          num_shards > std::numeric_limits<int>::max() / max_elements) {
+        return DatasetIterator<Dataset>::GetNextNInternal(
+            ctx, max_elements, out_elements, end_of_sequence);
+      }
+      mutex_lock l(mu_);
+      *end_of_sequence = false;
+      if (!input_impl_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      int64_t num_to_skip = (dataset()->index_ - next_index_) % num_shards;
+      if (num_to_skip < 0) {
+        num_to_skip += num_shards;
+      }
+      // Reads the input elements up to and including the last one of this
+      // shard that is needed.
+      std::vector<std::vector<Tensor>> input_elements;
+      TF_RETURN_IF_ERROR(input_impl_->GetNextN(
+          ctx, num_to_skip + (max_elements - 1) * num_shards + 1,
+          &input_elements, end_of_sequence));
+      for (std::vector<Tensor>& element : input_elements) {
+        if (next_index_ % num_shards == dataset()->index_) {
+          out_elements->push_back(std::move(element));
+        }
+        ++next_index_;
+      }
+      if (*end_of_sequence) {
+        input_impl_.reset();
+      }
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -223,6 +223,9 @@ std::vector<GetNextTestCase<ShardDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(ShardDatasetOpTest, ShardDatasetParams,
                          GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(ShardDatasetOpTest, ShardDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(ShardDatasetOpTest, DatasetNodeName) {
   auto dataset_params = ShardDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -84,6 +84,12 @@ class SkipDatasetOp::Dataset : public DatasetBase {
     return input_->CheckExternalState();
   }
 
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx, index + count_, out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -145,16 +151,9 @@ class SkipDatasetOp::Dataset : public DatasetBase {
         return Status::OK();
       }
 
-      if (i_ < dataset()->count_) {
-        int num_skipped;
-        TF_RETURN_IF_ERROR(input_impl_->Skip(ctx, dataset()->count_ - i_,
-                                             end_of_sequence, &num_skipped));
-        i_ += num_skipped;
-        if (*end_of_sequence) {
-          // We reached the end before the count was reached.
-          input_impl_.reset();
-          return Status::OK();
-        }
+      TF_RETURN_IF_ERROR(SkipPrefix(ctx, end_of_sequence));
+      if (*end_of_sequence) {
+        return Status::OK();
       }
 
       // Return GetNext() on the underlying iterator.
@@ -166,6 +165,26 @@ class SkipDatasetOp::Dataset : public DatasetBase {
       return Status::OK();
     }
 
+    Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                            std::vector<std::vector<Tensor>>* out_elements,
+                            bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (!input_impl_) {
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(SkipPrefix(ctx, end_of_sequence));
+      if (*end_of_sequence) {
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(input_impl_->GetNextN(ctx, max_elements, out_elements,
+                                               end_of_sequence));
+      if (*end_of_sequence) {
+        input_impl_.reset();
+      }
+      return Status::OK();
+    }
+
    protected:
     std::shared_ptr<model::Node> CreateNode(
         IteratorContext* ctx, model::Node::Args args) const override {
@@ -198,6 +217,23 @@ class SkipDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Skips the first `count` elements of the input, if not done yet.
+    Status SkipPrefix(IteratorContext* ctx, bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      *end_of_sequence = false;
+      if (i_ < dataset()->count_) {
+        int num_skipped;
+        TF_RETURN_IF_ERROR(input_impl_->Skip(ctx, dataset()->count_ - i_,
+                                             end_of_sequence, &num_skipped));
+        i_ += num_skipped;
+        if (*end_of_sequence) {
+          // We reached the end before the count was reached.
+          input_impl_.reset();
+        }
+      }
+      return Status::OK();
+    }
+
     mutex mu_;
     int64_t i_ TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
@@ -132,6 +132,9 @@ std::vector<GetNextTestCase<SkipDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(SkipDatasetOpTest, SkipDatasetParams,
                          GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(SkipDatasetOpTest, SkipDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(SkipDatasetOpTest, DatasetNodeName) {
   auto dataset_params = SkipDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
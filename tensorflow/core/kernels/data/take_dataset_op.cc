@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/take_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -84,6 +86,12 @@ Status TakeDataset::CheckExternalState() const {
   return input_->CheckExternalState();
 }
 
+Status TakeDataset::Get(OpKernelContext* ctx, int64 index,
+                        std::vector<Tensor>* out_tensors) const {
+  TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+  return input_->Get(ctx, index, out_tensors);
+}
+
 class TakeDataset::EmptyIterator : public DatasetIterator<TakeDataset> {
  public:
   explicit EmptyIterator(const Params& params)
@@ -142,6 +150,34 @@ class TakeDataset::FiniteIterator : public DatasetIterator<TakeDataset> {
     return Status::OK();
   }
 
+  Status GetNextNInternal(IteratorContext* ctx, int max_elements,
+                          std::vector<std::vector<Tensor>>* out_elements,
+                          bool* end_of_sequence) override {
+    mutex_lock l(mu_);
+    if (!input_impl_) {
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+    int num_to_take = max_elements;
+    if (dataset()->count_ >= 0) {
+      num_to_take = static_cast<int>(
+          std::min<int64_t>(num_to_take, dataset()->count_ - i_));
+    }
+    *end_of_sequence = false;
+    if (num_to_take > 0) {
+      const size_t num_existing_elements = out_elements->size();
+      TF_RETURN_IF_ERROR(input_impl_->GetNextN(ctx, num_to_take, out_elements,
+                                               end_of_sequence));
+      i_ += out_elements->size() - num_existing_elements;
+    }
+    if (*end_of_sequence ||
+        (dataset()->count_ >= 0 && i_ >= dataset()->count_)) {
+      *end_of_sequence = true;
+      input_impl_.reset();
+    }
+    return Status::OK();
+  }
+
  protected:
   std::shared_ptr<model::Node> CreateNode(
       IteratorContext* ctx, model::Node::Args args) const override {
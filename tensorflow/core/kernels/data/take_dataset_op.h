@@ -44,6 +44,9 @@ class TakeDataset : public DatasetBase {
 
   Status CheckExternalState() const override;
 
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override;
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -78,6 +78,9 @@ std::vector<GetNextTestCase<TakeDatasetParams>> GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(TakeDatasetOpTest, TakeDatasetParams,
                          GetNextTestCases())
 
+ITERATOR_GET_NEXT_N_TEST_P(TakeDatasetOpTest, TakeDatasetParams,
+                           GetNextTestCases())
+
 TEST_F(TakeDatasetOpTest, DatasetNodeName) {
   auto dataset_params = TakeLessTakeDatasetParams();
   TF_ASSERT_OK(Initialize(dataset_params));
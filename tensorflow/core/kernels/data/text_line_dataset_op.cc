@@ -14,7 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/text_line_dataset_op.h"
 
+#include <deque>
+
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -31,28 +35,155 @@ namespace data {
 /* static */ constexpr const char* const TextLineDatasetOp::kFileNames;
 /* static */ constexpr const char* const TextLineDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TextLineDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TextLineDatasetOp::kRangeSize;
+/* static */ constexpr const char* const
+    TextLineDatasetOp::kNumParallelRangeReads;
 
 constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
+constexpr char kNext[] = "next";
+constexpr char kNumRanges[] = "num_ranges";
+constexpr char kRange[] = "range";
+constexpr char kFileIndex[] = "file_index";
+constexpr char kStart[] = "start";
+constexpr char kEnd[] = "end";
+constexpr char kNextOffset[] = "next_offset";
+constexpr char kSlash[] = "/";
+constexpr char kSplitProvider[] = "split_provider";
+
+// Number of lines a range reader reads before publishing them to the consumer.
+constexpr int64_t kLinesPerBlock = 256;
+// Maximum number of lines buffered per range that is being read.
+constexpr int64_t kMaxBufferedLinesPerRange = 4 * kLinesPerBlock;
+// Marks a range that covers a whole (compressed) file.
+constexpr int64_t kWholeFile = -1;
+
+namespace {
+
+// A byte range `[start, end)` of the file at `file_index`. A range owns
+// exactly the lines whose first byte lies inside it, so adjacent ranges never
+// share a line regardless of where the range boundaries fall.
+struct FileRange {
+  int64_t file_index;
+  int64_t start;
+  int64_t end;
+};
+
+Tensor FileRangeToSplit(const FileRange& range) {
+  Tensor split(DT_INT64, TensorShape({3}));
+  auto flat = split.vec<int64_t>();
+  flat(0) = range.file_index;
+  flat(1) = range.start;
+  flat(2) = range.end;
+  return split;
+}
+
+Status SplitToFileRange(const Tensor& split, FileRange* range) {
+  if (split.dtype() != DT_INT64 || split.NumElements() != 3) {
+    return errors::Internal(
+        "TextLineDataset range splits must be int64 vectors of size 3, but "
+        "got ",
+        split.DebugString());
+  }
+  auto flat = split.vec<int64_t>();
+  range->file_index = flat(0);
+  range->start = flat(1);
+  range->end = flat(2);
+  return Status::OK();
+}
+
+// Divides `filenames` into ranges of roughly `range_size` bytes. Compressed
+// files cannot be read from an arbitrary offset, so each of them becomes a
+// single whole-file range.
+Status ComputeFileRanges(Env* env, const std::vector<string>& filenames,
+                         int64_t range_size, bool use_compression,
+                         std::vector<FileRange>* ranges) {
+  ranges->clear();
+  for (int64_t i = 0; i < filenames.size(); ++i) {
+    if (use_compression) {
+      ranges->push_back({i, 0, kWholeFile});
+      continue;
+    }
+    uint64 file_size;
+    TF_RETURN_IF_ERROR(env->GetFileSize(filenames[i], &file_size));
+    const int64_t size = static_cast<int64_t>(file_size);
+    for (int64_t start = 0; start < size; start += range_size) {
+      ranges->push_back({i, start, std::min(start + range_size, size)});
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+// Split provider where splits are newline-aligned byte ranges of the input
+// files. The split tensors are int64 vectors `[file_index, start, end]`, where
+// `end == -1` denotes a whole compressed file.
+class TextLineDatasetOp::RangeSplitProvider : public SplitProvider {
+ public:
+  explicit RangeSplitProvider(std::vector<FileRange> ranges)
+      : ranges_(std::move(ranges)) {}
+
+  Status GetNext(Tensor* split, bool* end_of_splits) override {
+    mutex_lock l(mu_);
+    if (next_ >= ranges_.size()) {
+      *end_of_splits = true;
+      return Status::OK();
+    }
+    *end_of_splits = false;
+    *split = FileRangeToSplit(ranges_[next_++]);
+    return Status::OK();
+  }
+
+  Status Reset() override {
+    mutex_lock l(mu_);
+    next_ = 0;
+    return Status::OK();
+  }
+
+  Status Save(std::function<std::string(std::string)> key_name_fn,
+              IteratorStateWriter* writer) override {
+    mutex_lock l(mu_);
+    return writer->WriteScalar(key_name_fn(kNext), next_);
+  }
+
+  Status Restore(std::function<std::string(std::string)> key_name_fn,
+                 IteratorStateReader* reader) override {
+    mutex_lock l(mu_);
+    return reader->ReadScalar(key_name_fn(kNext), &next_);
+  }
+
+ private:
+  const std::vector<FileRange> ranges_;
+  mutex mu_;
+  int64_t next_ TF_GUARDED_BY(mu_) = 0;
+};
 
 class TextLineDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, std::vector<string> filenames,
           const string& compression_type,
-          const io::ZlibCompressionOptions& options)
+          const io::ZlibCompressionOptions& options, int64_t range_size,
+          int64_t num_parallel_range_reads)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         use_compression_(!compression_type.empty()),
-        options_(options) {}
+        options_(options),
+        range_size_(range_size),
+        num_parallel_range_reads_(num_parallel_range_reads) {}
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
-    return absl::make_unique<Iterator>(Iterator::Params{
-        this,
-        name_utils::IteratorPrefix(TextLineDatasetOp::kDatasetType, prefix)});
+    const string iterator_prefix =
+        name_utils::IteratorPrefix(TextLineDatasetOp::kDatasetType, prefix);
+    if (range_size_ > 0) {
+      return absl::make_unique<RangeIterator>(
+          RangeIterator::Params{this, iterator_prefix});
+    }
+    return absl::make_unique<Iterator>(Iterator::Params{this, iterator_prefix});
   }
 
   const DataTypeVector& output_dtypes() const override {
@@ -76,6 +207,20 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return Status::OK(); }
 
+  Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                split_providers) const override {
+    if (range_size_ <= 0) {
+      return DatasetBase::MakeSplitProviders(split_providers);
+    }
+    std::vector<FileRange> ranges;
+    TF_RETURN_IF_ERROR(ComputeFileRanges(Env::Default(), filenames_,
+                                         range_size_, use_compression_,
+                                         &ranges));
+    split_providers->push_back(
+        absl::make_unique<RangeSplitProvider>(std::move(ranges)));
+    return Status::OK();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -86,8 +231,15 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     TF_RETURN_IF_ERROR(b->AddScalar(options_.input_buffer_size, &buffer_size));
+    AttrValue range_size;
+    b->BuildAttrValue(range_size_, &range_size);
+    AttrValue num_parallel_range_reads;
+    b->BuildAttrValue(num_parallel_range_reads_, &num_parallel_range_reads);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {std::make_pair(kRangeSize, range_size),
+         std::make_pair(kNumParallelRangeReads, num_parallel_range_reads)},
+        output));
     return Status::OK();
   }
 
@@ -227,14 +379,432 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
         TF_GUARDED_BY(mu_);  // must outlive input_stream_
   };
 
+
+  // Iterator used when `range_size > 0`. Files are divided into byte ranges
+  // which are read concurrently by `num_parallel_range_reads` threads. Lines
+  // are produced in range order, so the output is identical to the sequential
+  // iterator when the ranges come from the dataset itself. When the iterator
+  // context carries a split provider (e.g. tf.data service dynamic sharding),
+  // the ranges are taken from it instead.
+  class RangeIterator : public DatasetIterator<Dataset> {
+   public:
+    explicit RangeIterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~RangeIterator() override {
+      CancelThreads();
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      if (ctx->split_providers().empty()) {
+        std::vector<FileRange> ranges;
+        TF_RETURN_IF_ERROR(ComputeFileRanges(
+            ctx->env(), dataset()->filenames_, dataset()->range_size_,
+            dataset()->use_compression_, &ranges));
+        split_provider_ =
+            std::make_shared<RangeSplitProvider>(std::move(ranges));
+      } else {
+        TF_ASSIGN_OR_RETURN(split_provider_,
+                            GetSingleSplitProvider(ctx, dataset()));
+      }
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(), [this]() { CancelThreads(); },
+          &deregister_fn_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      EnsureThreadsStarted(ctx);
+      while (true) {
+        while (!cancelled_ && !HasOutputLocked()) {
+          RecordStop(ctx);
+          cond_var_.wait(l);
+          RecordStart(ctx);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        if (ranges_.empty()) {
+          if (!status_.ok()) {
+            return status_;
+          }
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        std::shared_ptr<PendingRange> range = ranges_.front();
+        if (!range->lines.empty()) {
+          static monitoring::CounterCell* bytes_counter =
+              metrics::GetTFDataBytesReadCounter(
+                  name_utils::OpName(TextLineDatasetOp::kDatasetType));
+          bytes_counter->IncrementBy(range->lines.front().size());
+          out_tensors->emplace_back(std::move(range->lines.front()));
+          range->lines.pop_front();
+          range->next_offset = range->line_ends.front();
+          range->line_ends.pop_front();
+          cond_var_.notify_all();
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        // The front range is done and fully consumed.
+        if (!range->status.ok()) {
+          return range->status;
+        }
+        ranges_.pop_front();
+        cond_var_.notify_all();
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      // Holding `split_mu_` prevents readers from claiming new ranges, and
+      // holding `mu_` freezes the consumer position of the claimed ones. The
+      // lines buffered by readers are not saved: the claimed ranges are
+      // re-read from the consumer position on restore.
+      mutex_lock split_l(split_mu_);
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(split_provider_->Save(
+          [this](const std::string& key) {
+            return SplitProviderKeyNameFn(key);
+          },
+          writer));
+      std::vector<std::shared_ptr<PendingRange>> pending(ranges_.begin(),
+                                                         ranges_.end());
+      pending.insert(pending.end(), restored_ranges_.begin(),
+                     restored_ranges_.end());
+      int64_t num_ranges = 0;
+      for (const auto& range : pending) {
+        // Ranges that were fully read and consumed need no state.
+        if (range->done && range->lines.empty() && range->status.ok()) {
+          continue;
+        }
+        const string prefix = absl::StrCat(kRange, "[", num_ranges, "]");
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(absl::StrCat(prefix, kFileIndex)),
+                                range->range.file_index));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(absl::StrCat(prefix, kStart)), range->range.start));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(absl::StrCat(prefix, kEnd)), range->range.end));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(absl::StrCat(prefix, kNextOffset)), range->next_offset));
+        ++num_ranges;
+      }
+      return writer->WriteScalar(full_name(kNumRanges), num_ranges);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      StopThreads();
+      mutex_lock split_l(split_mu_);
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(split_provider_->Restore(
+          [this](const std::string& key) {
+            return SplitProviderKeyNameFn(key);
+          },
+          reader));
+      int64_t num_ranges;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNumRanges), &num_ranges));
+      for (int64_t i = 0; i < num_ranges; ++i) {
+        const string prefix = absl::StrCat(kRange, "[", i, "]");
+        FileRange range;
+        int64_t next_offset;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(absl::StrCat(prefix, kFileIndex)), &range.file_index));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(absl::StrCat(prefix, kStart)), &range.start));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(absl::StrCat(prefix, kEnd)), &range.end));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(absl::StrCat(prefix, kNextOffset)), &next_offset));
+        auto pending = std::make_shared<PendingRange>(range);
+        pending->next_offset = next_offset;
+        restored_ranges_.push_back(std::move(pending));
+      }
+      return Status::OK();
+    }
+
+   private:
+    // A range claimed by a reader thread. Lines are appended by the reader and
+    // removed by the consumer.
+    struct PendingRange {
+      explicit PendingRange(const FileRange& range)
+          : range(range), next_offset(range.start) {}
+
+      const FileRange range;
+      // Offset right after the last line returned to the consumer. For
+      // uncompressed ranges this is the offset of the first byte of the next
+      // line, or `range.start` if no line has been returned yet.
+      int64_t next_offset;
+      std::deque<tstring> lines;
+      // `line_ends[i]` is the offset right after `lines[i]`.
+      std::deque<int64_t> line_ends;
+      bool done = false;
+      Status status;
+    };
+
+    // Whether `GetNextInternal` can make progress without waiting.
+    bool HasOutputLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (ranges_.empty()) {
+        return end_of_splits_ && restored_ranges_.empty();
+      }
+      return !ranges_.front()->lines.empty() || ranges_.front()->done;
+    }
+
+    void EnsureThreadsStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!reader_threads_.empty()) {
+        return;
+      }
+      auto new_ctx = std::make_shared<IteratorContext>(*ctx);
+      for (int64_t i = 0; i < dataset()->num_parallel_range_reads_; ++i) {
+        reader_threads_.push_back(ctx->StartThread(
+            absl::StrCat("tf_data_text_line_range_reader_", i),
+            [this, new_ctx]() { ReaderThread(new_ctx); }));
+      }
+    }
+
+    void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+    }
+
+    // Stops and joins the reader threads and discards all claimed ranges.
+    void StopThreads() TF_LOCKS_EXCLUDED(mu_) {
+      std::vector<std::unique_ptr<Thread>> threads;
+      {
+        mutex_lock l(mu_);
+        stopping_ = true;
+        cond_var_.notify_all();
+        threads = std::move(reader_threads_);
+        reader_threads_.clear();
+      }
+      threads.clear();
+      mutex_lock l(mu_);
+      stopping_ = false;
+      ranges_.clear();
+      restored_ranges_.clear();
+      end_of_splits_ = false;
+      status_ = Status::OK();
+    }
+
+    // Claims the next range to read, preferring ranges restored from a
+    // checkpoint over fresh splits. Returns nullptr when there is nothing left
+    // to read or the iterator is shutting down.
+    std::shared_ptr<PendingRange> ClaimRange() TF_LOCKS_EXCLUDED(mu_) {
+      {
+        mutex_lock l(mu_);
+        // Bound the number of ranges buffered ahead of the consumer.
+        while (!cancelled_ && !stopping_ &&
+               ranges_.size() >= 2 * dataset()->num_parallel_range_reads_) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_ || stopping_) {
+          return nullptr;
+        }
+      }
+      // `split_mu_` is held while fetching the split and publishing the range
+      // so that `ranges_` stays in split order. Fetching a split may involve
+      // an RPC to the tf.data service dispatcher, so `mu_` is not held while
+      // doing so.
+      mutex_lock split_l(split_mu_);
+      {
+        mutex_lock l(mu_);
+        if (!restored_ranges_.empty()) {
+          std::shared_ptr<PendingRange> range = restored_ranges_.front();
+          restored_ranges_.pop_front();
+          ranges_.push_back(range);
+          cond_var_.notify_all();
+          return range;
+        }
+        if (end_of_splits_) {
+          return nullptr;
+        }
+      }
+      Tensor split;
+      bool end_of_splits = false;
+      Status s = split_provider_->GetNext(&split, &end_of_splits);
+      FileRange file_range;
+      if (s.ok() && !end_of_splits) {
+        s = SplitToFileRange(split, &file_range);
+      }
+      if (s.ok() && !end_of_splits &&
+          (file_range.file_index < 0 ||
+           file_range.file_index >= dataset()->filenames_.size())) {
+        s = errors::InvalidArgument(
+            "TextLineDataset range split refers to file index ",
+            file_range.file_index, ", but there are only ",
+            dataset()->filenames_.size(), " files.");
+      }
+      mutex_lock l(mu_);
+      if (!s.ok() || end_of_splits) {
+        status_.Update(s);
+        end_of_splits_ = true;
+        cond_var_.notify_all();
+        return nullptr;
+      }
+      auto range = std::make_shared<PendingRange>(file_range);
+      ranges_.push_back(range);
+      cond_var_.notify_all();
+      return range;
+    }
+
+    void ReaderThread(const std::shared_ptr<IteratorContext>& ctx) {
+      while (true) {
+        std::shared_ptr<PendingRange> range = ClaimRange();
+        if (!range) {
+          return;
+        }
+        Status s = ReadRange(ctx->env(), range.get());
+        mutex_lock l(mu_);
+        range->status = s;
+        range->done = true;
+        cond_var_.notify_all();
+      }
+    }
+
+    // Reads the lines owned by `range`, starting at its `next_offset`, and
+    // publishes them in blocks of `kLinesPerBlock`.
+    Status ReadRange(Env* env, PendingRange* range) TF_LOCKS_EXCLUDED(mu_) {
+      const FileRange& file_range = range->range;
+      int64_t begin;
+      {
+        mutex_lock l(mu_);
+        begin = range->next_offset;
+      }
+      std::unique_ptr<RandomAccessFile> file;
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
+          dataset()->filenames_[file_range.file_index], &file));
+      io::RandomAccessInputStream input_stream(file.get(), false);
+      std::unique_ptr<io::ZlibInputStream> zlib_input_stream;
+      std::unique_ptr<io::BufferedInputStream> buffered_input_stream;
+      if (file_range.end == kWholeFile && dataset()->use_compression_) {
+        zlib_input_stream = absl::make_unique<io::ZlibInputStream>(
+            &input_stream, dataset()->options_.input_buffer_size,
+            dataset()->options_.input_buffer_size, dataset()->options_);
+        buffered_input_stream = absl::make_unique<io::BufferedInputStream>(
+            zlib_input_stream.get(), dataset()->options_.input_buffer_size,
+            false);
+      } else {
+        buffered_input_stream = absl::make_unique<io::BufferedInputStream>(
+            &input_stream, dataset()->options_.input_buffer_size, false);
+      }
+
+      if (begin > 0 && begin == file_range.start &&
+          file_range.end != kWholeFile) {
+        // Skip the line that straddles the range start; it is owned by the
+        // previous range. Starting one byte early handles the case where the
+        // range starts exactly at the beginning of a line.
+        TF_RETURN_IF_ERROR(buffered_input_stream->Seek(begin - 1));
+        tstring unused;
+        Status s = buffered_input_stream->ReadLine(&unused);
+        if (errors::IsOutOfRange(s)) {
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(s);
+      } else if (begin > 0) {
+        // Restored positions are always at the beginning of a line. For
+        // compressed files this seeks within the uncompressed stream.
+        TF_RETURN_IF_ERROR(buffered_input_stream->Seek(begin));
+      }
+
+      std::vector<tstring> lines;
+      std::vector<int64_t> line_ends;
+      lines.reserve(kLinesPerBlock);
+      line_ends.reserve(kLinesPerBlock);
+      bool end_of_range = false;
+      while (!end_of_range) {
+        while (lines.size() < kLinesPerBlock) {
+          if (file_range.end != kWholeFile &&
+              buffered_input_stream->Tell() >= file_range.end) {
+            end_of_range = true;
+            break;
+          }
+          tstring line;
+          Status s = buffered_input_stream->ReadLine(&line);
+          if (errors::IsOutOfRange(s)) {
+            end_of_range = true;
+            break;
+          }
+          TF_RETURN_IF_ERROR(s);
+          lines.push_back(std::move(line));
+          line_ends.push_back(buffered_input_stream->Tell());
+        }
+        mutex_lock l(mu_);
+        while (!cancelled_ && !stopping_ &&
+               range->lines.size() >= kMaxBufferedLinesPerRange) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_ || stopping_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        for (int64_t i = 0; i < lines.size(); ++i) {
+          range->lines.push_back(std::move(lines[i]));
+          range->line_ends.push_back(line_ends[i]);
+        }
+        lines.clear();
+        line_ends.clear();
+        cond_var_.notify_all();
+      }
+      return Status::OK();
+    }
+
+    std::string SplitProviderKeyNameFn(const std::string& key) {
+      return full_name(absl::StrCat(kSplitProvider, kSlash, key));
+    }
+
+    std::shared_ptr<SplitProvider> split_provider_;
+    std::function<void()> deregister_fn_;
+
+    // Serializes split fetching so that ranges are published in split order.
+    // Must be acquired before `mu_`.
+    mutex split_mu_;
+    mutex mu_ TF_ACQUIRED_AFTER(split_mu_);
+    condition_variable cond_var_;
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    bool stopping_ TF_GUARDED_BY(mu_) = false;
+    bool end_of_splits_ TF_GUARDED_BY(mu_) = false;
+    // Error encountered while fetching splits.
+    Status status_ TF_GUARDED_BY(mu_);
+    // Claimed ranges in consumption order.
+    std::deque<std::shared_ptr<PendingRange>> ranges_ TF_GUARDED_BY(mu_);
+    // Ranges restored from a checkpoint that have not been claimed yet.
+    std::deque<std::shared_ptr<PendingRange>> restored_ranges_
+        TF_GUARDED_BY(mu_);
+    // Declared last so that the threads are joined before the state they
+    // access is destroyed.
+    std::vector<std::unique_ptr<Thread>> reader_threads_ TF_GUARDED_BY(mu_);
+  };
+
   const std::vector<string> filenames_;
   const tstring compression_type_;
   const bool use_compression_;
   const io::ZlibCompressionOptions options_;
+  const int64_t range_size_;
+  const int64_t num_parallel_range_reads_;
 };
 
 TextLineDatasetOp::TextLineDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRangeSize, &range_size_));
+  OP_REQUIRES(ctx, range_size_ >= 0,
+              errors::InvalidArgument("`range_size` must be >= 0"));
+  OP_REQUIRES_OK(
+      ctx, ctx->GetAttr(kNumParallelRangeReads, &num_parallel_range_reads_));
+  OP_REQUIRES(
+      ctx, num_parallel_range_reads_ > 0,
+      errors::InvalidArgument("`num_parallel_range_reads` must be > 0"));
+}
 
 void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -279,7 +849,8 @@ void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        zlib_compression_options);
+                        zlib_compression_options, range_size_,
+                        num_parallel_range_reads_);
 }
 
 namespace {
@@ -26,6 +26,9 @@ class TextLineDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFileNames = "filenames";
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kRangeSize = "range_size";
+  static constexpr const char* const kNumParallelRangeReads =
+      "num_parallel_range_reads";
 
   explicit TextLineDatasetOp(OpKernelConstruction* ctx);
 
@@ -34,6 +37,10 @@ class TextLineDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+  class RangeSplitProvider;
+
+  int64_t range_size_;
+  int64_t num_parallel_range_reads_;
 };
 
 }  // namespace data
@@ -29,12 +29,15 @@ class TextLineDatasetParams : public DatasetParams {
  public:
   TextLineDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        string node_name)
+                        string node_name, int64_t range_size = 0,
+                        int64_t num_parallel_range_reads = 1)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        buffer_size_(buffer_size),
+        range_size_(range_size),
+        num_parallel_range_reads_(num_parallel_range_reads) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
@@ -57,6 +60,9 @@ class TextLineDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TextLineDatasetOp::kRangeSize, range_size_);
+    attr_vector->emplace_back(TextLineDatasetOp::kNumParallelRangeReads,
+                              num_parallel_range_reads_);
     return Status::OK();
   }
 
@@ -68,6 +74,8 @@ class TextLineDatasetParams : public DatasetParams {
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
   int64_t buffer_size_;
+  int64_t range_size_;
+  int64_t num_parallel_range_reads_;
 };
 
 class TextLineDatasetOpTest : public DatasetOpsTestBase {};
@@ -140,6 +148,46 @@ TextLineDatasetParams TextLineDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: multiple text files without compression, read in ranges of 12
+// bytes by two parallel readers.
+TextLineDatasetParams RangeTextLineDatasetParams() {
+  std::vector<tstring> filenames = {LocalTempFilename(), LocalTempFilename()};
+  std::vector<tstring> contents = {
+      absl::StrCat("hello world\n", "11223334455\n"),
+      absl::StrCat("abcd, EFgH\n", "           \n", "$%^&*()\n")};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TextLineDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*range_size=*/12,
+                               /*num_parallel_range_reads=*/2);
+}
+
+// Test case 5: multiple text files with GZIP compression in range mode. Each
+// compressed file is read as a single range.
+TextLineDatasetParams CompressedRangeTextLineDatasetParams() {
+  std::vector<tstring> filenames = {LocalTempFilename(), LocalTempFilename()};
+  std::vector<tstring> contents = {
+      absl::StrCat("hello world\n", "11223334455\n"),
+      absl::StrCat("abcd, EFgH\n", "           \n", "$%^&*()\n")};
+  CompressionType compression_type = CompressionType::GZIP;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TextLineDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*range_size=*/12,
+                               /*num_parallel_range_reads=*/2);
+}
+
 std::vector<GetNextTestCase<TextLineDatasetParams>> GetNextTestCases() {
   return {{/*dataset_params=*/TextLineDatasetParams1(),
            /*expected_outputs=*/
@@ -155,6 +203,18 @@ std::vector<GetNextTestCase<TextLineDatasetParams>> GetNextTestCases() {
                                                     {"           "},
                                                     {"$%^&*()"}})},
           {/*dataset_params=*/TextLineDatasetParams3(),
+           CreateTensors<tstring>(TensorShape({}), {{"hello world"},
+                                                    {"11223334455"},
+                                                    {"abcd, EFgH"},
+                                                    {"           "},
+                                                    {"$%^&*()"}})},
+          {/*dataset_params=*/RangeTextLineDatasetParams(),
+           CreateTensors<tstring>(TensorShape({}), {{"hello world"},
+                                                    {"11223334455"},
+                                                    {"abcd, EFgH"},
+                                                    {"           "},
+                                                    {"$%^&*()"}})},
+          {/*dataset_params=*/CompressedRangeTextLineDatasetParams(),
            CreateTensors<tstring>(TensorShape({}), {{"hello world"},
                                                     {"11223334455"},
                                                     {"abcd, EFgH"},
@@ -235,6 +295,20 @@ IteratorSaveAndRestoreTestCases() {
                                                     {"$%^&*()"}})},
           {/*dataset_params=*/TextLineDatasetParams3(),
            /*breakpoints=*/{0, 2, 6},
+           CreateTensors<tstring>(TensorShape({}), {{"hello world"},
+                                                    {"11223334455"},
+                                                    {"abcd, EFgH"},
+                                                    {"           "},
+                                                    {"$%^&*()"}})},
+          {/*dataset_params=*/RangeTextLineDatasetParams(),
+           /*breakpoints=*/{0, 2, 4, 6},
+           CreateTensors<tstring>(TensorShape({}), {{"hello world"},
+                                                    {"11223334455"},
+                                                    {"abcd, EFgH"},
+                                                    {"           "},
+                                                    {"$%^&*()"}})},
+          {/*dataset_params=*/CompressedRangeTextLineDatasetParams(),
+           /*breakpoints=*/{0, 3, 6},
            CreateTensors<tstring>(TensorShape({}), {{"hello world"},
                                                     {"11223334455"},
                                                     {"abcd, EFgH"},
@@ -245,6 +319,34 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TextLineDatasetOpTest, TextLineDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(TextLineDatasetOpTest, RangeSplitProvider) {
+  auto params = RangeTextLineDatasetParams();
+  TF_ASSERT_OK(InitializeRuntime(params));
+  TF_EXPECT_OK(CheckSplitProviderFullIteration(
+      params, CreateTensors<tstring>(TensorShape({}), {{"hello world"},
+                                                       {"11223334455"},
+                                                       {"abcd, EFgH"},
+                                                       {"           "},
+                                                       {"$%^&*()"}})));
+  // The ranges are [0, 12) and [12, 24) of the first file and [0, 12),
+  // [12, 24) and [24, 31) of the second file. Shard 1 gets the second and
+  // fourth range.
+  TF_EXPECT_OK(CheckSplitProviderShardedIteration(
+      params, /*num_shards=*/2, /*shard_index=*/1,
+      CreateTensors<tstring>(TensorShape({}),
+                             {{"11223334455"}, {"$%^&*()"}})));
+}
+
+TEST_F(TextLineDatasetOpTest, NoSplitProviderWithoutRangeSize) {
+  auto params = TextLineDatasetParams3();
+  TF_ASSERT_OK(InitializeRuntime(params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(params, &dataset));
+  std::vector<std::unique_ptr<SplitProvider>> split_providers;
+  EXPECT_EQ(dataset->dataset()->MakeSplitProviders(&split_providers).code(),
+            tensorflow::error::UNIMPLEMENTED);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
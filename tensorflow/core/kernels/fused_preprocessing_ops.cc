@@ -0,0 +1,278 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc and ../ops/array_ops.cc.
+//
+// CPU kernels for the input-preprocessing fusions created by the remapper:
+// _FusedCastNormalize computes Cast followed by a chain of elementwise
+// Add/Sub/Mul/RealDiv by constants in a single pass over the data, and
+// _FusedTransposeCast computes Transpose followed by Cast without
+// materializing the transposed tensor in the source type.
+
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class NormalizeOp { kAdd, kSub, kMul, kDiv };
+
+Status ParseNormalizeOp(const string& name, NormalizeOp* op) {
+  if (name == "Add" || name == "AddV2") {
+    *op = NormalizeOp::kAdd;
+  } else if (name == "Sub") {
+    *op = NormalizeOp::kSub;
+  } else if (name == "Mul") {
+    *op = NormalizeOp::kMul;
+  } else if (name == "RealDiv") {
+    *op = NormalizeOp::kDiv;
+  } else {
+    return errors::InvalidArgument("Unsupported fused op: ", name);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename SrcT, typename DstT>
+class FusedCastNormalizeOp : public OpKernel {
+ public:
+  explicit FusedCastNormalizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, fused_ops.size() == context->num_inputs() - 1,
+                errors::InvalidArgument(
+                    "Number of fused ops (", fused_ops.size(),
+                    ") must match the number of args (",
+                    context->num_inputs() - 1, ")"));
+    ops_.resize(fused_ops.size());
+    for (int i = 0; i < fused_ops.size(); ++i) {
+      OP_REQUIRES_OK(context, ParseNormalizeOp(fused_ops[i], &ops_[i]));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const int64_t num_channels =
+        x.dims() > 0 ? x.dim_size(x.dims() - 1) : int64_t{1};
+
+    // Each arg is either a scalar or a vector broadcast along the innermost
+    // dimension, e.g. per-channel mean and stddev of an image.
+    const int num_ops = ops_.size();
+    std::vector<const DstT*> args(num_ops);
+    std::vector<int64_t> strides(num_ops);
+    for (int i = 0; i < num_ops; ++i) {
+      const Tensor& arg = context->input(i + 1);
+      if (arg.dims() == 0) {
+        strides[i] = 0;
+      } else {
+        OP_REQUIRES(context,
+                    arg.dims() == 1 && x.dims() > 0 &&
+                        arg.dim_size(0) == num_channels,
+                    errors::InvalidArgument(
+                        "Arg ", i, " must be a scalar or a vector of size ",
+                        num_channels, ", got shape ",
+                        arg.shape().DebugString()));
+        strides[i] = 1;
+      }
+      args[i] = arg.flat<DstT>().data();
+    }
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    const int64_t num_elements = x.NumElements();
+    if (num_elements == 0) return;
+
+    const SrcT* in = x.flat<SrcT>().data();
+    DstT* out = y->flat<DstT>().data();
+    const NormalizeOp* ops = ops_.data();
+    auto compute = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t channel = i % num_channels;
+        DstT value = static_cast<DstT>(in[i]);
+        for (int k = 0; k < num_ops; ++k) {
+          const DstT arg = args[k][channel * strides[k]];
+          switch (ops[k]) {
+            case NormalizeOp::kAdd:
+              value = value + arg;
+              break;
+            case NormalizeOp::kSub:
+              value = value - arg;
+              break;
+            case NormalizeOp::kMul:
+              value = value * arg;
+              break;
+            case NormalizeOp::kDiv:
+              value = value / arg;
+              break;
+          }
+        }
+        out[i] = value;
+      }
+    };
+
+    const CPUDevice& device = context->eigen_device<CPUDevice>();
+    const Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(SrcT),
+                                   /*bytes_stored=*/sizeof(DstT),
+                                   /*compute_cycles=*/5 * (num_ops + 1));
+    device.parallelFor(num_elements, cost, compute);
+  }
+
+ private:
+  std::vector<NormalizeOp> ops_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedCastNormalizeOp);
+};
+
+template <typename SrcT, typename DstT>
+class FusedTransposeCastOp : public OpKernel {
+ public:
+  explicit FusedTransposeCastOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& perm_tensor = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(perm_tensor.shape()),
+                errors::InvalidArgument("perm must be a vector, not ",
+                                        perm_tensor.shape().DebugString()));
+    const int dims = x.dims();
+    OP_REQUIRES(context, perm_tensor.NumElements() == dims,
+                errors::InvalidArgument(
+                    "transpose expects a vector of size ", dims,
+                    ". But input(1) is a vector of size ",
+                    perm_tensor.NumElements()));
+
+    gtl::InlinedVector<int32, 8> perm(dims);
+    for (int i = 0; i < dims; ++i) {
+      perm[i] = perm_tensor.dtype() == DT_INT32
+                    ? perm_tensor.vec<int32>()(i)
+                    : static_cast<int32>(perm_tensor.vec<int64_t>()(i));
+    }
+    gtl::InlinedVector<bool, 8> seen(dims, false);
+    TensorShape shape;
+    bool is_identity = true;
+    for (int i = 0; i < dims; ++i) {
+      const int32 d = perm[i];
+      OP_REQUIRES(context, 0 <= d && d < dims && !seen[d],
+                  errors::InvalidArgument(
+                      "perm is not a permutation of [0, ", dims, ")"));
+      seen[d] = true;
+      shape.AddDim(x.dim_size(d));
+      is_identity &= d == i;
+    }
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, shape, &y));
+    if (x.NumElements() == 0) return;
+
+    const CPUDevice& device = context->eigen_device<CPUDevice>();
+    if (is_identity) {
+      y->flat<DstT>().device(device) =
+          x.flat<SrcT>().template cast<DstT>();
+      return;
+    }
+    switch (dims) {
+      case 2:
+        Shuffle<2>(device, x, perm, y);
+        break;
+      case 3:
+        Shuffle<3>(device, x, perm, y);
+        break;
+      case 4:
+        Shuffle<4>(device, x, perm, y);
+        break;
+      case 5:
+        Shuffle<5>(device, x, perm, y);
+        break;
+      default:
+        context->SetStatus(errors::Unimplemented(
+            "_FusedTransposeCast does not support tensors of rank ", dims));
+    }
+  }
+
+ private:
+  template <int NDIMS>
+  static void Shuffle(const CPUDevice& device, const Tensor& x,
+                      const gtl::InlinedVector<int32, 8>& perm, Tensor* y) {
+    Eigen::array<int, NDIMS> p;
+    for (int i = 0; i < NDIMS; ++i) p[i] = perm[i];
+    y->tensor<DstT, NDIMS>().device(device) =
+        x.tensor<SrcT, NDIMS>().shuffle(p).template cast<DstT>();
+  }
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedTransposeCastOp);
+};
+
+#define REGISTER_CAST_NORMALIZE(SrcT, DstT)                   \
+  REGISTER_KERNEL_BUILDER(Name("_FusedCastNormalize")         \
+                              .Device(DEVICE_CPU)             \
+                              .TypeConstraint<SrcT>("SrcT")   \
+                              .TypeConstraint<DstT>("DstT"),  \
+                          FusedCastNormalizeOp<SrcT, DstT>);
+
+#define REGISTER_CAST_NORMALIZE_ALL(SrcT) \
+  REGISTER_CAST_NORMALIZE(SrcT, float)    \
+  REGISTER_CAST_NORMALIZE(SrcT, double)
+
+TF_CALL_uint8(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_int8(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_uint16(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_int16(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_int32(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_int64(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_half(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_bfloat16(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_float(REGISTER_CAST_NORMALIZE_ALL);
+TF_CALL_double(REGISTER_CAST_NORMALIZE_ALL);
+
+#undef REGISTER_CAST_NORMALIZE_ALL
+#undef REGISTER_CAST_NORMALIZE
+
+#define REGISTER_TRANSPOSE_CAST(SrcT)                          \
+  REGISTER_KERNEL_BUILDER(Name("_FusedTransposeCast")          \
+                              .Device(DEVICE_CPU)              \
+                              .TypeConstraint<SrcT>("SrcT")    \
+                              .TypeConstraint<float>("DstT")   \
+                              .HostMemory("perm"),             \
+                          FusedTransposeCastOp<SrcT, float>);
+
+TF_CALL_uint8(REGISTER_TRANSPOSE_CAST);
+TF_CALL_int8(REGISTER_TRANSPOSE_CAST);
+TF_CALL_uint16(REGISTER_TRANSPOSE_CAST);
+TF_CALL_int16(REGISTER_TRANSPOSE_CAST);
+TF_CALL_int32(REGISTER_TRANSPOSE_CAST);
+TF_CALL_int64(REGISTER_TRANSPOSE_CAST);
+TF_CALL_half(REGISTER_TRANSPOSE_CAST);
+TF_CALL_bfloat16(REGISTER_TRANSPOSE_CAST);
+
+#undef REGISTER_TRANSPOSE_CAST
+
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedCastNormalizeOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType src, const std::vector<string>& fused_ops) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_cast_normalize", "_FusedCastNormalize")
+                     .Input(FakeInput(src))
+                     .Input(FakeInput(fused_ops.size(), DT_FLOAT))
+                     .Attr("DstT", DT_FLOAT)
+                     .Attr("fused_ops", fused_ops)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedCastNormalizeOpTest, ScalarArgs) {
+  MakeOp(DT_UINT8, {"Sub", "Mul"});
+  AddInputFromArray<uint8>(TensorShape({2, 2}), {0, 64, 128, 255});
+  AddInputFromArray<float>(TensorShape({}), {127.5f});
+  AddInputFromArray<float>(TensorShape({}), {1.0f / 127.5f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillFn<float>(&expected, [](int i) {
+    const float x[] = {0, 64, 128, 255};
+    return (x[i] - 127.5f) * (1.0f / 127.5f);
+  });
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedCastNormalizeOpTest, PerChannelArgs) {
+  MakeOp(DT_INT32, {"AddV2", "Sub", "RealDiv"});
+  AddInputFromArray<int32>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  AddInputFromArray<float>(TensorShape({3}), {1.0f, 2.0f, 3.0f});
+  AddInputFromArray<float>(TensorShape({3}), {2.0f, 4.0f, 8.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected,
+                          {0.5f, 0.25f, 0.125f, 2.0f, 1.0f, 0.5f});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedCastNormalizeOpTest, MismatchedChannels) {
+  MakeOp(DT_UINT8, {"Sub"});
+  AddInputFromArray<uint8>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 2.0f});
+  Status s = RunOpKernel();
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+TEST_F(FusedCastNormalizeOpTest, UnsupportedOp) {
+  TF_ASSERT_OK(NodeDefBuilder("fused_cast_normalize", "_FusedCastNormalize")
+                   .Input(FakeInput(DT_UINT8))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Attr("DstT", DT_FLOAT)
+                   .Attr("fused_ops", std::vector<string>{"Maximum"})
+                   .Finalize(node_def()));
+  EXPECT_EQ(InitOp().code(), error::INVALID_ARGUMENT);
+}
+
+class FusedTransposeCastOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType src) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_transpose_cast", "_FusedTransposeCast")
+                     .Input(FakeInput(src))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("DstT", DT_FLOAT)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedTransposeCastOpTest, HwcToChw) {
+  MakeOp(DT_UINT8);
+  AddInputFromArray<uint8>(TensorShape({2, 2, 3}),
+                           {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+  AddInputFromArray<int32>(TensorShape({3}), {2, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2, 2}));
+  test::FillValues<float>(&expected, {0, 3, 6, 9, 1, 4, 7, 10, 2, 5, 8, 11});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedTransposeCastOpTest, IdentityPermutation) {
+  MakeOp(DT_INT16);
+  AddInputFromArray<int16>(TensorShape({2, 2}), {-1, 2, -3, 4});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {-1, 2, -3, 4});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedTransposeCastOpTest, InvalidPermutation) {
+  MakeOp(DT_UINT8);
+  AddInputFromArray<uint8>(TensorShape({2, 2}), {0, 1, 2, 3});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 1});
+  Status s = RunOpKernel();
+  EXPECT_EQ(s.code(), error::INVALID_ARGUMENT);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -33,7 +33,21 @@ REGISTER_KERNEL_BUILDER(Name("SummaryWriter").Device(DEVICE_CPU),
 class CreateSummaryFileWriterOp : public OpKernel {
  public:
   explicit CreateSummaryFileWriterOp(OpKernelConstruction* ctx)
-      : OpKernel(ctx) {}
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("max_pending_events",
+                                     &options_.max_pending_events));
+    string overflow_policy;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("overflow_policy", &overflow_policy));
+    if (overflow_policy == "drop_oldest") {
+      options_.overflow_policy = SummaryOverflowPolicy::kDropOldest;
+    } else if (overflow_policy == "drop_newest") {
+      options_.overflow_policy = SummaryOverflowPolicy::kDropNewest;
+    } else {
+      options_.overflow_policy = SummaryOverflowPolicy::kBlock;
+    }
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("compression_type", &options_.compression_type));
+  }
 
   void Compute(OpKernelContext* ctx) override {
     const Tensor* tmp;
@@ -54,16 +68,23 @@ class CreateSummaryFileWriterOp : public OpKernel {
                 errors::InvalidArgument("filename_suffix must be a scalar"));
     const string filename_suffix = tmp->scalar<tstring>()();
 
+    SummaryFileWriterOptions options = options_;
+    options.max_queue = max_queue;
+    options.flush_millis = flush_millis;
     core::RefCountPtr<SummaryWriterInterface> s;
     OP_REQUIRES_OK(ctx, LookupOrCreateResource<SummaryWriterInterface>(
                             ctx, HandleFromInput(ctx, 0), &s,
-                            [max_queue, flush_millis, logdir, filename_suffix,
+                            [options, logdir, filename_suffix,
                              ctx](SummaryWriterInterface** s) {
                               return CreateSummaryFileWriter(
-                                  max_queue, flush_millis, logdir,
-                                  filename_suffix, ctx->env(), s);
+                                  options, logdir, filename_suffix,
+                                  ctx->env(), s);
                             }));
   }
+
+ private:
+  // Options from the attributes. The queue options are inputs.
+  SummaryFileWriterOptions options_;
 };
 REGISTER_KERNEL_BUILDER(Name("CreateSummaryFileWriter").Device(DEVICE_CPU),
                         CreateSummaryFileWriterOp);
@@ -1440,6 +1440,22 @@ REGISTER_OP("_MklTranspose")
     .SetShapeFn(TransposeShapeFn);
 #endif  // INTEL_MKL
 
+REGISTER_OP("_FusedTransposeCast")
+    .Input("x: SrcT")
+    .Input("perm: Tperm")
+    .Output("y: DstT")
+    .Attr("SrcT: {uint8, int8, uint16, int16, int32, int64, half, bfloat16}")
+    .Attr("DstT: {float}")
+    .Attr("Tperm: {int32, int64} = DT_INT32")
+    .SetShapeFn(TransposeShapeFn)
+    .Doc(R"doc(
+Internal operation which is a composition of Transpose and Cast, computed in a
+single pass over the input.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("ConjugateTranspose")
     .Input("x: T")
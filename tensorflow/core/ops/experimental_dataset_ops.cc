@@ -80,6 +80,30 @@ REGISTER_OP("ExperimentalAutoShardDataset")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("BucketedPaddedBatchDataset")
+    .Input("input_dataset: variant")
+    .Input("bucket_boundaries: int64")
+    .Input("bucket_batch_sizes: int64")
+    .Input("padded_shapes: N * int64")
+    .Input("padding_values: Toutput_types")
+    .Input("drop_remainder: bool")
+    .Output("handle: variant")
+    .Attr("length_component: int = 0")
+    .Attr("pad_to_bucket_boundary: bool = false")
+    .Attr("Toutput_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("N: int >= 1")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // bucket_boundaries and bucket_batch_sizes should be vectors.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      // drop_remainder should be a scalar.
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(c->num_inputs() - 1), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("BytesProducedStatsDataset")
     .Input("input_dataset: variant")
     .Input("tag: string")
@@ -149,6 +173,17 @@ REGISTER_OP("UncompressElement")
     .Attr("output_shapes: list(shape) >= 1")
     .SetShapeFn(shape_inference::DatasetIteratorShape);
 
+REGISTER_OP("DataUdf")
+    .Input("args: Targuments")
+    .Output("output: output_types")
+    .Attr("udf_name: string")
+    .Attr("library: string = ''")
+    .Attr("config: string = ''")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::DatasetIteratorShape);
+
 REGISTER_OP("ComputeBatchSize")
     .Input("input_dataset : variant")
     .Output("batch_size : int64")
@@ -360,6 +395,46 @@ REGISTER_OP("ExperimentalDirectedInterleaveDataset")
     .Attr("N: int >= 1")
     .SetShapeFn(shape_inference::ScalarShape);
 
+REGISTER_OP("WeightedMixtureDataset")
+    .Input("weights: resource")
+    .Input("data_input_datasets: N * variant")
+    .Input("seed: int64")
+    .Input("seed2: int64")
+    .Input("buffer_size: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("N: int >= 1")
+    .Attr("stop_on_empty_dataset: bool = false")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      int num_inputs;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &num_inputs));
+      // seed, seed2, and buffer_size should be scalars.
+      for (int i = num_inputs + 1; i < num_inputs + 4; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+      return shape_inference::ScalarShape(c);
+    });
+
+REGISTER_OP("MixtureWeightsHandle")
+    .Output("handle: resource")
+    .Attr("num_inputs: int >= 1")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("AssignMixtureWeights")
+    .Input("handle: resource")
+    .Input("weights: double")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      return Status::OK();
+    });
+
 REGISTER_OP("GroupByReducerDataset")
     .Input("input_dataset: variant")
     .Input("key_func_other_arguments: Tkey_func_other_arguments")
@@ -785,6 +860,19 @@ REGISTER_OP("RandomDataset")
       return shape_inference::ScalarShape(c);
     });
 
+REGISTER_OP("RandomAccessCacheDataset")
+    .Input("input_dataset: variant")
+    .Input("capacity: int64")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      // capacity should be a scalar.
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      return shape_inference::ScalarShape(c);
+    });
+
 REGISTER_OP("ExperimentalRebatchDataset")
     .Input("input_dataset: variant")
     .Input("num_replicas: int64")
@@ -1244,6 +1332,7 @@ REGISTER_OP("DataServiceDataset")
     .Attr("target_workers: string = 'AUTO'")
     .Attr("partial_offload_enabled: bool = false")
     .Attr("ratio_local: float = 0.0")
+    .Attr("uncompress: bool = false")
     .SetIsStateful()
     .SetShapeFn(shape_inference::ScalarShape);
 
@@ -1268,6 +1357,7 @@ REGISTER_OP("DataServiceDatasetV2")
     .Attr("target_workers: string = 'AUTO'")
     .Attr("partial_offload_enabled: bool = false")
     .Attr("ratio_local: float = 0.0")
+    .Attr("uncompress: bool = false")
     .SetIsStateful()
     .SetShapeFn(shape_inference::ScalarShape);
 
@@ -1289,6 +1379,7 @@ REGISTER_OP("FastflowOffloadingFetch")
         .Attr("target_workers: string = 'AUTO'")
         .Attr("partial_offload_enabled: bool = false")
         .Attr("ratio_local: float = 0.0")
+        .Attr("num_epochs: int = -1")
         .SetIsStateful()
         .SetShapeFn(shape_inference::ScalarShape);
 
@@ -1311,6 +1402,7 @@ REGISTER_OP("FastflowOffloadingFetchV2")
         .Attr("target_workers: string = 'AUTO'")
         .Attr("partial_offload_enabled: bool = false")
         .Attr("ratio_local: float = 0.0")
+        .Attr("num_epochs: int = -1")
         .SetIsStateful()
         .SetShapeFn(shape_inference::ScalarShape);
 
@@ -1321,6 +1413,7 @@ REGISTER_OP("RegisterDataset")
     .Output("dataset_id: int64")
     .Attr("external_state_policy: int")
     .Attr("element_spec: string = ''")
+    .Attr("compress_on_worker: bool = false")
     .SetShapeFn(shape_inference::ScalarShape);
 
 REGISTER_OP("InitializeTableFromDataset")
@@ -202,6 +202,27 @@ Cast x of type SrcT to y of DstT.
 _HostCast requires its input and produces its output in host memory.
 )doc");
 
+REGISTER_OP("_FusedCastNormalize")
+    .Input("x: SrcT")
+    .Input("args: num_args * DstT")
+    .Output("y: DstT")
+    .Attr(
+        "SrcT: {uint8, int8, uint16, int16, int32, int64, half, bfloat16, "
+        "float, double}")
+    .Attr("DstT: {float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Internal operation which casts x to DstT and then applies the elementwise
+binary ops in fused_ops (Add, AddV2, Sub, Mul or RealDiv) in order, using the
+corresponding arg as the second operand of each op. Each arg is either a scalar
+or a vector broadcast along the innermost dimension of x.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("Abs")
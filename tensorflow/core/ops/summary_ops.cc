@@ -30,6 +30,10 @@ REGISTER_OP("CreateSummaryFileWriter")
     .Input("max_queue: int32")
     .Input("flush_millis: int32")
     .Input("filename_suffix: string")
+    .Attr("max_pending_events: int >= 0 = 0")
+    .Attr(
+        "overflow_policy: {'block', 'drop_oldest', 'drop_newest'} = 'block'")
+    .Attr("compression_type: {'', 'ZLIB', 'GZIP'} = ''")
     .SetShapeFn(shape_inference::NoOutputs);
 
 REGISTER_OP("CreateSummaryDbWriter")
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <deque>
+
+#include "absl/memory/memory.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -21,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
@@ -31,11 +35,14 @@ namespace {
 
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
-  SummaryFileWriter(int max_queue, int flush_millis, Env* env)
+  SummaryFileWriter(const SummaryFileWriterOptions& options, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
-        max_queue_(max_queue),
-        flush_millis_(flush_millis),
+        max_queue_(options.max_queue),
+        flush_millis_(options.flush_millis),
+        max_pending_events_(options.max_pending_events),
+        overflow_policy_(options.overflow_policy),
+        compression_type_(options.compression_type),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -54,14 +61,18 @@ class SummaryFileWriter : public SummaryWriterInterface {
     string sep = absl::StartsWith(filename_suffix, ".") ? "" : ".";
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+    events_writer_ = tensorflow::MakeUnique<EventsWriter>(
+        io::JoinPath(logdir, "events"), compression_type_);
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
         events_writer_->InitWithSuffix(uniquified_filename_suffix),
         "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+      is_initialized_ = true;
+    }
+    writer_thread_ = absl::WrapUnique(env_->StartThread(
+        ThreadOptions(), "tf_summary_file_writer", [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
@@ -70,11 +81,24 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    const int64_t flush_request = ++flush_requests_;
+    cv_.notify_all();
+    while (completed_flush_requests_ < flush_request) {
+      cv_.wait(ml);
+    }
+    last_flush_ = env_->NowMicros();
+    return TakeWriteStatus();
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      cancelled_ = true;
+      cv_.notify_all();
+    }
+    // The writer thread writes and flushes the remaining events before it
+    // exits.
+    writer_thread_.reset();
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -151,12 +175,34 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
-    queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    if (max_pending_events_ > 0 && queue_.size() >= max_pending_events_) {
+      switch (overflow_policy_) {
+        case SummaryOverflowPolicy::kBlock:
+          write_requested_ = true;
+          cv_.notify_all();
+          while (queue_.size() >= max_pending_events_) {
+            cv_.wait(ml);
+          }
+          break;
+        case SummaryOverflowPolicy::kDropOldest:
+          queue_.pop_front();
+          RecordDroppedEvent();
+          break;
+        case SummaryOverflowPolicy::kDropNewest:
+          RecordDroppedEvent();
+          return TakeWriteStatus();
+      }
     }
-    return Status::OK();
+    queue_.push_back(std::move(event));
+    const uint64 now = env_->NowMicros();
+    if (queue_.size() > max_queue_ || now - last_flush_ > 1000 * flush_millis_) {
+      // Hand the pending events to the writer thread; the caller never waits
+      // for the file system.
+      write_requested_ = true;
+      last_flush_ = now;
+      cv_.notify_all();
+    }
+    return TakeWriteStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -166,28 +212,96 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Writes the pending events in batches, until the writer is destroyed.
+  void WriterLoop() {
+    while (true) {
+      std::deque<std::unique_ptr<Event>> batch;
+      int64_t flush_request;
+      bool cancelled;
+      {
+        mutex_lock ml(mu_);
+        while (!cancelled_ && !write_requested_ &&
+               completed_flush_requests_ == flush_requests_) {
+          if (flush_millis_ <= 0) {
+            cv_.wait(ml);
+          } else if (cv_.wait_for(ml,
+                                  std::chrono::milliseconds(flush_millis_)) ==
+                         std::cv_status::timeout &&
+                     !queue_.empty()) {
+            write_requested_ = true;
+          }
+        }
+        batch.swap(queue_);
+        write_requested_ = false;
+        flush_request = flush_requests_;
+        cancelled = cancelled_;
+        // Wakes up callers blocked on a full queue.
+        cv_.notify_all();
+      }
+      const Status s = WriteBatch(batch);
+      {
+        mutex_lock ml(mu_);
+        write_status_.Update(s);
+        completed_flush_requests_ = flush_request;
+        cv_.notify_all();
+      }
+      if (cancelled) {
+        return;
+      }
+    }
+  }
+
+  Status WriteBatch(const std::deque<std::unique_ptr<Event>>& batch) {
+    for (const std::unique_ptr<Event>& e : batch) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
-  bool is_initialized_;
+  void RecordDroppedEvent() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ++num_dropped_events_;
+    LOG_EVERY_N(WARNING, 1000)
+        << "Summary writer dropped " << num_dropped_events_
+        << " events because more than " << max_pending_events_
+        << " events were waiting to be written.";
+  }
+
+  // Returns the error of the last failed background write, if it has not been
+  // returned yet.
+  Status TakeWriteStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status s = write_status_;
+    write_status_ = Status::OK();
+    return s;
+  }
+
+  bool is_initialized_ TF_GUARDED_BY(mu_);
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  const int64_t max_pending_events_;
+  const SummaryOverflowPolicy overflow_policy_;
+  const string compression_type_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
-  std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  condition_variable cv_;
+  std::deque<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  // Whether the writer thread should write the pending events.
+  bool write_requested_ TF_GUARDED_BY(mu_) = false;
+  // Number of calls to Flush(), and number of those whose events have been
+  // written by the writer thread.
+  int64_t flush_requests_ TF_GUARDED_BY(mu_) = 0;
+  int64_t completed_flush_requests_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  Status write_status_ TF_GUARDED_BY(mu_);
+  int64_t num_dropped_events_ TF_GUARDED_BY(mu_) = 0;
+  // A pointer to allow deferred construction. Only used by the writer thread
+  // after initialization.
+  std::unique_ptr<EventsWriter> events_writer_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> writer_thread_;
 };
 
 }  // namespace
@@ -196,7 +310,24 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result) {
-  SummaryFileWriter* w = new SummaryFileWriter(max_queue, flush_millis, env);
+  SummaryFileWriterOptions options;
+  options.max_queue = max_queue;
+  options.flush_millis = flush_millis;
+  return CreateSummaryFileWriter(options, logdir, filename_suffix, env, result);
+}
+
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result) {
+  if (options.compression_type != io::compression::kNone &&
+      options.compression_type != io::compression::kZlib &&
+      options.compression_type != io::compression::kGzip) {
+    *result = nullptr;
+    return errors::InvalidArgument("Unsupported summary compression type: ",
+                                   options.compression_type);
+  }
+  SummaryFileWriter* w = new SummaryFileWriter(options, env);
   const Status s = w->Initialize(logdir, filename_suffix);
   if (!s.ok()) {
     w->Unref();
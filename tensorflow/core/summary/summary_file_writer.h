@@ -22,6 +22,31 @@ limitations under the License.
 
 namespace tensorflow {
 
+/// \brief What the summary file writer does with a new event when
+/// `max_pending_events` events are already waiting to be written.
+enum class SummaryOverflowPolicy {
+  /// Block the caller until the background writer has caught up.
+  kBlock,
+  /// Drop the oldest pending event.
+  kDropOldest,
+  /// Drop the new event.
+  kDropNewest,
+};
+
+struct SummaryFileWriterOptions {
+  /// Number of pending events that triggers a write.
+  int max_queue = 10;
+  /// Maximum time between writes.
+  int flush_millis = 120000;
+  /// Maximum number of events waiting for the background writer, or 0 for
+  /// no limit.
+  int64_t max_pending_events = 0;
+  SummaryOverflowPolicy overflow_policy = SummaryOverflowPolicy::kBlock;
+  /// Compression of the records in the events file: "", "ZLIB" or "GZIP".
+  /// Compressed files can only be read with a matching RecordReader.
+  string compression_type;
+};
+
 /// \brief Creates SummaryWriterInterface which writes to a file.
 ///
 /// The file is an append-only records file of tf.Event protos. That
@@ -38,6 +63,17 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Like above, with the options given by `options`.
+///
+/// Events are serialized and written by a background thread, so writing a
+/// summary only enqueues it unless `max_pending_events` is reached under
+/// the kBlock policy. Errors of background writes are returned by the next
+/// call to Flush() or to one of the Write methods.
+Status CreateSummaryFileWriter(const SummaryFileWriterOptions& options,
+                               const string& logdir,
+                               const string& filename_suffix, Env* env,
+                               SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
@@ -281,5 +281,102 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+// Returns the steps of the summary events in the events file of `test_name`.
+std::vector<int64_t> ReadEventSteps(Env* env, const string& test_name,
+                                    const string& compression_type) {
+  std::vector<string> files;
+  TF_CHECK_OK(env->GetChildren(testing::TmpDir(), &files));
+  std::vector<int64_t> steps;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, test_name)) {
+      continue;
+    }
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(
+        read_file.get(),
+        io::RecordReaderOptions::CreateRecordReaderOptions(compression_type));
+    tstring record;
+    uint64 offset = 0;
+    while (reader.ReadRecord(&offset, &record).ok()) {
+      Event e;
+      CHECK(e.ParseFromString(record));
+      if (e.has_summary()) {
+        steps.push_back(e.step());
+      }
+    }
+  }
+  return steps;
+}
+
+// Writes events for steps 1 to `num_steps` without triggering a write, so that
+// they all stay pending until the final flush.
+void WritePendingEvents(const SummaryFileWriterOptions& options,
+                        const string& test_name, int num_steps, Env* env) {
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(options, testing::TmpDir(), test_name,
+                                      env, &writer));
+  core::ScopedUnref deleter(writer);
+  for (int step = 1; step <= num_steps; ++step) {
+    std::unique_ptr<Event> e{new Event};
+    e->set_step(step);
+    e->mutable_summary()->add_value()->set_tag("tag");
+    TF_CHECK_OK(writer->WriteEvent(std::move(e)));
+  }
+  TF_CHECK_OK(writer->Flush());
+}
+
+SummaryFileWriterOptions PendingEventsOptions() {
+  SummaryFileWriterOptions options;
+  options.max_queue = 100;
+  options.flush_millis = 3600 * 1000;
+  return options;
+}
+
+TEST_F(SummaryFileWriterTest, DropOldestPendingEvents) {
+  SummaryFileWriterOptions options = PendingEventsOptions();
+  options.max_pending_events = 2;
+  options.overflow_policy = SummaryOverflowPolicy::kDropOldest;
+  WritePendingEvents(options, "drop_oldest_test", 4, &env_);
+  EXPECT_EQ(ReadEventSteps(&env_, "drop_oldest_test", ""),
+            std::vector<int64_t>({3, 4}));
+}
+
+TEST_F(SummaryFileWriterTest, DropNewestPendingEvents) {
+  SummaryFileWriterOptions options = PendingEventsOptions();
+  options.max_pending_events = 2;
+  options.overflow_policy = SummaryOverflowPolicy::kDropNewest;
+  WritePendingEvents(options, "drop_newest_test", 4, &env_);
+  EXPECT_EQ(ReadEventSteps(&env_, "drop_newest_test", ""),
+            std::vector<int64_t>({1, 2}));
+}
+
+TEST_F(SummaryFileWriterTest, BlockOnPendingEvents) {
+  SummaryFileWriterOptions options = PendingEventsOptions();
+  options.max_pending_events = 2;
+  options.overflow_policy = SummaryOverflowPolicy::kBlock;
+  WritePendingEvents(options, "block_test", 5, &env_);
+  EXPECT_EQ(ReadEventSteps(&env_, "block_test", ""),
+            std::vector<int64_t>({1, 2, 3, 4, 5}));
+}
+
+TEST_F(SummaryFileWriterTest, CompressedEvents) {
+  SummaryFileWriterOptions options;
+  options.compression_type = "ZLIB";
+  WritePendingEvents(options, "compressed_test", 3, &env_);
+  EXPECT_EQ(ReadEventSteps(&env_, "compressed_test", "ZLIB"),
+            std::vector<int64_t>({1, 2, 3}));
+}
+
+TEST_F(SummaryFileWriterTest, UnsupportedCompression) {
+  SummaryFileWriterOptions options;
+  options.compression_type = "BROTLI";
+  SummaryWriterInterface* writer;
+  EXPECT_TRUE(errors::IsInvalidArgument(CreateSummaryFileWriter(
+      options, testing::TmpDir(), "unsupported_compression_test", &env_,
+      &writer)));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -31,9 +31,14 @@ limitations under the License.
 namespace tensorflow {
 
 EventsWriter::EventsWriter(const string& file_prefix)
+    : EventsWriter(file_prefix, /*compression_type=*/"") {}
+
+EventsWriter::EventsWriter(const string& file_prefix,
+                           const string& compression_type)
     // TODO(jeff,sanjay): Pass in env and use that here instead of Env::Default
     : env_(Env::Default()),
       file_prefix_(file_prefix),
+      compression_type_(compression_type),
       num_outstanding_events_(0) {}
 
 EventsWriter::~EventsWriter() {
@@ -76,7 +81,9 @@ Status EventsWriter::InitIfNeeded() {
   TF_RETURN_WITH_CONTEXT_IF_ERROR(
       env_->NewWritableFile(filename_, &recordio_file_),
       "Creating writable file ", filename_);
-  recordio_writer_.reset(new io::RecordWriter(recordio_file_.get()));
+  recordio_writer_.reset(new io::RecordWriter(
+      recordio_file_.get(),
+      io::RecordWriterOptions::CreateRecordWriterOptions(compression_type_)));
   if (recordio_writer_ == nullptr) {
     return errors::Unknown("Could not create record writer");
   }
@@ -139,7 +146,13 @@ Status EventsWriter::Flush() {
 Status EventsWriter::Close() {
   Status status = Flush();
   if (recordio_file_ != nullptr) {
-    Status close_status = recordio_file_->Close();
+    // Closing the record writer finishes the compressed stream, if any.
+    Status close_status = recordio_writer_ != nullptr
+                              ? recordio_writer_->Close()
+                              : Status::OK();
+    if (close_status.ok()) {
+      close_status = recordio_file_->Close();
+    }
     if (!close_status.ok()) {
       status = close_status;
     }
@@ -45,6 +45,11 @@ class EventsWriter {
   // Note that it is not recommended to simultaneously have two
   // EventWriters writing to the same file_prefix.
   explicit EventsWriter(const std::string& file_prefix);
+  // Like above, but compresses the records of the events file with
+  // `compression_type` ("", "ZLIB" or "GZIP"). Compressed events files must be
+  // read with a RecordReader using the same compression type.
+  EventsWriter(const std::string& file_prefix,
+               const std::string& compression_type);
   ~EventsWriter();
 
   // Sets the event file filename and opens file for writing.  If not called by
@@ -85,6 +90,7 @@ class EventsWriter {
 
   Env* env_;
   const std::string file_prefix_;
+  const std::string compression_type_;
   std::string file_suffix_;
   std::string filename_;
   std::unique_ptr<WritableFile> recordio_file_;
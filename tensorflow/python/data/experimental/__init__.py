@@ -71,6 +71,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@map_and_batch_with_legacy_function
 @@parallel_interleave
 @@parse_example_dataset
+@@plugin_udf
 @@prefetch_to_device
 @@rejection_resample
 @@sample_from_datasets
@@ -137,6 +138,7 @@ from tensorflow.python.data.experimental.ops.scan_ops import scan
 from tensorflow.python.data.experimental.ops.shuffle_ops import shuffle_and_repeat
 from tensorflow.python.data.experimental.ops.snapshot import snapshot
 from tensorflow.python.data.experimental.ops.take_while_ops import take_while
+from tensorflow.python.data.experimental.ops.udf_ops import plugin_udf
 from tensorflow.python.data.experimental.ops.unique import unique
 from tensorflow.python.data.experimental.ops.writers import TFRecordWriter
 from tensorflow.python.data.ops.dataset_ops import AUTOTUNE
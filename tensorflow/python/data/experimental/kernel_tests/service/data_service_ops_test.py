@@ -667,6 +667,29 @@ class DataServiceOpsTest(data_service_test_base.TestBase,
                                               dataset_id, ds.element_spec)
     self.assertDatasetProduces(from_dataset_id_ds, list(range(num_elements)))
 
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPrewarmDataset(self):
+    cluster = data_service_test_base.TestCluster(num_workers=2)
+
+    num_elements = 10
+    ds = dataset_ops.Dataset.range(num_elements)
+    dataset_id = self.register_dataset(cluster.dispatcher_address(), ds)
+    data_service_ops.prewarm_dataset(cluster.dispatcher_address(), dataset_id)
+    # Each epoch is a new job, which takes over the prewarmed pipelines.
+    for _ in range(3):
+      from_dataset_id_ds = self.from_dataset_id("parallel_epochs", cluster,
+                                                dataset_id, ds.element_spec)
+      self.assertDatasetProduces(
+          from_dataset_id_ds,
+          list(range(num_elements)) * 2,
+          assert_items_equal=True)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPrewarmUnknownDataset(self):
+    cluster = data_service_test_base.TestCluster(num_workers=1)
+    with self.assertRaisesRegex(errors.NotFoundError, "not found"):
+      data_service_ops.prewarm_dataset(cluster.dispatcher_address(), 1000)
+
   @combinations.generate(test_base.default_test_combinations())
   def testFromDatasetIdSharedJobs(self):
     cluster = data_service_test_base.TestCluster(num_workers=2)
@@ -17,6 +17,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
+
 from absl.testing import parameterized
 import numpy as np
 
@@ -24,6 +26,7 @@ from tensorflow.python.data.experimental.kernel_tests.service import test_base a
 from tensorflow.python.data.experimental.ops import data_service_ops
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import readers
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import errors
 from tensorflow.python.ops import math_ops
@@ -85,6 +88,20 @@ class DynamicShardingTest(data_service_test_base.TestBase,
     ds = self._make_dynamic_sharding_dataset(ds, cluster)
     self.assertDatasetProduces(ds, elements, assert_items_equal=True)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testTextLineDatasetRanges(self):
+    cluster = data_service_test_base.TestCluster(num_workers=2)
+    filename = os.path.join(self.get_temp_dir(), "text_lines.txt")
+    lines = [b"line %d" % i for i in range(1000)]
+    with open(filename, "wb") as f:
+      f.write(b"\n".join(lines) + b"\n")
+    ds = readers.TextLineDataset([filename], range_size=256)
+    # The ranges are only exposed as splits if the file is read by the outer
+    # dataset, rather than by a per-file dataset inside `flat_map`.
+    self.assertIsInstance(ds._impl, readers._TextLineDataset)  # pylint: disable=protected-access
+    ds = self._make_dynamic_sharding_dataset(ds, cluster)
+    self.assertDatasetProduces(ds, lines, assert_items_equal=True)
+
   @combinations.generate(test_base.default_test_combinations())
   def testRepeat(self):
     cluster = data_service_test_base.TestCluster(num_workers=2)
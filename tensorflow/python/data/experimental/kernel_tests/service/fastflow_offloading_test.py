@@ -0,0 +1,151 @@
+# Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests prefetching the next epoch's job when partially offloading."""
+
+import time
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.kernel_tests.service import multi_process_cluster
+from tensorflow.python.data.experimental.kernel_tests.service import test_base as data_service_test_base
+from tensorflow.python.data.experimental.ops import data_service_ops
+from tensorflow.python.data.experimental.ops.data_service_ops import ShardingPolicy
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
+
+
+class NextJobPrefetchTest(data_service_test_base.TestBase,
+                          parameterized.TestCase):
+  """Tests the job of the next epoch which is prefetched by each iterator."""
+
+  def _make_offloaded_range_dataset(self,
+                                    num_elements,
+                                    cluster,
+                                    job_name=None,
+                                    num_epochs=None):
+    dataset = dataset_ops.Dataset.range(num_elements)
+    # pylint: disable=protected-access
+    return dataset.apply(
+        data_service_ops._distribute(
+            ShardingPolicy.DYNAMIC,
+            cluster.dispatcher_address(),
+            job_name=job_name,
+            task_refresh_interval_hint_ms=20,
+            partial_offload_enabled=True,
+            ratio_local=0.5,
+            num_epochs=num_epochs))
+
+  def _read_epoch(self, it):
+    return [element.numpy() for element in it]
+
+  def _wait_for_local_tasks(self, cluster, num_tasks):
+    while cluster.num_tasks_on_local_workers() != num_tasks:
+      time.sleep(0.1)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPrefetchHit(self):
+    cluster = multi_process_cluster.MultiProcessCluster(
+        num_local_workers=1, num_remote_workers=1)
+    num_elements = 100
+    num_epochs = 3
+    ds = self._make_offloaded_range_dataset(
+        num_elements, cluster, num_epochs=num_epochs)
+    for epoch in range(num_epochs):
+      self.assertCountEqual(
+          self._read_epoch(iter(ds)), list(range(num_elements)))
+      # Only the prefetched job of the next epoch is left on the local worker.
+      self._wait_for_local_tasks(cluster, 0 if epoch == num_epochs - 1 else 1)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPrefetchMiss(self):
+    cluster = multi_process_cluster.MultiProcessCluster(
+        num_local_workers=1, num_remote_workers=1)
+    num_elements = 100
+    # With `num_epochs=1`, the next job is never prefetched, so each iterator
+    # creates its own job.
+    ds = self._make_offloaded_range_dataset(
+        num_elements, cluster, num_epochs=1)
+    for _ in range(2):
+      self.assertCountEqual(
+          self._read_epoch(iter(ds)), list(range(num_elements)))
+      self._wait_for_local_tasks(cluster, 0)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPrefetchMissForOtherIterator(self):
+    cluster = multi_process_cluster.MultiProcessCluster(
+        num_local_workers=1, num_remote_workers=1)
+    num_elements = 100
+    ds = self._make_offloaded_range_dataset(num_elements, cluster)
+    it0 = iter(ds)
+    it1 = iter(ds)
+    # `it0` prefetches the job of iterator 1, which was already created.
+    self.assertCountEqual(self._read_epoch(it0), list(range(num_elements)))
+    del it0
+    self._wait_for_local_tasks(cluster, 2)
+    self.assertCountEqual(self._read_epoch(it1), list(range(num_elements)))
+    del it1
+    # Iterator 2 releases the job prefetched for iterator 1, and prefetches the
+    # job of iterator 3.
+    self.assertCountEqual(
+        self._read_epoch(iter(ds)), list(range(num_elements)))
+    self._wait_for_local_tasks(cluster, 1)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testCancelReleasesNextJob(self):
+    cluster = multi_process_cluster.MultiProcessCluster(
+        num_local_workers=1, num_remote_workers=1)
+    num_elements = 100
+    ds = self._make_offloaded_range_dataset(num_elements, cluster)
+    it0 = iter(ds)
+    it1 = iter(ds)
+    self.assertCountEqual(self._read_epoch(it0), list(range(num_elements)))
+    del it0
+    # Destroying `it1` before the end of its epoch cancels it, which means
+    # training stopped. The job prefetched for the next epoch is released.
+    next(it1)
+    del it1
+    self._wait_for_local_tasks(cluster, 0)
+    self.assertCountEqual(
+        self._read_epoch(iter(ds)), list(range(num_elements)))
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPrefetchErrorIsPropagated(self):
+    cluster = multi_process_cluster.MultiProcessCluster(
+        num_local_workers=1, num_remote_workers=1)
+    num_elements = 100
+    ds = self._make_offloaded_range_dataset(
+        num_elements, cluster, job_name="job")
+    conflicting_ds = self.make_distributed_range_dataset(
+        num_elements,
+        cluster,
+        processing_mode=ShardingPolicy.OFF,
+        job_name="job")
+    it = iter(ds)
+    with self.assertRaisesRegex(errors.FailedPreconditionError,
+                                "processing mode"):
+      iter(conflicting_ds)
+    # Creates the job of the next epoch with a different processing mode, so
+    # that the prefetched job can't be created.
+    conflicting_it = iter(conflicting_ds)  # pylint: disable=unused-variable
+    self.assertCountEqual(self._read_epoch(it), list(range(num_elements)))
+    with self.assertRaisesRegex(errors.FailedPreconditionError,
+                                "processing mode"):
+      iter(ds)
+
+
+if __name__ == "__main__":
+  multi_process_cluster.test_main()
@@ -135,6 +135,9 @@ class MultiProcessCluster(object):
   def remote_worker_addresses(self):
     return [worker[0] for worker in self._remote_workers]
 
+  def num_tasks_on_local_workers(self):
+    return sum(worker.num_tasks() for worker in self._local_workers)
+
   def _stop(self):
     for worker in self._local_workers:
       worker.stop()
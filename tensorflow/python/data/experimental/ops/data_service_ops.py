@@ -199,7 +199,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
                target_workers="AUTO",
                partial_offload_enabled=False,
                ratio_local=0.0,
-               max_bandwidth_bps=None):
+               max_bandwidth_bps=None,
+               uncompress=False):
     """Constructs a _DataServiceDatasetV2.
 
     Args:
@@ -246,6 +247,9 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         avoid RPCs and data copy if every TF worker colocates with a tf.data
         service worker. Consumers of a shared job must use the same
         `target_workers`. Defaults to `"AUTO"`.
+      uncompress: (Optional.) Whether the elements were compressed by the
+        tf.data service workers and need to be uncompressed when they are
+        fetched. Defaults to `False`.
     """
     processing_mode = _serialize(
         _get_validated_sharding_policy(processing_mode))
@@ -313,6 +317,7 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         partial_offload_enabled=partial_offload_enabled,
         ratio_local=ratio_local,
         max_bandwidth_bps=self._max_bandwidth_bps,
+        uncompress=uncompress,
         **compat_kwargs,
         **self._flat_structure)
     super(_DataServiceDatasetV2, self).__init__(variant_tensor)
@@ -331,7 +336,7 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
                num_consumers, max_outstanding_requests,
                task_refresh_interval_hint_ms, target_workers, 
                partial_offload_enabled, ratio_local,
-               max_bandwidth_bps):
+               max_bandwidth_bps, uncompress=False):
 
     self._wrapped = _DataServiceDatasetV2(
         dataset_id=dataset_id,
@@ -348,7 +353,8 @@ class _DataServiceDatasetV1(dataset_ops.DatasetV1Adapter):
         target_workers=target_workers,
         partial_offload_enabled=partial_offload_enabled,
         ratio_local=ratio_local,
-        max_bandwidth_bps=max_bandwidth_bps)
+        max_bandwidth_bps=max_bandwidth_bps,
+        uncompress=uncompress)
     super(_DataServiceDatasetV1, self).__init__(self._wrapped)
 
 
@@ -370,7 +376,8 @@ class _FastflowOffloadingFetchV2(dataset_ops.DatasetSource):
                target_workers="AUTO",
                partial_offload_enabled=False,
                ratio_local=0.0,
-               max_bandwidth_bps=None):
+               max_bandwidth_bps=None,
+               num_epochs=None):
     """Constructs a _DataServiceDatasetV2.
 
     Args:
@@ -417,6 +424,9 @@ class _FastflowOffloadingFetchV2(dataset_ops.DatasetSource):
         avoid RPCs and data copy if every TF worker colocates with a tf.data
         service worker. Consumers of a shared job must use the same
         `target_workers`. Defaults to `"AUTO"`.
+      num_epochs: (Optional.) The number of epochs that will be read. The job
+        of the next epoch is only prefetched if there is a next epoch. If
+        `None`, it is always prefetched.
     """
     processing_mode = _serialize(
       _get_validated_sharding_policy(processing_mode))
@@ -435,6 +445,8 @@ class _FastflowOffloadingFetchV2(dataset_ops.DatasetSource):
         max_outstanding_requests = dataset_ops.AUTOTUNE
     if task_refresh_interval_hint_ms is None:
         task_refresh_interval_hint_ms = dataset_ops.AUTOTUNE
+    if num_epochs is None:
+        num_epochs = -1
 
     self._dataset_id = ops.convert_to_tensor(
         dataset_id, dtype=dtypes.int64, name="dataset_id")
@@ -484,6 +496,7 @@ class _FastflowOffloadingFetchV2(dataset_ops.DatasetSource):
       partial_offload_enabled=partial_offload_enabled,
       ratio_local=ratio_local,
       max_bandwidth_bps=self._max_bandwidth_bps,
+      num_epochs=num_epochs,
       **compat_kwargs,
       **self._flat_structure)
     super(_FastflowOffloadingFetchV2, self).__init__(variant_tensor)
@@ -503,7 +516,7 @@ class _FastflowOffloadingFetchV1(dataset_ops.DatasetV1Adapter):
                num_consumers, max_outstanding_requests,
                task_refresh_interval_hint_ms, target_workers,
                partial_offload_enabled, ratio_local,
-               max_bandwidth_bps):
+               max_bandwidth_bps, num_epochs=None):
 
     self._wrapped = _FastflowOffloadingFetchV2(
       dataset_id=dataset_id,
@@ -520,7 +533,8 @@ class _FastflowOffloadingFetchV1(dataset_ops.DatasetV1Adapter):
       target_workers=target_workers,
       partial_offload_enabled=partial_offload_enabled,
       ratio_local=ratio_local,
-      max_bandwidth_bps=max_bandwidth_bps)
+      max_bandwidth_bps=max_bandwidth_bps,
+      num_epochs=num_epochs)
     super(_FastflowOffloadingFetchV1, self).__init__(self._wrapped)
 
 
@@ -572,7 +586,8 @@ def _distribute(processing_mode,
                 target_workers="AUTO",
                 partial_offload_enabled=False,
                 ratio_local=0.0,
-                max_bandwidth_bps=None):
+                max_bandwidth_bps=None,
+                num_epochs=None):
   """A transformation that moves dataset processing to the tf.data service.
 
   This transformation is similar to `distribute`, but supports additional
@@ -624,6 +639,9 @@ def _distribute(processing_mode,
       data copy if every TF worker colocates with a tf.data service worker.
       Consumers of a shared job must use the same `target_workers`. Defaults to
       `"AUTO"`.
+    num_epochs: (Optional.) The number of epochs that will be read when
+      `partial_offload_enabled` is set. The job of the next epoch is only
+      prefetched if there is a next epoch. If `None`, it is always prefetched.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
@@ -649,7 +667,8 @@ def _distribute(processing_mode,
         target_workers=target_workers,
         partial_offload_enabled=partial_offload_enabled,
         ratio_local=ratio_local,
-        max_bandwidth_bps=max_bandwidth_bps)
+        max_bandwidth_bps=max_bandwidth_bps,
+        num_epochs=num_epochs)
 
   return _apply_fn
 
@@ -938,10 +957,6 @@ def _register_dataset(service, dataset, compression):
     encoded_spec = coder.encode_structure(
         dataset.element_spec).SerializeToString()
 
-  if compression == COMPRESSION_AUTO:
-    dataset = dataset.map(
-        lambda *x: compression_ops.compress(x),
-        num_parallel_calls=dataset_ops.AUTOTUNE)
   dataset = dataset.prefetch(dataset_ops.AUTOTUNE)
   dataset = dataset._apply_debug_options()  # pylint: disable=protected-access
 
@@ -950,7 +965,8 @@ def _register_dataset(service, dataset, compression):
       address=address,
       protocol=protocol,
       external_state_policy=external_state_policy.value,
-      element_spec=encoded_spec)
+      element_spec=encoded_spec,
+      compress_on_worker=compression == COMPRESSION_AUTO)
 
   return dataset_id
 
@@ -1004,6 +1020,55 @@ def register_dataset(service, dataset, compression="AUTO"):
   return _register_dataset(service, dataset, compression)
 
 
+@tf_export("data.experimental.service.prewarm_dataset")
+def prewarm_dataset(service, dataset_id):
+  """Asks tf.data service workers to prepare a registered dataset ahead of time.
+
+  Building a dataset's pipeline on a worker (importing the graph, instantiating
+  functions, opening files) can take several seconds, which delays the first
+  elements of every job. After `prewarm_dataset`, each worker keeps a pipeline
+  for the dataset instantiated and prefilled, and builds the next one as soon
+  as a job takes it over. This removes the startup gap of later jobs reading
+  the same dataset, such as one job per epoch.
+
+  Only jobs with `processing_mode="parallel_epochs"` (no sharding) that do not
+  use round-robin reads (`num_consumers` unset) use prewarmed pipelines. The
+  dispatcher stops prewarming the dataset once no job has read it for the
+  dispatcher's `job_gc_timeout_ms`; call `prewarm_dataset` again to resume.
+
+  >>> dispatcher = tf.data.experimental.service.DispatchServer()
+  >>> dispatcher_address = dispatcher.target.split("://")[1]
+  >>> worker = tf.data.experimental.service.WorkerServer(
+  ...     tf.data.experimental.service.WorkerConfig(
+  ...         dispatcher_address=dispatcher_address))
+  >>> dataset = tf.data.Dataset.range(10)
+  >>> dataset_id = tf.data.experimental.service.register_dataset(
+  ...     dispatcher.target, dataset)
+  >>> tf.data.experimental.service.prewarm_dataset(dispatcher.target,
+  ...                                              dataset_id)
+  >>> for epoch in range(2):
+  ...   dataset = tf.data.experimental.service.from_dataset_id(
+  ...       processing_mode="parallel_epochs",
+  ...       service=dispatcher.target,
+  ...       dataset_id=dataset_id,
+  ...       element_spec=tf.TensorSpec(shape=(), dtype=tf.int64))
+  ...   print(list(dataset.as_numpy_iterator()))
+  [0, 1, 2, 3, 4, 5, 6, 7, 8, 9]
+  [0, 1, 2, 3, 4, 5, 6, 7, 8, 9]
+
+  Args:
+    service: A string or a tuple indicating how to connect to the tf.data
+      service, in the same format as for
+      `tf.data.experimental.service.register_dataset`.
+    dataset_id: The id of a dataset registered with the tf.data service, as a
+      Python integer or a scalar int64 tensor.
+  """
+  protocol, address = _parse_service(service)
+  if isinstance(dataset_id, ops.Tensor):
+    dataset_id = tensor_util.constant_value(dataset_id)
+  _pywrap_server_lib.TF_DATA_PrewarmDataset(int(dataset_id), address, protocol)
+
+
 def _from_dataset_id(processing_mode,
                      service,
                      dataset_id,
@@ -1018,7 +1083,8 @@ def _from_dataset_id(processing_mode,
                      target_workers="AUTO",
                      partial_offload_enabled=False,
                      ratio_local=0.0,
-                     max_bandwidth_bps=None):
+                     max_bandwidth_bps=None,
+                     num_epochs=None):
   """Creates a dataset which reads data from the tf.data service.
 
   This transformation is similar to `from_dataset_id`, but supports additional
@@ -1076,6 +1142,9 @@ def _from_dataset_id(processing_mode,
       data copy if every TF worker colocates with a tf.data service worker.
       Consumers of a shared job must use the same `target_workers`. Defaults to
       `"AUTO"`.
+    num_epochs: (Optional.) The number of epochs that will be read when
+      `partial_offload_enabled` is set. The job of the next epoch is only
+      prefetched if there is a next epoch. If `None`, it is always prefetched.
 
   Returns:
     A `tf.data.Dataset` which reads from the tf.data service.
@@ -1122,11 +1191,20 @@ def _from_dataset_id(processing_mode,
     coder = nested_structure_coder.StructureCoder()
     element_spec = coder.decode_proto(struct_pb)
 
-  # If we compress, the data service side dataset will produce scalar variants.
+  # If we compress, the workers produce scalar variants. The data service
+  # dataset uncompresses them as they are fetched, except for partially
+  # offloaded reads, which uncompress them in a separate map.
   compression = _decide_compression(compression, data_transfer_protocol)
+  uncompress_in_map = (
+      compression == COMPRESSION_AUTO and partial_offload_enabled)
   data_service_element_spec = (
       tensor_spec.TensorSpec(shape=(), dtype=dtypes.variant)
-      if compression == COMPRESSION_AUTO else element_spec)
+      if uncompress_in_map else element_spec)
+  compat_kwargs = {}
+  if compression == COMPRESSION_AUTO and not partial_offload_enabled:
+    compat_kwargs["uncompress"] = True
+  if partial_offload_enabled:
+    compat_kwargs["num_epochs"] = num_epochs
 
 
   if tf2.enabled():
@@ -1156,8 +1234,9 @@ def _from_dataset_id(processing_mode,
     target_workers=target_workers,
     partial_offload_enabled=partial_offload_enabled,
     ratio_local=ratio_local,
-    max_bandwidth_bps=max_bandwidth_bps)
-  if compression == COMPRESSION_AUTO:
+    max_bandwidth_bps=max_bandwidth_bps,
+    **compat_kwargs)
+  if uncompress_in_map:
     dataset = dataset.map(
         lambda x: compression_ops.uncompress(x, output_spec=element_spec),
         num_parallel_calls=dataset_ops.AUTOTUNE)
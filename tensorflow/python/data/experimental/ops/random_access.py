@@ -18,7 +18,10 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.util import structure
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
 from tensorflow.python.ops import gen_experimental_dataset_ops
 
 
@@ -37,7 +40,9 @@ def at(dataset, index):
      Currently, random access is supported for the following tf.data ops:
      `tf.data.Dataset.from_tensor_slices`, `tf.data.Dataset.shuffle`,
      `tf.data.Dataset.batch`, `tf.data.Dataset.shard`, `tf.data.Dataset.map`,
-     and `tf.data.Dataset.range`.
+     `tf.data.Dataset.range`, `tf.data.Dataset.zip`,
+     `tf.data.Dataset.concatenate`, `tf.data.Dataset.skip`,
+     `tf.data.Dataset.take` and `cache`.
   """
   # pylint: disable=protected-access
   return structure.from_tensor_list(
@@ -47,3 +52,40 @@ def at(dataset, index):
           index,
           output_types=structure.get_flat_tensor_types(dataset.element_spec),
           output_shapes=structure.get_flat_tensor_shapes(dataset.element_spec)))
+
+
+def cache(capacity):
+  """Caches recently accessed elements of a dataset for random access.
+
+  Elements fetched with `at` are kept in a least-recently-used cache of up to
+  `capacity` elements, so that accessing the same index again does not
+  recompute the element through the input pipeline. Iterating over the dataset
+  is unaffected.
+
+  Args:
+    capacity: A `tf.int64` scalar, the maximum number of elements to cache.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    return _RandomAccessCacheDataset(dataset, capacity)
+
+  return _apply_fn
+
+
+class _RandomAccessCacheDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` that caches recently accessed elements of its input."""
+
+  def __init__(self, input_dataset, capacity):
+    self._input_dataset = input_dataset
+    self._capacity = ops.convert_to_tensor(
+        capacity, dtype=dtypes.int64, name="capacity")
+    variant_tensor = gen_experimental_dataset_ops.random_access_cache_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        self._capacity,
+        **self._flat_structure)
+    super(_RandomAccessCacheDataset, self).__init__(input_dataset,
+                                                    variant_tensor)
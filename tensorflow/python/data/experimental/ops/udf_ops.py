@@ -0,0 +1,73 @@
+# Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Python API for compiled tf.data UDFs provided by plugins."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import structure
+from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
+from tensorflow.python.util.tf_export import tf_export
+
+
+@tf_export("data.experimental.plugin_udf")
+def plugin_udf(udf_name, output_signature, library=None, config=None):
+  """Returns a function applying a compiled UDF provided by a plugin.
+
+  The UDF is registered by a shared object implementing the C API defined in
+  `tensorflow/c/experimental/data/udf_plugin.h`. Unlike `tf.py_function`, the
+  UDF runs without the Python GIL, so `map` transformations can apply it with
+  full parallelism, and it can run on tf.data service workers:
+
+  ```python
+  normalize = tf.data.experimental.plugin_udf(
+      "normalize_image",
+      output_signature=tf.TensorSpec([224, 224, 3], tf.float32),
+      library="/path/to/libmy_udfs.so")
+  dataset = dataset.map(normalize, num_parallel_calls=tf.data.AUTOTUNE)
+  ```
+
+  Args:
+    udf_name: The name under which the plugin registered the UDF.
+    output_signature: A nested structure of `tf.TypeSpec` objects describing
+      the output of the UDF. Only dense tensors are supported.
+    library: (Optional.) The path of the shared object providing the UDF. It is
+      loaded in every process running the UDF, so it must be available at the
+      same path on tf.data service workers, whose `data_udf_plugin_allowlist`
+      must list the path. If `None`, the plugin must have been loaded by other
+      means.
+    config: (Optional.) A `bytes` object passed to the UDF when it is
+      instantiated. Defaults to an empty configuration.
+
+  Returns:
+    A function taking the components of an element as positional arguments and
+    returning the transformed element, to be passed to e.g.
+    `tf.data.Dataset.map`.
+  """
+  flat_types = structure.get_flat_tensor_types(output_signature)
+  flat_shapes = structure.get_flat_tensor_shapes(output_signature)
+
+  def apply_udf(*args):
+    outputs = ged_ops.data_udf(
+        nest.flatten(args),
+        udf_name=udf_name,
+        output_types=flat_types,
+        output_shapes=flat_shapes,
+        library=library or "",
+        config=config or b"")
+    return structure.from_tensor_list(output_signature, outputs)
+
+  return apply_udf
@@ -373,6 +373,7 @@ from __future__ import print_function
 
 from tensorflow.python.data.experimental.ops.data_service_ops import distribute
 from tensorflow.python.data.experimental.ops.data_service_ops import from_dataset_id
+from tensorflow.python.data.experimental.ops.data_service_ops import prewarm_dataset
 from tensorflow.python.data.experimental.ops.data_service_ops import register_dataset
 from tensorflow.python.data.experimental.ops.data_service_ops import ShardingPolicy
 from tensorflow.python.data.experimental.service.server_lib import DispatcherConfig
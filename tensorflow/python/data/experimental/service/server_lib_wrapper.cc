@@ -116,4 +116,22 @@ PYBIND11_MODULE(_pywrap_server_lib, m) {
         return py::bytes(element_spec);
       },
       py::return_value_policy::reference);
+
+  m.def("TF_DATA_PrewarmDataset",
+        [](int64_t dataset_id, const std::string& address,
+           const std::string& protocol) {
+          tensorflow::data::DataServiceDispatcherClient client(address,
+                                                               protocol);
+          int64_t deadline_micros = tensorflow::kint64max;
+          tensorflow::Status status;
+          Py_BEGIN_ALLOW_THREADS;
+          status = tensorflow::data::grpc_util::Retry(
+              [&]() { return client.PrewarmDataset(dataset_id); },
+              /*description=*/
+              tensorflow::strings::StrCat(
+                  "prewarm dataset with dispatcher at ", address),
+              deadline_micros);
+          Py_END_ALLOW_THREADS;
+          tensorflow::MaybeRaiseFromStatus(status);
+        });
 };
@@ -20,6 +20,7 @@ from __future__ import print_function
 from absl.testing import parameterized
 import numpy as np
 
+from tensorflow.python.data.experimental.ops import random_access
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
@@ -187,5 +188,32 @@ class ConcatenateCheckpointTest(checkpoint_test_base.CheckpointTestBase,
     verify_fn(self, lambda: self._build_concatenate_dataset(array), num_outputs)
 
 
+
+class ConcatenateRandomAccessTest(test_base.DatasetTestBase,
+                                  parameterized.TestCase):
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(index=[-1, 7, 8])))
+  def testInvalidIndex(self, index):
+    dataset = dataset_ops.Dataset.range(3).concatenate(
+        dataset_ops.Dataset.range(4))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, index=index))
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(first=[0, 1, 5], second=[0, 1, 5])))
+  def testBasic(self, first, second):
+    dataset = dataset_ops.Dataset.range(first).concatenate(
+        dataset_ops.Dataset.range(100, 100 + second))
+    expected = list(range(first)) + list(range(100, 100 + second))
+    for i, value in enumerate(expected):
+      self.assertEqual(value, self.evaluate(random_access.at(dataset, i)))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, len(expected)))
+
+
 if __name__ == "__main__":
   test.main()
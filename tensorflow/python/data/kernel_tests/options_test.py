@@ -156,6 +156,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.experimental_optimization.map_parallelization = True
     options.experimental_optimization.noop_elimination = True
     options.experimental_optimization.parallel_batch = True
+    options.experimental_optimization.preprocessing_fusion = True
     options.experimental_optimization.shuffle_and_repeat_fusion = True
     options.experimental_slack = True
     options.threading.max_intra_op_parallelism = 30
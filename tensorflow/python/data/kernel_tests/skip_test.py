@@ -20,10 +20,12 @@ from __future__ import print_function
 from absl.testing import parameterized
 import numpy as np
 
+from tensorflow.python.data.experimental.ops import random_access
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
 from tensorflow.python.platform import test
 
 
@@ -67,5 +69,28 @@ class SkipDatasetCheckpointTest(checkpoint_test_base.CheckpointTestBase,
     verify_fn(self, lambda: self._build_skip_dataset(count), num_outputs)
 
 
+
+class SkipRandomAccessTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(index=[-1, 7, 8])))
+  def testInvalidIndex(self, index):
+    dataset = dataset_ops.Dataset.range(10).skip(3)
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, index=index))
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(count=[-1, 0, 3, 10, 15])))
+  def testBasic(self, count):
+    dataset = dataset_ops.Dataset.range(10).skip(count)
+    expected = [] if count < 0 else list(range(count, 10))
+    for i, value in enumerate(expected):
+      self.assertEqual(value, self.evaluate(random_access.at(dataset, i)))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, len(expected)))
+
+
 if __name__ == "__main__":
   test.main()
@@ -20,10 +20,12 @@ from __future__ import print_function
 from absl.testing import parameterized
 import numpy as np
 
+from tensorflow.python.data.experimental.ops import random_access
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
 from tensorflow.python.platform import test
 
 
@@ -66,5 +68,38 @@ class TakeDatasetCheckpointTest(checkpoint_test_base.CheckpointTestBase,
     verify_fn(self, lambda: self._build_take_dataset(count), num_outputs)
 
 
+
+class TakeRandomAccessTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(index=[-1, 3, 4])))
+  def testInvalidIndex(self, index):
+    dataset = dataset_ops.Dataset.range(10).take(3)
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, index=index))
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(count=[-1, 0, 3, 10, 15])))
+  def testBasic(self, count):
+    dataset = dataset_ops.Dataset.range(10).take(count)
+    expected = list(range(10)) if count < 0 else list(range(min(count, 10)))
+    for i, value in enumerate(expected):
+      self.assertEqual(value, self.evaluate(random_access.at(dataset, i)))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, len(expected)))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testComposedWithSkipAndCache(self):
+    # An index range of a dataset, as used to hand out a shard of elements.
+    dataset = dataset_ops.Dataset.range(100).map(lambda x: x * 2)
+    dataset = dataset.skip(40).take(10).apply(random_access.cache(4))
+    for i in [3, 0, 3, 9, 0]:
+      self.assertEqual(2 * (40 + i),
+                       self.evaluate(random_access.at(dataset, i)))
+    self.assertDatasetProduces(dataset, [2 * i for i in range(40, 50)])
+
+
 if __name__ == "__main__":
   test.main()
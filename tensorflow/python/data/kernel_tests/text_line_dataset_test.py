@@ -137,6 +137,43 @@ class TextLineDatasetTest(TextLineDatasetTestBase, parameterized.TestCase):
     self.assertDatasetProduces(
         dataset, expected_output=expected_output * 10, assert_items_equal=True)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(range_size=[1, 7, 64, 1024]),
+          combinations.combine(num_parallel_range_reads=[None, 1, 3])))
+  def testRangeRead(self, range_size, num_parallel_range_reads):
+    test_filenames = self._createFiles(2, 20, crlf=True)
+    expected_output = []
+    for j in range(2):
+      expected_output.extend(self._lineText(j, i) for i in range(20))
+    dataset = readers.TextLineDataset(
+        test_filenames,
+        range_size=range_size,
+        num_parallel_range_reads=num_parallel_range_reads)
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testRangeReadCompressed(self):
+    test_filenames = self._createFiles(2, 20, compression_type="GZIP")
+    expected_output = []
+    for j in range(2):
+      expected_output.extend(self._lineText(j, i) for i in range(20))
+    dataset = readers.TextLineDataset(
+        test_filenames,
+        compression_type="GZIP",
+        range_size=16,
+        num_parallel_range_reads=2)
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+  @combinations.generate(test_base.v1_only_combinations())
+  def testRangeReadV1(self):
+    test_filenames = self._createFiles(1, 10)
+    dataset = readers.TextLineDatasetV1(
+        test_filenames, range_size=8, num_parallel_range_reads=2)
+    self.assertDatasetProduces(
+        dataset, expected_output=[self._lineText(0, i) for i in range(10)])
+
   @combinations.generate(test_base.default_test_combinations())
   def testBuffering(self):
     test_filenames = self._createFiles(2, 5, crlf=True)
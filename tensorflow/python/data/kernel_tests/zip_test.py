@@ -22,6 +22,7 @@ from absl.testing import parameterized
 
 import numpy as np
 
+from tensorflow.python.data.experimental.ops import random_access
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
@@ -162,5 +163,39 @@ class ZipCheckpointTest(checkpoint_test_base.CheckpointTestBase,
     verify_fn(self, lambda: self._build_dataset(elements), len(elements))
 
 
+
+class ZipRandomAccessTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(index=[-1, 3, 4])))
+  def testInvalidIndex(self, index):
+    dataset = dataset_ops.Dataset.zip((dataset_ops.Dataset.range(3),
+                                       dataset_ops.Dataset.range(5)))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, index=index))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testNestedStructure(self):
+    dataset = dataset_ops.Dataset.zip(
+        (dataset_ops.Dataset.range(5),
+         (dataset_ops.Dataset.range(10, 20),
+          dataset_ops.Dataset.from_tensor_slices([[1, 2]] * 4))))
+    for i in range(4):
+      a, (b, c) = self.evaluate(random_access.at(dataset, i))
+      self.assertEqual(i, a)
+      self.assertEqual(10 + i, b)
+      self.assertAllEqual([1, 2], c)
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(random_access.at(dataset, 4))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testUnsupportedInput(self):
+    dataset = dataset_ops.Dataset.zip((dataset_ops.Dataset.range(3),
+                                       dataset_ops.Dataset.range(3).repeat(2)))
+    with self.assertRaises(errors.UnimplementedError):
+      self.evaluate(random_access.at(dataset, 0))
+
+
 if __name__ == "__main__":
   test.main()
@@ -304,6 +304,13 @@ class OptimizationOptions(options_lib.OptionsBase):
       "batching and b) you have validated that this optimization improves "
       "performance. If None, defaults to False.")
 
+  preprocessing_fusion = options_lib.create_option(
+      name="preprocessing_fusion",
+      ty=bool,
+      docstring="Whether to fuse elementwise preprocessing ops (e.g. a cast "
+      "followed by normalization) in user-defined functions into single "
+      "kernels. If None, defaults to True.")
+
   shuffle_and_repeat_fusion = options_lib.create_option(
       name="shuffle_and_repeat_fusion",
       ty=bool,
@@ -328,6 +335,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.noop_elimination = self.noop_elimination
     if self.parallel_batch is not None:
       pb.parallel_batch = self.parallel_batch
+    if self.preprocessing_fusion is not None:
+      pb.preprocessing_fusion = self.preprocessing_fusion
     if self.shuffle_and_repeat_fusion is not None:
       pb.shuffle_and_repeat_fusion = self.shuffle_and_repeat_fusion
     return pb
@@ -349,6 +358,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.noop_elimination = pb.noop_elimination
     if pb.WhichOneof("optional_parallel_batch") is not None:
       self.parallel_batch = pb.parallel_batch
+    if pb.WhichOneof("optional_preprocessing_fusion") is not None:
+      self.preprocessing_fusion = pb.preprocessing_fusion
     if pb.WhichOneof("optional_shuffle_and_repeat_fusion") is not None:
       self.shuffle_and_repeat_fusion = pb.shuffle_and_repeat_fusion
 
@@ -67,18 +67,30 @@ def _create_or_validate_filenames_dataset(filenames, name=None):
           "[] (i.e. scalars). Got a dataset of element shape "
           f"{element_shape!r}.")
   else:
-    filenames = nest.map_structure(_normalise_fspath, filenames)
-    filenames = ops.convert_to_tensor(filenames, dtype_hint=dtypes.string)
-    if filenames.dtype != dtypes.string:
-      raise TypeError(
-          "The `filenames` argument must contain `tf.string` elements. Got "
-          f"`{filenames.dtype!r}` elements.")
-    filenames = array_ops.reshape(filenames, [-1], name="flat_filenames")
+    filenames = _create_filenames_tensor(filenames)
     filenames = dataset_ops.TensorSliceDataset(
         filenames, is_files=True, name=name)
   return filenames
 
 
+def _create_filenames_tensor(filenames):
+  """Converts a list of filenames to a flat `tf.string` tensor.
+
+  Args:
+    filenames: A `tf.string` tensor, or a value that can be converted to one.
+
+  Returns:
+    A `tf.string` vector of filenames.
+  """
+  filenames = nest.map_structure(_normalise_fspath, filenames)
+  filenames = ops.convert_to_tensor(filenames, dtype_hint=dtypes.string)
+  if filenames.dtype != dtypes.string:
+    raise TypeError(
+        "The `filenames` argument must contain `tf.string` elements. Got "
+        f"`{filenames.dtype!r}` elements.")
+  return array_ops.reshape(filenames, [-1], name="flat_filenames")
+
+
 def _create_dataset_reader(dataset_creator,
                            filenames,
                            num_parallel_reads=None,
@@ -133,6 +145,8 @@ class _TextLineDataset(dataset_ops.DatasetSource):
                filenames,
                compression_type=None,
                buffer_size=None,
+               range_size=None,
+               num_parallel_range_reads=None,
                name=None):
     """Creates a `TextLineDataset`.
 
@@ -143,6 +157,11 @@ class _TextLineDataset(dataset_ops.DatasetSource):
       buffer_size: (Optional.) A `tf.int64` scalar denoting the number of bytes
         to buffer. A value of 0 results in the default buffering values chosen
         based on the compression type.
+      range_size: (Optional.) If positive, uncompressed files are divided into
+        newline-aligned byte ranges of this size, which are read in parallel
+        and can be distributed by tf.data service dynamic sharding.
+      num_parallel_range_reads: (Optional.) The number of ranges to read in
+        parallel when `range_size` is positive. Defaults to 1.
       name: (Optional.) A name for the tf.data operation.
     """
     self._filenames = filenames
@@ -161,6 +180,9 @@ class _TextLineDataset(dataset_ops.DatasetSource):
     kwargs = {}
     if name or compat.forward_compatible(2021, 9, 30):
       kwargs["metadata"] = self._metadata.SerializeToString()
+    if range_size:
+      kwargs["range_size"] = range_size
+      kwargs["num_parallel_range_reads"] = num_parallel_range_reads or 1
 
     variant_tensor = gen_dataset_ops.text_line_dataset(self._filenames,
                                                        self._compression_type,
@@ -214,6 +236,8 @@ class TextLineDatasetV2(dataset_ops.DatasetSource):
                compression_type=None,
                buffer_size=None,
                num_parallel_reads=None,
+               range_size=None,
+               num_parallel_range_reads=None,
                name=None):
     r"""Creates a `TextLineDataset`.
 
@@ -236,19 +260,43 @@ class TextLineDatasetV2(dataset_ops.DatasetSource):
         input pipeline is I/O bottlenecked, consider setting this parameter to a
         value greater than one to parallelize the I/O. If `None`, files will be
         read sequentially.
+      range_size: (Optional.) A Python integer representing the number of
+        bytes per range. If positive, each uncompressed file is divided into
+        ranges of this size, which are aligned to the next newline and read in
+        parallel. Lines are still produced in file order. If `None`, each file
+        is read as a single range.
+        If `filenames` is not a dataset and `num_parallel_reads` is `None`, the
+        ranges of all files are also exposed as splits, so that tf.data service
+        dynamic sharding can distribute a single large file across workers.
+      num_parallel_range_reads: (Optional.) A Python integer representing the
+        number of ranges of a file to read in parallel when `range_size` is
+        positive. Defaults to 1.
       name: (Optional.) A name for the tf.data operation.
     """
-    filenames = _create_or_validate_filenames_dataset(filenames, name=name)
-    self._filenames = filenames
     self._compression_type = compression_type
     self._buffer_size = buffer_size
 
     def creator_fn(filename):
       return _TextLineDataset(
-          filename, compression_type, buffer_size, name=name)
+          filename,
+          compression_type,
+          buffer_size,
+          range_size=range_size,
+          num_parallel_range_reads=num_parallel_range_reads,
+          name=name)
 
-    self._impl = _create_dataset_reader(
-        creator_fn, filenames, num_parallel_reads, name=name)
+    if (range_size and num_parallel_reads is None and
+        not isinstance(filenames, dataset_ops.DatasetV2)):
+      # Reads all files with a single dataset rather than one dataset per file,
+      # since `flat_map` does not pass split providers on to the datasets it
+      # creates.
+      self._filenames = _create_filenames_tensor(filenames)
+      self._impl = creator_fn(self._filenames)
+    else:
+      self._filenames = _create_or_validate_filenames_dataset(
+          filenames, name=name)
+      self._impl = _create_dataset_reader(
+          creator_fn, self._filenames, num_parallel_reads, name=name)
     variant_tensor = self._impl._variant_tensor  # pylint: disable=protected-access
 
     super(TextLineDatasetV2, self).__init__(variant_tensor)
@@ -267,9 +315,17 @@ class TextLineDatasetV1(dataset_ops.DatasetV1Adapter):
                compression_type=None,
                buffer_size=None,
                num_parallel_reads=None,
+               range_size=None,
+               num_parallel_range_reads=None,
                name=None):
-    wrapped = TextLineDatasetV2(filenames, compression_type, buffer_size,
-                                num_parallel_reads, name)
+    wrapped = TextLineDatasetV2(
+        filenames,
+        compression_type,
+        buffer_size,
+        num_parallel_reads,
+        range_size=range_size,
+        num_parallel_range_reads=num_parallel_range_reads,
+        name=name)
     super(TextLineDatasetV1, self).__init__(wrapped)
 
   __init__.__doc__ = TextLineDatasetV2.__init__.__doc__
@@ -770,6 +770,47 @@ class SummaryWriterTest(test_util.TensorFlowTestCase):
         writer.close()
         self.assertEqual(2, get_total())
 
+  def testCreate_withCompression(self):
+    logdir = self.get_temp_dir()
+    with context.eager_mode():
+      writer = summary_ops.create_file_writer_v2(
+          logdir, experimental_compression_type='GZIP')
+      with writer.as_default():
+        summary_ops.write('tag', 1, step=0)
+      writer.close()
+    files = gfile.ListDirectory(logdir)
+    self.assertLen(files, 1)
+    records = list(
+        tf_record.tf_record_iterator(
+            os.path.join(logdir, files[0]),
+            options=tf_record.TFRecordOptions('GZIP')))
+    self.assertLen(records, 2)
+    event = event_pb2.Event()
+    event.ParseFromString(records[1])
+    self.assertEqual('tag', event.summary.value[0].tag)
+
+  def testCreate_withMaxPendingEvents(self):
+    logdir = self.get_temp_dir()
+    with context.eager_mode():
+      writer = summary_ops.create_file_writer_v2(
+          logdir,
+          experimental_max_pending_events=1,
+          experimental_overflow_policy='block')
+      with writer.as_default():
+        for step in range(10):
+          summary_ops.write('tag', 1, step=step)
+      writer.close()
+    # Blocking on a full queue loses no events.
+    self.assertLen(events_from_logdir(logdir), 11)
+
+  def testCreate_invalidOverflowPolicy_raisesError(self):
+    logdir = self.get_temp_dir()
+    with context.eager_mode():
+      with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                  'overflow_policy'):
+        summary_ops.create_file_writer_v2(
+            logdir, experimental_overflow_policy='drop_all')
+
   def testCreate_fromFunction(self):
     logdir = self.get_temp_dir()
     @def_function.function
@@ -500,7 +500,10 @@ def create_file_writer_v2(logdir,
                           flush_millis=None,
                           filename_suffix=None,
                           name=None,
-                          experimental_trackable=False):
+                          experimental_trackable=False,
+                          experimental_max_pending_events=0,
+                          experimental_overflow_policy="block",
+                          experimental_compression_type=""):
   """Creates a summary file writer for the given log directory.
 
   Args:
@@ -513,6 +516,15 @@ def create_file_writer_v2(logdir,
     experimental_trackable: a boolean that controls whether the returned writer
       will be a `TrackableResource`, which makes it compatible with SavedModel
       when used as a `tf.Module` property.
+    experimental_max_pending_events: the largest number of summaries waiting
+      to be written by the background writer thread, or 0 for no limit.
+    experimental_overflow_policy: what to do with a new summary when
+      `experimental_max_pending_events` summaries are already waiting. One of
+      `"block"` (wait for the writer thread), `"drop_oldest"` or
+      `"drop_newest"`.
+    experimental_compression_type: the compression of the records in the
+      event file. One of `""`, `"ZLIB"` or `"GZIP"`. Compressed event files
+      can only be read by readers that support that compression.
 
   Returns:
     A SummaryWriter object.
@@ -553,7 +565,10 @@ def create_file_writer_v2(logdir,
           logdir=logdir,
           max_queue=max_queue,
           flush_millis=flush_millis,
-          filename_suffix=filename_suffix)
+          filename_suffix=filename_suffix,
+          max_pending_events=experimental_max_pending_events,
+          overflow_policy=experimental_overflow_policy,
+          compression_type=experimental_compression_type)
       if experimental_trackable:
         return _TrackableResourceSummaryWriter(
             create_fn=create_fn, init_op_fn=init_op_fn)